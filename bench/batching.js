@@ -0,0 +1,158 @@
+/**
+ * 自适应合并投递基准测试
+ *
+ * 启动若干个合成音频源会话，用主线程上的忙等模拟不同程度的事件循环负载
+ * （每次阻塞 block 毫秒，按负载比例穿插空闲），分别在固定投递（每个数据包
+ * 一次回调）和自适应合并（setDeliveryBatching）下统计每秒JS回调次数、
+ * 回调延迟和最终的批时长。在Linux CI上使用合成音频源运行，不需要捕获权限。
+ *
+ * 用法:
+ *   npm run build && node bench/batching.js [选项]
+ *
+ * 选项:
+ *   --sessions <n>     会话数（默认 8）
+ *   --duration <秒>    每档持续时间（默认 5）
+ *   --block <ms>       每次忙等的时长（默认 20）
+ *   --loads <列表>     事件循环负载比例，逗号分隔（默认 0,0.25,0.5,0.75,0.9）
+ *   --min <ms>         合并批时长下限（默认 0）
+ *   --max <ms>         合并批时长上限（默认 100）
+ *   --json <path>      JSON输出路径（默认 bench_batching.json）
+ */
+
+const fs = require("fs");
+const { AudioCapture } = require("..");
+
+const args = parseArgs(process.argv.slice(2));
+const sessionCount = parseInt(args.sessions || "8", 10);
+const durationMs = parseFloat(args.duration || "5") * 1000;
+const blockMs = parseFloat(args.block || "20");
+const loads = (args.loads || "0,0.25,0.5,0.75,0.9")
+  .split(",")
+  .map((value) => parseFloat(value));
+const batching = {
+  minLatencyMs: parseFloat(args.min || "0"),
+  maxLatencyMs: parseFloat(args.max || "100"),
+};
+const jsonPath = args.json || "bench_batching.json";
+
+// 按比例占用事件循环：忙等 blockMs，再空闲 blockMs * (1 - load) / load
+function startLoad(load) {
+  if (load <= 0) {
+    return () => {};
+  }
+  let stopped = false;
+  const idleMs = (blockMs * (1 - load)) / load;
+  const tick = () => {
+    if (stopped) {
+      return;
+    }
+    const end = Date.now() + blockMs;
+    while (Date.now() < end) {
+      // 忙等
+    }
+    setTimeout(tick, idleMs);
+  };
+  setTimeout(tick, 0);
+  return () => {
+    stopped = true;
+  };
+}
+
+async function runStep(load, adaptive) {
+  const sessions = [];
+  let callbacks = 0;
+  const cpuBefore = process.cpuUsage();
+
+  for (let i = 0; i < sessionCount; i++) {
+    const capture = new AudioCapture({ source: "synthetic" });
+    capture.setDeliveryBatching(adaptive ? batching : null);
+    if (
+      !capture.startCapture(i + 1, () => {
+        callbacks++;
+      })
+    ) {
+      throw new Error(`第 ${i + 1} 个会话启动失败`);
+    }
+    sessions.push(capture);
+  }
+
+  const stopLoad = startLoad(load);
+  await sleep(durationMs);
+  stopLoad();
+
+  const cpu = process.cpuUsage(cpuBefore);
+  const stats = sessions.map((capture) => capture.getStats());
+  sessions.forEach((capture) => capture.stopCapture());
+
+  const seconds = durationMs / 1000;
+  const max = (key) =>
+    Math.max(...stats.map((item) => item.callbackLatency[key]));
+  return {
+    load,
+    mode: adaptive ? "adaptive" : "fixed",
+    packetsPerSec: round(
+      stats.reduce((total, item) => total + item.packets, 0) / seconds
+    ),
+    callbacksPerSec: round(callbacks / seconds),
+    latencyP50Ms: round(max("p50")),
+    latencyP99Ms: round(max("p99")),
+    batchMsMean: round(
+      stats.reduce((total, item) => total + item.batchMs, 0) / stats.length
+    ),
+    cpuPct: round(((cpu.user + cpu.system) / 1000 / durationMs) * 100),
+  };
+}
+
+async function main() {
+  console.log(
+    `sessions=${sessionCount} duration=${durationMs / 1000}s block=${blockMs}ms ` +
+      `batching=${batching.minLatencyMs}~${batching.maxLatencyMs}ms loads=${loads.join(",")}`
+  );
+
+  const results = [];
+  for (const load of loads) {
+    results.push(await runStep(load, false));
+    await sleep(200);
+    results.push(await runStep(load, true));
+    await sleep(200);
+  }
+
+  console.table(results);
+
+  const report = {
+    sessions: sessionCount,
+    durationMs,
+    blockMs,
+    batching,
+    platform: process.platform,
+    arch: process.arch,
+    node: process.version,
+    results,
+  };
+  fs.writeFileSync(jsonPath, JSON.stringify(report, null, 2));
+  console.log(`JSON结果已写入 ${jsonPath}`);
+}
+
+function parseArgs(argv) {
+  const result = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith("--")) {
+      result[argv[i].slice(2)] = argv[i + 1];
+      i++;
+    }
+  }
+  return result;
+}
+
+function sleep(ms) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+function round(value) {
+  return Math.round(value * 100) / 100;
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
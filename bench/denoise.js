@@ -0,0 +1,149 @@
+/**
+ * 降噪基准测试
+ *
+ * 依次启动 1..N 个合成音频源会话，每个会话声明 denoise → js 的处理图
+ * （降噪在DSP线程池中执行），统计每路流的降噪CPU占用（节点自身计时，
+ * CaptureStats.denoiseCpuMs / denoiseAudioMs）和进程CPU。每档先用增益为1的
+ * gain 节点代替降噪节点跑一遍作为基线，两者进程CPU之差为降噪带来的额外开销。
+ * 在Linux CI上使用合成音频源运行，不需要捕获权限。
+ *
+ * 用法:
+ *   npm run build && node bench/denoise.js [选项]
+ *
+ * 选项:
+ *   --max <n>          最大会话数（默认 32）
+ *   --duration <秒>    每档持续时间（默认 5）
+ *   --reduction <dB>   最大衰减量（默认 20）
+ *   --json <path>      JSON输出路径（默认 bench_denoise.json）
+ */
+
+const fs = require("fs");
+const { AudioCapture } = require("..");
+
+const args = parseArgs(process.argv.slice(2));
+const maxSessions = parseInt(args.max || "32", 10);
+const durationMs = parseFloat(args.duration || "5") * 1000;
+const reduction = parseFloat(args.reduction || "20");
+const jsonPath = args.json || "bench_denoise.json";
+
+const denoiseGraph = [
+  { id: "dn", type: "denoise", reduction, offThread: true },
+  { id: "dn-out", type: "js", input: "dn" },
+];
+
+// 基线：同样在线程池中执行、逐样本处理并投递的节点
+const baselineGraph = [
+  { id: "pass", type: "gain", gain: 1, offThread: true },
+  { id: "pass-out", type: "js", input: "pass" },
+];
+
+async function runSessions(sessionCount, graph) {
+  const sessions = [];
+  const cpuBefore = process.cpuUsage();
+
+  for (let i = 0; i < sessionCount; i++) {
+    const capture = new AudioCapture({ source: "synthetic" });
+    capture.setProcessingGraph(graph);
+    if (!capture.startCapture(i + 1, () => {})) {
+      throw new Error(`第 ${i + 1} 个会话启动失败`);
+    }
+    sessions.push(capture);
+  }
+
+  await sleep(durationMs);
+
+  const cpu = process.cpuUsage(cpuBefore);
+  const stats = sessions.map((capture) => capture.getStats());
+  sessions.forEach((capture) => capture.stopCapture());
+  return { cpuMs: (cpu.user + cpu.system) / 1000, stats };
+}
+
+async function runStep(sessionCount) {
+  const baseline = await runSessions(sessionCount, baselineGraph);
+  await sleep(200);
+  const measured = await runSessions(sessionCount, denoiseGraph);
+
+  // 每路流的降噪CPU占用（占实时的百分比）
+  const streamPct = measured.stats
+    .filter((stats) => stats.denoiseAudioMs > 0)
+    .map((stats) => (stats.denoiseCpuMs / stats.denoiseAudioMs) * 100)
+    .sort((a, b) => a - b);
+  const mean =
+    streamPct.reduce((total, value) => total + value, 0) /
+    Math.max(1, streamPct.length);
+
+  return {
+    sessions: sessionCount,
+    streamCpuPctMean: round(mean),
+    streamCpuPctMax: round(streamPct.length ? streamPct[streamPct.length - 1] : 0),
+    cpuPerSessionPct: round(
+      (measured.cpuMs / durationMs / sessionCount) * 100
+    ),
+    overheadPerSessionPct: round(
+      ((measured.cpuMs - baseline.cpuMs) / durationMs / sessionCount) * 100
+    ),
+    graphDropped: measured.stats.reduce(
+      (total, stats) => total + stats.graphDropped,
+      0
+    ),
+  };
+}
+
+async function main() {
+  const steps = [];
+  for (let n = 1; n <= maxSessions; n *= 2) {
+    steps.push(n);
+  }
+  if (steps[steps.length - 1] !== maxSessions) {
+    steps.push(maxSessions);
+  }
+
+  console.log(
+    `duration=${durationMs / 1000}s reduction=${reduction}dB steps=${steps.join(",")}`
+  );
+
+  const results = [];
+  for (const n of steps) {
+    results.push(await runStep(n));
+    await sleep(200);
+  }
+
+  console.table(results);
+
+  const report = {
+    durationMs,
+    reduction,
+    graph: denoiseGraph,
+    baselineGraph,
+    platform: process.platform,
+    arch: process.arch,
+    node: process.version,
+    results,
+  };
+  fs.writeFileSync(jsonPath, JSON.stringify(report, null, 2));
+  console.log(`JSON结果已写入 ${jsonPath}`);
+}
+
+function parseArgs(argv) {
+  const result = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith("--")) {
+      result[argv[i].slice(2)] = argv[i + 1];
+      i++;
+    }
+  }
+  return result;
+}
+
+function sleep(ms) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+function round(value) {
+  return Math.round(value * 100) / 100;
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,179 @@
+/**
+ * DSP线程池基准测试
+ *
+ * 依次启动 1..N 个合成音频源会话，每个会话声明一个把重采样、下混和电平表
+ * 放在线程池中执行的处理图（offThread），统计每会话CPU占用、进程线程数、
+ * 线程池任务吞吐、窃取次数、最大队列深度和丢弃数，输出表格和JSON。
+ * 线程数不随会话数增长说明离开捕获线程的处理都共享同一个线程池。
+ * 开始前先检查超过一个槽位的大数据块（powersave周期上混到6声道）能完整
+ * 送到线程池中的节点，否则直接失败。
+ *
+ * 用法:
+ *   npm run build && node bench/dsp_pool.js [选项]
+ *
+ * 选项:
+ *   --max <n>          最大会话数（默认 64）
+ *   --duration <秒>    每档持续时间（默认 5）
+ *   --json <path>      JSON输出路径（默认 bench_dsp_pool.json）
+ */
+
+const fs = require("fs");
+const { AudioCapture } = require("..");
+
+const args = parseArgs(process.argv.slice(2));
+const maxSessions = parseInt(args.max || "64", 10);
+const durationMs = parseFloat(args.duration || "5") * 1000;
+const jsonPath = args.json || "bench_dsp_pool.json";
+
+// 线程池是进程级的，任意实例都能读取它的统计
+const probe = new AudioCapture({ source: "synthetic" });
+
+// 每个会话：48kHz源 → 16kHz → 单声道 → 电平表 + js输出端，全部在线程池中执行
+const graph = [
+  { id: "asr-rate", type: "resample", sampleRate: 16000, offThread: true },
+  { id: "asr-mono", type: "remix", channels: 1, input: "asr-rate" },
+  { id: "asr-level", type: "meter", input: "asr-mono" },
+  { id: "asr", type: "js", input: "asr-mono" },
+];
+
+async function runStep(sessionCount) {
+  const sessions = [];
+  const poolBefore = probe.getDspPoolStats();
+  const cpuBefore = process.cpuUsage();
+
+  for (let i = 0; i < sessionCount; i++) {
+    const capture = new AudioCapture({ source: "synthetic" });
+    capture.setProcessingGraph(graph);
+    if (!capture.startCapture(i + 1, () => {})) {
+      throw new Error(`第 ${i + 1} 个会话启动失败`);
+    }
+    sessions.push(capture);
+  }
+
+  await sleep(durationMs);
+
+  const cpu = process.cpuUsage(cpuBefore);
+  const threads = countThreads();
+  const pool = probe.getDspPoolStats();
+  const graphDropped = sessions.reduce(
+    (total, capture) => total + capture.getStats().graphDropped,
+    0
+  );
+  sessions.forEach((capture) => capture.stopCapture());
+
+  const cpuMs = (cpu.user + cpu.system) / 1000;
+  return {
+    sessions: sessionCount,
+    cpuPerSessionPct: round((cpuMs / durationMs / sessionCount) * 100),
+    threads,
+    workers: pool.workers,
+    jobsPerSec: round(((pool.jobs - poolBefore.jobs) / durationMs) * 1000),
+    steals: pool.steals - poolBefore.steals,
+    maxQueueDepth: pool.maxQueueDepth,
+    poolDropped: pool.dropped - poolBefore.dropped,
+    graphDropped,
+  };
+}
+
+// 100ms周期上混到6声道后每块28800个样本，超过一个槽位，应拆分而不是丢弃
+async function checkLargeBlocks() {
+  const capture = new AudioCapture({ source: "synthetic" });
+  capture.setProcessingGraph([
+    { id: "big-6ch", type: "remix", channels: 6 },
+    { id: "big-level", type: "meter", input: "big-6ch", offThread: true },
+    { id: "big", type: "js", input: "big-level" },
+  ]);
+  let frames = 0;
+  const started = capture.startCapture(
+    1,
+    (audioData) => {
+      if (audioData.sink === "big") {
+        frames += audioData.buffer.length / audioData.channels;
+      }
+    },
+    { latencyHint: "powersave" }
+  );
+  if (!started) {
+    throw new Error("大数据块检查的会话启动失败");
+  }
+
+  await sleep(1000);
+  const stats = capture.getStats();
+  capture.stopCapture();
+  await sleep(100);
+
+  if (stats.graphDropped !== 0 || frames === 0) {
+    throw new Error(
+      `大数据块未完整送达线程池节点: graphDropped=${stats.graphDropped} frames=${frames}`
+    );
+  }
+  console.log(`大数据块检查通过: frames=${frames}`);
+}
+
+async function main() {
+  await checkLargeBlocks();
+
+  const steps = [];
+  for (let n = 1; n <= maxSessions; n *= 2) {
+    steps.push(n);
+  }
+  if (steps[steps.length - 1] !== maxSessions) {
+    steps.push(maxSessions);
+  }
+
+  console.log(`duration=${durationMs / 1000}s steps=${steps.join(",")}`);
+
+  const results = [];
+  for (const n of steps) {
+    results.push(await runStep(n));
+    await sleep(200);
+  }
+
+  console.table(results);
+
+  const report = {
+    durationMs,
+    graph,
+    platform: process.platform,
+    arch: process.arch,
+    node: process.version,
+    results,
+  };
+  fs.writeFileSync(jsonPath, JSON.stringify(report, null, 2));
+  console.log(`JSON结果已写入 ${jsonPath}`);
+}
+
+// 进程当前的线程数（只在Linux上可用）
+function countThreads() {
+  try {
+    const status = fs.readFileSync("/proc/self/status", "utf8");
+    const match = status.match(/^Threads:\s+(\d+)/m);
+    return match ? parseInt(match[1], 10) : -1;
+  } catch {
+    return -1;
+  }
+}
+
+function parseArgs(argv) {
+  const result = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith("--")) {
+      result[argv[i].slice(2)] = argv[i + 1];
+      i++;
+    }
+  }
+  return result;
+}
+
+function sleep(ms) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+function round(value) {
+  return Math.round(value * 100) / 100;
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
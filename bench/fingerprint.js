@@ -0,0 +1,144 @@
+/**
+ * 音频指纹基准测试
+ *
+ * 依次启动 1..N 个合成音频源会话，每个会话声明 fingerprint → js 的处理图
+ * （指纹节点总是在DSP线程池中执行），统计收到的指纹记录数和进程CPU时间。
+ * 每档先用 levels 节点代替指纹节点跑一遍作为基线（相同的捕获和投递开销），
+ * 两者CPU时间之差视为指纹提取的开销，输出每CPU秒的指纹数和实时倍数。
+ *
+ * 用法:
+ *   npm run build && node bench/fingerprint.js [选项]
+ *
+ * 选项:
+ *   --max <n>          最大会话数（默认 16）
+ *   --duration <秒>    每档持续时间（默认 5）
+ *   --rate <Hz>        指纹记录的输出频率（默认 4）
+ *   --json <path>      JSON输出路径（默认 bench_fingerprint.json）
+ */
+
+const fs = require("fs");
+const { AudioCapture } = require("..");
+
+const args = parseArgs(process.argv.slice(2));
+const maxSessions = parseInt(args.max || "16", 10);
+const durationMs = parseFloat(args.duration || "5") * 1000;
+const rate = parseFloat(args.rate || "4");
+const jsonPath = args.json || "bench_fingerprint.json";
+
+const fingerprintGraph = [
+  { id: "fp", type: "fingerprint", rate },
+  { id: "fp-out", type: "js", input: "fp" },
+];
+
+// 基线：同样在线程池中执行、以相同频率投递的轻量分析节点
+const baselineGraph = [
+  { id: "lv", type: "levels", rate, offThread: true },
+  { id: "lv-out", type: "js", input: "lv" },
+];
+
+async function runSessions(sessionCount, graph) {
+  const sessions = [];
+  const counts = { records: 0, fingerprints: 0 };
+  const cpuBefore = process.cpuUsage();
+
+  for (let i = 0; i < sessionCount; i++) {
+    const capture = new AudioCapture({ source: "synthetic" });
+    capture.setProcessingGraph(graph);
+    const started = capture.startCapture(i + 1, (data) => {
+      counts.records++;
+      // 每条指纹占一帧：[哈希, 锚点时间]
+      counts.fingerprints += data.buffer.length / data.channels;
+    });
+    if (!started) {
+      throw new Error(`第 ${i + 1} 个会话启动失败`);
+    }
+    sessions.push(capture);
+  }
+
+  await sleep(durationMs);
+
+  const cpu = process.cpuUsage(cpuBefore);
+  sessions.forEach((capture) => capture.stopCapture());
+  return { ...counts, cpuMs: (cpu.user + cpu.system) / 1000 };
+}
+
+async function runStep(sessionCount) {
+  const baseline = await runSessions(sessionCount, baselineGraph);
+  await sleep(200);
+  const measured = await runSessions(sessionCount, fingerprintGraph);
+
+  // 指纹提取本身的CPU时间，基线波动时至少按0.1ms计
+  const fingerprintCpuMs = Math.max(0.1, measured.cpuMs - baseline.cpuMs);
+  const audioSeconds = (sessionCount * durationMs) / 1000;
+  return {
+    sessions: sessionCount,
+    fingerprints: measured.fingerprints,
+    records: measured.records,
+    fingerprintsPerAudioSec: round(measured.fingerprints / audioSeconds),
+    cpuMs: round(measured.cpuMs),
+    baselineCpuMs: round(baseline.cpuMs),
+    fingerprintsPerCpuSec: Math.round(
+      measured.fingerprints / (fingerprintCpuMs / 1000)
+    ),
+    realtimeFactor: round(audioSeconds / (fingerprintCpuMs / 1000)),
+  };
+}
+
+async function main() {
+  const steps = [];
+  for (let n = 1; n <= maxSessions; n *= 2) {
+    steps.push(n);
+  }
+  if (steps[steps.length - 1] !== maxSessions) {
+    steps.push(maxSessions);
+  }
+
+  console.log(
+    `duration=${durationMs / 1000}s rate=${rate}Hz steps=${steps.join(",")}`
+  );
+
+  const results = [];
+  for (const n of steps) {
+    results.push(await runStep(n));
+    await sleep(200);
+  }
+
+  console.table(results);
+
+  const report = {
+    durationMs,
+    rate,
+    graph: fingerprintGraph,
+    baselineGraph,
+    platform: process.platform,
+    arch: process.arch,
+    node: process.version,
+    results,
+  };
+  fs.writeFileSync(jsonPath, JSON.stringify(report, null, 2));
+  console.log(`JSON结果已写入 ${jsonPath}`);
+}
+
+function parseArgs(argv) {
+  const result = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith("--")) {
+      result[argv[i].slice(2)] = argv[i + 1];
+      i++;
+    }
+  }
+  return result;
+}
+
+function sleep(ms) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+function round(value) {
+  return Math.round(value * 100) / 100;
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,113 @@
+/**
+ * 启动到第一帧延迟基准测试
+ *
+ * 分别测量直接 startCapture 和先 prepareCapture 再 startCapture 两种方式下，
+ * 从调用 startCapture 到后端送出第一个数据包的耗时（getStats().firstFrameLatency），
+ * 以及 startCapture 调用本身阻塞JS线程的时间。
+ *
+ * 用法:
+ *   npm run build && node bench/first_frame.js [选项]
+ *
+ * 选项:
+ *   --source synthetic|platform  音频源（默认 platform）
+ *   --pid <pid>                  目标进程（platform 源必需）
+ *   --runs <n>                   每种方式的测量次数（默认 10）
+ *   --timeout <秒>               等待第一帧的超时时间（默认 5）
+ */
+
+const { AudioCapture } = require("..");
+
+const args = parseArgs(process.argv.slice(2));
+const source = args.source || "platform";
+const runs = parseInt(args.runs || "10", 10);
+const timeoutMs = parseFloat(args.timeout || "5") * 1000;
+const targetPid = args.pid ? parseInt(args.pid, 10) : source === "synthetic" ? 1 : 0;
+
+if (!targetPid) {
+  console.error("platform 源需要通过 --pid 指定目标进程");
+  process.exit(1);
+}
+
+async function measure(prepare) {
+  const capture = new AudioCapture({ source });
+
+  if (prepare && !capture.prepareCapture(targetPid)) {
+    throw new Error("prepareCapture 失败");
+  }
+
+  const callStart = process.hrtime.bigint();
+  if (!capture.startCapture(targetPid, () => {})) {
+    throw new Error("startCapture 失败");
+  }
+  const callMs = Number(process.hrtime.bigint() - callStart) / 1e6;
+
+  // 第一帧由原生侧记录，这里只需要等它出现
+  const deadline = Date.now() + timeoutMs;
+  let firstFrameMs = -1;
+  while (Date.now() < deadline) {
+    firstFrameMs = capture.getStats().firstFrameLatency;
+    if (firstFrameMs >= 0) {
+      break;
+    }
+    await sleep(1);
+  }
+
+  capture.stopCapture();
+  return { callMs, firstFrameMs };
+}
+
+async function main() {
+  console.log(`source=${source} pid=${targetPid} runs=${runs}`);
+
+  const results = [];
+  for (const prepare of [false, true]) {
+    const samples = [];
+    for (let i = 0; i < runs; i++) {
+      samples.push(await measure(prepare));
+      await sleep(100);
+    }
+
+    const received = samples.filter((s) => s.firstFrameMs >= 0);
+    results.push({
+      mode: prepare ? "prepare+start" : "start",
+      startCallMs: round(median(samples.map((s) => s.callMs))),
+      firstFrameP50Ms: round(median(received.map((s) => s.firstFrameMs))),
+      firstFrameMaxMs: round(Math.max(...received.map((s) => s.firstFrameMs))),
+      timeouts: samples.length - received.length,
+    });
+  }
+
+  console.table(results);
+}
+
+function median(values) {
+  if (values.length === 0) {
+    return NaN;
+  }
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+function parseArgs(argv) {
+  const result = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith("--")) {
+      result[argv[i].slice(2)] = argv[i + 1];
+      i++;
+    }
+  }
+  return result;
+}
+
+function sleep(ms) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+function round(value) {
+  return Math.round(value * 100) / 100;
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
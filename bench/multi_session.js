@@ -0,0 +1,143 @@
+/**
+ * 多会话并发压力基准测试
+ *
+ * 依次启动 1..N 个并发捕获会话，经过完整的插件管线（后端回调 → 入队 →
+ * TSFN → JS回调），统计每会话CPU占用、事件循环延迟、RSS增长、丢包数
+ * 和回调延迟百分位，输出表格和JSON。
+ *
+ * 用法:
+ *   npm run build && node bench/multi_session.js [选项]
+ *
+ * 选项:
+ *   --source synthetic|platform  音频源（默认 synthetic）
+ *   --trace <path>               按录制的回调节奏回放（replay 源，忽略 --source）
+ *   --pid <pid>                  platform 源的目标进程（Linux上需要PipeWire）
+ *   --max <n>                    最大会话数（默认 64）
+ *   --duration <秒>              每档持续时间（默认 5）
+ *   --json <path>                JSON输出路径（默认 bench_sessions.json）
+ */
+
+const fs = require("fs");
+const { monitorEventLoopDelay } = require("perf_hooks");
+const { AudioCapture } = require("..");
+
+const args = parseArgs(process.argv.slice(2));
+const source = args.trace ? "replay" : args.source || "synthetic";
+const maxSessions = parseInt(args.max || "64", 10);
+const durationMs = parseFloat(args.duration || "5") * 1000;
+const jsonPath = args.json || "bench_sessions.json";
+const targetPid = args.pid ? parseInt(args.pid, 10) : 0;
+
+if (source === "platform" && !targetPid) {
+  console.error("platform 源需要通过 --pid 指定目标进程");
+  process.exit(1);
+}
+
+async function runStep(sessionCount) {
+  const sessions = [];
+  const loopDelay = monitorEventLoopDelay({ resolution: 1 });
+
+  global.gc?.();
+  const rssBefore = process.memoryUsage().rss;
+  const cpuBefore = process.cpuUsage();
+  loopDelay.enable();
+
+  for (let i = 0; i < sessionCount; i++) {
+    const capture = new AudioCapture({
+      source,
+      replay: args.trace ? { trace: args.trace } : undefined,
+    });
+    const pid = source === "platform" ? targetPid : i + 1;
+    if (!capture.startCapture(pid, () => {})) {
+      throw new Error(`第 ${i + 1} 个会话启动失败`);
+    }
+    sessions.push(capture);
+  }
+
+  await sleep(durationMs);
+
+  const cpu = process.cpuUsage(cpuBefore);
+  const rssAfter = process.memoryUsage().rss;
+  loopDelay.disable();
+
+  const stats = sessions.map((capture) => capture.getStats());
+  sessions.forEach((capture) => capture.stopCapture());
+
+  const cpuMs = (cpu.user + cpu.system) / 1000;
+  const sum = (key) => stats.reduce((total, s) => total + s[key], 0);
+  const maxOf = (key) =>
+    Math.max(...stats.map((s) => s.callbackLatency[key]));
+
+  return {
+    sessions: sessionCount,
+    cpuPerSessionPct: round((cpuMs / durationMs / sessionCount) * 100),
+    loopLagP50Ms: round(loopDelay.percentile(50) / 1e6),
+    loopLagP99Ms: round(loopDelay.percentile(99) / 1e6),
+    loopLagMaxMs: round(loopDelay.max / 1e6),
+    rssGrowthMB: round((rssAfter - rssBefore) / 1024 / 1024),
+    packets: sum("packets"),
+    delivered: sum("delivered"),
+    dropped: sum("dropped"),
+    latencyP50Ms: round(maxOf("p50")),
+    latencyP99Ms: round(maxOf("p99")),
+    latencyMaxMs: round(maxOf("max")),
+  };
+}
+
+async function main() {
+  const steps = [];
+  for (let n = 1; n <= maxSessions; n *= 2) {
+    steps.push(n);
+  }
+  if (steps[steps.length - 1] !== maxSessions) {
+    steps.push(maxSessions);
+  }
+
+  console.log(
+    `source=${source} duration=${durationMs / 1000}s steps=${steps.join(",")}`
+  );
+
+  const results = [];
+  for (const n of steps) {
+    results.push(await runStep(n));
+    // 让上一档的残留回调处理完
+    await sleep(200);
+  }
+
+  console.table(results);
+
+  const report = {
+    source,
+    durationMs,
+    platform: process.platform,
+    arch: process.arch,
+    node: process.version,
+    results,
+  };
+  fs.writeFileSync(jsonPath, JSON.stringify(report, null, 2));
+  console.log(`JSON结果已写入 ${jsonPath}`);
+}
+
+function parseArgs(argv) {
+  const result = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith("--")) {
+      result[argv[i].slice(2)] = argv[i + 1];
+      i++;
+    }
+  }
+  return result;
+}
+
+function sleep(ms) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+function round(value) {
+  return Math.round(value * 100) / 100;
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
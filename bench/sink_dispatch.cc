@@ -0,0 +1,291 @@
+/**
+ * 接收端分派基准测试
+ *
+ * 比较同一条处理链（增益 → 峰值表 → 累加）的三种串联方式：
+ * - function-sample: 每一级是 std::function，逐样本调用
+ * - function-packet: 每一级是 AudioDataCallback 形式的 std::function，逐包调用
+ * - static:          audio_sink.h 的静态接收端，逐包调用，按声道数特化
+ * 对 1、2、6 声道各跑一遍，输出每包和每样本的耗时，以及表格和JSON。
+ *
+ * 用法:
+ *   npm run build && npm run bench:sink -- [选项]
+ *
+ * 选项:
+ *   --packets <n>      每种方式的数据包数（默认 200000）
+ *   --frames <n>       每包帧数（默认 480，即48kHz下10毫秒）
+ *   --json <path>      JSON输出路径（默认 bench_sink.json）
+ */
+
+#include "../include/audio_sink.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using audio_capture::AudioDataCallback;
+using audio_capture::AudioSink;
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr float kGain = 0.5f;
+
+// 防止编译器把整条链优化掉
+volatile float g_sink = 0.0f;
+
+// 静态处理链：每一级持有下一级的引用，以相同的 Channels 调用
+
+class SumSink : public AudioSink<SumSink> {
+public:
+  template <int Channels>
+  void Consume(const float *samples, size_t frames, int channels,
+               int /*sample_rate*/, uint64_t /*position*/) {
+    const size_t count = frames * ChannelCount<Channels>(channels);
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+      sum += samples[i];
+    }
+    total += sum;
+  }
+
+  float total = 0.0f;
+};
+
+template <typename Next> class PeakStage : public AudioSink<PeakStage<Next>> {
+public:
+  explicit PeakStage(Next &next) : next_(next) {}
+
+  template <int Channels>
+  void Consume(const float *samples, size_t frames, int channels,
+               int sample_rate, uint64_t position) {
+    const int count = AudioSink<PeakStage>::template ChannelCount<Channels>(
+        channels);
+    for (size_t frame = 0; frame < frames; ++frame) {
+      for (int ch = 0; ch < count; ++ch) {
+        peaks[ch] = std::max(peaks[ch], std::fabs(samples[frame * count + ch]));
+      }
+    }
+    next_.template Consume<Channels>(samples, frames, channels, sample_rate,
+                                     position);
+  }
+
+  float peaks[32] = {};
+
+private:
+  Next &next_;
+};
+
+template <typename Next> class GainStage : public AudioSink<GainStage<Next>> {
+public:
+  explicit GainStage(Next &next) : next_(next) {}
+
+  template <int Channels>
+  void Consume(const float *samples, size_t frames, int channels,
+               int sample_rate, uint64_t position) {
+    const size_t count =
+        frames * AudioSink<GainStage>::template ChannelCount<Channels>(
+                     channels);
+    scratch_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      scratch_[i] = samples[i] * kGain;
+    }
+    next_.template Consume<Channels>(scratch_.data(), frames, channels,
+                                     sample_rate, position);
+  }
+
+private:
+  Next &next_;
+  std::vector<float> scratch_;
+};
+
+struct Result {
+  std::string mode;
+  int channels;
+  double ns_per_packet;
+  double ns_per_sample;
+  float checksum;
+};
+
+template <typename Fn>
+Result Measure(const char *mode, int channels, size_t frames, size_t packets,
+               Fn &&push) {
+  std::vector<float> input(frames * channels);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = std::sin(static_cast<float>(i) * 0.01f);
+  }
+
+  // 预热
+  for (size_t i = 0; i < packets / 10; ++i) {
+    push(input.data());
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < packets; ++i) {
+    push(input.data());
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+  return {mode, channels, ns / packets,
+          ns / (static_cast<double>(packets) * frames * channels), g_sink};
+}
+
+Result RunFunctionSample(int channels, size_t frames, size_t packets) {
+  float total = 0.0f;
+  std::vector<float> peaks(channels, 0.0f);
+  std::function<void(float)> sum = [&total](float sample) { total += sample; };
+  std::function<void(float, int)> peak = [&peaks, &sum](float sample, int ch) {
+    peaks[ch] = std::max(peaks[ch], std::fabs(sample));
+    sum(sample);
+  };
+  std::function<void(float, int)> gain = [&peak](float sample, int ch) {
+    peak(sample * kGain, ch);
+  };
+
+  Result result = Measure("function-sample", channels, frames, packets,
+                          [&](const float *samples) {
+                            for (size_t frame = 0; frame < frames; ++frame) {
+                              for (int ch = 0; ch < channels; ++ch) {
+                                gain(samples[frame * channels + ch], ch);
+                              }
+                            }
+                            g_sink = total;
+                          });
+  result.checksum = total;
+  return result;
+}
+
+Result RunFunctionPacket(int channels, size_t frames, size_t packets) {
+  float total = 0.0f;
+  std::vector<float> peaks(channels, 0.0f);
+  std::vector<float> scratch;
+  AudioDataCallback sum = [&total](const uint8_t *data, size_t length,
+                                   int /*channels*/, int /*sample_rate*/) {
+    const float *samples = reinterpret_cast<const float *>(data);
+    float value = 0.0f;
+    for (size_t i = 0; i < length / sizeof(float); ++i) {
+      value += samples[i];
+    }
+    total += value;
+  };
+  AudioDataCallback peak = [&peaks, &sum](const uint8_t *data, size_t length,
+                                          int channels, int sample_rate) {
+    const float *samples = reinterpret_cast<const float *>(data);
+    size_t frames = length / (sizeof(float) * channels);
+    for (size_t frame = 0; frame < frames; ++frame) {
+      for (int ch = 0; ch < channels; ++ch) {
+        peaks[ch] =
+            std::max(peaks[ch], std::fabs(samples[frame * channels + ch]));
+      }
+    }
+    sum(data, length, channels, sample_rate);
+  };
+  AudioDataCallback gain = [&scratch, &peak](const uint8_t *data,
+                                             size_t length, int channels,
+                                             int sample_rate) {
+    const float *samples = reinterpret_cast<const float *>(data);
+    scratch.resize(length / sizeof(float));
+    for (size_t i = 0; i < scratch.size(); ++i) {
+      scratch[i] = samples[i] * kGain;
+    }
+    peak(reinterpret_cast<const uint8_t *>(scratch.data()), length, channels,
+         sample_rate);
+  };
+
+  Result result = Measure("function-packet", channels, frames, packets,
+                          [&](const float *samples) {
+                            gain(reinterpret_cast<const uint8_t *>(samples),
+                                 frames * channels * sizeof(float), channels,
+                                 kSampleRate);
+                            g_sink = total;
+                          });
+  result.checksum = total;
+  return result;
+}
+
+Result RunStatic(int channels, size_t frames, size_t packets) {
+  SumSink sum;
+  PeakStage<SumSink> peak(sum);
+  GainStage<PeakStage<SumSink>> gain(peak);
+
+  Result result = Measure("static", channels, frames, packets,
+                          [&](const float *samples) {
+                            gain.Push(samples, frames, channels, kSampleRate,
+                                      0);
+                            g_sink = sum.total;
+                          });
+  result.checksum = sum.total;
+  return result;
+}
+
+const char *Arg(int argc, char **argv, const char *name, const char *fallback) {
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (std::strcmp(argv[i], name) == 0) {
+      return argv[i + 1];
+    }
+  }
+  return fallback;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const size_t packets =
+      std::strtoull(Arg(argc, argv, "--packets", "200000"), nullptr, 10);
+  const size_t frames =
+      std::strtoull(Arg(argc, argv, "--frames", "480"), nullptr, 10);
+  const char *json_path = Arg(argc, argv, "--json", "bench_sink.json");
+  if (packets == 0 || frames == 0) {
+    std::fprintf(stderr, "参数错误: --packets 和 --frames 必须为正整数\n");
+    return 1;
+  }
+
+  std::printf("packets=%zu frames=%zu\n", packets, frames);
+
+  std::vector<Result> results;
+  for (int channels : {1, 2, 6}) {
+    results.push_back(RunFunctionSample(channels, frames, packets));
+    results.push_back(RunFunctionPacket(channels, frames, packets));
+    results.push_back(RunStatic(channels, frames, packets));
+  }
+
+  std::printf("%-16s %8s %14s %14s %10s\n", "mode", "channels", "ns/packet",
+              "ns/sample", "vs static");
+  for (const Result &result : results) {
+    double baseline = 0;
+    for (const Result &other : results) {
+      if (other.mode == "static" && other.channels == result.channels) {
+        baseline = other.ns_per_packet;
+      }
+    }
+    std::printf("%-16s %8d %14.1f %14.3f %9.2fx\n", result.mode.c_str(),
+                result.channels, result.ns_per_packet, result.ns_per_sample,
+                baseline > 0 ? result.ns_per_packet / baseline : 0.0);
+  }
+
+  FILE *file = std::fopen(json_path, "w");
+  if (!file) {
+    std::fprintf(stderr, "无法写入 %s\n", json_path);
+    return 1;
+  }
+  std::fprintf(file, "{\n  \"packets\": %zu,\n  \"frames\": %zu,\n", packets,
+               frames);
+  std::fprintf(file, "  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &result = results[i];
+    std::fprintf(file,
+                 "    { \"mode\": \"%s\", \"channels\": %d, "
+                 "\"nsPerPacket\": %.1f, \"nsPerSample\": %.3f }%s\n",
+                 result.mode.c_str(), result.channels, result.ns_per_packet,
+                 result.ns_per_sample, i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(file, "  ]\n}\n");
+  std::fclose(file);
+  std::printf("JSON结果已写入 %s\n", json_path);
+  return 0;
+}
@@ -1,9 +1,29 @@
 {
+  "variables": {
+    "rt_check%": "false"
+  },
   "targets": [
     {
       "target_name": "process-audio-capture",
       "sources": [
         "src/audio_capture_addon.cc",
+        "src/trace.cc",
+        "src/rt_check.cc",
+        "src/capture_stats.cc",
+        "src/level_trigger.cc",
+        "src/idle_suspend.cc",
+        "src/metrics.cc",
+        "src/delivery_batcher.cc",
+        "src/synthetic_audio_capture.cc",
+        "src/cadence_trace.cc",
+        "src/replay_audio_capture.cc",
+        "src/target_switcher.cc",
+        "src/audio_mixer.cc",
+        "src/processing_graph.cc",
+        "src/dsp_pool.cc",
+        "src/fft.cc",
+        "src/fingerprint.cc",
+        "src/noise_suppressor.cc",
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -18,6 +38,22 @@
       "cflags!": ["-fno-exceptions"],
       "cflags_cc!": ["-fno-exceptions"],
       "conditions": [
+        ["rt_check=='true'", {
+          "defines": [
+            "AUDIO_CAPTURE_RT_CHECK=1"
+          ],
+          "conditions": [
+            ["OS=='linux'", {
+              "ldflags": [
+                "-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free",
+                "-Wl,--wrap=_Znwm,--wrap=_Znam,--wrap=_ZdlPv,--wrap=_ZdaPv,--wrap=_ZdlPvm,--wrap=_ZdaPvm",
+                "-Wl,--wrap=pthread_mutex_lock,--wrap=pthread_cond_wait,--wrap=pthread_cond_timedwait",
+                "-Wl,--wrap=nanosleep,--wrap=usleep,--wrap=read,--wrap=write,--wrap=poll",
+                "-Wl,--wrap=napi_call_threadsafe_function"
+              ]
+            }]
+          ]
+        }],
         ["OS=='mac'", {
           "sources": [
             "src/mac/mac_audio_capture.mm",
@@ -65,7 +101,8 @@
             "-lgdiplus",
             "-lversion",
             "-lmmdevapi",
-            "-lavrt"
+            "-lavrt",
+            "-lws2_32"
           ],
           "msvs_settings": {
             "VCCLCompilerTool": {
@@ -79,6 +116,25 @@
             "WIN32_LEAN_AND_MEAN",
             "NOMINMAX"
           ]
+        }],
+        ["OS=='linux'", {
+          "sources": [
+            "src/linux/linux_audio_capture.cc",
+            "src/linux/linux_permission_manager.cc",
+            "src/linux/linux_utils.cc",
+            "src/linux/process_manager.cc",
+            "src/linux/audio_tap.cc"
+          ],
+          "include_dirs": [
+            "include/linux"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "<!@(pkg-config --cflags libpipewire-0.3)"
+          ],
+          "libraries": [
+            "<!@(pkg-config --libs libpipewire-0.3)"
+          ]
         }]
       ]
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "process_manager.h"
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -19,6 +20,8 @@ namespace audio_capture {
 // 使用process_manager中的类型
 using ProcessInfo = process_manager::ProcessInfo;
 
+class IdleSuspend;
+
 /**
  * @typedef AudioDataCallback
  * @brief PCM音频数据回调函数类型
@@ -33,6 +36,77 @@ using ProcessInfo = process_manager::ProcessInfo;
 using AudioDataCallback = std::function<void(const uint8_t *data, size_t length,
                                              int channels, int sampleRate)>;
 
+/**
+ * @typedef EndedCallback
+ * @brief 捕获会话因外部原因结束时的回调类型
+ *
+ * @param reason 结束原因：
+ *   - "process-exited" 目标进程退出
+ *   - "stream-removed" 目标的音频流或设备被移除
+ *   - "stream-error" 音频流出错
+ */
+using EndedCallback = std::function<void(const char *reason)>;
+
+/**
+ * @typedef ChannelLayout
+ * @brief 各声道的位置，顺序与交错数据一致
+ *
+ * 使用常见的简写：FL、FR、FC、LFE、RL、RR、SL、SR 等，
+ * 位置未知的声道为 AUX0、AUX1……
+ */
+using ChannelLayout = std::vector<std::string>;
+
+/**
+ * @struct CaptureOptions
+ * @brief 捕获会话的配置项
+ *
+ * 在Prepare阶段传入，所有字段都有默认值。
+ */
+struct CaptureOptions {
+  /// 后端准备阶段等待系统异步激活的超时时间（毫秒）
+  uint32_t activation_timeout_ms = 10000;
+
+  /// 取消标志（可为空）。Prepare在其他线程执行时，调用方置位后应尽快返回false
+  std::shared_ptr<std::atomic<bool>> cancel_flag;
+
+  /// 期望的捕获周期（按48kHz计的帧数），0表示使用后端默认值。
+  /// 后端按各自的机制尽量接近（缓冲区帧数、node.latency、轮询间隔），
+  /// 实际周期以统计中的数据包大小为准
+  uint32_t period_frames = 0;
+
+  /// 按音频源自身的采样率和声道布局捕获，不让系统下混或重采样。
+  /// 需要其他格式时由处理图的 resample/remix 阶段转换
+  bool native_format = false;
+
+  /// 空闲挂起策略（可为空）。长时间数字静音时后端按它停止音频流，
+  /// 改为低开销的空闲监视，不支持的后端忽略
+  std::shared_ptr<IdleSuspend> idle_suspend;
+
+  /// 后端trace事件记录用的会话ID，0表示使用目标进程ID
+  uint32_t trace_session = 0;
+
+  /// 是否已被调用方取消
+  bool IsCancelled() const { return cancel_flag && cancel_flag->load(); }
+
+  /// 后端trace事件的会话ID
+  uint32_t TraceSession(uint32_t pid) const {
+    return trace_session != 0 ? trace_session : pid;
+  }
+
+  /// 把期望的捕获周期换算为指定采样率下的帧数，未设置时返回0
+  uint32_t PeriodFramesAt(int sample_rate) const {
+    return static_cast<uint32_t>(static_cast<uint64_t>(period_frames) *
+                                 sample_rate / kReferenceSampleRate);
+  }
+
+  /// period_frames 所按的采样率
+  static constexpr int kReferenceSampleRate = 48000;
+  /// latencyHint 为 interactive 时的周期（约5ms）
+  static constexpr uint32_t kInteractivePeriodFrames = 240;
+  /// latencyHint 为 powersave 时的周期（约100ms）
+  static constexpr uint32_t kPowersavePeriodFrames = 4800;
+};
+
 /**
  * @class AudioCapture
  * @brief 音频捕获接口类
@@ -49,21 +123,59 @@ public:
    */
   virtual ~AudioCapture() = default;
 
+  /**
+   * @brief 预先准备指定进程的音频捕获
+   * @param pid 目标进程ID
+   * @param options 捕获配置
+   * @return 是否成功准备
+   *
+   * 完成所有耗时的后端初始化（创建tap/聚合设备、激活音频客户端、连接音频流等），
+   * 但不开始投递数据。之后调用Start()即可快速开始捕获。
+   * 已准备其他进程时会先释放之前的准备结果。
+   */
+  virtual bool Prepare(uint32_t pid, const CaptureOptions &options) = 0;
+
+  /**
+   * @brief 开始投递已准备好的捕获会话的音频数据
+   * @param callback 接收音频数据的回调函数
+   * @return 是否成功启动捕获
+   *
+   * 必须先调用Prepare()。该调用只做轻量操作，不会等待系统异步激活。
+   */
+  virtual bool Start(AudioDataCallback callback) = 0;
+
+  /**
+   * @brief 是否已为指定进程准备好且尚未开始捕获
+   * @param pid 目标进程ID
+   */
+  virtual bool IsPreparedFor(uint32_t pid) const = 0;
+
   /**
    * @brief 开始捕获指定进程的音频
    * @param pid 目标进程ID
    * @param callback 接收音频数据的回调函数
+   * @param options 捕获配置（已为该进程Prepare时忽略）
    * @return 是否成功启动捕获
    *
    * 开始捕获指定进程的音频，并通过回调函数返回PCM数据。
+   * 若尚未为该进程调用Prepare()，会先同步完成准备。
    */
-  virtual bool StartCapture(uint32_t pid, AudioDataCallback callback) = 0;
+  bool StartCapture(uint32_t pid, AudioDataCallback callback,
+                    const CaptureOptions &options = CaptureOptions()) {
+    if (IsCapturing()) {
+      return false;
+    }
+    if (!IsPreparedFor(pid) && !Prepare(pid, options)) {
+      return false;
+    }
+    return Start(std::move(callback));
+  }
 
   /**
    * @brief 停止捕获
    * @return 是否成功停止捕获
    *
-   * 停止当前的音频捕获，释放相关资源。
+   * 停止当前的音频捕获，释放相关资源（包括尚未开始的准备结果）。
    */
   virtual bool StopCapture() = 0;
 
@@ -74,6 +186,21 @@ public:
    * 返回当前是否正在进行音频捕获。
    */
   virtual bool IsCapturing() const = 0;
+
+  /**
+   * @brief 获取当前捕获格式的声道布局
+   * @return 声道位置，尚未准备或后端不支持时为空
+   */
+  virtual ChannelLayout GetChannelLayout() const { return ChannelLayout(); }
+
+  /**
+   * @brief 设置会话因外部原因结束时的回调
+   * @param callback 在后端线程最多调用一次，之后不再投递数据
+   *
+   * 必须在Start()之前设置。收到回调后调用方应尽快调用StopCapture()
+   * 释放线程和系统资源。不监视目标的后端（合成、回放）忽略。
+   */
+  virtual void SetEndedCallback(EndedCallback /*callback*/) {}
 };
 
 /**
@@ -84,4 +211,16 @@ public:
  */
 std::unique_ptr<AudioCapture> CreatePlatformAudioCapture();
 
+/**
+ * @brief 工厂函数 - 创建捕获输入设备（麦克风）的平台实现
+ * @param device 输入设备标识（Linux为节点名或序号，Windows为端点ID，
+ *               macOS为设备UID），为空时使用系统默认输入设备
+ * @return 输入设备的AudioCapture实例
+ *
+ * 返回的实例与进程捕获使用同样的接口，Prepare/StartCapture的pid参数
+ * 不用于选择音频源，只作为trace的会话ID。
+ */
+std::unique_ptr<AudioCapture>
+CreatePlatformInputCapture(const std::string &device);
+
 } // namespace audio_capture
\ No newline at end of file
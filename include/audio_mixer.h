@@ -0,0 +1,245 @@
+#pragma once
+
+#include "audio_capture.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file audio_mixer.h
+ * @brief 多进程音频混音会话
+ *
+ * 同时捕获多个进程的音频，在原生侧按各自的增益/静音混成一路立体声输出，
+ * 或按分轨模式把每个音频源输出到各自的立体声轨道。
+ */
+
+namespace audio_capture {
+
+/**
+ * @class StereoDownmix
+ * @brief 把任意声道数的交错帧混成立体声
+ *
+ * 声道按 WAVE 默认顺序解释（FL FR FC LFE 后置 侧置）：前两个声道为左右，
+ * 中置和成对之外的单个环绕声道以 -3dB 分到两侧，LFE 丢弃，成对的环绕声道
+ * 以 -3dB 分别进左右。两侧再各自按权重和归一化，避免多声道叠加后削波。
+ * 单声道复制到两侧。权重在 Configure 时计算，Apply 不分配内存。
+ */
+class StereoDownmix {
+public:
+  /// 参与混合的最大声道数，更多的声道被忽略
+  static constexpr int kMaxChannels = 32;
+
+  explicit StereoDownmix(int channels = 2) { Configure(channels); }
+
+  void Configure(int channels);
+  int channels() const { return channels_; }
+
+  /// 混合一帧（channels() 个交错样本）
+  void Apply(const float *frame, float *left, float *right) const {
+    float l = 0.0f;
+    float r = 0.0f;
+    for (int c = 0; c < used_; ++c) {
+      l += frame[c] * left_[c];
+      r += frame[c] * right_[c];
+    }
+    *left = l;
+    *right = r;
+  }
+
+private:
+  int channels_ = 0;
+  int used_ = 0;
+  float left_[kMaxChannels] = {};
+  float right_[kMaxChannels] = {};
+};
+
+/**
+ * @typedef CaptureFactory
+ * @brief 创建子音频源捕获实现的工厂函数
+ */
+using CaptureFactory = std::function<std::unique_ptr<AudioCapture>()>;
+
+/**
+ * @struct MixSourceInfo
+ * @brief 混音源的状态快照
+ */
+struct MixSourceInfo {
+  uint32_t pid;
+  float gain;
+  bool muted;
+  const char *state;  ///< "waiting" | "priming" | "running"
+  uint64_t underruns; ///< 缓冲区欠载次数
+  double drift_ppm;   ///< 当前的漂移校正量（百万分之一）
+};
+
+/**
+ * @class AudioMixer
+ * @brief 多音频源混音器
+ *
+ * 每个音频源在自己的回调线程中被转换为输出格式（立体声、输出采样率）并写入
+ * 独立的无锁环形缓冲区。混音线程以固定周期从各缓冲区读取同样数量的帧，
+ * 按增益累加后输出，因此各音频源以到达时间为时间戳对齐到同一时钟：
+ * - 新音频源先缓冲到目标延迟（priming）再参与混音；
+ * - 缓冲区水位相对目标延迟的偏差驱动每个音频源的重采样比，补偿时钟漂移；
+ * - 欠载（音频源消失或暂停）时该音频源输出静音并重新进入priming；
+ * - 启动失败的音频源（例如目标进程尚未播放）由后台线程定期重试。
+ *
+ * 分轨模式下各音频源不相加，而是写入交错输出中自己的立体声轨道，
+ * 经过同样的对齐和漂移校正后各轨道逐样本对应。
+ */
+class AudioMixer {
+public:
+  static constexpr size_t kMaxSources = 16;
+  static constexpr int kChannels = 2;
+
+  /**
+   * @brief 构造函数
+   * @param factory 创建子音频源的工厂
+   * @param sample_rate 输出采样率（Hz）
+   * @param period_frames 每次输出的帧数
+   * @param stems 分轨数量，0表示混成一路立体声；大于0时输出 stems*2 声道
+   * @param session 所属会话ID，混音周期按它记录trace
+   */
+  explicit AudioMixer(CaptureFactory factory, int sample_rate = 48000,
+                      int period_frames = 480, int stems = 0,
+                      uint32_t session = 0);
+  ~AudioMixer();
+
+  /**
+   * @brief 开始输出混音数据
+   * @param callback 接收混音结果的回调（交错float，声道数见GetChannels()）
+   */
+  bool Start(AudioDataCallback callback);
+
+  /**
+   * @brief 停止所有音频源和混音线程
+   */
+  bool Stop();
+
+  bool IsRunning() const { return running_.load(); }
+
+  /**
+   * @brief 输出的声道数
+   */
+  int GetChannels() const { return out_channels_; }
+
+  /**
+   * @brief 输出的声道布局，分轨模式下第一个轨道为FL/FR，其余轨道的声道记为AUX
+   */
+  ChannelLayout GetChannelLayout() const;
+
+  /**
+   * @brief 添加音频源
+   * @param pid 目标进程ID
+   * @param gain 线性增益
+   * @param muted 是否静音
+   * @param factory 该音频源使用的捕获工厂（例如麦克风），为空时使用混音器的工厂
+   * @param stem 分轨模式下输出到的轨道序号
+   * @return 是否已添加（暂时无法启动的音频源也会被添加并稍后重试）
+   */
+  bool AddSource(uint32_t pid, float gain = 1.0f, bool muted = false,
+                 CaptureFactory factory = nullptr, int stem = 0);
+
+  /**
+   * @brief 移除音频源
+   */
+  bool RemoveSource(uint32_t pid);
+
+  bool SetGain(uint32_t pid, float gain);
+  bool SetMuted(uint32_t pid, bool muted);
+
+  /**
+   * @brief 获取所有音频源的状态
+   */
+  std::vector<MixSourceInfo> GetSources() const;
+
+private:
+  static constexpr size_t kRingFrames = size_t{1} << 15;
+  static constexpr double kMaxDriftPpm = 5000.0;
+
+  enum class SourceState : int { kWaiting, kPriming, kRunning };
+
+  struct Source {
+    uint32_t pid = 0;
+    CaptureFactory factory; ///< 为空时使用混音器的工厂
+    int stem = 0;           ///< 分轨模式下的输出轨道
+    std::unique_ptr<AudioCapture> capture;
+    std::atomic<float> gain{1.0f};
+    std::atomic<bool> muted{false};
+    std::atomic<int> state{static_cast<int>(SourceState::kWaiting)};
+    bool busy = false;    ///< 正在由后台线程启动（受control_mutex_保护）
+    bool removed = false; ///< 启动期间被移除，由后台线程释放
+    std::atomic<bool> ended{false}; ///< 后端报告目标已结束（进程退出等）
+
+    // 环形缓冲区（交错立体声，输出采样率）
+    std::vector<float> ring;
+    std::atomic<size_t> ring_read{0};
+    std::atomic<size_t> ring_write{0};
+
+    // 生产者（音频源回调线程）的重采样状态
+    double phase = 0.0;
+    float last[kChannels] = {0.0f, 0.0f}; ///< 上一包最后一帧（已混成立体声）
+    StereoDownmix downmix;
+    std::atomic<double> ratio_adjust{1.0};
+
+    // 消费者（混音线程）的状态
+    float applied_gain = 0.0f;
+    double fill_error = 0.0;
+    std::atomic<uint64_t> underruns{0};
+  };
+
+  CaptureFactory factory_;
+  uint32_t session_;
+  int sample_rate_;
+  int period_frames_;
+  int stems_;
+  int out_channels_;
+  size_t target_fill_;
+
+  std::atomic<bool> running_{false};
+  AudioDataCallback callback_;
+  std::array<std::atomic<Source *>, kMaxSources> sources_{};
+  // 混音线程进入周期时加一、结束时再加一，奇数表示周期进行中
+  std::atomic<uint64_t> tick_{0};
+
+  // 控制操作（增删音频源、重试）互斥，不在音频路径上
+  mutable std::mutex control_mutex_;
+
+  std::thread mix_thread_;
+  std::thread supervisor_thread_;
+  std::mutex supervisor_mutex_;
+  std::condition_variable supervisor_cv_;
+  bool supervisor_wake_ = false;
+
+  std::vector<float> mix_buffer_;
+  std::vector<float> read_buffer_;
+
+  Source *FindSource(uint32_t pid) const;
+  bool StartSource(Source *source);
+  void WaitForTick();
+  void WakeSupervisor();
+  void OnSourceData(Source *source, const float *samples, size_t frames,
+                    int channels, int sample_rate);
+  void MixThreadProc();
+  void SupervisorThreadProc();
+  void MixSource(Source *source);
+};
+
+/**
+ * @brief 带增益的向量化累加 out[i] += in[i] * gain
+ *
+ * 在支持SSE/NEON的平台上使用SIMD指令，其余平台使用标量循环。
+ */
+void MixAccumulate(float *out, const float *in, size_t count, float gain);
+
+/**
+ * @brief 带线性增益斜坡的累加，增益从 from 逐样本过渡到 to，避免增益突变的咔嗒声
+ */
+void MixAccumulateRamp(float *out, const float *in, size_t frames, int channels,
+                       float from, float to);
+
+} // namespace audio_capture
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "audio_capture.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @file audio_sink.h
+ * @brief 编译期组合的音频接收端（CRTP）
+ *
+ * AudioDataCallback 是 std::function，每次调用都经过类型擦除，编译器无法
+ * 把下游内联到上游。捕获数据从后端进入投递链、处理图的js输出端进入合并器
+ * 都是每个数据包一次的调用，这些链改为在编译期组合：每一级是具体类型，
+ * 直接调用下一级的 Consume<Channels>，整条链可以内联；声道数在入口处分派
+ * 一次（1、2 和运行时声道数三种特化），之后各级的内层循环都按常量声道数展开。
+ * std::function 只保留在与后端接口之间的适配处（ToCallback / CallbackSink）。
+ */
+
+namespace audio_capture {
+
+/**
+ * @class AudioSink
+ * @brief 静态接收端的基类
+ *
+ * 派生类实现：
+ * @code
+ * template <int Channels>
+ * void Consume(const float *samples, size_t frames, int channels,
+ *              int sample_rate, uint64_t position);
+ * @endcode
+ * Channels 为 1 或 2 时与 channels 相同，为 0 时按运行时的 channels 处理。
+ * position 为第一帧在所属流中的位置。处理级持有下一级的引用，
+ * 并以相同的 Channels 调用它的 Consume。
+ */
+template <typename Derived> class AudioSink {
+public:
+  /**
+   * @brief 输入一个数据包，按声道数选择特化
+   * @param samples 交错float数据
+   */
+  void Push(const float *samples, size_t frames, int channels, int sample_rate,
+            uint64_t position) {
+    switch (channels) {
+    case 1:
+      derived().template Consume<1>(samples, frames, 1, sample_rate, position);
+      break;
+    case 2:
+      derived().template Consume<2>(samples, frames, 2, sample_rate, position);
+      break;
+    default:
+      derived().template Consume<0>(samples, frames, channels, sample_rate,
+                                    position);
+      break;
+    }
+  }
+
+  /**
+   * @brief 以 AudioDataCallback 的参数输入一个数据包
+   *
+   * 不校验数据，空指针或无效的声道数原样交给链的第一级处理。
+   */
+  void PushBytes(const uint8_t *data, size_t length, int channels,
+                 int sample_rate, uint64_t position = 0) {
+    size_t frames =
+        channels > 0
+            ? length / (sizeof(float) * static_cast<size_t>(channels))
+            : 0;
+    Push(reinterpret_cast<const float *>(data), frames, channels, sample_rate,
+         position);
+  }
+
+protected:
+  /// 编译期声道数，Channels 为 0 时返回运行时的声道数
+  template <int Channels> static constexpr int ChannelCount(int channels) {
+    return Channels > 0 ? Channels : channels;
+  }
+
+private:
+  Derived &derived() { return static_cast<Derived &>(*this); }
+};
+
+/**
+ * @class CallbackSink
+ * @brief 把 AudioDataCallback 作为链的末端，数据原样交给回调（不含位置）
+ */
+class CallbackSink : public AudioSink<CallbackSink> {
+public:
+  explicit CallbackSink(AudioDataCallback callback)
+      : callback_(std::move(callback)) {}
+
+  template <int Channels>
+  void Consume(const float *samples, size_t frames, int channels,
+               int sample_rate, uint64_t /*position*/) {
+    if (callback_) {
+      callback_(reinterpret_cast<const uint8_t *>(samples),
+                frames * static_cast<size_t>(channels) * sizeof(float),
+                channels, sample_rate);
+    }
+  }
+
+private:
+  AudioDataCallback callback_;
+};
+
+/**
+ * @brief 把静态接收端包装成 AudioDataCallback（交给后端、切换器或混音器）
+ *
+ * 边界上仍然是一次 std::function 调用，链内部不再有类型擦除。
+ * AudioDataCallback 不携带位置，传入链的 position 为0，由链的第一级编号。
+ */
+template <typename Sink>
+AudioDataCallback ToCallback(std::shared_ptr<Sink> sink) {
+  return [sink](const uint8_t *data, size_t length, int channels,
+                int sample_rate) {
+    sink->PushBytes(data, length, channels, sample_rate);
+  };
+}
+
+} // namespace audio_capture
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file cadence_trace.h
+ * @brief 回调节奏的录制和读取
+ *
+ * 记录每个数据包到达的时间、帧数和格式（不含PCM），写成紧凑的二进制文件，
+ * 由 replay 音频源按同样的时间和大小回放，用于在任意平台上以真实的到达模式
+ * （WASAPI突发、CoreAudio 512帧周期、PipeWire quantum变化）测试插件管线。
+ *
+ * 文件格式（小端）：
+ * - 头部16字节："PACD"、版本(u32)=1、数据包数(u32)、溢出丢弃的数据包数(u32)
+ * - 每个数据包12字节：距上一个数据包的时间(u32, 微秒)、帧数(u32)、
+ *   通道数(高8位) | 采样率(低24位)
+ */
+
+namespace audio_capture {
+
+/**
+ * @struct CadencePacket
+ * @brief 一个数据包的到达时间和格式
+ */
+struct CadencePacket {
+  uint64_t time_ns;  ///< 相对第一个数据包的到达时间
+  uint32_t frames;
+  int channels;
+  int sample_rate;
+};
+
+/**
+ * @brief 读取回调节奏文件
+ * @param path 文件路径
+ * @param packets 读取到的数据包
+ * @param error 失败时的错误描述
+ * @return 是否成功（没有数据包时视为失败）
+ */
+bool LoadCadenceTrace(const std::string &path,
+                      std::vector<CadencePacket> *packets, std::string *error);
+
+/**
+ * @brief 写出回调节奏文件
+ * @param overflow 录制时因容量不足丢弃的数据包数（写入头部）
+ */
+bool SaveCadenceTrace(const std::string &path,
+                      const std::vector<CadencePacket> &packets,
+                      uint32_t overflow, std::string *error);
+
+/**
+ * @class CadenceRecorder
+ * @brief 会话级的回调节奏录制器
+ *
+ * 缓冲区在Start时按容量一次性分配；音频线程的Record只做原子操作，
+ * 容量用完后只计数不再记录。Stop先关闭录制，等待正在写入的音频线程离开，
+ * 再把记录写成文件。Start/Stop在JS线程调用。
+ */
+class CadenceRecorder {
+public:
+  /// 默认容量：每秒100个数据包时约1小时
+  static constexpr size_t kDefaultCapacity = 360000;
+
+  /**
+   * @brief 开始录制（已在录制时返回false）
+   * @param capacity 最多记录的数据包数
+   */
+  bool Start(size_t capacity = kDefaultCapacity);
+
+  /**
+   * @brief 记录一个数据包（在音频线程调用，未录制时直接返回）
+   */
+  void Record(uint32_t frames, int channels, int sample_rate);
+
+  /**
+   * @brief 停止录制并写出文件
+   * @param path 输出路径
+   * @param error 失败时的错误描述
+   * @return 未在录制或写文件失败时返回false
+   */
+  bool Stop(const std::string &path, std::string *error);
+
+  bool IsRecording() const { return enabled_.load(); }
+
+private:
+  struct Entry {
+    uint64_t time_ns;
+    uint32_t frames;
+    uint32_t format; ///< 通道数 << 24 | 采样率
+  };
+
+  std::vector<Entry> entries_;
+  std::atomic<bool> enabled_{false};
+  std::atomic<size_t> next_{0};
+  std::atomic<int> writers_{0};
+};
+
+} // namespace audio_capture
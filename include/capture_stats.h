@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file capture_stats.h
+ * @brief 捕获会话的运行统计
+ *
+ * 提供无锁的计数器和延迟直方图，音频线程和JS线程都可以直接写入，
+ * 供基准测试和诊断接口读取。
+ */
+
+namespace audio_capture {
+
+/**
+ * @class LatencyHistogram
+ * @brief 无锁的对数分桶延迟直方图
+ *
+ * 以纳秒为单位记录，每个2的幂区间再细分为8个子桶，相对误差约12%。
+ * Record() 只做一次原子加法，可以在任意线程调用。
+ */
+class LatencyHistogram {
+public:
+  /**
+   * @brief 记录一个延迟样本
+   * @param ns 延迟（纳秒）
+   */
+  void Record(uint64_t ns);
+
+  /**
+   * @brief 计算百分位数
+   * @param percentile 百分位（0~100）
+   * @return 延迟（纳秒），没有样本时返回0
+   */
+  uint64_t Percentile(double percentile) const;
+
+  /**
+   * @brief 获取记录过的最大延迟（纳秒）
+   */
+  uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 获取样本数
+   */
+  uint64_t Count() const;
+
+  /**
+   * @brief 清空所有样本
+   */
+  void Reset();
+
+private:
+  static constexpr size_t kSubBuckets = 8;
+  static constexpr size_t kBuckets = 64 * kSubBuckets;
+
+  static size_t BucketIndex(uint64_t ns);
+  static uint64_t BucketValue(size_t index);
+
+  std::atomic<uint64_t> counts_[kBuckets] = {};
+  std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @struct CaptureStats
+ * @brief 单个捕获会话的统计数据
+ */
+struct CaptureStats {
+  std::atomic<uint64_t> packets{0};   ///< 后端回调次数
+  std::atomic<uint64_t> frames{0};    ///< 收到的音频帧数
+  std::atomic<uint64_t> delivered{0}; ///< 已交付给JS的回调次数
+  std::atomic<uint64_t> dropped{0};   ///< 被丢弃的数据包数
+
+  /// 从后端回调入队到JS回调开始执行的延迟
+  LatencyHistogram callback_latency;
+
+  std::atomic<uint64_t> start_ns{0};       ///< 调用Start的时间（trace时钟）
+  std::atomic<uint64_t> first_frame_ns{0}; ///< 收到第一个数据包的时间
+
+  /// 最近一个数据包的格式（通道数 << 32 | 采样率），0表示尚未收到数据
+  std::atomic<uint64_t> format{0};
+  std::atomic<uint64_t> format_changes{0}; ///< 捕获过程中格式变化的次数
+  std::atomic<uint64_t> period_frames{0};  ///< 最近一个数据包的帧数（实际周期）
+
+  /// JS回调的排队延迟和执行耗时（指数平滑，纳秒），自适应合并据此调整批大小
+  std::atomic<uint64_t> dispatch_delay_ns{0};
+  std::atomic<uint64_t> callback_run_ns{0};
+
+  /**
+   * @brief 在后端回调中记录第一个数据包的到达时间（只记录一次）
+   * @param now_ns 当前时间（trace时钟）
+   */
+  void MarkFirstFrame(uint64_t now_ns) {
+    uint64_t expected = 0;
+    first_frame_ns.compare_exchange_strong(expected, now_ns,
+                                           std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 在JS线程记录一次TSFN回调的排队延迟和执行耗时
+   * @param delay_ns 从入队到回调开始执行
+   * @param run_ns 回调本身的执行耗时
+   */
+  void RecordDispatch(uint64_t delay_ns, uint64_t run_ns);
+
+  /**
+   * @brief 清空所有统计
+   */
+  void Reset();
+};
+
+} // namespace audio_capture
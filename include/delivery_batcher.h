@@ -0,0 +1,163 @@
+#pragma once
+
+#include "audio_sink.h"
+#include "capture_stats.h"
+#include "processing_graph.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file delivery_batcher.h
+ * @brief 按事件循环负载自适应合并投递给JS的数据包
+ *
+ * 固定的投递粒度在事件循环繁忙时回调过于频繁，空闲时又平白增加延迟。
+ * DeliveryBatcher 位于TSFN之前，把同一输出端连续的数据包拼接成一次JS回调，
+ * 每批的音频时长在配置的上下限之间按JS线程的实际情况调整：
+ * - JS线程回调开始执行时记录排队延迟和回调执行耗时（CaptureStats::RecordDispatch）；
+ * - 排队延迟或执行耗时相对批时长偏大（事件循环跟不上回调频率）时批时长加倍；
+ * - 两者都很小时批时长逐步缩短，回到低延迟。
+ */
+
+namespace audio_capture {
+
+/**
+ * @class DeliveryBatcher
+ * @brief 投递给JS之前的自适应批量合并
+ *
+ * 捕获源的数据包和各js输出端的数据块都经由 Push 进入，按输出端分别缓存，
+ * 满一批、格式变化或位置不连续时交给下游回调。未启用时直接转交，不加锁。
+ * 启用后 Push 会持有一个互斥锁：捕获线程与处理图的线程池线程可能同时投递，
+ * 锁只在两者恰好同时到达时才会竞争。
+ *
+ * 音频源停止送数据时（如目标进程静音），最后不足一批的数据要等到下一个
+ * 数据包到达或 Flush 时才投递。
+ */
+class DeliveryBatcher {
+public:
+  /**
+   * @brief 构造函数
+   * @param output 下游回调（复制数据并通过TSFN交给JS）
+   * @param stats 会话统计，从中读取JS线程记录的排队延迟和执行耗时
+   */
+  DeliveryBatcher(GraphSinkCallback output,
+                  std::shared_ptr<CaptureStats> stats);
+
+  /**
+   * @brief 设置每批音频时长的范围（在JS线程调用，捕获期间可以调整）
+   * @param min_ms 下限，0表示空闲时每个数据包单独投递
+   * @param max_ms 上限，0表示关闭合并
+   *
+   * 调整前先投递所有已缓存的数据，批时长从下限重新开始。
+   */
+  void Configure(double min_ms, double max_ms);
+
+  /**
+   * @brief 设置不参与合并的输出端（如chunk节点之后的固定帧数输出）
+   */
+  void SetUnbatchedSinks(std::vector<std::string> sinks);
+
+  /**
+   * @brief 投递一个数据块，参数与 GraphSinkCallback 相同
+   *        （捕获源的数据 sink_id 为空）
+   */
+  void Push(const std::string &sink_id, const uint8_t *data, size_t length,
+            int channels, int sample_rate, uint64_t position,
+            SampleFormat format);
+
+  /**
+   * @brief 立即投递所有已缓存的数据（格式变化通知之前、停止捕获时调用）
+   */
+  void Flush();
+
+  /**
+   * @brief 当前的目标批时长（毫秒），未启用合并时为0
+   */
+  double BatchMs() const {
+    return batch_ns_.load(std::memory_order_relaxed) / 1e6;
+  }
+
+private:
+  /// 一个输出端尚未投递的数据
+  struct Pending {
+    std::string sink_id;
+    std::vector<uint8_t> data;
+    int channels = 0;
+    int sample_rate = 0;
+    SampleFormat format = SampleFormat::kFloat32;
+    uint64_t position = 0;  ///< 第一帧的位置
+    uint64_t frames = 0;
+    uint64_t first_ns = 0;  ///< 第一个数据块到达的时间
+  };
+
+  /// 两次调整批时长之间的最短间隔，让排队延迟的平滑值跟上上一次调整
+  static constexpr uint64_t kAdjustIntervalNs = 250000000;
+
+  GraphSinkCallback output_;
+  std::shared_ptr<CaptureStats> stats_;
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> batch_ns_{0}; ///< 当前目标批时长
+
+  std::mutex mutex_;
+  uint64_t min_ns_ = 0;
+  uint64_t max_ns_ = 0;
+  uint64_t adjusted_ns_ = 0; ///< 上一次调整批时长的时间
+  std::vector<Pending> pending_;
+  std::vector<std::string> unbatched_;
+
+  void Emit(Pending &pending);
+  void Adjust(uint64_t now_ns, uint64_t packet_ns);
+  void FlushLocked();
+};
+
+/**
+ * @class BatcherSink
+ * @brief 静态接收端链的末级：把数据块交给合并器
+ *
+ * Format 为 kInt16 时先转换为16位整数（缓冲区只在数据块变大时增长）。
+ * 捕获源的数据 sink_id 为空，处理图js输出端为节点ID。
+ */
+template <SampleFormat Format>
+class BatcherSink : public AudioSink<BatcherSink<Format>> {
+public:
+  BatcherSink(std::shared_ptr<DeliveryBatcher> batcher, std::string sink_id)
+      : batcher_(std::move(batcher)), sink_id_(std::move(sink_id)) {}
+
+  template <int Channels>
+  void Consume(const float *samples, size_t frames, int channels,
+               int sample_rate, uint64_t position) {
+    const size_t count =
+        frames * static_cast<size_t>(
+                     AudioSink<BatcherSink>::template ChannelCount<Channels>(
+                         channels));
+    if (Format == SampleFormat::kInt16) {
+      if (pcm16_.size() < count) {
+        pcm16_.resize(count);
+      }
+      for (size_t i = 0; i < count; ++i) {
+        float value = std::max(-1.0f, std::min(1.0f, samples[i]));
+        pcm16_[i] = static_cast<int16_t>(std::lrintf(value * 32767.0f));
+      }
+      batcher_->Push(sink_id_, reinterpret_cast<const uint8_t *>(pcm16_.data()),
+                     count * sizeof(int16_t), channels, sample_rate, position,
+                     Format);
+    } else {
+      batcher_->Push(sink_id_, reinterpret_cast<const uint8_t *>(samples),
+                     count * sizeof(float), channels, sample_rate, position,
+                     Format);
+    }
+  }
+
+private:
+  std::shared_ptr<DeliveryBatcher> batcher_;
+  std::string sink_id_;
+  std::vector<int16_t> pcm16_;
+};
+
+} // namespace audio_capture
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file dsp_pool.h
+ * @brief 进程级共享的DSP工作线程池
+ *
+ * 所有会话的编码、分析等离开捕获线程的处理都调度到同一个按CPU核数配置的
+ * 工作线程池上，避免会话数增加时每个会话各开线程导致的过度订阅。
+ */
+
+namespace audio_capture {
+
+/**
+ * @struct AudioBlock
+ * @brief 一块交错float音频数据（不拥有内存）
+ */
+struct AudioBlock {
+  const float *samples = nullptr;
+  size_t frames = 0;
+  int channels = 0;
+  int sample_rate = 0;
+};
+
+/**
+ * @struct DspPoolStats
+ * @brief 线程池统计
+ */
+struct DspPoolStats {
+  size_t workers;           ///< 工作线程数
+  uint64_t jobs;            ///< 已执行的任务数
+  uint64_t steals;          ///< 从其他工作线程队列窃取的次数
+  uint64_t queue_depth;     ///< 当前排队等待执行的任务数
+  uint64_t max_queue_depth; ///< 排队任务数的历史最大值
+  uint64_t dropped;         ///< 队列满而丢弃的任务数
+};
+
+class DspStrand;
+
+/**
+ * @class DspPool
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程有自己的就绪队列（有界无锁MPMC队列），就绪的串行队列
+ * （DspStrand）被放入某个工作线程的队列；工作线程先处理自己的队列，空闲时
+ * 从其他工作线程的队列中窃取。同一个串行队列同一时刻只在一个工作线程上执行，
+ * 因此每个会话的任务保持提交顺序。
+ */
+class DspPool {
+public:
+  /**
+   * @brief 进程级共享的线程池，首次调用时按CPU核数创建
+   */
+  static DspPool &Shared();
+
+  /**
+   * @brief 共享线程池已创建时返回它，否则返回nullptr（不会创建线程池）
+   */
+  static DspPool *SharedIfCreated();
+
+  /**
+   * @brief 构造函数
+   * @param workers 工作线程数
+   */
+  explicit DspPool(size_t workers);
+  ~DspPool();
+
+  DspPoolStats GetStats() const;
+
+private:
+  friend class DspStrand;
+
+  static constexpr size_t kQueueCapacity = 1024;
+
+  // Vyukov有界MPMC队列
+  class ReadyQueue {
+  public:
+    ReadyQueue();
+    bool Push(DspStrand *strand);
+    DspStrand *Pop();
+
+  private:
+    struct Cell {
+      std::atomic<size_t> sequence;
+      DspStrand *strand;
+    };
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+  };
+
+  std::vector<std::unique_ptr<ReadyQueue>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<bool> running_{true};
+  std::atomic<size_t> next_queue_{0};
+
+  // 空闲工作线程在这里等待；生产者只在有线程等待时才通知
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
+  std::atomic<int> idle_workers_{0};
+
+  std::atomic<uint64_t> jobs_{0};
+  std::atomic<uint64_t> steals_{0};
+  std::atomic<uint64_t> queue_depth_{0};
+  std::atomic<uint64_t> max_queue_depth_{0};
+  std::atomic<uint64_t> dropped_{0};
+
+  void Schedule(DspStrand *strand);
+  void WorkerProc(size_t index);
+  void OnJobQueued();
+  void OnJobDone();
+};
+
+/**
+ * @class DspStrand
+ * @brief 线程池上的串行任务队列（通常每个会话分支一个）
+ *
+ * 提交方（捕获线程）把数据复制到预分配的槽位中后入队，不加锁、不分配内存；
+ * 超过槽位容量的数据块按整帧拆到连续的多个槽位（处理函数依次收到各段），
+ * 槽位不够时整块丢弃并计数。任务按提交顺序依次交给处理函数。
+ */
+class DspStrand {
+public:
+  using Handler = std::function<void(const AudioBlock &block)>;
+
+  /**
+   * @brief 构造函数
+   * @param pool 所属线程池
+   * @param handler 在工作线程中处理每块数据的函数
+   * @param session 所属会话ID，用于trace
+   * @param slots 槽位数
+   * @param slot_capacity 每个槽位可容纳的float样本数
+   */
+  DspStrand(DspPool &pool, Handler handler, uint32_t session = 0,
+            size_t slots = 32, size_t slot_capacity = 16384);
+
+  /**
+   * @brief 析构前等待已提交的任务执行完
+   */
+  ~DspStrand();
+
+  /**
+   * @brief 提交一块数据（复制到槽位，过大时拆到多个槽位）
+   * @return 剩余槽位放不下时返回false
+   */
+  bool Submit(const AudioBlock &block);
+
+  /**
+   * @brief 等待已提交的任务全部执行完，之后不能再提交
+   */
+  void Close();
+
+  uint64_t Dropped() const { return dropped_.load(); }
+
+private:
+  friend class DspPool;
+
+  // 每次被调度时最多执行的任务数，之后让出工作线程保证各会话公平
+  static constexpr size_t kRunBudget = 4;
+
+  struct Slot {
+    std::vector<float> samples;
+    size_t frames = 0;
+    int channels = 0;
+    int sample_rate = 0;
+  };
+
+  DspPool &pool_;
+  Handler handler_;
+  uint32_t session_;
+  size_t slot_capacity_;
+  std::vector<Slot> slots_;
+  std::atomic<size_t> read_{0};
+  std::atomic<size_t> write_{0};
+  std::atomic<bool> scheduled_{false};
+  // 在就绪队列中或正在执行时为1，归零后工作线程不再访问该串行队列
+  std::atomic<int> refs_{0};
+  std::atomic<bool> closed_{false};
+  std::atomic<uint64_t> dropped_{0};
+
+  bool HasPending() const;
+
+  // 执行一批任务，返回执行的任务数
+  size_t RunBatch(size_t budget);
+};
+
+} // namespace audio_capture
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file fft.h
+ * @brief 实数FFT（供指纹、降噪等频域处理阶段使用）
+ */
+
+namespace audio_capture {
+
+/**
+ * @class Fft
+ * @brief 长度为2的幂的实数FFT
+ *
+ * 把N点实数序列打包为N/2点复数序列做基2变换，再拆分出 0..N/2 的频点，
+ * 计算量约为直接做N点复数FFT的一半。实部和虚部分开存放，便于逐频点的
+ * 处理循环被编译器向量化。旋转因子和工作缓冲区在构造时分配，变换时不分配内存；
+ * 工作缓冲区属于实例，同一实例不能在多个线程中同时使用。
+ */
+class Fft {
+public:
+  /**
+   * @brief 构造函数
+   * @param size 变换长度（实数样本数），必须是不小于4的2的幂
+   */
+  explicit Fft(size_t size);
+
+  size_t Size() const { return size_; }
+
+  /**
+   * @brief 频点数（size/2 + 1）
+   */
+  size_t Bins() const { return half_ + 1; }
+
+  /**
+   * @brief 正变换
+   * @param input size个实数样本
+   * @param re 输出的实部（Bins()个）
+   * @param im 输出的虚部（Bins()个）
+   */
+  void Forward(const float *input, float *re, float *im);
+
+  /**
+   * @brief 逆变换（包含 1/size 的缩放，Forward之后Inverse还原输入）
+   * @param re 实部（Bins()个）
+   * @param im 虚部（Bins()个）
+   * @param output size个实数样本
+   */
+  void Inverse(const float *re, const float *im, float *output);
+
+private:
+  // size_/2 点复数FFT（原地，正变换）
+  void Transform(float *re, float *im) const;
+
+  size_t size_;
+  size_t half_;
+  std::vector<uint32_t> bit_reverse_;
+  std::vector<float> cos_;      ///< half_ 点变换的旋转因子
+  std::vector<float> sin_;
+  std::vector<float> post_cos_; ///< 拆分频点用的 N 点旋转因子（0..half_）
+  std::vector<float> post_sin_;
+  std::vector<float> work_re_;
+  std::vector<float> work_im_;
+};
+
+} // namespace audio_capture
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "fft.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file fingerprint.h
+ * @brief 音频指纹（频谱峰值对哈希）
+ *
+ * 在原生侧从捕获的PCM提取可用于识别曲目或广告的指纹，PCM不需要离开进程。
+ */
+
+namespace audio_capture {
+
+/**
+ * @struct Landmark
+ * @brief 一个指纹记录：锚点峰值与目标区域中一个峰值组成的哈希
+ */
+struct Landmark {
+  uint32_t hash; ///< 锚点频率(8位) | 频率差+64(7位) | 帧间隔(5位)，共20位
+  float time;    ///< 锚点在流中的时间（秒）
+};
+
+/**
+ * @class Fingerprinter
+ * @brief 峰值对（landmark）指纹提取器
+ *
+ * 处理流程：
+ * - 下混为单声道，低通滤波后降采样到 8kHz；
+ * - 512点Hann窗FFT、步长256（32ms）计算对数幅度谱；
+ * - 每帧在按对数划分的频带内选出突出于本帧平均值的局部峰值；
+ * - 每个锚点峰值与其后 1~31 帧、频率差小于64个频点的最多 kFanOut 个峰值
+ *   组成哈希。锚点要等目标区域的帧都到达后才输出，因此记录约有1秒延迟。
+ *
+ * 哈希只依赖频率和帧间隔，不依赖音量，20位的值可以精确地存放在float中。
+ * 只在一个线程中使用，稳态下不分配内存（输出向量除外）。
+ */
+class Fingerprinter {
+public:
+  static constexpr int kSampleRate = 8000;
+  static constexpr size_t kFftSize = 512;
+  static constexpr size_t kHop = 256;
+  static constexpr size_t kBins = kFftSize / 2;
+  static constexpr int kTargetFrames = 32; ///< 目标区域跨越的帧数（含锚点帧）
+  static constexpr int kMaxDeltaBins = 64;
+  static constexpr int kFanOut = 5;
+  static constexpr int kBands = 6;
+
+  Fingerprinter();
+
+  /**
+   * @brief 处理一块交错float数据，提取到的记录追加到out
+   * @param samples 交错数据
+   * @param frames 帧数
+   * @param channels 通道数
+   * @param sample_rate 采样率（变化时重新计算滤波器，不清空已有状态）
+   */
+  void Process(const float *samples, size_t frames, int channels,
+               int sample_rate, std::vector<Landmark> *out);
+
+  /**
+   * @brief 清空所有状态，之后的时间从0开始
+   */
+  void Reset();
+
+  /**
+   * @brief 已经分析的帧数
+   */
+  uint64_t FrameCount() const { return frame_index_; }
+
+private:
+  struct Peak {
+    uint16_t bin;
+    float magnitude;
+  };
+
+  // 一帧中选出的峰值，最多每个频带一个
+  struct PeakFrame {
+    std::array<Peak, kBands> peaks;
+    int count = 0;
+  };
+
+  void Configure(int sample_rate);
+  void AnalyzeFrame(std::vector<Landmark> *out);
+  void PairAnchor(uint64_t anchor, std::vector<Landmark> *out);
+
+  // 降采样
+  int input_rate_ = 0;
+  double step_ = 1.0;  ///< 每个输出样本对应的输入样本数
+  double phase_ = 1.0; ///< 下一个输出样本的位置（0为上一个输入样本）
+  float last_ = 0.0f;
+  // 二阶低通（Direct Form I）
+  float b0_ = 1, b1_ = 0, b2_ = 0, a1_ = 0, a2_ = 0;
+  float x1_ = 0, x2_ = 0, y1_ = 0, y2_ = 0;
+
+  // 分析窗口（环形）
+  std::array<float, kFftSize> window_ring_{};
+  size_t ring_pos_ = 0;
+  size_t filled_ = 0;
+  size_t since_hop_ = 0;
+
+  // 频谱
+  Fft fft_{kFftSize};
+  std::array<float, kFftSize> hann_{};
+  std::array<float, kFftSize> frame_{};
+  std::array<float, kBins + 1> re_{};
+  std::array<float, kBins + 1> im_{};
+  std::array<float, kBins> magnitude_db_{};
+
+  // 最近 kTargetFrames 帧的峰值
+  std::array<PeakFrame, kTargetFrames> history_{};
+  uint64_t frame_index_ = 0;
+};
+
+} // namespace audio_capture
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/**
+ * @file idle_suspend.h
+ * @brief 长时间静音时挂起捕获（空闲监视）
+ *
+ * 目标程序可能连续几小时不发声，但捕获线程仍然按周期唤醒、逐包处理。
+ * 启用后，后端在连续收到指定时长的数字静音（全零样本或系统标记为静音的
+ * 数据包）后停止音频流，改为低开销的空闲监视：Linux上暂停PipeWire流并
+ * 监听目标节点的状态，Windows上停止音频客户端；目标重新开始播放或到达
+ * 探测间隔时恢复捕获。空闲期间的唤醒次数和CPU耗时计入统计。
+ */
+
+namespace audio_capture {
+
+/**
+ * @struct IdleSuspendOptions
+ * @brief 空闲挂起的配置
+ */
+struct IdleSuspendOptions {
+  uint32_t silence_ms = 30000;       ///< 连续静音多久后挂起
+  uint32_t probe_interval_ms = 2000; ///< 挂起期间多久恢复一次检查是否有声音
+};
+
+/**
+ * @class IdleSuspend
+ * @brief 捕获实例的空闲挂起策略和统计
+ *
+ * 由addon按实例创建，通过 CaptureOptions 交给后端，切换目标时新旧音频源
+ * 共用。配置在JS线程修改，后端在自己的线程读取；挂起中的后端通过 Suspended
+ * 注册唤醒函数，配置变化时被唤醒并按新配置继续等待或恢复捕获。
+ */
+class IdleSuspend {
+public:
+  /// 统计快照
+  struct Snapshot {
+    bool idle = false;         ///< 当前是否挂起
+    uint64_t suspensions = 0;  ///< 进入空闲监视的次数
+    uint64_t probes = 0;       ///< 因探测间隔到达而恢复的次数
+    uint64_t wakeups = 0;      ///< 空闲期间捕获线程被唤醒的次数
+    uint64_t cpu_ns = 0;       ///< 空闲期间各次唤醒消耗的CPU时间
+    uint64_t idle_ns = 0;      ///< 处于空闲监视的总时长
+  };
+
+  /**
+   * @brief 启用空闲挂起或更新参数，挂起中的后端按新参数重新计时
+   */
+  void Configure(const IdleSuspendOptions &options);
+
+  /**
+   * @brief 关闭空闲挂起，挂起中的后端立即恢复捕获
+   */
+  void Disable();
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_acquire); }
+  uint32_t SilenceMs() const {
+    return silence_ms_.load(std::memory_order_relaxed);
+  }
+  uint32_t ProbeIntervalMs() const {
+    return probe_interval_ms_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 后端进入空闲监视
+   * @param owner 后端对象，用于注册唤醒函数
+   * @param wake 配置变化时调用（在JS线程），应尽快唤醒等待中的线程
+   */
+  void Suspended(const void *owner, std::function<void()> wake);
+
+  /**
+   * @brief 后端恢复捕获或停止
+   * @param probe 是否因探测间隔到达而恢复
+   */
+  void Resumed(const void *owner, bool probe);
+
+  /**
+   * @brief 记录一次空闲期间的唤醒
+   * @param cpu_ns 本次唤醒消耗的线程CPU时间（见 ThreadCpuNs）
+   */
+  void RecordWakeup(uint64_t cpu_ns) {
+    wakeups_.fetch_add(1, std::memory_order_relaxed);
+    cpu_ns_.fetch_add(cpu_ns, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 获取统计快照（进行中的空闲时长也计入）
+   */
+  Snapshot GetSnapshot() const;
+
+  /**
+   * @brief 清空统计（不影响配置和挂起状态）
+   */
+  void ResetStats();
+
+private:
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint32_t> silence_ms_{30000};
+  std::atomic<uint32_t> probe_interval_ms_{2000};
+
+  std::atomic<uint32_t> idle_count_{0}; ///< 正在挂起的后端数
+  std::atomic<uint64_t> suspensions_{0};
+  std::atomic<uint64_t> probes_{0};
+  std::atomic<uint64_t> wakeups_{0};
+  std::atomic<uint64_t> cpu_ns_{0};
+  std::atomic<uint64_t> idle_ns_{0};
+
+  // 挂起中的后端：唤醒函数和挂起的时间
+  struct Watcher {
+    const void *owner;
+    std::function<void()> wake;
+    uint64_t since_ns;
+  };
+  mutable std::mutex mutex_;
+  std::vector<Watcher> watchers_;
+
+  void WakeAll();
+};
+
+/**
+ * @class SilenceDetector
+ * @brief 后端捕获线程中的数字静音计时
+ *
+ * 每个后端一个，只在捕获线程使用。策略未启用时 Feed 只做一次原子读取。
+ */
+class SilenceDetector {
+public:
+  /// 探测恢复后仍然静音时，再等待这么久就重新挂起
+  static constexpr uint32_t kProbeWindowMs = 200;
+
+  void SetPolicy(const IdleSuspend *policy) { policy_ = policy; }
+
+  /**
+   * @brief 记录一个数据包
+   * @param samples 交错float数据，为空表示系统标记为静音的数据包
+   * @return 静音达到挂起时长（每次计时只返回一次true）
+   */
+  bool Feed(const float *samples, size_t frames, int channels,
+            int sample_rate);
+
+  /**
+   * @brief 恢复捕获时重新计时（后端的音频流停止期间调用）
+   * @param probe 是否因探测恢复，此时只等待 kProbeWindowMs
+   */
+  void Reset(bool probe);
+
+private:
+  const IdleSuspend *policy_ = nullptr;
+  uint64_t silent_frames_ = 0;
+  bool probing_ = false;
+  bool tripped_ = false;
+};
+
+/**
+ * @brief 当前线程消耗的CPU时间（纳秒），不支持时返回0
+ */
+uint64_t ThreadCpuNs();
+
+} // namespace audio_capture
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file level_trigger.h
+ * @brief 按电平触发的投递（带预录缓冲）
+ *
+ * 监控场景只关心目标程序真正发声的时段。触发器位于捕获源和下游
+ * （处理图、JS投递）之间：空闲时数据只写入预录环形缓冲区，下游完全
+ * 收不到数据；某个数据包的电平超过阈值时先输出预录的数据，再输出
+ * 当前数据包，之后持续输出，直到电平连续低于阈值达到保持时长。
+ */
+
+namespace audio_capture {
+
+/**
+ * @struct LevelTriggerOptions
+ * @brief 电平触发的配置
+ */
+struct LevelTriggerOptions {
+  float threshold_db = -50.0f; ///< 触发阈值（数据包RMS，dBFS）
+  uint32_t pre_roll_ms = 2000; ///< 触发时一并输出的之前的音频时长
+  uint32_t hold_ms = 3000;     ///< 电平低于阈值持续多久后停止输出
+};
+
+/**
+ * @class LevelTrigger
+ * @brief 会话级的电平触发器
+ *
+ * Configure 在JS线程调用，参数通过原子变量交给捕获线程，下一个数据包生效；
+ * Process 只在捕获线程调用。预录缓冲区在格式或预录时长变化时重新分配，
+ * 稳态下不分配内存。
+ */
+class LevelTrigger {
+public:
+  /// 一段需要输出的连续数据
+  struct Segment {
+    const float *samples;
+    size_t frames;
+    uint64_t position; ///< 第一帧在会话中的位置
+  };
+
+  /// Process 的结果
+  struct Result {
+    Segment segments[3]; ///< 预录缓冲区（可能绕回分成两段）和当前数据包
+    size_t count = 0;
+    bool opened = false; ///< 本数据包触发了输出
+    bool closed = false; ///< 本数据包之前已经静默了保持时长，停止输出
+    float level_db = 0;  ///< 本数据包的RMS（dBFS）
+  };
+
+  /**
+   * @brief 启用触发器或更新参数
+   */
+  void Configure(const LevelTriggerOptions &options);
+
+  /**
+   * @brief 关闭触发器，之后的数据直接输出
+   */
+  void Disable();
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 当前是否在输出（未启用时总是输出）
+   */
+  bool IsActive() const { return active_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 处理一个数据包（在捕获线程调用）
+   * @param samples 交错float数据
+   * @param position 第一帧在会话中的位置
+   * @param result 需要输出的片段；未启用时只有当前数据包
+   */
+  void Process(const float *samples, size_t frames, int channels,
+               int sample_rate, uint64_t position, Result *result);
+
+private:
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> active_{true};
+  std::atomic<float> threshold_db_{-50.0f};
+  std::atomic<uint32_t> pre_roll_ms_{2000};
+  std::atomic<uint32_t> hold_ms_{3000};
+
+  // 以下只在捕获线程访问
+  bool was_enabled_ = false;
+  bool open_ = false;
+  int channels_ = 0;
+  int sample_rate_ = 0;
+  uint32_t ring_ms_ = 0;
+  std::vector<float> ring_;   ///< 预录环形缓冲区
+  size_t ring_frames_ = 0;    ///< 容量（帧）
+  size_t ring_write_ = 0;     ///< 下一次写入的帧位置
+  size_t ring_filled_ = 0;    ///< 已写入的帧数
+  uint64_t ring_end_ = 0;     ///< 缓冲区最后一帧之后的会话位置
+  uint64_t silent_frames_ = 0;
+
+  void Reset(int channels, int sample_rate, uint32_t pre_roll_ms);
+  void Write(const float *samples, size_t frames, uint64_t position);
+};
+
+} // namespace audio_capture
@@ -0,0 +1,138 @@
+#pragma once
+
+#ifdef __linux__
+
+#include "../audio_capture.h"
+#include "../idle_suspend.h"
+#include <atomic>
+#include <mutex>
+#include <pipewire/pipewire.h>
+#include <string>
+
+/**
+ * @file audio_tap.h
+ * @brief Linux进程级音频捕获
+ *
+ * 使用PipeWire将捕获流直接连接到目标进程的音频输出流节点
+ */
+
+namespace audio_capture {
+namespace linux_audio {
+
+/**
+ * @class AudioTap
+ * @brief Linux进程级音频捕获类
+ *
+ * 通过 target.object 将输入流连接到目标进程的 Stream/Output/Audio 节点，
+ * 由会话管理器（WirePlumber等）建立链接。数据在PipeWire的实时线程中回调。
+ * 调用SetInputDevice()后改为连接 Audio/Source 节点（麦克风或null source）。
+ * 启用空闲挂起时，长时间静音后暂停流，由线程循环监听目标节点的状态，
+ * 节点重新进入运行状态或到达探测间隔时恢复。
+ * 捕获进程时通过pidfd监视目标进程，并监听注册表中目标节点的移除，
+ * 目标退出或节点消失时停止投递并调用结束回调。
+ */
+class AudioTap {
+public:
+  explicit AudioTap(uint32_t pid);
+  ~AudioTap();
+
+  // 改为捕获输入设备，device为节点名或序号，为空时连接默认音频源
+  // 必须在Initialize()之前调用
+  void SetInputDevice(const std::string &device);
+
+  // 目标进程退出或音频流被移除时在线程循环中调用，必须在Start()之前设置
+  void SetEndedCallback(EndedCallback callback) {
+    ended_callback_ = std::move(callback);
+  }
+
+  // 主要接口
+  bool Initialize(const CaptureOptions &options = CaptureOptions());
+  bool Start(AudioDataCallback callback);
+  void Stop();
+
+  // 状态查询
+  bool IsCapturing() const { return is_capturing_.load(); }
+  std::string GetErrorMessage() const { return error_message_; }
+  ChannelLayout GetChannelLayout() const;
+
+private:
+  // 基本属性
+  uint32_t target_pid_;
+  uint32_t trace_session_; ///< trace事件的会话ID
+  uint64_t target_serial_ = 0;
+  uint32_t target_id_ = 0;
+  bool input_device_ = false;
+  std::string device_;
+  std::atomic<bool> is_capturing_{false};
+  std::string error_message_;
+  AudioDataCallback callback_;
+  EndedCallback ended_callback_;
+  std::atomic<const char *> ended_reason_{nullptr}; ///< 已结束时为结束原因
+
+  // PipeWire对象
+  pw_thread_loop *thread_loop_ = nullptr;
+  pw_context *context_ = nullptr;
+  pw_core *core_ = nullptr;
+  pw_stream *stream_ = nullptr;
+  spa_hook stream_listener_ = {};
+  pw_registry *registry_ = nullptr; ///< 监听目标节点的移除（输入设备时为空）
+  spa_hook registry_listener_ = {};
+  spa_source *pidfd_source_ = nullptr; ///< 目标进程的pidfd，进程退出时可读
+
+  // 空闲挂起：数据线程请求挂起，其余状态只在线程循环中访问
+  std::shared_ptr<IdleSuspend> idle_;
+  SilenceDetector detector_;
+  std::atomic<bool> suspend_requested_{false};
+  std::atomic<int> rearm_{0}; ///< 恢复后数据线程重新计时：1 正常，2 探测
+  bool suspended_ = false;
+  spa_source *idle_event_ = nullptr;
+  spa_source *probe_timer_ = nullptr;
+  pw_node *target_node_ = nullptr; ///< 监听状态的目标节点（输入设备时为空）
+  spa_hook node_listener_ = {};
+  pw_node_state target_state_ = PW_NODE_STATE_CREATING;
+
+  // 协商后的音频格式
+  bool native_format_ = false;
+  std::atomic<int> channels_{2};
+  std::atomic<int> sample_rate_{48000};
+  mutable std::mutex layout_mutex_;
+  ChannelLayout layout_{"FL", "FR"};
+
+  // 内部方法
+  bool ConnectStream();
+  void Cleanup();
+  void SetError(const std::string &message);
+  void ProcessAudioData();
+  void WatchTarget();
+  void EndCapture(const char *reason);
+  void SuspendStream();
+  void ResumeStream(bool probe);
+  void ArmProbeTimer();
+
+  // pw_stream事件回调
+  static void OnProcess(void *userdata);
+  static void OnParamChanged(void *userdata, uint32_t id,
+                             const struct spa_pod *param);
+  static void OnStateChanged(void *userdata, enum pw_stream_state old,
+                             enum pw_stream_state state, const char *error);
+  static const pw_stream_events kStreamEvents;
+  static pw_stream_events MakeStreamEvents();
+
+  // 线程循环中的空闲挂起事件
+  static void OnIdleEvent(void *userdata, uint64_t count);
+  static void OnProbeTimer(void *userdata, uint64_t expirations);
+  static void OnNodeInfo(void *userdata, const pw_node_info *info);
+  static const pw_node_events kNodeEvents;
+  static pw_node_events MakeNodeEvents();
+
+  // 目标进程退出、目标节点移除
+  static void OnTargetExit(void *userdata, int fd, uint32_t mask);
+  static void OnGlobalRemove(void *userdata, uint32_t id);
+  static const pw_registry_events kRegistryEvents;
+  static pw_registry_events MakeRegistryEvents();
+};
+
+} // namespace linux_audio
+} // namespace audio_capture
+
+#endif // __linux__
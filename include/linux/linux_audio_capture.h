@@ -0,0 +1,60 @@
+#pragma once
+
+#ifdef __linux__
+
+#include "../audio_capture.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+/**
+ * @file linux_audio_capture.h
+ * @brief Linux音频捕获实现
+ *
+ * Linux平台音频捕获接口实现
+ */
+
+namespace audio_capture {
+// 前向声明
+namespace linux_audio {
+class AudioTap;
+}
+
+/**
+ * @brief Linux音频捕获实现类
+ *
+ * 使用PipeWire实现Linux平台的音频捕获功能
+ */
+class LinuxAudioCapture : public AudioCapture {
+public:
+  LinuxAudioCapture();
+  ~LinuxAudioCapture() override;
+
+  bool Prepare(uint32_t pid, const CaptureOptions &options) override;
+  bool Start(AudioDataCallback callback) override;
+  bool IsPreparedFor(uint32_t pid) const override;
+  bool StopCapture() override;
+  bool IsCapturing() const override;
+  ChannelLayout GetChannelLayout() const override;
+  void SetEndedCallback(EndedCallback callback) override;
+
+  /**
+   * @brief 改为捕获输入设备（节点名或序号，为空时使用默认音频源）
+   */
+  void SetInputDevice(const std::string &device);
+
+private:
+  // 状态管理
+  std::atomic<bool> capturing_{false};
+  AudioDataCallback callback_;
+  EndedCallback ended_callback_;
+  uint32_t current_pid_{0};
+  bool input_device_{false};
+  std::string device_;
+
+  // 音频捕获对象
+  std::unique_ptr<linux_audio::AudioTap> audio_tap_;
+};
+} // namespace audio_capture
+
+#endif // __linux__
@@ -0,0 +1,47 @@
+#pragma once
+
+#ifdef __linux__
+
+#include "../permission_manager.h"
+
+/**
+ * @file linux_permission_manager.h
+ * @brief Linux平台的音频录制权限管理
+ *
+ * PipeWire对同一用户会话内的客户端不做额外授权，
+ * 因此Linux平台始终视为已授权。
+ */
+
+namespace permission_manager {
+
+/**
+ * @class LinuxPermissionManager
+ * @brief Linux平台的音频录制权限管理类
+ */
+class LinuxPermissionManager : public PermissionManager {
+public:
+  /**
+   * @brief 构造函数
+   */
+  LinuxPermissionManager();
+
+  /**
+   * @brief 析构函数
+   */
+  ~LinuxPermissionManager() override;
+
+  /**
+   * @brief 检查音频录制权限状态
+   * @return 当前权限状态
+   */
+  PermissionStatus CheckPermission() override;
+
+  /**
+   * @brief 请求音频录制权限
+   * @param callback 权限状态变化回调函数
+   */
+  void RequestPermission(PermissionCallback callback) override;
+};
+} // namespace permission_manager
+
+#endif // __linux__
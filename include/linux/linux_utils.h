@@ -0,0 +1,59 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file linux_utils.h
+ * @brief Linux平台工具函数
+ *
+ * 提供PipeWire初始化、音频流节点枚举和/proc进程信息读取等功能
+ */
+
+namespace audio_capture {
+namespace linux_utils {
+
+/**
+ * @struct StreamNode
+ * @brief PipeWire中应用程序的音频输出流节点
+ */
+struct StreamNode {
+  uint32_t id;          ///< 节点ID
+  uint64_t serial;      ///< 节点序列号（用于target.object）
+  uint32_t pid;         ///< 所属进程ID（application.process.id）
+  std::string app_name; ///< 应用名称（application.name）
+  std::string binary;   ///< 可执行文件名（application.process.binary）
+};
+
+/**
+ * @brief 初始化PipeWire库（可重复调用，只会初始化一次）
+ */
+void EnsurePipeWireInit();
+
+/**
+ * @brief 获取所有应用程序的音频输出流节点（Stream/Output/Audio）
+ * @return 节点列表，无法连接PipeWire时返回空列表
+ */
+std::vector<StreamNode> GetAudioStreamNodes();
+
+/**
+ * @brief 获取进程名称（/proc/<pid>/comm）
+ * @param pid 进程ID
+ * @return 进程名称，失败时返回空字符串
+ */
+std::string GetProcessName(uint32_t pid);
+
+/**
+ * @brief 获取进程的可执行文件路径（/proc/<pid>/exe）
+ * @param pid 进程ID
+ * @return 进程路径，失败时返回空字符串
+ */
+std::string GetProcessPath(uint32_t pid);
+
+} // namespace linux_utils
+} // namespace audio_capture
+
+#endif // __linux__
@@ -7,6 +7,7 @@
 #include <CoreAudio/AudioHardwareTapping.h>
 #include <CoreAudio/CATapDescription.h>
 #include <CoreAudio/CoreAudio.h>
+#include <dispatch/dispatch.h>
 #include <functional>
 
 /**
@@ -44,11 +45,25 @@ public:
    */
   ~ProcessTap();
 
+  /**
+   * @brief 改为捕获输入设备，必须在Initialize()之前调用
+   * @param device 输入设备UID，为空时使用默认输入设备
+   */
+  void SetInputDevice(const std::string &device);
+
+  /**
+   * @brief 设置目标进程退出时的回调，必须在Start()之前调用
+   */
+  void SetEndedCallback(EndedCallback callback) {
+    ended_callback_ = std::move(callback);
+  }
+
   /**
    * @brief 初始化音频捕获
+   * @param options 捕获配置（使用其中的周期和原始格式设置）
    * @return 是否成功初始化
    */
-  bool Initialize();
+  bool Initialize(const CaptureOptions &options = CaptureOptions());
 
   /**
    * @brief 开始捕获音频
@@ -69,8 +84,14 @@ public:
    */
   std::string GetErrorMessage() const;
 
+  /**
+   * @brief 获取捕获格式的声道布局
+   */
+  ChannelLayout GetChannelLayout() const { return layout_; }
+
 private:
   uint32_t pid_;                         ///< 目标进程ID
+  uint32_t trace_session_;               ///< trace事件的会话ID
   bool initialized_ = false;             ///< 是否已初始化
   bool capturing_ = false;               ///< 是否正在捕获
   std::string error_message_;            ///< 错误信息
@@ -83,6 +104,15 @@ private:
   AudioDeviceIOProcID device_proc_id_ = nullptr;            ///< 设备IO过程ID
   AudioStreamBasicDescription tap_stream_description_ = {}; ///< 音频流格式
   void *audio_format_ = nullptr; ///< AVAudioFormat对象指针
+  bool rate_listener_added_ = false; ///< 是否已注册采样率监听器
+  uint32_t period_frames_ = 0;       ///< 期望的IO缓冲区帧数（按48kHz计）
+  bool native_format_ = false;       ///< 按输出设备的原始格式捕获
+  bool input_device_ = false;        ///< 捕获输入设备而不是进程
+  std::string device_uid_;           ///< 输入设备UID，为空表示默认输入设备
+  ChannelLayout layout_;             ///< 捕获格式的声道布局
+  EndedCallback ended_callback_;     ///< 目标进程退出时调用（在exit_queue_上）
+  dispatch_queue_t exit_queue_ = nullptr;   ///< 进程退出监视的串行队列
+  dispatch_source_t exit_source_ = nullptr; ///< 目标进程的退出事件源
 
   /**
    * @brief 准备进程音频捕获
@@ -91,6 +121,32 @@ private:
    */
   bool Prepare(AudioObjectID objectID);
 
+  /**
+   * @brief 准备输入设备捕获：创建只包含该设备的私有聚合设备
+   * @return 是否成功准备
+   */
+  bool PrepareInput();
+
+  /**
+   * @brief 按期望的周期设置聚合设备的IO缓冲区帧数（失败时沿用设备默认值）
+   */
+  void ApplyPeriod();
+
+  /**
+   * @brief 移除聚合设备的采样率监听器
+   */
+  void RemoveSampleRateListener();
+
+  /**
+   * @brief 监视目标进程退出（捕获输入设备时不监视）
+   */
+  void WatchProcessExit();
+
+  /**
+   * @brief 取消进程退出监视，返回后回调不会再被调用
+   */
+  void CancelProcessExitWatch();
+
   /**
    * @brief 清理资源
    */
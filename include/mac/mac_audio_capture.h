@@ -47,12 +47,25 @@ public:
   ~MacAudioCapture() override;
 
   /**
-   * @brief 开始捕获指定进程的音频
+   * @brief 预先创建进程tap和聚合设备
    * @param pid 目标进程ID
+   * @param options 捕获配置
+   * @return 是否成功准备
+   */
+  bool Prepare(uint32_t pid, const CaptureOptions &options) override;
+
+  /**
+   * @brief 启动已准备好的聚合设备
    * @param callback 接收音频数据的回调函数
    * @return 是否成功启动捕获
    */
-  bool StartCapture(uint32_t pid, AudioDataCallback callback) override;
+  bool Start(AudioDataCallback callback) override;
+
+  /**
+   * @brief 是否已为指定进程准备好
+   * @param pid 目标进程ID
+   */
+  bool IsPreparedFor(uint32_t pid) const override;
 
   /**
    * @brief 停止音频捕获
@@ -66,11 +79,30 @@ public:
    */
   bool IsCapturing() const override;
 
+  /**
+   * @brief 获取捕获格式的声道布局
+   */
+  ChannelLayout GetChannelLayout() const override;
+
+  /**
+   * @brief 设置目标进程退出时的回调
+   */
+  void SetEndedCallback(EndedCallback callback) override;
+
+  /**
+   * @brief 改为捕获输入设备
+   * @param device 输入设备UID，为空时使用默认输入设备
+   */
+  void SetInputDevice(const std::string &device);
+
 private:
   std::atomic<bool> capturing_{false};   ///< 是否正在捕获音频
   std::atomic<bool> initialized_{false}; ///< 是否已初始化
   AudioDataCallback callback_;           ///< 音频数据回调函数
+  EndedCallback ended_callback_;         ///< 会话结束回调
   uint32_t current_pid_{0};              ///< 当前捕获的进程ID
+  bool input_device_{false};             ///< 是否捕获输入设备
+  std::string device_;                   ///< 输入设备UID
 
   // 音频捕获对象
   std::unique_ptr<audio_tap::ProcessTap> process_tap_;
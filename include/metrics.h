@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @file metrics.h
+ * @brief 进程级的运行指标，按OpenMetrics文本格式导出
+ *
+ * 计数器、仪表和直方图都是固定的原子变量，记录时不加锁也不分配内存。
+ * 指标默认关闭（Enable之前除会话数外都不记录），开启后可以通过 Render
+ * 取得文本，或者由 Serve 在本地Unix socket / 回环HTTP端口上直接应答抓取，
+ * 每次抓取都在服务线程中完成，不经过JS。
+ */
+
+namespace audio_capture {
+namespace metrics {
+
+/**
+ * @enum Stage
+ * @brief 单独统计耗时的处理阶段，耗时与音频时长之比即实时率
+ */
+enum class Stage {
+  kDenoise, ///< 处理图 denoise 节点
+  kWav,     ///< 处理图 wav 输出端（编码并写入文件）
+};
+
+/**
+ * @brief 是否正在记录指标
+ */
+bool IsEnabled();
+
+/**
+ * @brief 开启或关闭指标记录（关闭时保留已有的累计值）
+ */
+void Enable(bool enabled);
+
+/**
+ * @brief 会话开始/结束投递数据（不受开关影响，保证仪表值正确）
+ */
+void SessionStarted();
+void SessionEnded();
+
+/**
+ * @brief 后端回调收到的数据包数
+ */
+void AddPackets(uint64_t count);
+
+/**
+ * @brief 投递给JS之前被丢弃的数据包数
+ */
+void AddDropped(uint64_t count);
+
+/**
+ * @brief 记录一次从入队到JS回调开始执行的延迟
+ */
+void ObserveCallbackLatency(uint64_t ns);
+
+/**
+ * @brief 记录一次进程枚举的耗时
+ */
+void ObserveEnumeration(uint64_t ns);
+
+/**
+ * @brief 累加处理阶段的耗时和处理的音频时长
+ */
+void AddStageCost(Stage stage, uint64_t cpu_ns, uint64_t audio_ns);
+
+/**
+ * @brief 按OpenMetrics文本格式导出所有指标（以 "# EOF" 结尾）
+ */
+std::string Render();
+
+/**
+ * @brief 在本地地址上应答抓取请求（已在服务时先停止原来的服务）
+ * @param socket_path Unix socket路径，为空时使用端口
+ * @param port 回环地址127.0.0.1上的HTTP端口，socket_path非空时忽略
+ * @param error 失败时的错误描述
+ *
+ * 无论请求路径如何都返回指标文本。Unix socket上同样使用HTTP，
+ * 可以用 curl --unix-socket 抓取。Windows上只支持端口。
+ */
+bool Serve(const std::string &socket_path, int port, std::string *error);
+
+/**
+ * @brief 停止应答抓取请求（Unix socket文件会被删除）
+ */
+void StopServing();
+
+/**
+ * @brief 是否正在应答抓取请求
+ */
+bool IsServing();
+
+} // namespace metrics
+} // namespace audio_capture
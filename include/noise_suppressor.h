@@ -0,0 +1,81 @@
+#pragma once
+
+#include "fft.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @file noise_suppressor.h
+ * @brief 谱减法降噪
+ */
+
+namespace audio_capture {
+
+/**
+ * @class NoiseSuppressor
+ * @brief 按10ms帧处理的谱减法降噪器
+ *
+ * 每个通道独立处理：
+ * - 以10ms为步长、20ms的sqrt-Hann窗做短时傅里叶变换（补零到2的幂）；
+ * - 平滑后的功率谱按频点做最小值跟踪，缓慢上升，得到噪声估计；
+ * - 增益 max(下限, 1 - 过减因子·噪声/平滑功率)，在时间上平滑以减少音乐噪声；
+ * - 逆变换后再加同样的窗并重叠相加。
+ *
+ * 输出比输入延迟一个窗长（两个步长，20ms）。只在格式变化时分配内存，
+ * 逐频点的循环不含分支，可以被编译器向量化。只在一个线程中使用。
+ */
+class NoiseSuppressor {
+public:
+  /**
+   * @brief 构造函数
+   * @param reduction_db 最大衰减量（dB），即增益下限
+   */
+  explicit NoiseSuppressor(float reduction_db = 20.0f);
+  ~NoiseSuppressor();
+
+  /**
+   * @brief 处理一块交错数据
+   * @param in 输入
+   * @param out 输出（与输入同样的帧数和通道数，可以与输入相同）
+   * @param frames 帧数
+   * @param channels 通道数
+   * @param sample_rate 采样率，与上次不同（或通道数不同）时重新开始估计噪声
+   */
+  void Process(const float *in, float *out, size_t frames, int channels,
+               int sample_rate);
+
+  /**
+   * @brief 每个步长的帧数（10ms），尚未收到数据时为0
+   */
+  size_t HopFrames() const { return hop_; }
+
+private:
+  struct Channel {
+    std::vector<float> input;    ///< 最近两个步长的输入
+    std::vector<float> output;   ///< 下一个步长要输出的数据
+    std::vector<float> overlap;  ///< 上一帧逆变换的后半部分
+    std::vector<float> smoothed; ///< 平滑后的功率谱
+    std::vector<float> noise;    ///< 噪声功率估计
+    std::vector<float> gain;     ///< 平滑后的增益
+  };
+
+  void Configure(int channels, int sample_rate);
+  void ProcessHop(Channel *channel);
+
+  float floor_;
+  int channels_ = 0;
+  int sample_rate_ = 0;
+  size_t hop_ = 0;
+  size_t position_ = 0; ///< 当前步长内已经收到的帧数
+  uint64_t hops_ = 0;   ///< 已处理的步长数
+  std::unique_ptr<Fft> fft_;
+  std::vector<float> window_;
+  std::vector<float> frame_;
+  std::vector<float> re_;
+  std::vector<float> im_;
+  std::vector<Channel> state_;
+};
+
+} // namespace audio_capture
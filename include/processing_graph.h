@@ -0,0 +1,210 @@
+#pragma once
+
+#include "dsp_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file processing_graph.h
+ * @brief 会话级的音频处理图
+ *
+ * 一个捕获会话可以声明由处理阶段和输出端组成的有向无环图
+ * （source → stages → sinks），所有分支共享一次捕获和相同配置的处理阶段。
+ */
+
+namespace audio_capture {
+
+class DeliveryBatcher;
+
+/**
+ * @struct GraphNodeSpec
+ * @brief 处理图节点的声明
+ *
+ * 支持的类型：
+ * - resample { sampleRate }：线性插值重采样
+ * - remix { channels }：改变通道数（下混取平均，上混复制）
+ * - gain { gain }：线性增益
+ * - denoise { reduction }：谱减法降噪（10ms帧，最多衰减 reduction dB，
+ *   延迟20ms），统计自身的处理耗时
+ * - meter：峰值/RMS电平表，数据原样通过
+ * - chunk { frames }：重新分块为固定帧数
+ * - levels { rate }：按 rate Hz 输出各通道的峰值和RMS，不输出PCM
+ * - fingerprint { rate }：提取音频指纹（总是在DSP线程池中执行），按 rate Hz
+ *   输出累积的记录，每条记录为一帧 [哈希, 锚点时间（秒）]，不输出PCM
+ * - js { int16 }：投递给JavaScript回调（AudioData.sink 为节点ID），
+ *   int16 非0时转换为16位整数
+ * - wav { path, index }：写入WAV文件（总是在DSP线程池中执行），
+ *   index 非0时在录音结束时写出 <path>.idx 查找索引（每秒的偏移和响度、
+ *   按 silenceDb/minSilenceMs 检测的活动区间）。数据达到RIFF的4GiB上限
+ *   或写入失败时停止写入并通过 GraphErrorCallback 报告，已写入的部分
+ *   （和索引）保持有效
+ */
+struct GraphNodeSpec {
+  std::string id;
+  std::string type;
+  std::string input = "source"; ///< 上游节点ID，"source"表示捕获源
+  std::map<std::string, double> params;
+  std::string path;
+  bool off_thread = false; ///< 该节点及其下游在DSP线程池中执行
+};
+
+/**
+ * @struct MeterReading
+ * @brief 电平表读数
+ */
+struct MeterReading {
+  std::string id;
+  float peak;
+  float rms;
+};
+
+/**
+ * @struct StageCost
+ * @brief 处理阶段的累计开销
+ */
+struct StageCost {
+  uint64_t cpu_ns = 0;   ///< 处理耗时
+  uint64_t audio_ns = 0; ///< 处理的音频时长
+};
+
+/**
+ * @enum SampleFormat
+ * @brief js输出端投递的样本格式
+ */
+enum class SampleFormat { kFloat32, kInt16 };
+
+/**
+ * @typedef GraphSinkCallback
+ * @brief 投递给JS的回调（合并器与N-API层之间的适配处）
+ * @param sink_id 输出端节点ID
+ * @param position 本数据块第一帧在该输出端中的位置（按输出端的采样率计）
+ * @param format data中的样本格式
+ */
+using GraphSinkCallback = std::function<void(
+    const std::string &sink_id, const uint8_t *data, size_t length,
+    int channels, int sample_rate, uint64_t position, SampleFormat format)>;
+
+/**
+ * @typedef GraphErrorCallback
+ * @brief 处理图节点运行中出错时的回调（可能在DSP线程池中调用）
+ * @param node_id 出错的节点ID
+ * @param message 错误描述
+ */
+using GraphErrorCallback =
+    std::function<void(const std::string &node_id, const std::string &message)>;
+
+/**
+ * @class ProcessingGraph
+ * @brief 按声明构建并执行处理图
+ *
+ * 构建时按 (类型, 参数, 上游) 对节点去重，声明中配置相同的节点只会实例化一次，
+ * 引用它们的节点ID都映射到同一个实例。捕获线程中按拓扑顺序处理数据，
+ * 标记为 off_thread 的节点（以及wav输出端、指纹节点）各自对应进程级
+ * DSP线程池上的一个串行队列（DspStrand），保持数据顺序的同时不为每个会话单独开线程。
+ * 处理阶段的输出缓冲区按需增长，稳态下不分配内存。
+ */
+class ProcessingGraph {
+public:
+  ~ProcessingGraph();
+
+  /**
+   * @brief 根据声明构建处理图
+   * @param specs 节点声明（顺序任意，上游必须存在且不能成环）
+   * @param sink 所有js输出端共用的合并器（只校验声明时可以为空）
+   * @param error 失败时的错误描述
+   * @param session 所属会话ID，处理图和线程池任务的trace按它记录
+   * @param on_error 节点运行中出错时的回调，可为空
+   * @return 构建成功时返回处理图，否则返回空
+   */
+  static std::unique_ptr<ProcessingGraph>
+  Build(const std::vector<GraphNodeSpec> &specs,
+        std::shared_ptr<DeliveryBatcher> sink, std::string *error,
+        uint32_t session = 0, GraphErrorCallback on_error = nullptr);
+
+  /**
+   * @brief 开始接收数据（Build只校验和实例化节点，不占用线程池）
+   */
+  void Start();
+
+  /**
+   * @brief 把捕获源的一个数据包送入处理图（在捕获线程调用）
+   */
+  void Push(const uint8_t *data, size_t length, int channels, int sample_rate);
+
+  /**
+   * @brief 等待线程池中已提交的数据处理完并关闭输出文件
+   */
+  void Stop();
+
+  /**
+   * @brief 获取所有电平表节点的读数
+   */
+  std::vector<MeterReading> GetMeters() const;
+
+  /**
+   * @brief 实际实例化的节点数（去重之后）
+   */
+  size_t NodeCount() const { return nodes_.size(); }
+
+  /**
+   * @brief 所有降噪节点的累计开销
+   */
+  StageCost DenoiseCost() const;
+
+  /**
+   * @brief 线程池串行队列满而丢弃的数据块数
+   */
+  uint64_t DroppedBlocks() const;
+
+  class Node;
+
+private:
+  ProcessingGraph() = default;
+
+  std::vector<std::unique_ptr<Node>> nodes_;
+  std::vector<Node *> roots_;
+  std::vector<std::unique_ptr<DspStrand>> strands_;
+  uint32_t session_ = 0;
+  bool started_ = false;
+  bool stopped_ = false;
+};
+
+/**
+ * @class ProcessingGraphSlot
+ * @brief 捕获回调使用的处理图槽位，支持在捕获过程中替换处理图
+ *
+ * 捕获线程进入槽位时只增加一个原子计数；替换时先发布新处理图，
+ * 再等待仍在旧处理图中的捕获线程离开（最多一个数据包的处理时间），
+ * 之后旧处理图才会被停止和释放。
+ */
+class ProcessingGraphSlot {
+public:
+  /**
+   * @brief 把数据包送入当前处理图（在捕获线程调用）
+   * @return 没有处理图时返回false，由调用方直接投递
+   */
+  bool Push(const uint8_t *data, size_t length, int channels, int sample_rate);
+
+  /**
+   * @brief 替换处理图（在JS线程调用），旧处理图在返回前停止
+   * @param graph 已启动的新处理图，为空时取消处理图
+   */
+  void Replace(std::shared_ptr<ProcessingGraph> graph);
+
+  /**
+   * @brief 当前处理图（只在JS线程访问）
+   */
+  const std::shared_ptr<ProcessingGraph> &Current() const { return owner_; }
+
+private:
+  std::atomic<ProcessingGraph *> graph_{nullptr};
+  std::atomic<int> readers_{0};
+  std::shared_ptr<ProcessingGraph> owner_;
+};
+
+} // namespace audio_capture
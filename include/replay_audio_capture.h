@@ -0,0 +1,87 @@
+#pragma once
+
+#include "audio_capture.h"
+#include "cadence_trace.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file replay_audio_capture.h
+ * @brief 按录制的回调节奏回放的音频源
+ *
+ * 与合成音频源一样不依赖系统音频API，但数据包的到达时间、帧数和格式
+ * 完全按回调节奏文件（cadence_trace.h）重现，内容为正弦波或WAV文件的音频。
+ */
+
+namespace audio_capture {
+
+/**
+ * @struct ReplayAudio
+ * @brief 回放使用的音频内容（交错float）
+ */
+struct ReplayAudio {
+  std::vector<float> samples;
+  int channels = 0;
+};
+
+/**
+ * @brief 读取WAV文件（16位整数或32位浮点PCM）作为回放内容
+ * @param path 文件路径
+ * @param audio 读取结果
+ * @param error 失败时的错误描述
+ */
+bool LoadReplayAudio(const std::string &path, ReplayAudio *audio,
+                     std::string *error);
+
+/**
+ * @class ReplayAudioCapture
+ * @brief 按回调节奏文件回放的音频源
+ *
+ * 回放线程按每个数据包的相对到达时间等待，然后投递同样帧数和格式的数据。
+ * 音频内容循环读取，通道数不同时按通道序号取模，采样率不同时不做转换
+ * （只关心节奏时可以不提供音频文件，此时为pid决定频率的正弦波）。
+ * 数据包全部回放后，loop 为true时从头重复，否则停止投递直到StopCapture。
+ */
+class ReplayAudioCapture : public AudioCapture {
+public:
+  /**
+   * @brief 构造函数
+   * @param packets 回调节奏（多个会话共享）
+   * @param audio 音频内容，为空时使用正弦波
+   * @param loop 回放完毕后是否从头重复
+   */
+  ReplayAudioCapture(std::shared_ptr<const std::vector<CadencePacket>> packets,
+                     std::shared_ptr<const ReplayAudio> audio, bool loop);
+
+  ~ReplayAudioCapture() override;
+
+  bool Prepare(uint32_t pid, const CaptureOptions &options) override;
+  bool Start(AudioDataCallback callback) override;
+  bool IsPreparedFor(uint32_t pid) const override;
+  bool StopCapture() override;
+  bool IsCapturing() const override;
+
+private:
+  std::shared_ptr<const std::vector<CadencePacket>> packets_;
+  std::shared_ptr<const ReplayAudio> audio_;
+  bool loop_;
+  uint32_t pid_{0};
+  uint32_t trace_session_{0}; ///< trace事件的会话ID
+
+  bool prepared_{false};
+  std::atomic<bool> capturing_{false};
+  bool stop_{false}; ///< 由mutex_保护，StopCapture通过条件变量唤醒回放线程
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread thread_;
+  AudioDataCallback callback_;
+  std::vector<float> buffer_; ///< 按最大的数据包预分配
+
+  void ThreadProc();
+};
+
+} // namespace audio_capture
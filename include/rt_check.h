@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file rt_check.h
+ * @brief 音频回调路径的实时安全检查
+ *
+ * 在音频线程上标记实时作用域，作用域内发生的内存分配/释放、互斥锁等待和
+ * 阻塞调用会按调用位置计数，用于在测试中发现实时性违规。
+ *
+ * 仅在定义了 AUDIO_CAPTURE_RT_CHECK 的构建中生效
+ * （node-gyp rebuild --rt_check=true）。拦截基于链接器的 --wrap 选项，
+ * 目前只在Linux上可用；其他平台上作用域标记仍然生效，但不会拦截调用。
+ */
+
+namespace audio_capture {
+namespace rt_check {
+
+/**
+ * @enum ViolationKind
+ * @brief 实时性违规类型
+ */
+enum class ViolationKind : uint8_t {
+  Allocation, ///< 内存分配（malloc/new等）
+  Free,       ///< 内存释放（free/delete等）
+  MutexWait,  ///< 互斥锁或条件变量等待
+  Blocking,   ///< 可能阻塞的系统调用或阻塞式TSFN调用
+};
+
+/**
+ * @struct Violation
+ * @brief 一个调用位置上的违规统计
+ */
+struct Violation {
+  ViolationKind kind;
+  std::string location; ///< 调用位置（符号+偏移，无法解析时为地址）
+  uint64_t count;
+};
+
+/**
+ * @brief 当前线程是否处于实时作用域内
+ */
+bool InRealtimeScope();
+
+/**
+ * @brief 进入实时作用域（可嵌套）
+ */
+void EnterRealtimeScope();
+
+/**
+ * @brief 离开实时作用域
+ */
+void LeaveRealtimeScope();
+
+/**
+ * @brief 记录一次违规
+ * @param kind 违规类型
+ * @param call_site 调用位置的返回地址
+ *
+ * 不分配内存也不加锁，可在拦截函数内部调用。
+ */
+void ReportViolation(ViolationKind kind, const void *call_site);
+
+/**
+ * @brief 获取所有违规统计（会解析符号，不可在音频线程调用）
+ * @return 按次数从高到低排序的违规列表
+ */
+std::vector<Violation> GetViolations();
+
+/**
+ * @brief 清空违规统计
+ */
+void Reset();
+
+/**
+ * @brief 获取违规类型的名称
+ */
+const char *KindName(ViolationKind kind);
+
+/**
+ * @class RealtimeScope
+ * @brief 实时作用域的RAII标记
+ */
+class RealtimeScope {
+public:
+  RealtimeScope() { EnterRealtimeScope(); }
+  ~RealtimeScope() { LeaveRealtimeScope(); }
+
+private:
+  RealtimeScope(const RealtimeScope &) = delete;
+  RealtimeScope &operator=(const RealtimeScope &) = delete;
+};
+
+} // namespace rt_check
+} // namespace audio_capture
+
+// 在音频线程的回调入口处使用，非检查构建中不产生任何代码
+#ifdef AUDIO_CAPTURE_RT_CHECK
+#define AUDIO_CAPTURE_RT_SCOPE()                                               \
+  audio_capture::rt_check::RealtimeScope audio_capture_rt_scope_
+#else
+#define AUDIO_CAPTURE_RT_SCOPE()                                               \
+  do {                                                                         \
+  } while (0)
+#endif
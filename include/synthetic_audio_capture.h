@@ -0,0 +1,61 @@
+#pragma once
+
+#include "audio_capture.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @file synthetic_audio_capture.h
+ * @brief 合成音频源
+ *
+ * 不依赖任何系统音频API的AudioCapture实现，按固定周期生成正弦波，
+ * 用于在任意平台（包括无音频服务的CI环境）上对插件管线做基准测试。
+ */
+
+namespace audio_capture {
+
+/**
+ * @class SyntheticAudioCapture
+ * @brief 按固定周期生成正弦波的音频源
+ *
+ * 每个会话在独立线程中以实时节奏产生数据，回调的线程模型与真实后端一致。
+ * 正弦波频率由pid决定，便于区分不同会话。
+ */
+class SyntheticAudioCapture : public AudioCapture {
+public:
+  /**
+   * @brief 构造函数
+   * @param sample_rate 采样率（Hz）
+   * @param channels 通道数
+   * @param period_frames 每次回调的帧数（CaptureOptions 指定周期时以其为准）
+   */
+  SyntheticAudioCapture(int sample_rate = 48000, int channels = 2,
+                        int period_frames = 480);
+
+  ~SyntheticAudioCapture() override;
+
+  bool Prepare(uint32_t pid, const CaptureOptions &options) override;
+  bool Start(AudioDataCallback callback) override;
+  bool IsPreparedFor(uint32_t pid) const override;
+  bool StopCapture() override;
+  bool IsCapturing() const override;
+
+private:
+  int sample_rate_;
+  int channels_;
+  int period_frames_;
+  uint32_t pid_{0};
+  uint32_t trace_session_{0}; ///< trace事件的会话ID
+
+  bool prepared_{false};
+  std::atomic<bool> capturing_{false};
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+  AudioDataCallback callback_;
+  std::vector<float> buffer_; ///< 预分配的周期缓冲区
+
+  void ThreadProc();
+};
+
+} // namespace audio_capture
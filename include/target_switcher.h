@@ -0,0 +1,133 @@
+#pragma once
+
+#include "audio_capture.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file target_switcher.h
+ * @brief 捕获目标的无缝切换
+ *
+ * 在同一个会话中从一个音频源切换到另一个音频源，下游（TSFN、统计、
+ * 采样位置）保持不变，切换发生在旧音频源的数据包边界上。
+ */
+
+namespace audio_capture {
+
+/**
+ * @class TargetSwitcher
+ * @brief 在两个音频源之间做包边界切换的分发器
+ *
+ * 每个音频源通过 SourceCallback()/BeginSwitch() 得到一个带代号的回调，
+ * 任一时刻只有一个音频源向下游输出：
+ * - 没有切换时，当前音频源直接输出；
+ * - 切换期间，新音频源的数据先写入无锁环形缓冲区，旧音频源在下一个
+ *   数据包边界上把输出权交给新音频源（可选地与缓冲数据做短交叉淡化）；
+ * - 交接后，新音频源先输出缓冲区中剩余的数据，再输出自己的数据包。
+ *
+ * 环形缓冲区为单生产者单消费者：生产者始终是新音频源的线程，消费者在交接
+ * 前是旧音频源的线程、交接后是新音频源的线程，通过 state_ 的
+ * release/acquire 完成消费者的转移。交接本身由一个只在切换期间竞争的
+ * 标志保护，音频线程抢不到时照常输出、下一个数据包再试；
+ * 缓冲区在构造时分配，回调路径不分配内存、不阻塞。
+ */
+class TargetSwitcher {
+public:
+  /**
+   * @brief 构造函数
+   * @param output 下游回调，同一时刻只会被一个线程调用
+   * @param session 所属会话ID，交接时按它记录trace
+   */
+  explicit TargetSwitcher(AudioDataCallback output, uint32_t session = 0);
+
+  /**
+   * @brief 获取当前音频源的回调
+   */
+  AudioDataCallback SourceCallback();
+
+  /**
+   * @brief 开始切换，返回新音频源应使用的回调
+   * @param crossfade_ms 交叉淡化时长（毫秒），0表示直接切换
+   *
+   * 只能在JS线程调用，且上一次切换必须已经完成或取消。
+   */
+  AudioDataCallback BeginSwitch(uint32_t crossfade_ms);
+
+  /**
+   * @brief 取消尚未完成的切换（新音频源启动失败时调用）
+   */
+  void CancelSwitch();
+
+  /**
+   * @brief 请求旧音频源在下一个数据包边界交接，即使新音频源还没有数据
+   */
+  void ForceSwitch() { force_.store(true, std::memory_order_release); }
+
+  /**
+   * @brief 旧音频源不再产生数据时，由调用方直接完成交接
+   * @return 切换是否已经完成
+   */
+  bool TryCompleteSwitch();
+
+  /**
+   * @brief 切换是否已经完成（没有进行中的切换时也返回true）
+   */
+  bool IsSwitchComplete() const {
+    return PendingGen(state_.load(std::memory_order_acquire)) == 0;
+  }
+
+private:
+  static constexpr size_t kRingCapacity = size_t{1} << 18; ///< 浮点样本数
+  static constexpr size_t kScratchCapacity = size_t{1} << 16;
+
+  AudioDataCallback output_;
+  uint32_t session_;
+
+  // 高32位为当前输出的音频源代号，低32位为切换中的新音频源代号（0表示无）
+  std::atomic<uint64_t> state_{0};
+  std::atomic<bool> handoff_lock_{false};
+  std::atomic<bool> old_emitting_{false}; ///< 旧音频源在锁外输出中
+  uint32_t next_gen_ = 1;
+  std::atomic<bool> force_{false};
+  uint32_t crossfade_ms_ = 0;
+
+  // 新音频源的缓冲数据（交错float）及其格式
+  std::vector<float> ring_;
+  std::atomic<size_t> ring_read_{0};
+  std::atomic<size_t> ring_write_{0};
+  std::atomic<int> pending_channels_{0};
+  std::atomic<int> pending_sample_rate_{0};
+
+  // 交叉淡化的输出缓冲区
+  std::vector<float> scratch_;
+
+  static uint64_t Pack(uint32_t active, uint32_t pending) {
+    return (static_cast<uint64_t>(active) << 32) | pending;
+  }
+  static uint32_t ActiveGen(uint64_t state) {
+    return static_cast<uint32_t>(state >> 32);
+  }
+  static uint32_t PendingGen(uint64_t state) {
+    return static_cast<uint32_t>(state);
+  }
+
+  bool TryLockHandoff() {
+    return !handoff_lock_.exchange(true, std::memory_order_acquire);
+  }
+  void UnlockHandoff() {
+    handoff_lock_.store(false, std::memory_order_release);
+  }
+
+  void OnPacket(uint32_t gen, const uint8_t *data, size_t length, int channels,
+                int sample_rate);
+  void Handoff(uint32_t pending, const float *samples, size_t count,
+               int channels, int sample_rate);
+  void DrainRing();
+
+  size_t RingAvailable() const;
+  void RingWrite(const float *samples, size_t count, int channels);
+  size_t RingRead(float *out, size_t count);
+};
+
+} // namespace audio_capture
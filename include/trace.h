@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @file trace.h
+ * @brief 捕获管线的trace事件记录
+ *
+ * 提供可选开启的耗时span记录，用于分析后端回调、格式转换、入队、
+ * TSFN调度和JS回调各阶段的耗时。事件写入每个线程独立的缓冲区，
+ * 写入过程无锁且不分配内存；停止记录时导出为Chrome trace JSON格式
+ * （可直接在 chrome://tracing 或 Perfetto UI 中打开）。
+ */
+
+namespace audio_capture {
+namespace trace {
+
+/**
+ * @brief 获取单调时钟的当前时间
+ * @return 纳秒时间戳
+ */
+uint64_t NowNs();
+
+/**
+ * @brief 是否正在记录trace
+ * @return 是否已开启
+ */
+bool IsEnabled();
+
+/**
+ * @brief 开始记录trace
+ * @return 是否成功开始（已在记录时返回false）
+ *
+ * 开始记录时会清空上一次记录的所有事件。
+ */
+bool Start();
+
+/**
+ * @brief 停止记录并导出为Chrome trace JSON文件
+ * @param path 输出文件路径
+ * @param error 失败时写入错误信息，可为空
+ * @return 是否成功导出
+ */
+bool Stop(const std::string &path, std::string *error = nullptr);
+
+/**
+ * @brief 为调用线程预先注册事件缓冲区
+ *
+ * 在非实时路径上调用（线程启动时、开始捕获前）。注册会分配缓冲区并加锁，
+ * 同时补足备用缓冲区，供后端创建的实时线程（PipeWire数据线程、
+ * CoreAudio IO线程等）在首次写入时无锁领取。未开启trace时不做任何事。
+ * 实时线程上没有可用的缓冲区时事件被丢弃并计数，不会分配内存。
+ */
+void RegisterThread();
+
+/**
+ * @brief 记录一个完整的span事件
+ * @param name 事件名称（必须是静态字符串）
+ * @param session 会话ID
+ * @param begin_ns 开始时间（NowNs()）
+ * @param end_ns 结束时间（NowNs()）
+ */
+void RecordSpan(const char *name, uint32_t session, uint64_t begin_ns,
+                uint64_t end_ns);
+
+/**
+ * @brief 记录一个瞬时事件
+ * @param name 事件名称（必须是静态字符串）
+ * @param session 会话ID
+ */
+void RecordInstant(const char *name, uint32_t session);
+
+/**
+ * @class ScopedSpan
+ * @brief 作用域span，析构时记录从构造到析构的耗时
+ *
+ * 未开启trace时只有一次原子读取的开销。
+ */
+class ScopedSpan {
+public:
+  ScopedSpan(const char *name, uint32_t session)
+      : name_(name), session_(session), begin_ns_(IsEnabled() ? NowNs() : 0) {}
+
+  ~ScopedSpan() {
+    if (begin_ns_ != 0) {
+      RecordSpan(name_, session_, begin_ns_, NowNs());
+    }
+  }
+
+private:
+  const char *name_;
+  uint32_t session_;
+  uint64_t begin_ns_;
+
+  // 禁止拷贝构造和赋值操作
+  ScopedSpan(const ScopedSpan &) = delete;
+  ScopedSpan &operator=(const ScopedSpan &) = delete;
+};
+
+} // namespace trace
+} // namespace audio_capture
@@ -3,6 +3,7 @@
 #ifdef _WIN32
 
 #include "../audio_capture.h"
+#include "../idle_suspend.h"
 #include <atomic>
 #include <audioclient.h>
 #include <audioclientactivationparams.h>
@@ -10,6 +11,7 @@
 #include <mmdeviceapi.h>
 #include <string>
 #include <thread>
+#include <vector>
 #include <windows.h>
 #include <wrl/client.h>
 #include <wrl/ftm.h>
@@ -35,7 +37,10 @@ namespace win_audio {
  * @class AudioTap
  * @brief Windows进程级音频捕获类
  *
- * 使用WASAPI进程级loopback模式捕获指定进程的音频输出
+ * 使用WASAPI进程级loopback模式捕获指定进程的音频输出。
+ * 启用空闲挂起时，长时间静音后停止音频客户端，捕获线程只在探测间隔
+ * 或配置变化时唤醒。捕获线程同时等待目标进程句柄，进程退出或设备失效时
+ * 结束线程并调用结束回调。
  */
 class AudioTap : public RuntimeClass<RuntimeClassFlags<ClassicCom>, FtmBase,
                                      IActivateAudioInterfaceCompletionHandler> {
@@ -46,14 +51,24 @@ public:
   // WRL初始化方法
   HRESULT RuntimeClassInitialize(uint32_t pid);
 
+  // 改为捕获输入设备（端点ID，为空时使用默认通信输入设备）
+  // 必须在Initialize()之前调用
+  void SetInputDevice(const std::string &device);
+
+  // 目标进程退出或设备失效时在捕获线程调用，必须在Start()之前设置
+  void SetEndedCallback(EndedCallback callback) {
+    ended_callback_ = std::move(callback);
+  }
+
   // 主要接口
-  bool Initialize();
+  bool Initialize(const CaptureOptions &options = CaptureOptions());
   bool Start(AudioDataCallback callback);
   void Stop();
 
   // 状态查询
   bool IsCapturing() const { return is_capturing_.load(); }
   std::string GetErrorMessage() const { return error_message_; }
+  ChannelLayout GetChannelLayout() const { return layout_; }
 
   // IActivateAudioInterfaceCompletionHandler实现
   STDMETHOD(ActivateCompleted)(
@@ -62,9 +77,14 @@ public:
 private:
   // 基本属性
   uint32_t target_pid_;
+  uint32_t trace_session_ = 0; ///< trace事件的会话ID
+  bool input_device_ = false;
+  std::wstring device_id_;
   std::atomic<bool> is_capturing_{false};
   std::string error_message_;
   AudioDataCallback callback_;
+  EndedCallback ended_callback_;
+  HANDLE process_handle_ = nullptr; ///< 目标进程（SYNCHRONIZE），退出时有信号
 
   // COM接口
   ComPtr<IMMDeviceEnumerator> device_enumerator_;
@@ -79,19 +99,39 @@ private:
   std::atomic<bool> stop_capture_{false};
   HANDLE capture_event_;
   HANDLE activate_completed_event_;
+  HANDLE wake_event_; ///< 唤醒空闲监视中的捕获线程（停止或配置变化）
 
   // 音频格式
   WAVEFORMATEX *mix_format_;
   UINT32 buffer_frame_count_;
+  bool native_format_ = false; ///< 按默认输出设备的混音格式捕获
+  ChannelLayout layout_;       ///< 请求格式的声道布局
   HRESULT activate_result_;
+  DWORD activation_timeout_ms_;
+  CO_MTA_USAGE_COOKIE mta_cookie_ = nullptr; ///< 持有期间MTA不会被销毁
+  bool mf_started_ = false;
+  std::shared_ptr<std::atomic<bool>> cancel_flag_;
+
+  // 捕获周期
+  UINT32 period_frames_ = 0;   ///< 期望的周期（按48kHz计的帧数）
+  DWORD poll_interval_ms_ = 0; ///< 轮询间隔，0表示按引擎周期的事件唤醒
+  std::vector<float> pending_; ///< 一次唤醒中转换好的数据，合并为一次回调
+
+  // 空闲挂起
+  std::shared_ptr<IdleSuspend> idle_;
+  SilenceDetector detector_;
 
   // 内部方法
   void Cleanup();
   void SetError(const std::string &message);
   bool CheckTargetProcessExists();
   bool ActivateProcessLoopbackAudioClient();
+  bool ActivateInputDeviceAudioClient();
   HRESULT InitializeAudioClientInCallback();
+  WAVEFORMATEX *QueryDeviceMixFormat();
   void CaptureThreadProc();
+  bool IdleWait();
+  void EndCapture(const char *reason);
   void ProcessAudioData(BYTE *data, UINT32 frames, DWORD flags);
 };
 
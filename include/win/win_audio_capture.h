@@ -39,16 +39,28 @@ public:
   WinAudioCapture();
   ~WinAudioCapture() override;
 
-  bool StartCapture(uint32_t pid, AudioDataCallback callback) override;
+  bool Prepare(uint32_t pid, const CaptureOptions &options) override;
+  bool Start(AudioDataCallback callback) override;
+  bool IsPreparedFor(uint32_t pid) const override;
   bool StopCapture() override;
   bool IsCapturing() const override;
+  ChannelLayout GetChannelLayout() const override;
+  void SetEndedCallback(EndedCallback callback) override;
+
+  /**
+   * @brief 改为捕获输入设备（端点ID，为空时使用默认通信输入设备）
+   */
+  void SetInputDevice(const std::string &device);
 
 private:
   // 状态管理
   std::atomic<bool> capturing_{false};
   std::atomic<bool> initialized_{false};
   AudioDataCallback callback_;
+  EndedCallback ended_callback_;
   uint32_t current_pid_{0};
+  bool input_device_{false};
+  std::string device_;
 
   // 音频捕获对象
   Microsoft::WRL::ComPtr<win_audio::AudioTap> process_capture_;
@@ -1,11 +1,38 @@
 import bindings from "bindings";
 import type {
   AudioCaptureEvents,
+  AudioCaptureOptions,
   AudioData,
+  CaptureEnded,
+  CaptureOptions,
+  CaptureSession,
+  CaptureStats,
+  DeliveryBatchingOptions,
+  DeliveryProfile,
+  DspPoolStats,
+  FormatChange,
+  MetricsOptions,
+  GraphError,
+  GraphMeterReading,
+  GraphNodeSpec,
+  IdleSuspendOptions,
+  LevelTriggerChange,
+  LevelTriggerOptions,
+  MeetingCaptureOptions,
+  MixSource,
+  MixSourceStatus,
   PermissionStatus,
   ProcessInfo,
+  ProcessingGraphSpec,
+  ProfileData,
+  RealtimeViolation,
+  StartCaptureAsyncOptions,
+  SwitchTargetOptions,
+  Unsubscribe,
 } from "./types";
 import { EventEmitter } from "events";
+import { profileKey } from "./transport";
+import * as fs from "fs";
 import * as os from "os";
 import path from "path";
 
@@ -22,14 +49,116 @@ interface AudioCaptureAddon {
   /** 获取可捕获音频的进程列表 */
   getProcessList(): ProcessInfo[];
 
+  /** 预先完成指定进程的捕获准备 */
+  prepareCapture(pid: number, options?: CaptureOptions): boolean;
+
   /** 开始捕获指定进程的音频 */
-  startCapture(pid: number, callback: (audioData: AudioData) => void): boolean;
+  startCapture(
+    pid: number,
+    callback: (audioData: AudioData) => void,
+    options?: CaptureOptions
+  ): boolean;
+
+  /** 在工作线程中完成后端准备后开始捕获 */
+  startCaptureAsync(
+    pid: number,
+    callback: (audioData: AudioData) => void,
+    options?: CaptureOptions
+  ): Promise<CaptureSession>;
+
+  /** 取消正在进行的异步启动 */
+  cancelStart(): boolean;
+
+  /** 在不中断下游的情况下切换捕获目标 */
+  switchTarget(
+    pid: number,
+    options?: SwitchTargetOptions
+  ): Promise<CaptureSession>;
+
+  /** 获取进程内唯一的会话ID */
+  getSessionId(): number;
+
+  /** 开始混音捕获 */
+  startMixCapture(
+    sources: Array<number | MixSource>,
+    callback: (audioData: AudioData) => void
+  ): boolean;
+
+  /** 开始会议捕获（进程音频 + 麦克风） */
+  startMeetingCapture(
+    pid: number,
+    options: MeetingCaptureOptions,
+    callback: (audioData: AudioData) => void
+  ): boolean;
+
+  /** 向混音会话添加音频源 */
+  addMixSource(source: number | MixSource): boolean;
+
+  /** 从混音会话移除音频源 */
+  removeMixSource(pid: number): boolean;
+
+  /** 设置混音源增益 */
+  setMixSourceGain(pid: number, gain: number): boolean;
+
+  /** 设置混音源静音 */
+  setMixSourceMuted(pid: number, muted: boolean): boolean;
+
+  /** 获取混音源状态 */
+  getMixSources(): MixSourceStatus[];
+
+  /** 声明会话的处理图 */
+  setProcessingGraph(nodes: GraphNodeSpec[] | null): boolean;
+
+  /** 配置投递给JS的自适应合并 */
+  setDeliveryBatching(options: DeliveryBatchingOptions | null): boolean;
+
+  /** 配置电平触发 */
+  setLevelTrigger(options: LevelTriggerOptions | null): boolean;
+
+  /** 配置长时间静音时的空闲挂起 */
+  setIdleSuspend(options: IdleSuspendOptions | null): boolean;
+
+  /** 获取处理图中所有电平表的读数 */
+  getGraphMeters(): GraphMeterReading[];
+
+  /** 获取进程级DSP线程池的统计 */
+  getDspPoolStats(): DspPoolStats;
+
+  /** 获取当前捕获格式的声道布局 */
+  getChannelLayout(): string[];
 
   /** 停止捕获 */
   stopCapture(): boolean;
 
   /** 检查是否正在捕获音频 */
   isCapturing(): boolean;
+
+  /** 获取当前会话的统计数据 */
+  getStats(): CaptureStats;
+
+  /** 开始记录捕获管线的trace */
+  startTracing(): boolean;
+
+  /** 停止记录trace并导出为Chrome trace JSON文件 */
+  stopTracing(path: string): boolean;
+
+  /** 获取音频线程实时作用域内的违规统计 */
+  getRealtimeViolations(reset?: boolean): RealtimeViolation[];
+
+  /** 开始录制回调节奏 */
+  startCadenceRecording(maxPackets?: number): boolean;
+
+  /** 停止录制回调节奏并写出文件 */
+  stopCadenceRecording(path: string): boolean;
+
+  /** 开启进程级指标 */
+  startMetrics(options?: MetricsOptions): boolean;
+
+  /** 关闭进程级指标 */
+  stopMetrics(): boolean;
+
+  /** 按OpenMetrics文本格式导出进程级指标 */
+  getMetricsText(): string;
 }
 
 interface OsVersion {
@@ -39,7 +168,7 @@ interface OsVersion {
 
 interface NativeModule {
   AudioCaptureAddon: {
-    new (): AudioCaptureAddon;
+    new (options?: AudioCaptureOptions): AudioCaptureAddon;
   };
 }
 
@@ -117,7 +246,7 @@ class AudioCaptureStub extends EventEmitter<AudioCaptureEvents> {
    * 仅支持
    * - macOS 14.4+
    * - Windows 10+
-   * - Linux 不支持
+   * - Linux (PipeWire)
    */
   isPlatformSupported(): boolean {
     return false;
@@ -138,18 +267,294 @@ class AudioCaptureStub extends EventEmitter<AudioCaptureEvents> {
     return [];
   }
 
+  /**
+   * 预先完成指定进程的捕获准备
+   *
+   * 提前完成创建tap、激活音频客户端、连接音频流等耗时操作，
+   * 之后对同一进程调用 startCapture 可以立即开始投递数据
+   */
+  prepareCapture(_pid: number, _options?: CaptureOptions): boolean {
+    return false;
+  }
+
   /** 开始捕获指定进程的音频 */
   startCapture(
     _pid: number,
+    _callback?: (audioData: AudioData) => void,
+    _options?: CaptureOptions
+  ): boolean {
+    return false;
+  }
+
+  /**
+   * 异步开始捕获指定进程的音频
+   *
+   * 所有耗时的后端初始化都在工作线程中完成，不会阻塞事件循环。
+   * 多个实例可以并行启动。数据通过 `audio-data` 事件投递。
+   *
+   * 取消或超时时 reject，错误的 code 分别为
+   * `ERR_CAPTURE_CANCELLED` 和 `ERR_CAPTURE_TIMEOUT`
+   */
+  startCaptureAsync(
+    _pid: number,
+    _options?: StartCaptureAsyncOptions
+  ): Promise<CaptureSession> {
+    return Promise.reject(new Error("当前平台不支持音频捕获"));
+  }
+
+  /**
+   * 在不中断下游的情况下切换捕获目标
+   *
+   * 新目标在后台准备好后，在旧目标的数据包边界上切换，`audio-data` 事件、
+   * 统计和 `position` 保持连续。可选 `crossfadeMs` 做短交叉淡化
+   */
+  switchTarget(
+    _pid: number,
+    _options?: SwitchTargetOptions
+  ): Promise<CaptureSession> {
+    return Promise.reject(new Error("当前平台不支持音频捕获"));
+  }
+
+  /**
+   * 同时捕获多个进程并在原生侧混成一路立体声
+   *
+   * 各音频源按捕获时间对齐并做时钟漂移校正；暂时没有音频输出的进程会在
+   * 后台定期重试，中途消失的音频源输出静音。用 stopCapture 停止
+   */
+  startMixCapture(
+    _sources: Array<number | MixSource>,
     _callback?: (audioData: AudioData) => void
   ): boolean {
     return false;
   }
 
+  /**
+   * 同时捕获目标进程和麦克风，按时间对齐并做时钟漂移校正后输出
+   *
+   * 两个音频源出现在 getMixSources 中，麦克风的 pid 为 0，可以用
+   * setMixSourceGain/setMixSourceMuted 单独调节。用 stopCapture 停止
+   */
+  startMeetingCapture(
+    _pid: number,
+    _options?: MeetingCaptureOptions,
+    _callback?: (audioData: AudioData) => void
+  ): boolean {
+    return false;
+  }
+
+  /** 向正在运行的混音会话添加音频源 */
+  addMixSource(_source: number | MixSource): boolean {
+    return false;
+  }
+
+  /** 从混音会话移除音频源 */
+  removeMixSource(_pid: number): boolean {
+    return false;
+  }
+
+  /** 设置混音源的线性增益 */
+  setMixSourceGain(_pid: number, _gain: number): boolean {
+    return false;
+  }
+
+  /** 设置混音源是否静音 */
+  setMixSourceMuted(_pid: number, _muted: boolean): boolean {
+    return false;
+  }
+
+  /** 获取混音源的状态 */
+  getMixSources(): MixSourceStatus[] {
+    return [];
+  }
+
+  /**
+   * 声明会话的处理图，在下一次开始捕获时生效
+   *
+   * 捕获源的数据在原生侧依次经过各处理阶段，由 `js` 节点投递到 `audio-data`
+   * 事件（`AudioData.sink` 为节点ID），`wav` 节点直接写入文件。
+   * 例如电平表 + 录音 + 16kHz单声道识别输入只需要一次捕获。
+   * 声明无效时抛出TypeError；捕获过程中调用时立即替换。传入null取消处理图
+   */
+  setProcessingGraph(_spec: ProcessingGraphSpec | null): boolean {
+    return false;
+  }
+
+  /**
+   * 配置投递给JS的自适应合并，捕获过程中调用时立即生效
+   *
+   * 事件循环繁忙时原生侧把多个数据包拼接成一次回调以减少回调次数，
+   * 空闲时回到每个数据包一次。参数无效时抛出TypeError；传入null关闭合并
+   */
+  setDeliveryBatching(_options: DeliveryBatchingOptions | null): boolean {
+    return false;
+  }
+
+  /**
+   * 配置电平触发，捕获过程中调用时立即生效
+   *
+   * 启用后只在目标程序发声时投递（含预录数据），空闲时JS收不到任何回调，
+   * 开始和停止时触发 `level-trigger` 事件。参数无效时抛出TypeError；传入null关闭
+   */
+  setLevelTrigger(_options: LevelTriggerOptions | null): boolean {
+    return false;
+  }
+
+  /**
+   * 配置空闲挂起，捕获过程中调用时立即生效
+   *
+   * 连续静音达到设定时长后后端停止音频流，只在目标重新播放或探测间隔到达时
+   * 唤醒，挂起次数和空闲期间的唤醒、CPU耗时见 getStats()。
+   * 参数无效时抛出TypeError；传入null关闭
+   */
+  setIdleSuspend(_options: IdleSuspendOptions | null): boolean {
+    return false;
+  }
+
+  /** 获取处理图中所有电平表的读数 */
+  getGraphMeters(): GraphMeterReading[] {
+    return [];
+  }
+
+  /**
+   * 按配置订阅音频数据
+   *
+   * 每个不同的配置（采样率、通道数、分块大小、样本格式或只要电平）在原生侧
+   * 对每个数据包只计算一次，结果只分发给该配置的订阅者；不同配置之间共享
+   * 相同的处理阶段。捕获过程中订阅和取消订阅会立即生效
+   *
+   * @returns 取消此次订阅的函数
+   */
+  subscribe(
+    _profile: DeliveryProfile,
+    _listener: (data: ProfileData) => void
+  ): Unsubscribe {
+    return () => {};
+  }
+
+  /**
+   * 获取进程级DSP线程池的统计
+   *
+   * 所有会话离开捕获线程的处理（处理图的 offThread 节点、wav 输出端）共享
+   * 一个按CPU核数配置的工作窃取线程池，每个会话分支内保持数据顺序
+   */
+  getDspPoolStats(): DspPoolStats {
+    return {
+      workers: 0,
+      jobs: 0,
+      steals: 0,
+      queueDepth: 0,
+      maxQueueDepth: 0,
+      dropped: 0,
+    };
+  }
+
+  /**
+   * 获取当前捕获格式的声道布局
+   *
+   * 顺序与交错数据一致，如 ["FL", "FR", "FC", "LFE", "SL", "SR"]；
+   * 位置未知的声道为 AUX0、AUX1……，尚未开始捕获时为空数组
+   */
+  getChannelLayout(): string[] {
+    return [];
+  }
+
   /** 停止捕获 */
   stopCapture(): boolean {
     return false;
   }
+
+  /** 获取当前会话的统计数据 */
+  getStats(): CaptureStats {
+    return {
+      packets: 0,
+      frames: 0,
+      delivered: 0,
+      dropped: 0,
+      callbackLatency: { p50: 0, p90: 0, p99: 0, max: 0 },
+      firstFrameLatency: -1,
+      graphDropped: 0,
+      denoiseCpuMs: 0,
+      denoiseAudioMs: 0,
+      triggerActive: true,
+      batchMs: 0,
+      idle: false,
+      idleSuspensions: 0,
+      idleProbes: 0,
+      idleWakeups: 0,
+      idleCpuMs: 0,
+      idleMs: 0,
+      formatChanges: 0,
+      periodFrames: 0,
+      periodMs: 0,
+    };
+  }
+
+  /**
+   * 开始记录捕获管线的trace
+   *
+   * 记录后端回调、格式转换、入队、TSFN调度和JS回调各阶段的耗时
+   */
+  startTracing(): boolean {
+    return false;
+  }
+
+  /**
+   * 停止记录trace并导出为Chrome trace JSON文件
+   *
+   * 导出的文件可在 chrome://tracing 或 Perfetto UI 中打开
+   */
+  stopTracing(_path: string): boolean {
+    return false;
+  }
+
+  /**
+   * 获取音频线程实时作用域内的违规统计
+   *
+   * 仅在 `npm run build:native:rt-check` 构建的插件中有数据（目前仅Linux拦截调用）
+   *
+   * @param _reset 获取后是否清空统计
+   */
+  getRealtimeViolations(_reset?: boolean): RealtimeViolation[] {
+    return [];
+  }
+
+  /**
+   * 开始录制本会话每个数据包的到达时间、帧数和格式（不含PCM）
+   *
+   * 录制的文件可以用 `{ source: "replay", replay: { trace } }` 按同样的节奏回放
+   *
+   * @param _maxPackets 最多记录的数据包数（默认 360000，每秒100包时约1小时）
+   */
+  startCadenceRecording(_maxPackets?: number): boolean {
+    return false;
+  }
+
+  /**
+   * 停止录制回调节奏并写出紧凑的二进制文件，未在录制时返回false
+   */
+  stopCadenceRecording(_path: string): boolean {
+    return false;
+  }
+
+  /**
+   * 开启进程级指标（会话数、丢包、回调延迟、进程枚举耗时、处理阶段实时率等）
+   *
+   * 指定 socket 或 port 时由原生线程在本地应答抓取，每次抓取不经过JS。
+   * 已开启时按新的参数重新应答；监听失败时抛出异常
+   */
+  startMetrics(_options?: MetricsOptions): boolean {
+    return false;
+  }
+
+  /** 停止记录指标和应答抓取（保留已有的累计值），未开启时返回false */
+  stopMetrics(): boolean {
+    return false;
+  }
+
+  /** 按OpenMetrics文本格式导出进程级指标，可直接作为抓取响应 */
+  getMetricsText(): string {
+    return "# EOF\n";
+  }
 }
 
 /**
@@ -158,10 +563,35 @@ class AudioCaptureStub extends EventEmitter<AudioCaptureEvents> {
 export class AudioCapture extends AudioCaptureStub {
   private addon: AudioCaptureAddon;
 
-  constructor() {
+  /** setProcessingGraph 声明的节点 */
+  private graphNodes: GraphNodeSpec[] = [];
+
+  /** 订阅配置，按 profileKey 索引 */
+  private profiles = new Map<
+    string,
+    { profile: DeliveryProfile; listeners: Set<(data: ProfileData) => void> }
+  >();
+
+  /** 开始捕获时传入的回调 */
+  private captureCallback?: (audioData: AudioData) => void;
+
+  /**
+   * @param options 可选配置，每个实例是一个独立的捕获会话
+   */
+  constructor(options?: AudioCaptureOptions) {
     super();
     // 创建C++类的实例
-    this.addon = new native.AudioCaptureAddon();
+    this.addon = new native.AudioCaptureAddon(options);
+
+    // 有订阅配置时，audio-data 监听器的增减决定是否需要原样投递源数据
+    const onListenersChanged = (eventName: string | symbol) => {
+      if (eventName === "audio-data" && this.profiles.size > 0) {
+        queueMicrotask(() => this.applyGraph());
+      }
+    };
+    const emitter = this as unknown as EventEmitter;
+    emitter.on("newListener", onListenersChanged);
+    emitter.on("removeListener", onListenersChanged);
   }
 
   public get isCapturing(): boolean {
@@ -187,6 +617,13 @@ export class AudioCapture extends AudioCaptureStub {
       return majorVersion >= 10;
     }
 
+    // Linux 支持检查
+    if (platform === "linux") {
+      // 需要当前会话中运行着PipeWire
+      const runtimeDir = process.env.XDG_RUNTIME_DIR;
+      return !!runtimeDir && fs.existsSync(path.join(runtimeDir, "pipewire-0"));
+    }
+
     // 其他平台不支持
     return false;
   }
@@ -213,9 +650,20 @@ export class AudioCapture extends AudioCaptureStub {
     return this.addon.getProcessList();
   }
 
+  prepareCapture(pid: number, options?: CaptureOptions): boolean {
+    // 检查权限
+    const permission = this.checkPermission();
+    if (permission.status !== "authorized") {
+      throw new Error("没有音频捕获权限");
+    }
+
+    return this.addon.prepareCapture(pid, options);
+  }
+
   startCapture(
     pid: number,
-    callback?: (audioData: AudioData) => void
+    callback?: (audioData: AudioData) => void,
+    options?: CaptureOptions
   ): boolean {
     // 检查权限
     const permission = this.checkPermission();
@@ -224,11 +672,14 @@ export class AudioCapture extends AudioCaptureStub {
     }
 
     try {
-      const result = this.addon.startCapture(pid, (audioData) => {
-        callback?.(audioData);
-        this.emit("audio-data", audioData);
-      });
+      this.setCaptureCallback(callback);
+      const result = this.addon.startCapture(
+        pid,
+        (audioData) => this.deliver(audioData),
+        options
+      );
       if (result) {
+        sessions.set(this.addon.getSessionId(), this);
         this.emit("capturing", true);
       }
 
@@ -238,19 +689,329 @@ export class AudioCapture extends AudioCaptureStub {
     }
   }
 
+  async startCaptureAsync(
+    pid: number,
+    options: StartCaptureAsyncOptions = {}
+  ): Promise<CaptureSession> {
+    // 检查权限
+    const permission = this.checkPermission();
+    if (permission.status !== "authorized") {
+      throw new Error("没有音频捕获权限");
+    }
+
+    const { signal, timeoutMs, ...captureOptions } = options;
+    if (signal?.aborted) {
+      throw createCaptureError("捕获启动已取消", "ERR_CAPTURE_CANCELLED");
+    }
+
+    let timedOut = false;
+    const timer =
+      timeoutMs !== undefined
+        ? setTimeout(() => {
+            timedOut = true;
+            this.addon.cancelStart();
+          }, timeoutMs)
+        : undefined;
+    const onAbort = () => this.addon.cancelStart();
+    signal?.addEventListener("abort", onAbort, { once: true });
+
+    try {
+      this.setCaptureCallback(undefined);
+      const session = await this.addon.startCaptureAsync(
+        pid,
+        (audioData) => this.deliver(audioData),
+        captureOptions
+      );
+      sessions.set(session.sessionId, this);
+      this.emit("capturing", true);
+      return session;
+    } catch (error) {
+      if (timedOut) {
+        throw createCaptureError("捕获启动超时", "ERR_CAPTURE_TIMEOUT");
+      }
+      throw error;
+    } finally {
+      clearTimeout(timer);
+      signal?.removeEventListener("abort", onAbort);
+    }
+  }
+
   stopCapture(): boolean {
     if (!this.isCapturing) {
+      // 释放 prepareCapture 的准备结果
+      this.addon.stopCapture();
       return false;
     }
 
     const result = this.addon.stopCapture();
     if (result) {
+      sessions.delete(this.addon.getSessionId());
       this.emit("capturing", false);
     }
 
     return result;
   }
 
+  switchTarget(
+    pid: number,
+    options?: SwitchTargetOptions
+  ): Promise<CaptureSession> {
+    return this.addon.switchTarget(pid, options);
+  }
+
+  startMixCapture(
+    sources: Array<number | MixSource>,
+    callback?: (audioData: AudioData) => void
+  ): boolean {
+    // 检查权限
+    const permission = this.checkPermission();
+    if (permission.status !== "authorized") {
+      throw new Error("没有音频捕获权限");
+    }
+
+    this.setCaptureCallback(callback);
+    const result = this.addon.startMixCapture(sources, (audioData) =>
+      this.deliver(audioData)
+    );
+    if (result) {
+      sessions.set(this.addon.getSessionId(), this);
+      this.emit("capturing", true);
+    }
+
+    return result;
+  }
+
+  startMeetingCapture(
+    pid: number,
+    options: MeetingCaptureOptions = {},
+    callback?: (audioData: AudioData) => void
+  ): boolean {
+    // 检查权限
+    const permission = this.checkPermission();
+    if (permission.status !== "authorized") {
+      throw new Error("没有音频捕获权限");
+    }
+
+    this.setCaptureCallback(callback);
+    const result = this.addon.startMeetingCapture(pid, options, (audioData) =>
+      this.deliver(audioData)
+    );
+    if (result) {
+      sessions.set(this.addon.getSessionId(), this);
+      this.emit("capturing", true);
+    }
+
+    return result;
+  }
+
+  addMixSource(source: number | MixSource): boolean {
+    return this.addon.addMixSource(source);
+  }
+
+  removeMixSource(pid: number): boolean {
+    return this.addon.removeMixSource(pid);
+  }
+
+  setMixSourceGain(pid: number, gain: number): boolean {
+    return this.addon.setMixSourceGain(pid, gain);
+  }
+
+  setMixSourceMuted(pid: number, muted: boolean): boolean {
+    return this.addon.setMixSourceMuted(pid, muted);
+  }
+
+  getMixSources(): MixSourceStatus[] {
+    return this.addon.getMixSources();
+  }
+
+  setProcessingGraph(spec: ProcessingGraphSpec | null): boolean {
+    if (typeof spec === "string") {
+      spec = JSON.parse(spec) as ProcessingGraphSpec;
+    }
+    if (spec && !Array.isArray(spec) && typeof spec === "object") {
+      spec = spec.nodes;
+    }
+    const nodes = (spec as GraphNodeSpec[] | null) ?? [];
+
+    // 先单独校验，声明无效时保留原来的处理图
+    const previous = this.graphNodes;
+    this.graphNodes = nodes;
+    try {
+      return this.applyGraph();
+    } catch (error) {
+      this.graphNodes = previous;
+      throw error;
+    }
+  }
+
+  subscribe(
+    profile: DeliveryProfile,
+    listener: (data: ProfileData) => void
+  ): Unsubscribe {
+    const key = profileKey(profile);
+    let entry = this.profiles.get(key);
+    if (!entry) {
+      entry = { profile, listeners: new Set() };
+      this.profiles.set(key, entry);
+      this.applyGraph();
+    }
+    entry.listeners.add(listener);
+
+    return () => {
+      const current = this.profiles.get(key);
+      if (current?.listeners.delete(listener) && current.listeners.size === 0) {
+        this.profiles.delete(key);
+        this.applyGraph();
+      }
+    };
+  }
+
+  getGraphMeters(): GraphMeterReading[] {
+    return this.addon.getGraphMeters();
+  }
+
+  setDeliveryBatching(options: DeliveryBatchingOptions | null): boolean {
+    return this.addon.setDeliveryBatching(options);
+  }
+
+  setLevelTrigger(options: LevelTriggerOptions | null): boolean {
+    return this.addon.setLevelTrigger(options);
+  }
+
+  setIdleSuspend(options: IdleSuspendOptions | null): boolean {
+    return this.addon.setIdleSuspend(options);
+  }
+
+  getDspPoolStats(): DspPoolStats {
+    return this.addon.getDspPoolStats();
+  }
+
+  getChannelLayout(): string[] {
+    return this.addon.getChannelLayout();
+  }
+
+  getStats(): CaptureStats {
+    return this.addon.getStats();
+  }
+
+  startTracing(): boolean {
+    return this.addon.startTracing();
+  }
+
+  stopTracing(path: string): boolean {
+    return this.addon.stopTracing(path);
+  }
+
+  getRealtimeViolations(reset?: boolean): RealtimeViolation[] {
+    return this.addon.getRealtimeViolations(reset);
+  }
+
+  startCadenceRecording(maxPackets?: number): boolean {
+    return this.addon.startCadenceRecording(maxPackets);
+  }
+
+  stopCadenceRecording(path: string): boolean {
+    return this.addon.stopCadenceRecording(path);
+  }
+
+  startMetrics(options?: MetricsOptions): boolean {
+    return this.addon.startMetrics(options);
+  }
+
+  stopMetrics(): boolean {
+    return this.addon.stopMetrics();
+  }
+
+  getMetricsText(): string {
+    return this.addon.getMetricsText();
+  }
+
+  private setCaptureCallback(callback?: (audioData: AudioData) => void) {
+    const changed = !!callback !== !!this.captureCallback;
+    this.captureCallback = callback;
+    if (changed && this.profiles.size > 0) {
+      this.applyGraph();
+    }
+  }
+
+  /**
+   * 合并 setProcessingGraph 声明的节点和各订阅配置的节点，交给原生侧
+   *
+   * 没有自定义处理图时，只有存在 audio-data 监听器或捕获回调才原样投递源数据
+   */
+  private applyGraph(): boolean {
+    const nodes = new Map<string, GraphNodeSpec>();
+    this.graphNodes.forEach((node) => nodes.set(node.id, node));
+
+    this.profiles.forEach(({ profile }) => {
+      profileNodes(profile).forEach((node) => nodes.set(node.id, node));
+    });
+
+    const passthrough =
+      this.profiles.size > 0 &&
+      this.graphNodes.length === 0 &&
+      (this.listenerCount("audio-data") > 0 || !!this.captureCallback);
+    if (passthrough) {
+      profileNodes({}).forEach((node) => nodes.set(node.id, node));
+    }
+
+    return this.addon.setProcessingGraph(
+      nodes.size > 0 ? Array.from(nodes.values()) : null
+    );
+  }
+
+  /**
+   * 分发原生侧投递的数据：订阅配置的结果交给对应的订阅者，
+   * 其余的交给捕获回调和 audio-data 事件
+   */
+  private deliver(audioData: AudioData | NativeEvent) {
+    // 格式变化、电平触发、结束通知和数据经由同一个回调，
+    // 保证事件在对应的数据之前触发
+    if ("event" in audioData) {
+      if (audioData.event === "ended") {
+        // 目标已经不存在，立即停止并释放原生侧的资源
+        const { pid, reason } = audioData;
+        const sessionId = this.addon.getSessionId();
+        this.stopCapture();
+        // 无论原生侧返回什么，会话在JS侧都已结束
+        if (sessions.get(sessionId) === this) {
+          sessions.delete(sessionId);
+          this.emit("capturing", false);
+        }
+        this.emit("ended", { pid, reason });
+      } else if (audioData.event === "graph-error") {
+        const { event: _event, ...error } = audioData;
+        this.emit("graph-error", error);
+      } else if (audioData.event === "level-trigger") {
+        const { event: _event, ...change } = audioData;
+        this.emit("level-trigger", change);
+      } else {
+        const { event: _event, ...change } = audioData;
+        this.emit("format-changed", change);
+      }
+      return;
+    }
+    const sink = audioData.sink;
+    if (sink?.startsWith(PROFILE_SINK_PREFIX)) {
+      const key = sink.slice(PROFILE_SINK_PREFIX.length);
+      const entry = this.profiles.get(key);
+      if (entry) {
+        const data = toProfileData(entry.profile, audioData);
+        entry.listeners.forEach((listener) => listener(data));
+      }
+
+      // 原样投递的输出端同时作为 audio-data 事件的数据源
+      if (key !== profileKey({})) {
+        return;
+      }
+      const { buffer, channels, sampleRate, position } = audioData;
+      audioData = { buffer, channels, sampleRate, position };
+    }
+
+    this.captureCallback?.(audioData);
+    this.emit("audio-data", audioData);
+  }
+
   private getOsVersion(): OsVersion {
     try {
       const osRelease = os.release();
@@ -264,10 +1025,125 @@ export class AudioCapture extends AudioCaptureStub {
   }
 }
 
+/** 原生回调中的格式变化、电平触发和结束通知 */
+type NativeEvent =
+  | (FormatChange & { event: "format-changed" })
+  | (LevelTriggerChange & { event: "level-trigger" })
+  | (CaptureEnded & { event: "ended" })
+  | (GraphError & { event: "graph-error" });
+
+/** 正在捕获的会话，按会话ID索引 */
+const sessions = new Map<number, AudioCapture>();
+
+/**
+ * 按会话ID切换捕获目标
+ *
+ * @param sessionId startCaptureAsync 返回的会话ID
+ * @param pid 新的目标进程ID
+ * @param options 切换配置
+ */
+export function switchTarget(
+  sessionId: number,
+  pid: number,
+  options?: SwitchTargetOptions
+): Promise<CaptureSession> {
+  const session = sessions.get(sessionId);
+  if (!session) {
+    return Promise.reject(
+      createCaptureError("会话不存在或已停止", "ERR_SESSION_NOT_FOUND")
+    );
+  }
+  return session.switchTarget(pid, options);
+}
+
+/** 订阅配置对应的js输出端节点ID前缀 */
+const PROFILE_SINK_PREFIX = "profile:";
+
+/**
+ * 订阅配置对应的处理图节点
+ *
+ * 中间节点的ID由前面各阶段的配置组成，前缀相同的配置生成相同的节点，
+ * 合并后只计算一次
+ */
+function profileNodes(profile: DeliveryProfile): GraphNodeSpec[] {
+  const sinkId = `${PROFILE_SINK_PREFIX}${profileKey(profile)}`;
+  if (profile.levels) {
+    const id = `profile-stage:levels=${profile.levels}`;
+    return [
+      { id, type: "levels", rate: profile.levels },
+      { id: sinkId, type: "js", input: id },
+    ];
+  }
+
+  const nodes: GraphNodeSpec[] = [];
+  let input = "source";
+  let stage = "profile-stage:";
+  const push = (key: string, node: GraphNodeSpec) => {
+    stage += key;
+    nodes.push({ ...node, id: stage, input } as GraphNodeSpec);
+    input = stage;
+  };
+  if (profile.sampleRate) {
+    push(`rate=${profile.sampleRate};`, {
+      id: "",
+      type: "resample",
+      sampleRate: profile.sampleRate,
+    });
+  }
+  if (profile.channels) {
+    push(`ch=${profile.channels};`, {
+      id: "",
+      type: "remix",
+      channels: profile.channels,
+    });
+  }
+  if (profile.chunkFrames) {
+    push(`chunk=${profile.chunkFrames};`, {
+      id: "",
+      type: "chunk",
+      frames: profile.chunkFrames,
+    });
+  }
+  nodes.push({
+    id: sinkId,
+    type: "js",
+    input,
+    int16: profile.format === "s16",
+  });
+  return nodes;
+}
+
+/**
+ * 把js输出端投递的数据转换为订阅者收到的格式
+ */
+function toProfileData(
+  profile: DeliveryProfile,
+  audioData: AudioData
+): ProfileData {
+  const { buffer, channels, sampleRate, position } = audioData;
+  if (profile.levels) {
+    // 电平输出端的数据为 [peak0..peakN-1, rms0..rmsN-1]
+    return {
+      kind: "levels",
+      peak: Array.from(buffer.subarray(0, channels)),
+      rms: Array.from(buffer.subarray(channels, channels * 2)),
+    };
+  }
+  return { kind: "pcm", buffer, channels, sampleRate, position };
+}
+
+function createCaptureError(message: string, code: string): Error {
+  return Object.assign(new Error(message), { code });
+}
+
 /** 音频捕获实例 */
 let audioCapture: AudioCaptureStub;
 
-if (process.platform === "darwin" || process.platform === "win32") {
+if (
+  process.platform === "darwin" ||
+  process.platform === "win32" ||
+  process.platform === "linux"
+) {
   audioCapture = new AudioCapture();
 } else {
   // 为不支持的平台提供回退方案
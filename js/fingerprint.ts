@@ -0,0 +1,15 @@
+import type { AudioData, Fingerprint } from "./types";
+
+/**
+ * 解码 fingerprint 节点下游 js 输出端投递的数据
+ *
+ * 每条记录占一帧两个通道：[哈希, 锚点时间（秒）]
+ */
+export function readFingerprints(data: AudioData): Fingerprint[] {
+  const { buffer, channels } = data;
+  const result: Fingerprint[] = [];
+  for (let i = 0; i + 1 < buffer.length; i += channels) {
+    result.push({ hash: buffer[i], time: buffer[i + 1] });
+  }
+  return result;
+}
@@ -1,2 +1,5 @@
 export * from "./core";
+export * from "./transport";
+export * from "./recording_index";
+export * from "./fingerprint";
 export * from "./types.d";
@@ -1,7 +1,15 @@
-import { ipcMain } from "electron";
+import { ipcMain, MessageChannelMain } from "electron";
 import { audioCapture } from "./core";
-import type { AudioData } from "./types";
+import type { EventEmitter } from "events";
+import type {
+  AudioCaptureEvents,
+  AudioData,
+  DeliveryProfile,
+  ProfileData,
+  Unsubscribe,
+} from "./types";
 import { AUDIO_CAPTURE_IPC_PREFIX } from "./shared";
+import { AudioDataPortHub, profileKey } from "./transport";
 
 const PREFIX = AUDIO_CAPTURE_IPC_PREFIX;
 
@@ -77,46 +85,112 @@ export const setupAudioCaptureIpc = () => {
 
   listenAudioData();
 
-  listenCapturing();
+  listenAudioDataPort();
+
+  listenEvent("capturing");
+
+  listenEvent("format-changed");
+
+  listenEvent("level-trigger");
+
+  listenEvent("ended");
+
+  listenEvent("graph-error");
 };
 
 const listenAudioData = () => {
   const eventName = "audio-data";
   const listeners = new Map<string, (audioData: AudioData) => void>();
 
+  // 只在有监听器时挂到 audioCapture 上，避免无人接收时仍强制输出原始数据
+  const forward = (audioData: AudioData) => {
+    listeners.forEach((listener) => {
+      listener(audioData);
+    });
+  };
+  const update = () => {
+    audioCapture.off(eventName, forward);
+    if (listeners.size > 0) {
+      audioCapture.on(eventName, forward);
+    }
+  };
+
   ipcMain.on(`${PREFIX}:on-${eventName}`, (event, id) => {
     listeners.set(id, (audioData) => {
       if (!event.sender.isDestroyed()) {
         event.sender.send(`${PREFIX}:on-${eventName}:${id}`, audioData);
       }
     });
+    update();
   });
 
   ipcMain.on(`${PREFIX}:off-${eventName}`, (_event, id) => {
     listeners.delete(id);
+    update();
   });
 
   ipcMain.on(`${PREFIX}:off-all`, (_event, name) => {
     if (name === eventName || !name) {
       listeners.clear();
+      update();
     }
   });
+};
 
-  audioCapture.on(eventName, (audioData) => {
-    listeners.forEach((listener) => {
-      listener(audioData);
-    });
-  });
+/**
+ * 通过消息端口向渲染进程分发音频数据
+ *
+ * 每个渲染进程对每种订阅配置申请一个端口，数据包对每个渲染进程只序列化一次；
+ * 配置相同的端口共用一个分发器和一次原生订阅，最后一个端口关闭时取消订阅
+ */
+const listenAudioDataPort = () => {
+  const hubs = new Map<string, AudioDataPortHub<ProfileData>>();
+
+  ipcMain.on(
+    `${PREFIX}:open-audio-port`,
+    (event, profile: DeliveryProfile = {}) => {
+      const key = profileKey(profile);
+      let hub = hubs.get(key);
+      if (!hub) {
+        let unsubscribe: Unsubscribe | undefined;
+        const created = new AudioDataPortHub<ProfileData>(() => {
+          hubs.delete(key);
+          unsubscribe?.();
+          unsubscribe = undefined;
+        });
+        hubs.set(key, created);
+        unsubscribe = audioCapture.subscribe(profile, (data) =>
+          created.publish(data)
+        );
+        hub = created;
+      }
+
+      const { port1, port2 } = new MessageChannelMain();
+      hub.add(port1);
+      event.sender.postMessage(`${PREFIX}:audio-port`, key, [port2]);
+    }
+  );
 };
 
-const listenCapturing = () => {
-  const eventName = "capturing";
-  const listeners = new Map<string, (capturing: boolean) => void>();
+/**
+ * 把 audioCapture 的事件转发给渲染进程中注册的监听器
+ */
+const listenEvent = <
+  K extends
+    | "capturing"
+    | "format-changed"
+    | "level-trigger"
+    | "ended"
+    | "graph-error"
+>(
+  eventName: K
+) => {
+  const listeners = new Map<string, (...args: AudioCaptureEvents[K]) => void>();
 
   ipcMain.on(`${PREFIX}:on-${eventName}`, (event, id) => {
-    listeners.set(id, (capturing) => {
+    listeners.set(id, (...args) => {
       if (!event.sender.isDestroyed()) {
-        event.sender.send(`${PREFIX}:on-${eventName}:${id}`, capturing);
+        event.sender.send(`${PREFIX}:on-${eventName}:${id}`, ...args);
       }
     });
   });
@@ -131,9 +205,9 @@ const listenCapturing = () => {
     }
   });
 
-  audioCapture.on(eventName, (capturing) => {
+  (audioCapture as unknown as EventEmitter).on(eventName, (...args: unknown[]) => {
     listeners.forEach((listener) => {
-      listener(capturing);
+      listener(...(args as AudioCaptureEvents[K]));
     });
   });
 };
@@ -3,11 +3,45 @@ import type {
   ProcessAudioCaptureApi,
   Unsubscribe,
   AudioCaptureEvents,
+  DeliveryProfile,
+  ProfileData,
 } from "./types";
 import { AUDIO_CAPTURE_IPC_PREFIX } from "./shared";
+import { AudioDataPortReceiver, profileKey } from "./transport";
 
 const PREFIX = AUDIO_CAPTURE_IPC_PREFIX;
 
+/**
+ * 音频数据经由主进程发来的消息端口接收，
+ * 本进程中订阅配置相同的监听器共用一个端口
+ */
+const receivers = new Map<string, AudioDataPortReceiver<ProfileData>>();
+
+const receiverFor = (profile: DeliveryProfile) => {
+  const key = profileKey(profile);
+  let receiver = receivers.get(key);
+  if (!receiver) {
+    receiver = new AudioDataPortReceiver<ProfileData>(() =>
+      ipcRenderer.send(`${PREFIX}:open-audio-port`, profile)
+    );
+    receivers.set(key, receiver);
+  }
+  return receiver;
+};
+
+ipcRenderer.on(`${PREFIX}:audio-port`, (event, key: string) => {
+  const [port] = event.ports;
+  if (!port) {
+    return;
+  }
+  const receiver = receivers.get(key);
+  if (receiver) {
+    receiver.attach(port);
+  } else {
+    port.close();
+  }
+});
+
 /**
  * 定义暴露给渲染进程的API
  *
@@ -30,6 +64,13 @@ export const processAudioCapture: ProcessAudioCaptureApi = {
     eventName: K,
     callback: (...args: AudioCaptureEvents[K]) => void
   ): Unsubscribe => {
+    if (eventName === "audio-data") {
+      // 原始数据就是空配置的订阅，数据包只比 AudioData 多一个 kind 字段
+      return receiverFor({}).subscribe(
+        callback as unknown as (data: ProfileData) => void
+      );
+    }
+
     const id = uuid();
     const listener = (
       _event: Electron.IpcRendererEvent,
@@ -44,8 +85,15 @@ export const processAudioCapture: ProcessAudioCaptureApi = {
     };
   },
   off: <K extends keyof AudioCaptureEvents>(eventName?: K) => {
+    if (eventName === "audio-data" || !eventName) {
+      receiverFor({}).close();
+    }
+    if (!eventName) {
+      receivers.forEach((receiver) => receiver.close());
+    }
     ipcRenderer.send(`${PREFIX}:off-all`, eventName);
   },
+  subscribe: (profile, callback) => receiverFor(profile).subscribe(callback),
 };
 
 /**
@@ -0,0 +1,219 @@
+import type { RecordingSpan } from "./types";
+
+/** 响度最大的窗口及其平均响度（dBFS） */
+export type LoudestWindow = RecordingSpan & { rmsDb: number };
+
+/** 索引文件头部的字节数 */
+const HEADER_BYTES = 48;
+/** 每个索引块的字节数：偏移(u64) + RMS(f32) + 峰值(f32) */
+const BLOCK_BYTES = 16;
+/** 每个活动区间的字节数：起始帧(u64) + 结束帧(u64) */
+const SPAN_BYTES = 16;
+
+/**
+ * 录音查找索引（wav 输出端 `index: true` 时写出的 `.idx` 文件）
+ *
+ * 只读取索引，不访问PCM数据：
+ * - nextActive 在活动区间上二分查找，O(log n)
+ * - loudness 使用每秒能量的前缀和，任意区间 O(1)
+ * - loudestWindow 对每种窗口长度扫描一次后缓存结果
+ *
+ * 不依赖 Node.js 模块，渲染进程中也可以使用：
+ * `RecordingIndex.parse(fs.readFileSync(path + ".idx"))`
+ */
+export class RecordingIndex {
+  readonly sampleRate: number;
+  readonly channels: number;
+  /** 每帧的字节数 */
+  readonly blockAlign: number;
+  /** PCM数据在录音文件中的起始偏移 */
+  readonly dataOffset: number;
+  /** 静音阈值（dBFS） */
+  readonly silenceDb: number;
+  /** 录音时长（秒） */
+  readonly duration: number;
+
+  /** 每个索引块（默认1秒）的时长 */
+  private readonly blockSeconds: number;
+  private readonly offsets: number[];
+  private readonly rmsDb: Float32Array;
+  private readonly peakDb: Float32Array;
+  /** 活动区间的起止时间（秒），按时间排序 */
+  private readonly starts: Float64Array;
+  private readonly ends: Float64Array;
+  /** 各索引块能量（均方值 × 时长）的前缀和 */
+  private readonly energy: Float64Array;
+  private readonly loudest = new Map<number, LoudestWindow>();
+
+  private constructor(view: DataView) {
+    const magic = String.fromCharCode(
+      view.getUint8(0),
+      view.getUint8(1),
+      view.getUint8(2),
+      view.getUint8(3)
+    );
+    if (magic !== "PAIX" || view.getUint32(4, true) !== 1) {
+      throw new Error("不支持的录音索引格式");
+    }
+
+    this.sampleRate = view.getUint32(8, true);
+    this.channels = view.getUint32(12, true);
+    this.blockAlign = view.getUint32(16, true);
+    this.dataOffset = view.getUint32(20, true);
+    const blockFrames = view.getUint32(24, true);
+    this.silenceDb = view.getFloat32(28, true);
+    const blockCount = view.getUint32(32, true);
+    const spanCount = view.getUint32(36, true);
+    const totalFrames = Number(view.getBigUint64(40, true));
+    const expectedBytes =
+      HEADER_BYTES + blockCount * BLOCK_BYTES + spanCount * SPAN_BYTES;
+    if (this.sampleRate === 0 || view.byteLength < expectedBytes) {
+      throw new Error("录音索引文件不完整");
+    }
+
+    this.blockSeconds = blockFrames / this.sampleRate;
+    this.duration = totalFrames / this.sampleRate;
+
+    this.offsets = new Array(blockCount);
+    this.rmsDb = new Float32Array(blockCount);
+    this.peakDb = new Float32Array(blockCount);
+    this.energy = new Float64Array(blockCount + 1);
+    for (let i = 0; i < blockCount; i++) {
+      const at = HEADER_BYTES + i * BLOCK_BYTES;
+      this.offsets[i] = Number(view.getBigUint64(at, true));
+      this.rmsDb[i] = view.getFloat32(at + 8, true);
+      this.peakDb[i] = view.getFloat32(at + 12, true);
+      // 最后一块可能不足一个完整的块
+      const seconds = Math.min(
+        this.blockSeconds,
+        this.duration - i * this.blockSeconds
+      );
+      this.energy[i + 1] =
+        this.energy[i] + Math.pow(10, this.rmsDb[i] / 10) * seconds;
+    }
+
+    this.starts = new Float64Array(spanCount);
+    this.ends = new Float64Array(spanCount);
+    const spansAt = HEADER_BYTES + blockCount * BLOCK_BYTES;
+    for (let i = 0; i < spanCount; i++) {
+      const at = spansAt + i * SPAN_BYTES;
+      this.starts[i] = Number(view.getBigUint64(at, true)) / this.sampleRate;
+      this.ends[i] = Number(view.getBigUint64(at + 8, true)) / this.sampleRate;
+    }
+  }
+
+  /**
+   * 解析索引文件的内容
+   */
+  static parse(data: ArrayBuffer | ArrayBufferView): RecordingIndex {
+    const view = ArrayBuffer.isView(data)
+      ? new DataView(data.buffer, data.byteOffset, data.byteLength)
+      : new DataView(data);
+    return new RecordingIndex(view);
+  }
+
+  /** 所有活动（非静音）区间 */
+  get activeSpans(): RecordingSpan[] {
+    return Array.from(this.starts, (start, i) => ({ start, end: this.ends[i] }));
+  }
+
+  /**
+   * 时间 t（秒）之后的下一段非静音区间，t 落在区间内时从 t 开始；没有时返回 null
+   */
+  nextActive(t: number): RecordingSpan | null {
+    // 第一个结束时间晚于 t 的区间
+    let low = 0;
+    let high = this.ends.length;
+    while (low < high) {
+      const mid = (low + high) >>> 1;
+      if (this.ends[mid] <= t) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    if (low === this.ends.length) {
+      return null;
+    }
+    return { start: Math.max(this.starts[low], t), end: this.ends[low] };
+  }
+
+  /**
+   * 时间 t（秒）处的PCM字节偏移，按帧对齐
+   */
+  byteOffset(t: number): number {
+    const clamped = Math.max(0, Math.min(t, this.duration));
+    const block = Math.min(
+      Math.floor(clamped / this.blockSeconds),
+      this.offsets.length - 1
+    );
+    if (block < 0) {
+      return this.dataOffset;
+    }
+    const frames = Math.round(
+      (clamped - block * this.blockSeconds) * this.sampleRate
+    );
+    return this.offsets[block] + frames * this.blockAlign;
+  }
+
+  /**
+   * [from, to) 区间的RMS响度（dBFS），按索引块的粒度计算
+   */
+  loudness(from: number, to: number): number {
+    const first = Math.max(0, Math.floor(from / this.blockSeconds));
+    const last = Math.min(this.rmsDb.length, Math.ceil(to / this.blockSeconds));
+    if (last <= first) {
+      return -Infinity;
+    }
+    const seconds =
+      Math.min(last * this.blockSeconds, this.duration) -
+      first * this.blockSeconds;
+    const mean = (this.energy[last] - this.energy[first]) / seconds;
+    return mean > 0 ? 10 * Math.log10(mean) : -Infinity;
+  }
+
+  /**
+   * 平均响度最大的连续窗口（默认1分钟），录音短于窗口时返回整段录音
+   */
+  loudestWindow(seconds = 60): LoudestWindow | null {
+    const cached = this.loudest.get(seconds);
+    if (cached) {
+      return cached;
+    }
+
+    const count = this.rmsDb.length;
+    if (count === 0) {
+      return null;
+    }
+    const width = Math.max(
+      1,
+      Math.min(count, Math.round(seconds / this.blockSeconds))
+    );
+    let best = 0;
+    for (let i = 1; i + width <= count; i++) {
+      if (
+        this.energy[i + width] - this.energy[i] >
+        this.energy[best + width] - this.energy[best]
+      ) {
+        best = i;
+      }
+    }
+
+    const start = best * this.blockSeconds;
+    const end = Math.min((best + width) * this.blockSeconds, this.duration);
+    const result = { start, end, rmsDb: this.loudness(start, end) };
+    this.loudest.set(seconds, result);
+    return result;
+  }
+
+  /**
+   * 每个索引块的响度：{ time, rmsDb, peakDb }
+   */
+  levels(): Array<{ time: number; rmsDb: number; peakDb: number }> {
+    return Array.from(this.rmsDb, (rmsDb, i) => ({
+      time: i * this.blockSeconds,
+      rmsDb,
+      peakDb: this.peakDb[i],
+    }));
+  }
+}
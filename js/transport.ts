@@ -0,0 +1,194 @@
+import type { AudioData, DeliveryProfile, Unsubscribe } from "./types";
+
+/**
+ * 传递音频数据的消息端口
+ *
+ * Electron 的 MessagePortMain、浏览器的 MessagePort 和 Node.js
+ * worker_threads 的 MessagePort 都满足这个接口，测试时也可以传入模拟端口
+ */
+export interface AudioDataPort {
+  postMessage(message: unknown, transfer?: any[]): void;
+  close(): void;
+  start?(): void;
+  /** MessagePortMain / worker_threads 风格的事件接口 */
+  on?(event: string, listener: (...args: any[]) => void): unknown;
+  /** DOM 风格的事件接口 */
+  addEventListener?(event: string, listener: (event: any) => void): unknown;
+}
+
+/**
+ * 订阅配置的规范化键，配置相同的订阅共用一个键
+ */
+export function profileKey(profile: DeliveryProfile): string {
+  if (profile.levels) {
+    return `levels=${profile.levels}`;
+  }
+  const parts: string[] = [];
+  if (profile.sampleRate) parts.push(`rate=${profile.sampleRate}`);
+  if (profile.channels) parts.push(`ch=${profile.channels}`);
+  if (profile.chunkFrames) parts.push(`chunk=${profile.chunkFrames}`);
+  if (profile.format === "s16") parts.push("s16");
+  return parts.length > 0 ? `pcm:${parts.join(",")}` : "pcm";
+}
+
+/**
+ * 监听端口的消息和关闭事件，兼容两种事件接口
+ */
+const listenPort = (
+  port: AudioDataPort,
+  onMessage: (data: unknown) => void,
+  onClose: () => void
+) => {
+  if (typeof port.on === "function") {
+    // MessagePortMain 的事件参数是 { data, ports }，worker_threads 直接是数据
+    port.on("message", (event: any) =>
+      onMessage(event && "data" in event && "ports" in event ? event.data : event)
+    );
+    port.on("close", onClose);
+  } else if (typeof port.addEventListener === "function") {
+    port.addEventListener("message", (event: any) => onMessage(event.data));
+    port.addEventListener("close", onClose);
+  }
+};
+
+/**
+ * 主进程侧：把音频数据通过消息端口分发给各渲染进程
+ *
+ * 每个渲染进程只持有一个端口，无论它注册了多少个监听器，
+ * 每个数据包对每个渲染进程只序列化一次；监听器在渲染进程内部分发
+ */
+export class AudioDataPortHub<T = AudioData> {
+  private ports = new Set<AudioDataPort>();
+
+  /**
+   * @param onEmpty 最后一个端口移除时调用
+   */
+  constructor(private readonly onEmpty?: () => void) {}
+
+  /**
+   * 添加一个端口，端口关闭时自动移除
+   * @returns 移除并关闭该端口的函数
+   */
+  add(port: AudioDataPort): Unsubscribe {
+    this.ports.add(port);
+    listenPort(port, () => {}, () => this.remove(port));
+    port.start?.();
+
+    return () => {
+      if (this.remove(port)) {
+        port.close();
+      }
+    };
+  }
+
+  /**
+   * 把一个数据包发送给所有端口
+   *
+   * 主进程中的其他监听器也会读取同一个 Float32Array，因此这里不转移
+   * ArrayBuffer 的所有权，由端口按结构化克隆复制到目标进程
+   */
+  publish(audioData: T) {
+    this.ports.forEach((port) => {
+      try {
+        port.postMessage(audioData);
+      } catch {
+        // 目标进程已销毁，移除失效的端口
+        this.remove(port);
+      }
+    });
+  }
+
+  /** 当前连接的端口数 */
+  get size(): number {
+    return this.ports.size;
+  }
+
+  /** 关闭并移除所有端口 */
+  clear() {
+    this.ports.forEach((port) => port.close());
+    this.ports.clear();
+    this.onEmpty?.();
+  }
+
+  private remove(port: AudioDataPort): boolean {
+    const removed = this.ports.delete(port);
+    if (removed && this.ports.size === 0) {
+      this.onEmpty?.();
+    }
+    return removed;
+  }
+}
+
+/**
+ * 渲染进程侧：从消息端口接收音频数据并分发给本地监听器
+ *
+ * 第一个监听器注册时通过 requestPort 向主进程申请端口，
+ * 最后一个监听器取消时关闭端口，主进程随之停止向该进程发送数据
+ */
+export class AudioDataPortReceiver<T = AudioData> {
+  private listeners = new Set<(audioData: T) => void>();
+  private port: AudioDataPort | undefined;
+  private requested = false;
+
+  /**
+   * @param requestPort 向主进程申请端口，端口到达后调用 attach
+   */
+  constructor(private readonly requestPort: () => void) {}
+
+  /**
+   * 接入主进程发来的端口
+   */
+  attach(port: AudioDataPort) {
+    this.requested = false;
+    this.port?.close();
+
+    // 所有监听器都已取消，不再需要这个端口
+    if (this.listeners.size === 0) {
+      port.close();
+      this.port = undefined;
+      return;
+    }
+
+    this.port = port;
+    listenPort(
+      port,
+      (data) => this.dispatch(data as T),
+      () => {
+        if (this.port === port) {
+          this.port = undefined;
+        }
+      }
+    );
+    port.start?.();
+  }
+
+  /**
+   * 注册监听器
+   * @returns 取消此次注册的函数
+   */
+  subscribe(listener: (audioData: T) => void): Unsubscribe {
+    this.listeners.add(listener);
+    if (!this.port && !this.requested) {
+      this.requested = true;
+      this.requestPort();
+    }
+
+    return () => {
+      this.listeners.delete(listener);
+      if (this.listeners.size === 0) {
+        this.close();
+      }
+    };
+  }
+
+  /** 取消所有监听器并关闭端口 */
+  close() {
+    this.listeners.clear();
+    this.port?.close();
+    this.port = undefined;
+  }
+
+  private dispatch(audioData: T) {
+    this.listeners.forEach((listener) => listener(audioData));
+  }
+}
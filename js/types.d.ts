@@ -30,6 +30,101 @@ export interface AudioData {
   channels: number;
   /** 采样率（Hz） */
   sampleRate: number;
+  /**
+   * 第一帧在会话中的位置（帧），切换捕获目标后继续递增；
+   * 来自处理图js输出端时为该输出端的位置（按输出端的采样率计）
+   */
+  position: number;
+  /** 处理图js输出端的节点ID，未设置处理图时不存在 */
+  sink?: string;
+}
+
+/**
+ * 捕获格式变化
+ *
+ * 在第一个新格式的数据包之前触发，之后的 audio-data 都是新格式
+ */
+export interface FormatChange {
+  channels: number;
+  sampleRate: number;
+  previousChannels: number;
+  previousSampleRate: number;
+  /** 第一个新格式数据帧在会话中的位置（帧） */
+  position: number;
+}
+
+/**
+ * 电平触发的配置
+ *
+ * 启用后空闲时数据只写入原生侧的预录缓冲区，JS收不到任何回调；某个数据包的
+ * RMS 超过 thresholdDb 时先投递之前 preRollMs 的数据，再持续投递，直到电平
+ * 连续 holdMs 低于阈值。处理图（包括 wav 录音）同样只收到触发期间的数据
+ */
+export interface LevelTriggerOptions {
+  /** 触发阈值（dBFS，默认 -50） */
+  thresholdDb?: number;
+  /** 触发时一并投递的之前的音频时长（毫秒，默认 2000，最大 30000） */
+  preRollMs?: number;
+  /** 电平低于阈值持续多久后停止投递（毫秒，默认 3000） */
+  holdMs?: number;
+}
+
+/**
+ * 电平触发的状态变化
+ */
+export interface LevelTriggerChange {
+  /** 是否开始投递 */
+  active: boolean;
+  /** 开始时为预录数据第一帧的位置，停止时为第一个未投递帧的位置（帧） */
+  position: number;
+  /** 触发或停止时数据包的RMS（dBFS） */
+  level: number;
+}
+
+/**
+ * 捕获目标结束的原因
+ * - process-exited: 目标进程退出
+ * - stream-removed: 目标的音频流或捕获设备被移除
+ * - stream-error: 音频流出错，无法继续捕获
+ */
+export type CaptureEndReason =
+  | "process-exited"
+  | "stream-removed"
+  | "stream-error";
+
+/**
+ * 捕获目标结束的通知
+ */
+export interface CaptureEnded {
+  /** 结束的捕获目标（与开始捕获时传入的进程ID相同） */
+  pid: number;
+  /** 结束原因 */
+  reason: CaptureEndReason;
+}
+
+/**
+ * 处理图节点运行中的错误
+ */
+export interface GraphError {
+  /** 出错的节点ID */
+  node: string;
+  /** 错误描述 */
+  message: string;
+}
+
+/**
+ * 空闲挂起的配置
+ *
+ * 启用后，连续 silenceMs 收到数字静音（全零样本）时后端停止音频流，改为
+ * 低开销的空闲监视：Linux上暂停PipeWire流并监听目标节点状态，目标重新开始
+ * 播放时立即恢复；每隔 probeIntervalMs 也会恢复一次检查是否有声音。
+ * 只对平台捕获的 Linux、Windows 后端生效
+ */
+export interface IdleSuspendOptions {
+  /** 连续静音多久后挂起（毫秒，默认 30000，最小 1000） */
+  silenceMs?: number;
+  /** 挂起期间多久恢复一次检查是否有声音（毫秒，默认 2000，100~600000） */
+  probeIntervalMs?: number;
 }
 
 /**
@@ -39,6 +134,388 @@ export interface PermissionStatus {
   status: "authorized" | "denied" | "unknown";
 }
 
+/**
+ * replay 音频源的配置
+ */
+export interface ReplayOptions {
+  /** stopCadenceRecording 写出的回调节奏文件 */
+  trace: string;
+  /**
+   * 回放的音频内容（16位整数或32位浮点WAV，循环读取），默认为正弦波。
+   * 通道数不同时按通道序号取模，采样率不同时不做转换
+   */
+  audio?: string;
+  /** 回放完所有数据包后是否从头重复（默认 true） */
+  loop?: boolean;
+}
+
+/**
+ * 投递给JS的自适应合并配置
+ *
+ * 同一输出端连续的数据包在原生侧拼接成一次回调，每批的音频时长在
+ * [minLatencyMs, maxLatencyMs] 之间按事件循环的负载调整：回调排队或执行
+ * 耗时偏大时加倍，空闲时逐步缩短。chunk 节点之后的输出端不参与合并
+ */
+export interface DeliveryBatchingOptions {
+  /** 批时长下限（毫秒，默认 0：空闲时每个数据包单独投递） */
+  minLatencyMs?: number;
+  /** 批时长上限（毫秒，默认 100，最大 1000） */
+  maxLatencyMs?: number;
+}
+
+/**
+ * 音频捕获实例配置
+ */
+export interface AudioCaptureOptions {
+  /**
+   * 音频源
+   * - platform: 系统音频API（默认）
+   * - synthetic: 合成正弦波，不依赖系统音频服务，用于基准测试
+   * - replay: 按录制的回调节奏（到达时间、帧数、格式）回放，用于在任意平台上
+   *   以真实的到达模式做基准测试
+   */
+  source?: "platform" | "synthetic" | "replay";
+  /** source 为 replay 时必需 */
+  replay?: ReplayOptions;
+}
+
+/**
+ * 捕获会话配置
+ */
+export interface CaptureOptions {
+  /** 准备阶段等待系统异步激活音频客户端的超时时间（毫秒，默认 10000） */
+  activationTimeoutMs?: number;
+  /**
+   * 捕获周期，在延迟和唤醒次数之间取舍
+   * - interactive: 约5ms
+   * - balanced: 后端默认值（默认）
+   * - powersave: 约100ms，适合批量录制
+   * - 数字: 按48kHz计的帧数（16 ~ 48000）
+   *
+   * 后端尽量接近，实际周期见 CaptureStats.periodMs
+   */
+  latencyHint?: "interactive" | "balanced" | "powersave" | number;
+  /**
+   * 按音频源自身的采样率和声道布局捕获（默认 false：48kHz 立体声）
+   *
+   * 系统不再下混或重采样；需要其他格式时用处理图或 subscribe 的配置转换，
+   * 声道位置见 getChannelLayout()
+   */
+  nativeFormat?: boolean;
+}
+
+/**
+ * 异步启动捕获的配置
+ */
+export interface StartCaptureAsyncOptions extends CaptureOptions {
+  /** 用于取消启动的信号 */
+  signal?: AbortSignal;
+  /** 整个启动过程的超时时间（毫秒），超时后取消启动 */
+  timeoutMs?: number;
+}
+
+/**
+ * 切换捕获目标的配置
+ */
+export interface SwitchTargetOptions extends CaptureOptions {
+  /** 新旧音频源的交叉淡化时长（毫秒，默认 0，即在包边界直接切换） */
+  crossfadeMs?: number;
+}
+
+/**
+ * 混音源配置
+ */
+export interface MixSource {
+  /** 目标进程ID */
+  pid: number;
+  /** 线性增益（默认 1） */
+  gain?: number;
+  /** 是否静音 */
+  muted?: boolean;
+}
+
+/**
+ * 会议捕获配置
+ */
+export interface MeetingCaptureOptions {
+  /**
+   * 输入设备标识，默认使用系统默认输入设备
+   * - Linux: PipeWire 节点名或序号（可以是 null source）
+   * - Windows: 音频端点ID
+   * - macOS: 设备UID
+   */
+  device?: string;
+  /**
+   * - mix（默认）: 进程音频和麦克风混成一路立体声
+   * - stems: 4声道，前两个声道为进程音频，后两个为麦克风
+   */
+  output?: "mix" | "stems";
+}
+
+/**
+ * 混音源状态
+ */
+export interface MixSourceStatus {
+  pid: number;
+  gain: number;
+  muted: boolean;
+  /**
+   * - waiting: 尚未启动（目标进程没有音频输出时会定期重试）
+   * - priming: 正在缓冲到目标延迟
+   * - running: 正在参与混音
+   */
+  state: "waiting" | "priming" | "running";
+  /** 缓冲区欠载次数 */
+  underruns: number;
+  /** 当前的时钟漂移校正量（ppm） */
+  driftPpm: number;
+}
+
+/**
+ * 处理图节点声明
+ *
+ * 节点通过 `input` 连成以捕获源为根的有向无环图，配置相同（类型、参数、上游）
+ * 的节点只会实例化一次，因此多个分支可以共享同一个处理阶段
+ */
+export type GraphNodeSpec = {
+  /** 节点ID，不能为 "source" */
+  id: string;
+  /** 上游节点ID（默认 "source"，即捕获源） */
+  input?: string;
+  /** 该节点及其下游在进程级DSP线程池中执行，不占用捕获线程 */
+  offThread?: boolean;
+} & (
+  /** 线性插值重采样 */
+  | { type: "resample"; sampleRate: number }
+  /** 改变通道数（下混取平均，上混复制） */
+  | { type: "remix"; channels: number }
+  /** 线性增益 */
+  | { type: "gain"; gain: number }
+  /**
+   * 谱减法降噪：按10ms帧估计并减去稳态背景噪声，最多衰减 reduction dB（默认 20），
+   * 输出延迟20ms。开销见 CaptureStats.denoiseCpuMs，建议配合 offThread 使用
+   */
+  | { type: "denoise"; reduction?: number }
+  /** 峰值/RMS电平表，读数通过 getGraphMeters 获取 */
+  | { type: "meter" }
+  /** 重新分块为固定帧数 */
+  | { type: "chunk"; frames: number }
+  /** 按 rate Hz 输出各通道的峰值和RMS，不输出PCM（默认 30） */
+  | { type: "levels"; rate?: number }
+  /**
+   * 提取音频指纹（总是在DSP线程池中执行），按 rate Hz（默认 4）输出累积的记录，
+   * 不输出PCM；下游 js 输出端收到的数据用 readFingerprints 解码
+   */
+  | { type: "fingerprint"; rate?: number }
+  /** 投递到 `audio-data` 事件，AudioData.sink 为节点ID；int16 时为16位整数 */
+  | { type: "js"; int16?: boolean }
+  /**
+   * 写入32位浮点WAV文件（总是在DSP线程池中执行）
+   *
+   * index 为 true 时在录音结束后写出 `${path}.idx` 查找索引，用 RecordingIndex 读取。
+   * 均方根低于 silenceDb（默认 -50 dBFS）的部分视为静音，
+   * 短于 minSilenceMs（默认 500）的静音不切分活动区间
+   */
+  | {
+      type: "wav";
+      path: string;
+      index?: boolean;
+      silenceDb?: number;
+      minSilenceMs?: number;
+    }
+);
+
+/**
+ * 录音中的一段区间（秒）
+ */
+export interface RecordingSpan {
+  start: number;
+  end: number;
+}
+
+/**
+ * 音频指纹记录：锚点峰值与其后一个峰值组成的哈希
+ */
+export interface Fingerprint {
+  /** 20位哈希：锚点频点(8位) | 频点差+64(7位) | 帧间隔(5位) */
+  hash: number;
+  /** 锚点在捕获流中的时间（秒），两段音频的匹配哈希时间差一致时即为同一内容 */
+  time: number;
+}
+
+/**
+ * 处理图声明：节点数组、{ nodes } 或对应的JSON字符串
+ */
+export type ProcessingGraphSpec =
+  | GraphNodeSpec[]
+  | { nodes: GraphNodeSpec[] }
+  | string;
+
+/**
+ * 处理图电平表读数
+ */
+export interface GraphMeterReading {
+  id: string;
+  /** 最近一块数据的峰值 */
+  peak: number;
+  /** 最近一块数据的RMS */
+  rms: number;
+}
+
+/**
+ * 订阅配置：声明订阅者需要的数据形式
+ *
+ * 配置相同的订阅者共用一份原生计算结果，不同配置之间共享相同的处理阶段
+ * （例如同为16kHz的两个配置只重采样一次）
+ */
+export interface DeliveryProfile {
+  /** 采样率（Hz，默认为源采样率） */
+  sampleRate?: number;
+  /** 通道数（默认为源通道数） */
+  channels?: number;
+  /** 每次投递的帧数（默认按源数据包投递） */
+  chunkFrames?: number;
+  /** 样本格式（默认 f32） */
+  format?: "f32" | "s16";
+  /** 只接收电平分析结果（每秒 levels 次），不接收PCM；设置后忽略其他选项 */
+  levels?: number;
+}
+
+/**
+ * 按订阅配置计算的PCM数据
+ */
+export interface ProfileAudioData {
+  kind: "pcm";
+  /** format 为 s16 时是 Int16Array */
+  buffer: Float32Array | Int16Array;
+  channels: number;
+  sampleRate: number;
+  /** 第一帧在该配置输出中的位置（帧） */
+  position: number;
+}
+
+/**
+ * 电平分析结果
+ */
+export interface AudioLevels {
+  kind: "levels";
+  /** 各通道的峰值 */
+  peak: number[];
+  /** 各通道的RMS */
+  rms: number[];
+}
+
+/**
+ * 订阅者收到的数据
+ */
+export type ProfileData = ProfileAudioData | AudioLevels;
+
+/**
+ * 进程级DSP线程池统计（所有会话共享）
+ */
+export interface DspPoolStats {
+  /** 工作线程数（等于CPU核数） */
+  workers: number;
+  /** 已执行的任务数 */
+  jobs: number;
+  /** 空闲工作线程从其他线程队列窃取任务的次数 */
+  steals: number;
+  /** 当前排队等待执行的任务数 */
+  queueDepth: number;
+  /** 排队任务数的历史最大值 */
+  maxQueueDepth: number;
+  /** 会话队列满而丢弃的任务数 */
+  dropped: number;
+}
+
+/**
+ * 已启动的捕获会话
+ */
+export interface CaptureSession {
+  /** 进程内唯一的会话ID */
+  sessionId: number;
+  /** 目标进程ID */
+  pid: number;
+}
+
+/**
+ * 延迟百分位统计（毫秒）
+ */
+export interface LatencyPercentiles {
+  p50: number;
+  p90: number;
+  p99: number;
+  max: number;
+}
+
+/**
+ * 捕获会话统计
+ */
+export interface CaptureStats {
+  /** 后端回调次数 */
+  packets: number;
+  /** 收到的音频帧数 */
+  frames: number;
+  /** 已交付给JS的回调次数 */
+  delivered: number;
+  /** 被丢弃的数据包数 */
+  dropped: number;
+  /** 从后端回调到JS回调开始执行的延迟 */
+  callbackLatency: LatencyPercentiles;
+  /** 从调用startCapture到收到第一个数据包的耗时（毫秒），尚未收到时为 -1 */
+  firstFrameLatency: number;
+  /** 处理图在DSP线程池中的队列满而丢弃的数据块数 */
+  graphDropped: number;
+  /** 处理图中 denoise 节点的累计处理耗时（毫秒） */
+  denoiseCpuMs: number;
+  /** denoise 节点处理的音频时长（毫秒），denoiseCpuMs / denoiseAudioMs 即该路流的CPU占用 */
+  denoiseAudioMs: number;
+  /** 电平触发是否正在投递（未启用时总是 true） */
+  triggerActive: boolean;
+  /** 自适应合并当前的批时长（毫秒），未启用时为 0 */
+  batchMs: number;
+  /** 后端当前是否因长时间静音而挂起 */
+  idle: boolean;
+  /** 进入空闲监视的次数 */
+  idleSuspensions: number;
+  /** 因探测间隔到达而恢复的次数 */
+  idleProbes: number;
+  /** 空闲期间捕获线程被唤醒的次数 */
+  idleWakeups: number;
+  /** 空闲期间各次唤醒消耗的CPU时间（毫秒） */
+  idleCpuMs: number;
+  /** 处于空闲监视的总时长（毫秒） */
+  idleMs: number;
+  /** 捕获过程中格式变化的次数 */
+  formatChanges: number;
+  /** 实际的捕获周期：最近一个数据包的帧数 */
+  periodFrames: number;
+  /** 实际的捕获周期（毫秒） */
+  periodMs: number;
+}
+
+/**
+ * 进程级指标的抓取配置（socket 和 port 只能指定一个，都不指定时只记录）
+ */
+export interface MetricsOptions {
+  /** 在该路径的Unix socket上以HTTP应答抓取（macOS/Linux） */
+  socket?: string;
+  /** 在 127.0.0.1 的该端口上以HTTP应答抓取 */
+  port?: number;
+}
+
+/**
+ * 音频线程实时作用域内的违规统计
+ */
+export interface RealtimeViolation {
+  /** 违规类型 */
+  kind: "allocation" | "free" | "mutex-wait" | "blocking";
+  /** 调用位置（符号+偏移） */
+  location: string;
+  /** 发生次数 */
+  count: number;
+}
+
 /**
  * 取消订阅
  */
@@ -53,6 +530,21 @@ export interface AudioCaptureEvents {
 
   /** 音频数据 */
   "audio-data": [audioData: AudioData];
+
+  /** 捕获格式（采样率或通道数）变化 */
+  "format-changed": [change: FormatChange];
+
+  /** 电平触发开始或停止投递，在对应的数据之前触发 */
+  "level-trigger": [change: LevelTriggerChange];
+
+  /**
+   * 捕获目标退出或音频流被移除，捕获已经停止（在 capturing 变为 false 之后触发）。
+   * 之前的数据都已投递
+   */
+  ended: [ended: CaptureEnded];
+
+  /** 处理图节点运行中出错（例如 wav 输出端达到4GiB上限后停止写入） */
+  "graph-error": [error: GraphError];
 }
 
 /**
@@ -74,6 +566,15 @@ export interface ProcessAudioCaptureApi {
   /** 开始捕获指定进程的音频 */
   startCapture: (pid: number) => Promise<boolean>;
 
+  /**
+   * 按配置订阅音频数据（例如16kHz单声道、30Hz电平），
+   * 配置相同的订阅者在主进程中共用一份计算结果
+   */
+  subscribe: (
+    profile: DeliveryProfile,
+    callback: (data: ProfileData) => void
+  ) => Unsubscribe;
+
   /** 停止捕获 */
   stopCapture: () => Promise<boolean>;
 
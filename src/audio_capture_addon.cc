@@ -1,12 +1,33 @@
 #include "../include/audio_capture.h"
+#include "../include/audio_mixer.h"
+#include "../include/audio_sink.h"
+#include "../include/cadence_trace.h"
+#include "../include/capture_stats.h"
+#include "../include/delivery_batcher.h"
+#include "../include/dsp_pool.h"
+#include "../include/idle_suspend.h"
+#include "../include/level_trigger.h"
+#include "../include/metrics.h"
 #include "../include/permission_manager.h"
 #include "../include/process_manager.h"
+#include "../include/processing_graph.h"
+#include "../include/replay_audio_capture.h"
+#include "../include/rt_check.h"
+#include "../include/synthetic_audio_capture.h"
+#include "../include/target_switcher.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <memory>
 #include <napi.h>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 /**
@@ -17,12 +38,6 @@
  * 使用 Node-API (N-API) 实现跨 Node.js 版本的稳定性。
  */
 
-// 创建平台特定的实现
-std::unique_ptr<audio_capture::AudioCapture> g_audio_capture;
-
-// PCM数据回调函数的JavaScript引用
-Napi::ThreadSafeFunction g_ts_callback;
-
 // 权限状态回调函数的JavaScript引用
 Napi::ThreadSafeFunction g_ts_permission_callback;
 
@@ -41,9 +56,55 @@ public:
                            &AudioCaptureAddon::RequestPermission),
             InstanceMethod("getProcessList",
                            &AudioCaptureAddon::GetProcessList),
+            InstanceMethod("prepareCapture",
+                           &AudioCaptureAddon::PrepareCapture),
             InstanceMethod("startCapture", &AudioCaptureAddon::StartCapture),
+            InstanceMethod("startCaptureAsync",
+                           &AudioCaptureAddon::StartCaptureAsync),
+            InstanceMethod("cancelStart", &AudioCaptureAddon::CancelStart),
+            InstanceMethod("switchTarget", &AudioCaptureAddon::SwitchTarget),
+            InstanceMethod("getSessionId", &AudioCaptureAddon::GetSessionId),
+            InstanceMethod("startMixCapture",
+                           &AudioCaptureAddon::StartMixCapture),
+            InstanceMethod("startMeetingCapture",
+                           &AudioCaptureAddon::StartMeetingCapture),
+            InstanceMethod("addMixSource", &AudioCaptureAddon::AddMixSource),
+            InstanceMethod("removeMixSource",
+                           &AudioCaptureAddon::RemoveMixSource),
+            InstanceMethod("setMixSourceGain",
+                           &AudioCaptureAddon::SetMixSourceGain),
+            InstanceMethod("setMixSourceMuted",
+                           &AudioCaptureAddon::SetMixSourceMuted),
+            InstanceMethod("getMixSources", &AudioCaptureAddon::GetMixSources),
+            InstanceMethod("setProcessingGraph",
+                           &AudioCaptureAddon::SetProcessingGraph),
+            InstanceMethod("setDeliveryBatching",
+                           &AudioCaptureAddon::SetDeliveryBatching),
+            InstanceMethod("setLevelTrigger",
+                           &AudioCaptureAddon::SetLevelTrigger),
+            InstanceMethod("setIdleSuspend",
+                           &AudioCaptureAddon::SetIdleSuspend),
+            InstanceMethod("getGraphMeters",
+                           &AudioCaptureAddon::GetGraphMeters),
+            InstanceMethod("getDspPoolStats",
+                           &AudioCaptureAddon::GetDspPoolStats),
+            InstanceMethod("getChannelLayout",
+                           &AudioCaptureAddon::GetChannelLayout),
             InstanceMethod("stopCapture", &AudioCaptureAddon::StopCapture),
             InstanceMethod("isCapturing", &AudioCaptureAddon::IsCapturing),
+            InstanceMethod("getStats", &AudioCaptureAddon::GetStats),
+            InstanceMethod("startTracing", &AudioCaptureAddon::StartTracing),
+            InstanceMethod("stopTracing", &AudioCaptureAddon::StopTracing),
+            InstanceMethod("getRealtimeViolations",
+                           &AudioCaptureAddon::GetRealtimeViolations),
+            InstanceMethod("startMetrics", &AudioCaptureAddon::StartMetrics),
+            InstanceMethod("stopMetrics", &AudioCaptureAddon::StopMetrics),
+            InstanceMethod("getMetricsText",
+                           &AudioCaptureAddon::GetMetricsText),
+            InstanceMethod("startCadenceRecording",
+                           &AudioCaptureAddon::StartCadenceRecording),
+            InstanceMethod("stopCadenceRecording",
+                           &AudioCaptureAddon::StopCadenceRecording),
         });
 
     // 创建构造函数的持久引用
@@ -57,15 +118,529 @@ public:
   }
 
   // 构造函数
+  // 可选参数 { source: "platform" | "synthetic" | "replay", replay? }，
+  // 每个实例是一个独立的捕获会话
   AudioCaptureAddon(const Napi::CallbackInfo &info)
       : Napi::ObjectWrap<AudioCaptureAddon>(info) {
-    // 延迟初始化平台特定的实现
-    if (!g_audio_capture) {
-      g_audio_capture = audio_capture::CreatePlatformAudioCapture();
+    source_ = "platform";
+    if (info.Length() > 0 && info[0].IsObject()) {
+      Napi::Value value = info[0].As<Napi::Object>().Get("source");
+      if (!value.IsUndefined()) {
+        if (value.IsString()) {
+          source_ = value.As<Napi::String>().Utf8Value();
+        }
+        // 拼写错误不应悄悄退回到平台捕获
+        if (!value.IsString() || (source_ != "platform" &&
+                                  source_ != "synthetic" &&
+                                  source_ != "replay")) {
+          Napi::TypeError::New(
+              info.Env(),
+              "参数错误: source 必须是 \"platform\"、\"synthetic\" 或 \"replay\"")
+              .ThrowAsJavaScriptException();
+          return;
+        }
+      }
+    }
+
+    if (source_ == "replay" &&
+        !LoadReplay(info.Env(), info[0].As<Napi::Object>().Get("replay"))) {
+      return;
+    }
+
+    capture_ = CreateCapture();
+  }
+
+  // 析构函数，确保捕获线程在对象回收前停止
+  ~AudioCaptureAddon() override {
+    if (mixer_) {
+      mixer_->Stop();
+    }
+    if (capture_ && capture_->IsCapturing()) {
+      capture_->StopCapture();
     }
+    ReleaseCallback();
   }
 
 private:
+  // 创建实例时选择的音频源
+  std::string source_;
+
+  // replay 源的回调节奏和音频内容（为空时使用正弦波），各次捕获共享
+  std::shared_ptr<const std::vector<audio_capture::CadencePacket>>
+      replay_packets_;
+  std::shared_ptr<const audio_capture::ReplayAudio> replay_audio_;
+  bool replay_loop_ = true;
+
+  // 回调节奏录制器，投递回调中持有共享引用
+  std::shared_ptr<audio_capture::CadenceRecorder> cadence_ =
+      std::make_shared<audio_capture::CadenceRecorder>();
+
+  // 音频源到下游的分发器，音频源的回调引用它，必须比capture_后销毁
+  std::shared_ptr<audio_capture::TargetSwitcher> switcher_;
+
+  // 当前会话的捕获实现
+  std::unique_ptr<audio_capture::AudioCapture> capture_;
+
+  // 混音会话（startMixCapture），与单进程捕获互斥
+  std::unique_ptr<audio_capture::AudioMixer> mixer_;
+
+  // switchTarget期间：正在准备的新音频源 / 等待交接后停止的旧音频源
+  std::unique_ptr<audio_capture::AudioCapture> standby_;
+  std::unique_ptr<audio_capture::AudioCapture> retiring_;
+  bool switch_pending_ = false;
+  bool switch_stopped_ = false; ///< 切换期间调用了stopCapture，由切换的工作线程收尾
+
+  // setProcessingGraph声明的处理图，每次开始捕获时按声明重新构建
+  std::vector<audio_capture::GraphNodeSpec> graph_specs_;
+
+  // 捕获回调使用的处理图槽位，捕获期间可以替换处理图
+  std::shared_ptr<audio_capture::ProcessingGraphSlot> graph_slot_;
+
+  // 投递给JS之前的自适应合并（setDeliveryBatching配置的批时长范围，
+  // 上限为0表示不合并），捕获源和js输出端共用
+  std::shared_ptr<audio_capture::DeliveryBatcher> batcher_;
+  double batch_min_ms_ = 0;
+  double batch_max_ms_ = 0;
+
+  // 电平触发（setLevelTrigger），每个捕获会话按配置新建，捕获期间可以调整
+  std::shared_ptr<audio_capture::LevelTrigger> trigger_;
+  audio_capture::LevelTriggerOptions trigger_options_;
+  bool trigger_enabled_ = false;
+
+  // 空闲挂起（setIdleSuspend），通过捕获配置交给后端，捕获期间可以调整
+  std::shared_ptr<audio_capture::IdleSuspend> idle_ =
+      std::make_shared<audio_capture::IdleSuspend>();
+
+  // 当前音频源的结束通知是否有效：切换目标或停止时作废，
+  // 避免已被替换的音频源或已停止的会话再发出 ended 事件
+  std::shared_ptr<std::atomic<bool>> ended_armed_;
+
+  // PCM数据回调函数的JavaScript引用
+  Napi::ThreadSafeFunction ts_callback_;
+
+  // 是否计入了进程级指标中的活动会话
+  bool metrics_session_ = false;
+
+  // 当前会话的统计数据，回调中持有共享引用
+  std::shared_ptr<audio_capture::CaptureStats> stats_ =
+      std::make_shared<audio_capture::CaptureStats>();
+
+  // 进程内唯一的会话ID
+  uint32_t session_id_ = NextSessionId();
+
+  // startCaptureAsync的后端准备是否正在工作线程中进行
+  // 期间工作线程独占capture_，JS线程上的其他操作直接返回false
+  bool start_pending_ = false;
+  std::shared_ptr<std::atomic<bool>> cancel_flag_;
+
+  bool IsMixing() const { return mixer_ && mixer_->IsRunning(); }
+
+  // 会话是否正在启动、切换或捕获（此时不能开始新的捕获）
+  bool IsBusy() const {
+    return start_pending_ || switch_pending_ || IsMixing() ||
+           capture_->IsCapturing();
+  }
+
+  // 按实例的音频源类型创建捕获实现
+  std::unique_ptr<audio_capture::AudioCapture> CreateCapture() const {
+    if (source_ == "synthetic") {
+      return std::make_unique<audio_capture::SyntheticAudioCapture>();
+    }
+    if (source_ == "replay") {
+      return std::make_unique<audio_capture::ReplayAudioCapture>(
+          replay_packets_, replay_audio_, replay_loop_);
+    }
+    return audio_capture::CreatePlatformAudioCapture();
+  }
+
+  // 按实例的音频源类型创建输入设备（麦克风）的捕获实现
+  std::unique_ptr<audio_capture::AudioCapture>
+  CreateInputCapture(const std::string &device) const {
+    if (source_ == "synthetic" || source_ == "replay") {
+      return std::make_unique<audio_capture::SyntheticAudioCapture>();
+    }
+    return audio_capture::CreatePlatformInputCapture(device);
+  }
+
+  // 读取 replay 源的配置 { trace, audio?, loop? }，失败时抛出JS异常
+  bool LoadReplay(Napi::Env env, Napi::Value value) {
+    Napi::Object options =
+        value.IsObject() ? value.As<Napi::Object>() : Napi::Object::New(env);
+    Napi::Value trace = options.Get("trace");
+    Napi::Value audio = options.Get("audio");
+    Napi::Value loop = options.Get("loop");
+    if (!trace.IsString() || !(audio.IsUndefined() || audio.IsString()) ||
+        !(loop.IsUndefined() || loop.IsBoolean())) {
+      Napi::TypeError::New(env, "参数错误: replay 源需要 { trace: string, "
+                                "audio?: string, loop?: boolean }")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+
+    std::string error;
+    auto packets =
+        std::make_shared<std::vector<audio_capture::CadencePacket>>();
+    if (!audio_capture::LoadCadenceTrace(trace.As<Napi::String>().Utf8Value(),
+                                         packets.get(), &error)) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return false;
+    }
+    if (audio.IsString()) {
+      auto content = std::make_shared<audio_capture::ReplayAudio>();
+      if (!audio_capture::LoadReplayAudio(audio.As<Napi::String>().Utf8Value(),
+                                          content.get(), &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return false;
+      }
+      replay_audio_ = std::move(content);
+    }
+    replay_packets_ = std::move(packets);
+    replay_loop_ = loop.IsBoolean() ? loop.As<Napi::Boolean>().Value() : true;
+    return true;
+  }
+
+  // 会议捕获中麦克风在混音源中的ID（不会与进程ID冲突）
+  static constexpr uint32_t kMicrophoneSourceId = 0;
+
+  static uint32_t NextSessionId() {
+    static std::atomic<uint32_t> next_id{1};
+    return next_id.fetch_add(1);
+  }
+
+  /**
+   * 在libuv线程池中完成后端准备（可能阻塞数秒），回到JS线程后再开始投递数据。
+   * 持有addon对象的引用，保证执行期间对象不会被回收。
+   */
+  class StartCaptureWorker : public Napi::AsyncWorker {
+  public:
+    StartCaptureWorker(AudioCaptureAddon *addon, uint32_t pid,
+                       Napi::Function callback,
+                       const audio_capture::CaptureOptions &options)
+        : Napi::AsyncWorker(addon->Env(), "StartCaptureAsync"),
+          addon_(addon), addon_ref_(Napi::Persistent(addon->Value())),
+          pid_(pid), options_(options),
+          deferred_(Napi::Promise::Deferred::New(Env())),
+          callback_(Napi::Persistent(callback)) {}
+
+    Napi::Promise Promise() { return deferred_.Promise(); }
+
+  protected:
+    void Execute() override {
+      prepared_ = addon_->capture_->Prepare(pid_, options_);
+    }
+
+    void OnOK() override {
+      Napi::Env env = Env();
+      addon_->start_pending_ = false;
+
+      if (options_.IsCancelled()) {
+        // 释放已完成的准备结果
+        addon_->capture_->StopCapture();
+        Reject("捕获启动已取消", "ERR_CAPTURE_CANCELLED");
+        return;
+      }
+
+      if (!prepared_ ||
+          !addon_->StartDelivery(env, pid_, callback_.Value(), options_)) {
+        Reject("启动捕获失败", "ERR_CAPTURE_START_FAILED");
+        return;
+      }
+
+      Napi::Object session = Napi::Object::New(env);
+      session.Set("sessionId", Napi::Number::New(env, addon_->session_id_));
+      session.Set("pid", Napi::Number::New(env, pid_));
+      deferred_.Resolve(session);
+    }
+
+    void OnError(const Napi::Error &error) override {
+      addon_->start_pending_ = false;
+      deferred_.Reject(error.Value());
+    }
+
+  private:
+    AudioCaptureAddon *addon_;
+    Napi::ObjectReference addon_ref_; ///< 工作线程执行期间保持addon存活
+    uint32_t pid_;
+    audio_capture::CaptureOptions options_;
+    Napi::Promise::Deferred deferred_;
+    Napi::FunctionReference callback_;
+    bool prepared_ = false;
+
+    void Reject(const char *message, const char *code) {
+      Napi::Error error = Napi::Error::New(Env(), message);
+      error.Set("code", Napi::String::New(Env(), code));
+      deferred_.Reject(error.Value());
+    }
+  };
+
+  /**
+   * switchTarget第一阶段：在线程池中准备新音频源，回到JS线程后启动它，
+   * 新音频源的数据先由切换器缓冲，等待旧音频源在包边界交接。
+   */
+  class SwitchTargetWorker : public Napi::AsyncWorker {
+  public:
+    SwitchTargetWorker(AudioCaptureAddon *addon, uint32_t pid,
+                       uint32_t crossfade_ms,
+                       const audio_capture::CaptureOptions &options)
+        : Napi::AsyncWorker(addon->Env(), "SwitchTarget"), addon_(addon),
+          addon_ref_(Napi::Persistent(addon->Value())), pid_(pid),
+          crossfade_ms_(crossfade_ms), options_(options),
+          deferred_(Napi::Promise::Deferred::New(Env())) {}
+
+    Napi::Promise Promise() { return deferred_.Promise(); }
+
+  protected:
+    void Execute() override {
+      prepared_ = addon_->standby_->Prepare(pid_, options_);
+    }
+
+    void OnOK() override {
+      // 准备期间会话已经停止，丢弃新音频源
+      if (addon_->switch_stopped_) {
+        Fail("切换期间捕获已停止");
+        return;
+      }
+      if (!prepared_ || !addon_->capture_->IsCapturing()) {
+        Fail("准备新的捕获目标失败");
+        return;
+      }
+
+      auto armed = std::make_shared<std::atomic<bool>>(true);
+      addon_->standby_->SetEndedCallback(
+          addon_->MakeEndedCallback(pid_, armed));
+      if (!addon_->standby_->Start(
+              addon_->switcher_->BeginSwitch(crossfade_ms_))) {
+        addon_->switcher_->CancelSwitch();
+        Fail("启动新的捕获目标失败");
+        return;
+      }
+
+      // 之后只有新音频源的结束才代表会话结束
+      if (addon_->ended_armed_) {
+        addon_->ended_armed_->store(false);
+      }
+      addon_->ended_armed_ = armed;
+
+      // 新音频源成为当前会话的捕获实现，旧音频源交接后在线程池中停止
+      std::unique_ptr<audio_capture::AudioCapture> previous =
+          std::move(addon_->capture_);
+      addon_->capture_ = std::move(addon_->standby_);
+      (new RetireWorker(addon_, std::move(previous), pid_, deferred_))
+          ->Queue();
+    }
+
+    void OnError(const Napi::Error &error) override {
+      addon_->standby_.reset();
+      addon_->switch_pending_ = false;
+      addon_->switch_stopped_ = false;
+      deferred_.Reject(error.Value());
+    }
+
+  private:
+    AudioCaptureAddon *addon_;
+    Napi::ObjectReference addon_ref_; ///< 工作线程执行期间保持addon存活
+    uint32_t pid_;
+    uint32_t crossfade_ms_;
+    audio_capture::CaptureOptions options_;
+    Napi::Promise::Deferred deferred_;
+    bool prepared_ = false;
+
+    void Fail(const char *message) {
+      addon_->standby_.reset();
+      addon_->switch_pending_ = false;
+      addon_->switch_stopped_ = false;
+      Napi::Error error = Napi::Error::New(Env(), message);
+      error.Set("code",
+                Napi::String::New(Env(), "ERR_CAPTURE_SWITCH_FAILED"));
+      deferred_.Reject(error.Value());
+    }
+  };
+
+  /**
+   * switchTarget第二阶段：等待旧音频源在包边界交接（旧音频源没有数据时
+   * 超时后强制交接），然后停止旧音频源并resolve。
+   */
+  class RetireWorker : public Napi::AsyncWorker {
+  public:
+    RetireWorker(AudioCaptureAddon *addon,
+                 std::unique_ptr<audio_capture::AudioCapture> previous,
+                 uint32_t pid, Napi::Promise::Deferred deferred)
+        : Napi::AsyncWorker(addon->Env(), "RetireCapture"), addon_(addon),
+          addon_ref_(Napi::Persistent(addon->Value())),
+          switcher_(addon->switcher_), previous_(std::move(previous)),
+          pid_(pid), deferred_(deferred) {}
+
+  protected:
+    void Execute() override {
+      using Clock = std::chrono::steady_clock;
+      constexpr auto kPollInterval = std::chrono::milliseconds(5);
+
+      // 正常情况下新音频源的第一个数据包到达后，旧音频源在下一个包边界交接
+      auto deadline = Clock::now() + std::chrono::milliseconds(1000);
+      while (!switcher_->IsSwitchComplete() && Clock::now() < deadline) {
+        std::this_thread::sleep_for(kPollInterval);
+      }
+
+      // 新音频源一直没有数据（目标进程静音），让旧音频源直接交接
+      if (!switcher_->IsSwitchComplete()) {
+        switcher_->ForceSwitch();
+        deadline = Clock::now() + std::chrono::milliseconds(100);
+        while (!switcher_->IsSwitchComplete() && Clock::now() < deadline) {
+          std::this_thread::sleep_for(kPollInterval);
+        }
+      }
+
+      // 旧音频源也没有数据，由这里完成交接
+      while (!switcher_->IsSwitchComplete()) {
+        if (!switcher_->TryCompleteSwitch()) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      }
+
+      previous_->StopCapture();
+    }
+
+    void OnOK() override {
+      previous_.reset();
+      addon_->switch_pending_ = false;
+
+      // 交接期间会话已经停止：旧音频源现在才停止，TSFN到这里才能释放
+      if (addon_->switch_stopped_) {
+        addon_->switch_stopped_ = false;
+        addon_->ReleaseCallback();
+        Napi::Error error = Napi::Error::New(Env(), "切换期间捕获已停止");
+        error.Set("code",
+                  Napi::String::New(Env(), "ERR_CAPTURE_SWITCH_FAILED"));
+        deferred_.Reject(error.Value());
+        return;
+      }
+
+      Napi::Env env = Env();
+      Napi::Object session = Napi::Object::New(env);
+      session.Set("sessionId", Napi::Number::New(env, addon_->session_id_));
+      session.Set("pid", Napi::Number::New(env, pid_));
+      deferred_.Resolve(session);
+    }
+
+    void OnError(const Napi::Error &error) override {
+      previous_.reset();
+      addon_->switch_pending_ = false;
+      if (addon_->switch_stopped_) {
+        addon_->switch_stopped_ = false;
+        addon_->ReleaseCallback();
+      }
+      deferred_.Reject(error.Value());
+    }
+
+  private:
+    AudioCaptureAddon *addon_;
+    Napi::ObjectReference addon_ref_; ///< 工作线程执行期间保持addon存活
+    std::shared_ptr<audio_capture::TargetSwitcher> switcher_;
+    std::unique_ptr<audio_capture::AudioCapture> previous_;
+    uint32_t pid_;
+    Napi::Promise::Deferred deferred_;
+  };
+
+  // 释放线程安全函数
+  void ReleaseCallback() {
+    // 停止后不再通知音频源结束
+    if (ended_armed_) {
+      ended_armed_->store(false);
+      ended_armed_.reset();
+    }
+
+    // 处理图的工作线程也会调用TSFN，先停止它们并写完输出文件
+    if (graph_slot_) {
+      graph_slot_->Replace(nullptr);
+      graph_slot_.reset();
+    }
+
+    // 投递合并中剩余的数据，之后TSFN才能释放
+    if (batcher_) {
+      batcher_->Flush();
+      batcher_.reset();
+    }
+
+    if (metrics_session_) {
+      audio_capture::metrics::SessionEnded();
+      metrics_session_ = false;
+    }
+
+    if (ts_callback_) {
+      try {
+        ts_callback_.Release();
+      } catch (...) {
+        // 忽略释放时的异常
+      }
+      ts_callback_ = Napi::ThreadSafeFunction();
+    }
+  }
+
+  // 解析JavaScript传入的捕获配置 { activationTimeoutMs }
+  // 参数无效时抛出TypeError并返回false
+  static bool ParseCaptureOptions(Napi::Env env, Napi::Value value,
+                                  audio_capture::CaptureOptions *options) {
+    if (value.IsUndefined() || value.IsNull()) {
+      return true;
+    }
+    if (!value.IsObject()) {
+      Napi::TypeError::New(env, "参数错误: 捕获配置必须是对象")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+
+    Napi::Value timeout =
+        value.As<Napi::Object>().Get("activationTimeoutMs");
+    if (!timeout.IsUndefined()) {
+      if (!timeout.IsNumber() || timeout.As<Napi::Number>().DoubleValue() <= 0) {
+        Napi::TypeError::New(env, "参数错误: activationTimeoutMs 必须是正数")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+      options->activation_timeout_ms = timeout.As<Napi::Number>().Uint32Value();
+    }
+
+    Napi::Value native = value.As<Napi::Object>().Get("nativeFormat");
+    if (!native.IsUndefined()) {
+      if (!native.IsBoolean()) {
+        Napi::TypeError::New(env, "参数错误: nativeFormat 必须是布尔值")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+      options->native_format = native.As<Napi::Boolean>().Value();
+    }
+
+    // 捕获周期：interactive/balanced/powersave 或按48kHz计的帧数
+    Napi::Value hint = value.As<Napi::Object>().Get("latencyHint");
+    if (hint.IsString()) {
+      std::string name = hint.As<Napi::String>().Utf8Value();
+      if (name == "interactive") {
+        options->period_frames =
+            audio_capture::CaptureOptions::kInteractivePeriodFrames;
+      } else if (name == "powersave") {
+        options->period_frames =
+            audio_capture::CaptureOptions::kPowersavePeriodFrames;
+      } else if (name != "balanced") {
+        Napi::TypeError::New(env, "参数错误: 未知的 latencyHint: " + name)
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+    } else if (hint.IsNumber()) {
+      double frames = hint.As<Napi::Number>().DoubleValue();
+      if (frames < 16 || frames > 48000) {
+        Napi::TypeError::New(env, "参数错误: latencyHint 帧数必须在 16~48000 之间")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+      options->period_frames = static_cast<uint32_t>(frames);
+    } else if (!hint.IsUndefined()) {
+      Napi::TypeError::New(env, "参数错误: latencyHint 必须是字符串或帧数")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    return true;
+  }
+
   // 检查音频捕获权限状态
   Napi::Value CheckPermission(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
@@ -151,8 +726,11 @@ private:
   // 获取进程列表（已自动过滤当前应用进程）
   Napi::Value GetProcessList(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
+    uint64_t beginNs = audio_capture::trace::NowNs();
     std::vector<process_manager::ProcessInfo> processes =
         process_manager::GetProcessList();
+    audio_capture::metrics::ObserveEnumeration(audio_capture::trace::NowNs() -
+                                               beginNs);
 
     Napi::Array result = Napi::Array::New(env, processes.size());
 
@@ -192,6 +770,33 @@ private:
     return result;
   }
 
+  // 预先完成指定进程的后端初始化，之后的startCapture只需开始投递数据
+  Napi::Value PrepareCapture(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // 验证参数
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "参数错误: 需要进程ID")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    audio_capture::CaptureOptions options;
+    if (info.Length() > 1 && !ParseCaptureOptions(env, info[1], &options)) {
+      return env.Null();
+    }
+    options.idle_suspend = idle_;
+    options.trace_session = session_id_;
+
+    uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
+    if (IsBusy()) {
+      return Napi::Boolean::New(env, false);
+    }
+
+    bool result = capture_->Prepare(pid, options);
+    return Napi::Boolean::New(env, result);
+  }
+
   // 开始捕获指定进程的音频
   Napi::Value StartCapture(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
@@ -203,115 +808,1431 @@ private:
       return env.Null();
     }
 
+    audio_capture::CaptureOptions options;
+    if (info.Length() > 2 && !ParseCaptureOptions(env, info[2], &options)) {
+      return env.Null();
+    }
+    options.idle_suspend = idle_;
+    options.trace_session = session_id_;
+
     uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
     Napi::Function callback = info[1].As<Napi::Function>();
 
-    // 创建线程安全的函数回调
-    g_ts_callback = Napi::ThreadSafeFunction::New(
-        env, callback, "AudioCaptureCallback", 0, 1, [](Napi::Env) {
-          // 清理回调
-        });
+    if (IsBusy()) {
+      return Napi::Boolean::New(env, false);
+    }
+
+    bool result = StartDelivery(env, pid, callback, options);
+    return Napi::Boolean::New(env, result);
+  }
 
-    // 设置C++回调函数，将PCM数据传递给JavaScript
-    bool result = g_audio_capture->StartCapture(pid, [](const uint8_t *data,
-                                                        size_t length,
-                                                        int channels,
-                                                        int sampleRate) {
-      // 数据有效性检查
-      if (!data || length == 0 || length > 16 * 1024 * 1024) { // 限制最大16MB
+  // 创建JS回调并开始投递数据（已准备时不会阻塞）
+  bool StartDelivery(Napi::Env env, uint32_t pid, Napi::Function callback,
+                     const audio_capture::CaptureOptions &options) {
+    switcher_ = std::make_shared<audio_capture::TargetSwitcher>(
+        MakeOutput(env, callback), session_id_);
+    ended_armed_ = std::make_shared<std::atomic<bool>>(true);
+    capture_->SetEndedCallback(MakeEndedCallback(pid, ended_armed_));
+    bool result =
+        capture_->StartCapture(pid, switcher_->SourceCallback(), options);
+
+    if (!result) {
+      ReleaseCallback();
+    }
+
+    return result;
+  }
+
+  // 音频源的结束回调（在后端线程调用）：投递剩余数据后通知JS，
+  // armed 被作废或已经通知过时忽略
+  audio_capture::EndedCallback
+  MakeEndedCallback(uint32_t pid, std::shared_ptr<std::atomic<bool>> armed) {
+    Napi::ThreadSafeFunction tsfn = ts_callback_;
+    std::shared_ptr<audio_capture::DeliveryBatcher> batcher = batcher_;
+    return [armed, tsfn, batcher, pid](const char *reason) mutable {
+      if (!armed->exchange(false)) {
         return;
       }
+      batcher->Flush();
+      NotifyEnded(tsfn, pid, reason);
+    };
+  }
+
+  // 投递链的末级：有处理图时送入处理图，否则交给合并器
+  class RouteStage : public audio_capture::AudioSink<RouteStage> {
+  public:
+    RouteStage(std::shared_ptr<audio_capture::ProcessingGraphSlot> slot,
+               std::shared_ptr<audio_capture::DeliveryBatcher> batcher,
+               std::shared_ptr<audio_capture::CaptureStats> stats)
+        : slot_(std::move(slot)), batch_(std::move(batcher), std::string()),
+          stats_(std::move(stats)) {}
 
-      // 参数合理性检查
-      if (channels <= 0 || channels > 32 || sampleRate <= 0 ||
-          sampleRate > 192000) {
+    template <int Channels>
+    void Consume(const float *samples, size_t frames, int channels,
+                 int sampleRate, uint64_t position) {
+      size_t size = frames * ChannelCount<Channels>(channels) * sizeof(float);
+      if (slot_->Push(reinterpret_cast<const uint8_t *>(samples), size,
+                      channels, sampleRate)) {
+        stats_->MarkFirstFrame(audio_capture::trace::NowNs());
         return;
       }
+      batch_.template Consume<Channels>(samples, frames, channels, sampleRate,
+                                        position);
+    }
 
-      // 创建数据副本，避免悬空指针问题
-      std::vector<uint8_t> dataCopy;
-      try {
-        dataCopy.assign(data, data + length);
-      } catch (const std::exception &e) {
-        // 内存分配失败，跳过这帧数据
-        return;
+  private:
+    std::shared_ptr<audio_capture::ProcessingGraphSlot> slot_;
+    audio_capture::BatcherSink<audio_capture::SampleFormat::kFloat32> batch_;
+    std::shared_ptr<audio_capture::CaptureStats> stats_;
+  };
+
+  // 电平触发：空闲时数据只写入预录缓冲区，触发时连同预录数据一起输出
+  template <typename Next>
+  class TriggerStage : public audio_capture::AudioSink<TriggerStage<Next>> {
+  public:
+    TriggerStage(Next &next,
+                 std::shared_ptr<audio_capture::LevelTrigger> trigger,
+                 std::shared_ptr<audio_capture::DeliveryBatcher> batcher,
+                 Napi::ThreadSafeFunction tsfn)
+        : next_(next), trigger_(std::move(trigger)),
+          batcher_(std::move(batcher)), tsfn_(tsfn) {}
+
+    template <int Channels>
+    void Consume(const float *samples, size_t frames, int channels,
+                 int sampleRate, uint64_t position) {
+      trigger_->Process(samples, frames, channels, sampleRate, position,
+                        &gated_);
+      if (gated_.closed) {
+        // 停止输出前投递合并中的数据，空闲期间JS不再收到任何回调
+        batcher_->Flush();
+        NotifyLevelTrigger(tsfn_, false, position, gated_.level_db);
+      } else if (gated_.opened) {
+        NotifyLevelTrigger(tsfn_, true, gated_.segments[0].position,
+                           gated_.level_db);
       }
 
-      // 在新线程中调用JavaScript回调
-      auto callback = [dataCopy = std::move(dataCopy), length, channels,
-                       sampleRate](Napi::Env env, Napi::Function jsCallback) {
-        try {
-          // 再次验证数据长度
-          if (dataCopy.size() != length || length == 0) {
-            return;
-          }
+      for (size_t i = 0; i < gated_.count; ++i) {
+        const audio_capture::LevelTrigger::Segment &segment =
+            gated_.segments[i];
+        next_.template Consume<Channels>(segment.samples, segment.frames,
+                                         channels, sampleRate,
+                                         segment.position);
+      }
+    }
 
-          // 创建ArrayBuffer来存储PCM数据
-          Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, length);
-          if (!buffer.Data()) {
-            return; // ArrayBuffer创建失败
-          }
+  private:
+    Next &next_;
+    std::shared_ptr<audio_capture::LevelTrigger> trigger_;
+    std::shared_ptr<audio_capture::DeliveryBatcher> batcher_;
+    Napi::ThreadSafeFunction tsfn_;
+    audio_capture::LevelTrigger::Result gated_;
+  };
+
+  // 投递链的第一级：校验、统计、格式变化通知，并为数据包编号
+  // 传入的 position 被忽略，会话中的位置由统计的帧数决定，切换目标后继续递增
+  template <typename Next>
+  class EntryStage : public audio_capture::AudioSink<EntryStage<Next>> {
+  public:
+    EntryStage(Next &next, std::shared_ptr<audio_capture::CaptureStats> stats,
+               std::shared_ptr<audio_capture::CadenceRecorder> cadence,
+               std::shared_ptr<audio_capture::DeliveryBatcher> batcher,
+               Napi::ThreadSafeFunction tsfn, uint32_t session)
+        : next_(next), stats_(std::move(stats)), cadence_(std::move(cadence)),
+          batcher_(std::move(batcher)), tsfn_(tsfn), session_(session) {}
+
+    template <int Channels>
+    void Consume(const float *samples, size_t frames, int channels,
+                 int sampleRate, uint64_t /*position*/) {
+      audio_capture::trace::ScopedSpan span("enqueue", session_);
+      stats_->packets.fetch_add(1, std::memory_order_relaxed);
+      audio_capture::metrics::AddPackets(1);
+
+      // 数据有效性检查（限制最大16MB）和参数合理性检查
+      if (!samples || frames == 0 || channels <= 0 || channels > 32 ||
+          sampleRate <= 0 || sampleRate > 192000 ||
+          frames * channels * sizeof(float) > 16 * 1024 * 1024) {
+        stats_->dropped.fetch_add(1, std::memory_order_relaxed);
+        audio_capture::metrics::AddDropped(1);
+        return;
+      }
+
+      // 本数据包第一帧在会话中的位置
+      uint64_t position =
+          stats_->frames.fetch_add(frames, std::memory_order_relaxed);
+      stats_->period_frames.store(frames, std::memory_order_relaxed);
+      cadence_->Record(static_cast<uint32_t>(frames), channels, sampleRate);
 
-          // 安全的内存拷贝
-          std::memcpy(buffer.Data(), dataCopy.data(), length);
-
-          // 创建返回对象
-          Napi::Object result = Napi::Object::New(env);
-          size_t sampleCount = length / sizeof(float);
-          result.Set("buffer",
-                     Napi::Float32Array::New(env, sampleCount, buffer, 0));
-          result.Set("channels", Napi::Number::New(env, channels));
-          result.Set("sampleRate", Napi::Number::New(env, sampleRate));
-
-          // 调用JavaScript回调，添加错误处理
-          jsCallback.Call({result});
-        } catch (const Napi::Error &e) {
-          // 捕获N-API异常，避免崩溃
-          // 在开发环境可以输出错误信息
-        } catch (const std::exception &e) {
-          // 捕获其他C++异常
-        } catch (...) {
-          // 捕获所有其他异常
+      // 后端通过属性监听器/参数变化事件缓存格式，这里只和上一个数据包比较；
+      // 格式变化时先通知JS，再投递新格式的数据，处理图随之重新配置一次
+      uint64_t format = (static_cast<uint64_t>(channels) << 32) |
+                        static_cast<uint32_t>(sampleRate);
+      uint64_t previous = stats_->format.load(std::memory_order_relaxed);
+      if (previous != format) {
+        stats_->format.store(format, std::memory_order_relaxed);
+        if (previous != 0) {
+          stats_->format_changes.fetch_add(1, std::memory_order_relaxed);
+          // 旧格式的数据先于通知投递
+          batcher_->Flush();
+          NotifyFormatChanged(tsfn_, previous, format, position);
         }
-      };
+      }
 
-      g_ts_callback.BlockingCall(callback);
-    });
+      next_.template Consume<Channels>(samples, frames, channels, sampleRate,
+                                       position);
+    }
 
-    return Napi::Boolean::New(env, result);
+  private:
+    Next &next_;
+    std::shared_ptr<audio_capture::CaptureStats> stats_;
+    std::shared_ptr<audio_capture::CadenceRecorder> cadence_;
+    std::shared_ptr<audio_capture::DeliveryBatcher> batcher_;
+    Napi::ThreadSafeFunction tsfn_;
+    uint32_t session_;
+  };
+
+  // 一个会话的投递链，各级按声明顺序构造，后一级引用前一级
+  struct OutputChain {
+    OutputChain(std::shared_ptr<audio_capture::ProcessingGraphSlot> slot,
+                std::shared_ptr<audio_capture::LevelTrigger> trigger,
+                std::shared_ptr<audio_capture::CaptureStats> stats,
+                std::shared_ptr<audio_capture::CadenceRecorder> cadence,
+                std::shared_ptr<audio_capture::DeliveryBatcher> batcher,
+                Napi::ThreadSafeFunction tsfn, uint32_t session)
+        : route(std::move(slot), batcher, stats),
+          gate(route, std::move(trigger), batcher, tsfn),
+          entry(gate, std::move(stats), std::move(cadence), batcher, tsfn,
+                session) {}
+
+    RouteStage route;
+    TriggerStage<RouteStage> gate;
+    EntryStage<TriggerStage<RouteStage>> entry;
+  };
+
+  // 创建JS回调的TSFN并返回下游C++回调：统计、复制数据并交给JS
+  // 单进程捕获（经由切换器）和混音会话共用
+  audio_capture::AudioDataCallback MakeOutput(Napi::Env env,
+                                              Napi::Function callback) {
+    // 创建线程安全的函数回调
+    ReleaseCallback();
+    // 在捕获开始前注册JS线程并补足后端实时线程领取的trace缓冲区
+    audio_capture::trace::RegisterThread();
+    ts_callback_ = Napi::ThreadSafeFunction::New(
+        env, callback, "AudioCaptureCallback", 0, 1, [](Napi::Env) {
+          // 清理回调
+        });
+
+    stats_->Reset();
+    idle_->ResetStats();
+    audio_capture::metrics::SessionStarted();
+    metrics_session_ = true;
+    Napi::ThreadSafeFunction tsfn = ts_callback_;
+    std::shared_ptr<audio_capture::CaptureStats> stats = stats_;
+    const uint32_t session = session_id_;
+
+    // 已预先准备时从这里开始计时，否则包含同步准备的耗时
+    stats_->start_ns.store(audio_capture::trace::NowNs(),
+                           std::memory_order_relaxed);
+
+    // 捕获源和各js输出端的数据都先经过合并器，再复制并交给JS
+    batcher_ = std::make_shared<audio_capture::DeliveryBatcher>(
+        [session, tsfn, stats](const std::string &sink, const uint8_t *data,
+                               size_t length, int channels, int sampleRate,
+                               uint64_t position,
+                               audio_capture::SampleFormat format) mutable {
+          Deliver(tsfn, stats, session, sink, position, data, length,
+                  channels, sampleRate, format);
+        },
+        stats);
+    batcher_->Configure(batch_min_ms_, batch_max_ms_);
+
+    trigger_ = std::make_shared<audio_capture::LevelTrigger>();
+    if (trigger_enabled_) {
+      trigger_->Configure(trigger_options_);
+    }
+
+    // 声明了处理图时，源数据先经过处理图，再由各js输出端分别投递
+    graph_slot_ = std::make_shared<audio_capture::ProcessingGraphSlot>();
+    graph_slot_->Replace(BuildGraph(graph_specs_));
+
+    // 所有音频源都经由切换器或混音器调用投递链，切换目标时保持不变；
+    // std::function 只在这里的入口处出现一次
+    auto chain = std::make_shared<OutputChain>(graph_slot_, trigger_, stats,
+                                               cadence_, batcher_, tsfn,
+                                               session);
+    return audio_capture::ToCallback(
+        std::shared_ptr<EntryStage<TriggerStage<RouteStage>>>(chain,
+                                                              &chain->entry));
   }
 
-  // 停止捕获
-  Napi::Value StopCapture(const Napi::CallbackInfo &info) {
-    Napi::Env env = info.Env();
+  // 按声明构建并启动处理图，声明为空时返回空
+  // 声明已在setProcessingGraph中校验过，这里不会构建失败
+  std::shared_ptr<audio_capture::ProcessingGraph>
+  BuildGraph(const std::vector<audio_capture::GraphNodeSpec> &specs) {
+    if (specs.empty()) {
+      return nullptr;
+    }
 
-    bool result = false;
-    try {
-      result = g_audio_capture->StopCapture();
+    // 处理图在TSFN释放之前停止，节点报告错误时TSFN仍然有效
+    Napi::ThreadSafeFunction tsfn = ts_callback_;
+    std::string error;
+    std::shared_ptr<audio_capture::ProcessingGraph> graph =
+        audio_capture::ProcessingGraph::Build(
+            specs, batcher_, &error, session_id_,
+            [tsfn](const std::string &node, const std::string &message) mutable {
+              NotifyGraphError(tsfn, node, message);
+            });
+    if (graph) {
+      graph->Start();
+    }
+    if (batcher_) {
+      batcher_->SetUnbatchedSinks(FixedSizeSinks(specs));
+    }
+    return graph;
+  }
 
-      // 释放线程安全函数
-      if (g_ts_callback) {
-        g_ts_callback.Release();
+  // chunk节点之后的js输出端承诺固定帧数，合并投递时跳过它们
+  static std::vector<std::string>
+  FixedSizeSinks(const std::vector<audio_capture::GraphNodeSpec> &specs) {
+    std::vector<std::string> sinks;
+    for (const auto &spec : specs) {
+      if (spec.type != "js") {
+        continue;
+      }
+      for (const auto &input : specs) {
+        if (input.id == spec.input && input.type == "chunk") {
+          sinks.push_back(spec.id);
+          break;
+        }
       }
+    }
+    return sinks;
+  }
+
+  // 复制一个数据包并通过TSFN交给JS回调
+  // sink 非空时是处理图js输出端的节点ID，作为 AudioData.sink 传给JS
+  static void Deliver(Napi::ThreadSafeFunction &tsfn,
+                      const std::shared_ptr<audio_capture::CaptureStats> &stats,
+                      uint32_t session, const std::string &sink,
+                      uint64_t position,
+                      const uint8_t *data, size_t length, int channels,
+                      int sampleRate, audio_capture::SampleFormat format) {
+    // 记录入队时间，用于统计回调延迟和TSFN调度耗时
+    uint64_t enqueueNs = audio_capture::trace::NowNs();
+    stats->MarkFirstFrame(enqueueNs);
+
+    // 创建数据副本，避免悬空指针问题
+    std::vector<uint8_t> dataCopy;
+    try {
+      dataCopy.assign(data, data + length);
     } catch (const std::exception &e) {
-      // 确保即使发生异常也能释放资源
-      if (g_ts_callback) {
-        try {
-          g_ts_callback.Release();
-        } catch (...) {
-          // 忽略释放时的异常
+      // 内存分配失败，跳过这帧数据
+      stats->dropped.fetch_add(1, std::memory_order_relaxed);
+      audio_capture::metrics::AddDropped(1);
+      return;
+    }
+
+    // 在新线程中调用JavaScript回调
+    auto callback = [dataCopy = std::move(dataCopy), length, channels,
+                     sampleRate, format, session, stats, position, sink,
+                     enqueueNs](Napi::Env env, Napi::Function jsCallback) {
+      uint64_t dispatchNs = audio_capture::trace::NowNs();
+      stats->callback_latency.Record(dispatchNs - enqueueNs);
+      audio_capture::metrics::ObserveCallbackLatency(dispatchNs - enqueueNs);
+      stats->delivered.fetch_add(1, std::memory_order_relaxed);
+      audio_capture::trace::RecordSpan("tsfn-dispatch", session, enqueueNs,
+                                       dispatchNs);
+      audio_capture::trace::ScopedSpan span("js-callback", session);
+
+      try {
+        // 再次验证数据长度
+        if (dataCopy.size() != length || length == 0) {
+          return;
+        }
+
+        // 创建ArrayBuffer来存储PCM数据
+        Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, length);
+        if (!buffer.Data()) {
+          return; // ArrayBuffer创建失败
+        }
+
+        // 安全的内存拷贝
+        std::memcpy(buffer.Data(), dataCopy.data(), length);
+
+        // 创建返回对象
+        Napi::Object result = Napi::Object::New(env);
+        if (format == audio_capture::SampleFormat::kInt16) {
+          result.Set("buffer", Napi::Int16Array::New(
+                                   env, length / sizeof(int16_t), buffer, 0));
+        } else {
+          result.Set("buffer", Napi::Float32Array::New(
+                                   env, length / sizeof(float), buffer, 0));
         }
+        result.Set("channels", Napi::Number::New(env, channels));
+        result.Set("sampleRate", Napi::Number::New(env, sampleRate));
+        result.Set("position",
+                   Napi::Number::New(env, static_cast<double>(position)));
+        if (!sink.empty()) {
+          result.Set("sink", Napi::String::New(env, sink));
+        }
+
+        // 调用JavaScript回调，添加错误处理
+        jsCallback.Call({result});
+      } catch (const Napi::Error &e) {
+        // 捕获N-API异常，避免崩溃
+        // 在开发环境可以输出错误信息
+      } catch (const std::exception &e) {
+        // 捕获其他C++异常
+      } catch (...) {
+        // 捕获所有其他异常
       }
+
+      // 排队延迟和执行耗时反馈给自适应合并
+      stats->RecordDispatch(dispatchNs - enqueueNs,
+                            audio_capture::trace::NowNs() - dispatchNs);
+    };
+
+    if (tsfn.BlockingCall(callback) != napi_ok) {
+      stats->dropped.fetch_add(1, std::memory_order_relaxed);
+      audio_capture::metrics::AddDropped(1);
     }
+  }
 
-    return Napi::Boolean::New(env, result);
+  // 通过数据回调的同一个TSFN通知JS格式变化，保证事件排在新格式的数据之前
+  // JS回调收到 { event: "format-changed", ... } 对象
+  static void NotifyFormatChanged(Napi::ThreadSafeFunction &tsfn,
+                                  uint64_t previous, uint64_t format,
+                                  uint64_t position) {
+    auto callback = [previous, format, position](Napi::Env env,
+                                                 Napi::Function jsCallback) {
+      try {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("event", Napi::String::New(env, "format-changed"));
+        result.Set("channels",
+                   Napi::Number::New(env, static_cast<double>(format >> 32)));
+        result.Set("sampleRate", Napi::Number::New(
+                                     env, static_cast<double>(
+                                              format & 0xffffffffu)));
+        result.Set("previousChannels",
+                   Napi::Number::New(env, static_cast<double>(previous >> 32)));
+        result.Set("previousSampleRate",
+                   Napi::Number::New(
+                       env, static_cast<double>(previous & 0xffffffffu)));
+        result.Set("position",
+                   Napi::Number::New(env, static_cast<double>(position)));
+        jsCallback.Call({result});
+      } catch (...) {
+        // 通知失败不影响数据投递
+      }
+    };
+    tsfn.BlockingCall(callback);
   }
 
-  // 检查是否正在捕获
-  Napi::Value IsCapturing(const Napi::CallbackInfo &info) {
-    Napi::Env env = info.Env();
-    bool result = g_audio_capture->IsCapturing();
-    return Napi::Boolean::New(env, result);
+  // 通过数据回调的同一个TSFN通知JS电平触发的状态变化
+  // JS回调收到 { event: "level-trigger", active, position, level } 对象，
+  // 开始输出时 position 为预录数据第一帧的位置，停止时为第一个未输出帧的位置
+  static void NotifyLevelTrigger(Napi::ThreadSafeFunction &tsfn, bool active,
+                                 uint64_t position, float level) {
+    auto callback = [active, position, level](Napi::Env env,
+                                              Napi::Function jsCallback) {
+      try {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("event", Napi::String::New(env, "level-trigger"));
+        result.Set("active", Napi::Boolean::New(env, active));
+        result.Set("position",
+                   Napi::Number::New(env, static_cast<double>(position)));
+        result.Set("level", Napi::Number::New(env, level));
+        jsCallback.Call({result});
+      } catch (...) {
+        // 通知失败不影响数据投递
+      }
+    };
+    tsfn.BlockingCall(callback);
+  }
+
+  // 通过数据回调的同一个TSFN通知JS捕获目标已经结束
+  // JS回调收到 { event: "ended", pid, reason } 对象，reason 见 EndedCallback
+  static void NotifyEnded(Napi::ThreadSafeFunction &tsfn, uint32_t pid,
+                          const char *reason) {
+    std::string text = reason;
+    auto callback = [pid, text](Napi::Env env, Napi::Function jsCallback) {
+      try {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("event", Napi::String::New(env, "ended"));
+        result.Set("pid", Napi::Number::New(env, pid));
+        result.Set("reason", Napi::String::New(env, text));
+        jsCallback.Call({result});
+      } catch (...) {
+        // 通知失败时由JS自行停止
+      }
+    };
+    tsfn.BlockingCall(callback);
+  }
+
+  // 通过数据回调的同一个TSFN通知JS处理图节点出错（例如wav文件达到上限）
+  // JS回调收到 { event: "graph-error", node, message } 对象
+  static void NotifyGraphError(Napi::ThreadSafeFunction &tsfn,
+                               const std::string &node,
+                               const std::string &message) {
+    auto callback = [node, message](Napi::Env env, Napi::Function jsCallback) {
+      try {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("event", Napi::String::New(env, "graph-error"));
+        result.Set("node", Napi::String::New(env, node));
+        result.Set("message", Napi::String::New(env, message));
+        jsCallback.Call({result});
+      } catch (...) {
+        // 通知失败不影响数据投递
+      }
+    };
+    tsfn.BlockingCall(callback);
+  }
+
+  // 异步开始捕获：后端准备在工作线程中完成，返回Promise
+  // 参数 (pid, callback, options?)，resolve为 { sessionId, pid }
+  Napi::Value StartCaptureAsync(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // 验证参数
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsFunction()) {
+      Napi::TypeError::New(env, "参数错误: 需要进程ID和回调函数")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    audio_capture::CaptureOptions options;
+    if (info.Length() > 2 && !ParseCaptureOptions(env, info[2], &options)) {
+      return env.Null();
+    }
+    options.idle_suspend = idle_;
+    options.trace_session = session_id_;
+
+    uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
+    Napi::Function callback = info[1].As<Napi::Function>();
+
+    if (IsBusy()) {
+      Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+      Napi::Error error =
+          Napi::Error::New(env, "当前会话正在启动或已经在捕获");
+      error.Set("code", Napi::String::New(env, "ERR_CAPTURE_BUSY"));
+      deferred.Reject(error.Value());
+      return deferred.Promise();
+    }
+
+    options.cancel_flag = std::make_shared<std::atomic<bool>>(false);
+    cancel_flag_ = options.cancel_flag;
+    start_pending_ = true;
+
+    auto *worker = new StartCaptureWorker(this, pid, callback, options);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+  }
+
+  // 在不中断下游的情况下切换捕获目标，返回Promise
+  // 参数 (newPid, options?)，options支持 crossfadeMs 和 activationTimeoutMs
+  Napi::Value SwitchTarget(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // 验证参数
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "参数错误: 需要新的进程ID")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    audio_capture::CaptureOptions options;
+    uint32_t crossfadeMs = 0;
+    if (info.Length() > 1) {
+      if (!ParseCaptureOptions(env, info[1], &options)) {
+        return env.Null();
+      }
+      if (info[1].IsObject()) {
+        Napi::Value crossfade = info[1].As<Napi::Object>().Get("crossfadeMs");
+        if (!crossfade.IsUndefined()) {
+          if (!crossfade.IsNumber() ||
+              crossfade.As<Napi::Number>().DoubleValue() < 0) {
+            Napi::TypeError::New(env, "参数错误: crossfadeMs 必须是非负数")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+          }
+          crossfadeMs = crossfade.As<Napi::Number>().Uint32Value();
+        }
+      }
+    }
+
+    uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
+
+    if (start_pending_ || switch_pending_ || IsMixing() ||
+        !capture_->IsCapturing() || !switcher_) {
+      Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+      Napi::Error error =
+          Napi::Error::New(env, "当前会话没有在捕获或正在切换目标");
+      error.Set("code", Napi::String::New(env, "ERR_CAPTURE_BUSY"));
+      deferred.Reject(error.Value());
+      return deferred.Promise();
+    }
+
+    options.idle_suspend = idle_;
+    options.trace_session = session_id_;
+    standby_ = CreateCapture();
+    switch_pending_ = true;
+
+    auto *worker = new SwitchTargetWorker(this, pid, crossfadeMs, options);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+  }
+
+  // 进程ID 0 是会议捕获中麦克风音频源的标识，不能作为混音源的进程ID
+  static bool CheckMixSourcePid(Napi::Env env, uint32_t pid) {
+    if (pid == kMicrophoneSourceId) {
+      Napi::TypeError::New(env, "参数错误: 无效的进程ID")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    return true;
+  }
+
+  // 解析混音源参数：进程ID或 { pid, gain?, muted? }
+  static bool ParseMixSource(Napi::Env env, Napi::Value value, uint32_t *pid,
+                             float *gain, bool *muted) {
+    if (value.IsNumber()) {
+      *pid = value.As<Napi::Number>().Uint32Value();
+      return CheckMixSourcePid(env, *pid);
+    }
+
+    if (value.IsObject()) {
+      Napi::Object object = value.As<Napi::Object>();
+      Napi::Value pidValue = object.Get("pid");
+      Napi::Value gainValue = object.Get("gain");
+      Napi::Value mutedValue = object.Get("muted");
+      if (pidValue.IsNumber() &&
+          (gainValue.IsUndefined() || gainValue.IsNumber())) {
+        *pid = pidValue.As<Napi::Number>().Uint32Value();
+        if (gainValue.IsNumber()) {
+          *gain = gainValue.As<Napi::Number>().FloatValue();
+        }
+        *muted = mutedValue.ToBoolean().Value();
+        return CheckMixSourcePid(env, *pid);
+      }
+    }
+
+    Napi::TypeError::New(env,
+                         "参数错误: 混音源必须是进程ID或 { pid, gain?, muted? }")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+
+  // 开始混音捕获：同时捕获多个进程，在原生侧混成一路立体声
+  // 参数 (sources, callback)，sources为进程ID或 { pid, gain?, muted? } 的数组
+  Napi::Value StartMixCapture(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // 验证参数
+    if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsFunction()) {
+      Napi::TypeError::New(env, "参数错误: 需要混音源数组和回调函数")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    Napi::Array sources = info[0].As<Napi::Array>();
+    std::vector<std::tuple<uint32_t, float, bool>> parsed;
+    for (uint32_t i = 0; i < sources.Length(); i++) {
+      uint32_t pid = 0;
+      float gain = 1.0f;
+      bool muted = false;
+      if (!ParseMixSource(env, sources.Get(i), &pid, &gain, &muted)) {
+        return env.Null();
+      }
+      parsed.emplace_back(pid, gain, muted);
+    }
+
+    if (IsBusy()) {
+      return Napi::Boolean::New(env, false);
+    }
+
+    mixer_ = std::make_unique<audio_capture::AudioMixer>(
+        [this]() { return CreateCapture(); }, 48000, 480, 0, session_id_);
+    if (!mixer_->Start(MakeOutput(env, info[1].As<Napi::Function>()))) {
+      mixer_.reset();
+      ReleaseCallback();
+      return Napi::Boolean::New(env, false);
+    }
+
+    for (const auto &source : parsed) {
+      mixer_->AddSource(std::get<0>(source), std::get<1>(source),
+                        std::get<2>(source));
+    }
+
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 开始会议捕获：同时捕获目标进程和输入设备，按时间对齐后输出
+  // 参数 (pid, options, callback)，options为 { device?, output?: "mix" | "stems" }
+  // stems模式输出4声道：前两个声道为进程音频，后两个为麦克风（单声道麦克风复制到两侧）
+  // 两个音频源在混音源中分别以进程ID和 kMicrophoneSourceId 标识
+  Napi::Value StartMeetingCapture(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // 验证参数
+    if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsObject() ||
+        !info[2].IsFunction()) {
+      Napi::TypeError::New(env, "参数错误: 需要进程ID、配置对象和回调函数")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
+    Napi::Object options = info[1].As<Napi::Object>();
+    Napi::Value device = options.Get("device");
+    Napi::Value output = options.Get("output");
+    std::string output_mode =
+        output.IsString() ? output.As<Napi::String>().Utf8Value() : "mix";
+    if (!(device.IsUndefined() || device.IsString()) ||
+        !(output.IsUndefined() || output.IsString()) ||
+        (output_mode != "mix" && output_mode != "stems")) {
+      Napi::TypeError::New(env, "参数错误: 会议捕获配置必须是 { device?: "
+                                "string, output?: \"mix\" | \"stems\" }")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (pid == kMicrophoneSourceId) {
+      Napi::TypeError::New(env, "参数错误: 无效的进程ID")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    std::string device_id =
+        device.IsString() ? device.As<Napi::String>().Utf8Value() : "";
+
+    if (IsBusy()) {
+      return Napi::Boolean::New(env, false);
+    }
+
+    // 两个音频源复用混音器的对齐、漂移校正和重试，分轨模式各占一个立体声轨道
+    bool stems = output_mode == "stems";
+    mixer_ = std::make_unique<audio_capture::AudioMixer>(
+        [this]() { return CreateCapture(); }, 48000, 480, stems ? 2 : 0,
+        session_id_);
+    Napi::Function callback = info[2].As<Napi::Function>();
+    if (!mixer_->Start(MakeOutput(env, callback))) {
+      mixer_.reset();
+      ReleaseCallback();
+      return Napi::Boolean::New(env, false);
+    }
+
+    mixer_->AddSource(pid, 1.0f, false, nullptr, 0);
+    mixer_->AddSource(
+        kMicrophoneSourceId, 1.0f, false,
+        [this, device_id]() { return CreateInputCapture(device_id); },
+        stems ? 1 : 0);
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 向正在运行的混音会话添加音频源
+  Napi::Value AddMixSource(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint32_t pid = 0;
+    float gain = 1.0f;
+    bool muted = false;
+    if (info.Length() < 1 ||
+        !ParseMixSource(env, info[0], &pid, &gain, &muted)) {
+      if (!env.IsExceptionPending()) {
+        Napi::TypeError::New(env, "参数错误: 需要混音源")
+            .ThrowAsJavaScriptException();
+      }
+      return env.Null();
+    }
+
+    bool result = IsMixing() && mixer_->AddSource(pid, gain, muted);
+    return Napi::Boolean::New(env, result);
+  }
+
+  // 从混音会话中移除音频源
+  Napi::Value RemoveMixSource(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "参数错误: 需要进程ID")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
+    bool result = IsMixing() && mixer_->RemoveSource(pid);
+    return Napi::Boolean::New(env, result);
+  }
+
+  // 设置混音源的增益
+  Napi::Value SetMixSourceGain(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+      Napi::TypeError::New(env, "参数错误: 需要进程ID和增益")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
+    float gain = info[1].As<Napi::Number>().FloatValue();
+    bool result = IsMixing() && mixer_->SetGain(pid, gain);
+    return Napi::Boolean::New(env, result);
+  }
+
+  // 设置混音源是否静音
+  Napi::Value SetMixSourceMuted(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "参数错误: 需要进程ID和静音状态")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
+    bool muted = info[1].ToBoolean().Value();
+    bool result = IsMixing() && mixer_->SetMuted(pid, muted);
+    return Napi::Boolean::New(env, result);
+  }
+
+  // 获取混音源的状态
+  Napi::Value GetMixSources(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    std::vector<audio_capture::MixSourceInfo> sources;
+    if (mixer_) {
+      sources = mixer_->GetSources();
+    }
+
+    Napi::Array result = Napi::Array::New(env, sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+      const auto &s = sources[i];
+      Napi::Object source = Napi::Object::New(env);
+      source.Set("pid", Napi::Number::New(env, s.pid));
+      source.Set("gain", Napi::Number::New(env, s.gain));
+      source.Set("muted", Napi::Boolean::New(env, s.muted));
+      source.Set("state", Napi::String::New(env, s.state));
+      source.Set("underruns",
+                 Napi::Number::New(env, static_cast<double>(s.underruns)));
+      source.Set("driftPpm", Napi::Number::New(env, s.drift_ppm));
+      result.Set(i, source);
+    }
+
+    return result;
+  }
+
+  // 获取进程内唯一的会话ID
+  Napi::Value GetSessionId(const Napi::CallbackInfo &info) {
+    return Napi::Number::New(info.Env(), session_id_);
+  }
+
+  // 取消正在进行的startCaptureAsync，返回是否有待取消的启动
+  Napi::Value CancelStart(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    bool pending = start_pending_ && cancel_flag_;
+    if (pending) {
+      cancel_flag_->store(true);
+    }
+    return Napi::Boolean::New(env, pending);
+  }
+
+  // 解析处理图节点声明 { id, type, input?, path?, offThread?, ...数值参数 }
+  static bool ParseGraphNode(Napi::Env env, Napi::Value value,
+                             audio_capture::GraphNodeSpec *spec) {
+    if (value.IsObject()) {
+      Napi::Object object = value.As<Napi::Object>();
+      Napi::Value id = object.Get("id");
+      Napi::Value type = object.Get("type");
+      Napi::Value input = object.Get("input");
+      Napi::Value path = object.Get("path");
+      if (id.IsString() && type.IsString() &&
+          (input.IsUndefined() || input.IsString()) &&
+          (path.IsUndefined() || path.IsString())) {
+        spec->id = id.As<Napi::String>().Utf8Value();
+        spec->type = type.As<Napi::String>().Utf8Value();
+        if (input.IsString()) {
+          spec->input = input.As<Napi::String>().Utf8Value();
+        }
+        if (path.IsString()) {
+          spec->path = path.As<Napi::String>().Utf8Value();
+        }
+        spec->off_thread = object.Get("offThread").ToBoolean().Value();
+
+        // 其余数值和布尔属性作为节点参数（sampleRate、channels、int16等）
+        Napi::Array names = object.GetPropertyNames();
+        for (uint32_t i = 0; i < names.Length(); ++i) {
+          std::string name = names.Get(i).ToString().Utf8Value();
+          Napi::Value param = object.Get(name);
+          if (param.IsNumber()) {
+            spec->params[name] = param.As<Napi::Number>().DoubleValue();
+          } else if (param.IsBoolean() && name != "offThread") {
+            spec->params[name] = param.As<Napi::Boolean>().Value() ? 1 : 0;
+          }
+        }
+        return true;
+      }
+    }
+
+    Napi::TypeError::New(env, "参数错误: 处理图节点必须是 { id, type, input?, "
+                              "path?, offThread?, ...参数 }")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+
+  // 声明会话的处理图，正在投递时立即替换，否则在下一次开始捕获时生效
+  // 参数为节点声明数组，传入null或空数组时取消处理图
+  Napi::Value SetProcessingGraph(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 ||
+        !(info[0].IsArray() || info[0].IsNull() || info[0].IsUndefined())) {
+      Napi::TypeError::New(env, "参数错误: 需要处理图节点数组")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    std::vector<audio_capture::GraphNodeSpec> specs;
+    if (info[0].IsArray()) {
+      Napi::Array array = info[0].As<Napi::Array>();
+      specs.resize(array.Length());
+      for (uint32_t i = 0; i < array.Length(); ++i) {
+        if (!ParseGraphNode(env, array.Get(i), &specs[i])) {
+          return env.Null();
+        }
+      }
+    }
+
+    // 构建一次以校验声明（只实例化节点，不启动工作线程）
+    std::string error;
+    if (!specs.empty() &&
+        !audio_capture::ProcessingGraph::Build(specs, nullptr, &error)) {
+      Napi::TypeError::New(env, "处理图无效: " + error)
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    graph_specs_ = std::move(specs);
+    if (graph_slot_) {
+      graph_slot_->Replace(BuildGraph(graph_specs_));
+    }
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 配置投递给JS的自适应合并 { minLatencyMs?, maxLatencyMs? }，null关闭
+  // 每批的音频时长在两者之间按事件循环的负载调整，捕获过程中调用时立即生效
+  Napi::Value SetDeliveryBatching(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    double minMs = 0;
+    double maxMs = 0;
+    if (info.Length() > 0 && info[0].IsObject()) {
+      Napi::Object options = info[0].As<Napi::Object>();
+      Napi::Value min = options.Get("minLatencyMs");
+      Napi::Value max = options.Get("maxLatencyMs");
+      if (!(min.IsUndefined() || min.IsNumber()) ||
+          !(max.IsUndefined() || max.IsNumber())) {
+        Napi::TypeError::New(env, "参数错误: minLatencyMs 和 maxLatencyMs 必须是数字")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      minMs = min.IsNumber() ? min.As<Napi::Number>().DoubleValue() : 0;
+      maxMs = max.IsNumber() ? max.As<Napi::Number>().DoubleValue()
+                             : std::max(minMs, 100.0);
+      if (!(minMs >= 0) || !(maxMs > 0) || maxMs > 1000 || minMs > maxMs) {
+        Napi::TypeError::New(env, "参数错误: 需要 0 <= minLatencyMs <= "
+                                  "maxLatencyMs <= 1000，且 maxLatencyMs > 0")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    } else if (info.Length() > 0 && !info[0].IsNull() &&
+               !info[0].IsUndefined()) {
+      Napi::TypeError::New(env, "参数错误: 需要合并配置对象或null")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    batch_min_ms_ = minMs;
+    batch_max_ms_ = maxMs;
+    if (batcher_) {
+      batcher_->Configure(batch_min_ms_, batch_max_ms_);
+    }
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 配置电平触发 { thresholdDb?, preRollMs?, holdMs? }，null关闭
+  // 启用后只在电平超过阈值时输出（含预录数据），捕获过程中调用时立即生效
+  Napi::Value SetLevelTrigger(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() > 0 && info[0].IsObject()) {
+      Napi::Object options = info[0].As<Napi::Object>();
+      audio_capture::LevelTriggerOptions parsed;
+      struct Field {
+        const char *name;
+        double min;
+        double max;
+        const char *range;
+        double value;
+      } fields[] = {
+          {"thresholdDb", -120, 0, "-120~0", parsed.threshold_db},
+          {"preRollMs", 0, 30000, "0~30000",
+           static_cast<double>(parsed.pre_roll_ms)},
+          {"holdMs", 0, 600000, "0~600000",
+           static_cast<double>(parsed.hold_ms)},
+      };
+      for (Field &field : fields) {
+        Napi::Value value = options.Get(field.name);
+        if (value.IsUndefined()) {
+          continue;
+        }
+        double number =
+            value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : NAN;
+        if (!(number >= field.min && number <= field.max)) {
+          Napi::TypeError::New(env, std::string("参数错误: ") + field.name +
+                                        " 必须在 " + field.range + " 之间")
+              .ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        field.value = number;
+      }
+      parsed.threshold_db = static_cast<float>(fields[0].value);
+      parsed.pre_roll_ms = static_cast<uint32_t>(fields[1].value);
+      parsed.hold_ms = static_cast<uint32_t>(fields[2].value);
+
+      trigger_options_ = parsed;
+      trigger_enabled_ = true;
+      if (trigger_) {
+        trigger_->Configure(trigger_options_);
+      }
+    } else if (info.Length() > 0 && !info[0].IsNull() &&
+               !info[0].IsUndefined()) {
+      Napi::TypeError::New(env, "参数错误: 需要电平触发配置对象或null")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    } else {
+      trigger_enabled_ = false;
+      if (trigger_) {
+        trigger_->Disable();
+      }
+    }
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 配置空闲挂起 { silenceMs?, probeIntervalMs? }，null关闭
+  // 只对平台捕获（Linux、Windows）生效，捕获过程中调用时立即生效
+  Napi::Value SetIdleSuspend(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() > 0 && info[0].IsObject()) {
+      Napi::Object options = info[0].As<Napi::Object>();
+      audio_capture::IdleSuspendOptions parsed;
+      struct Field {
+        const char *name;
+        double min;
+        double max;
+        const char *range;
+        uint32_t *value;
+      } fields[] = {
+          {"silenceMs", 1000, 86400000, "1000~86400000", &parsed.silence_ms},
+          {"probeIntervalMs", 100, 600000, "100~600000",
+           &parsed.probe_interval_ms},
+      };
+      for (const Field &field : fields) {
+        Napi::Value value = options.Get(field.name);
+        if (value.IsUndefined()) {
+          continue;
+        }
+        double number =
+            value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : NAN;
+        if (!(number >= field.min && number <= field.max)) {
+          Napi::TypeError::New(env, std::string("参数错误: ") + field.name +
+                                        " 必须在 " + field.range + " 之间")
+              .ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        *field.value = static_cast<uint32_t>(number);
+      }
+      idle_->Configure(parsed);
+    } else if (info.Length() > 0 && !info[0].IsNull() &&
+               !info[0].IsUndefined()) {
+      Napi::TypeError::New(env, "参数错误: 需要空闲挂起配置对象或null")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    } else {
+      idle_->Disable();
+    }
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 获取处理图中所有电平表的读数 [{ id, peak, rms }]
+  Napi::Value GetGraphMeters(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    std::vector<audio_capture::MeterReading> meters;
+    if (graph_slot_ && graph_slot_->Current()) {
+      meters = graph_slot_->Current()->GetMeters();
+    }
+
+    Napi::Array result = Napi::Array::New(env, meters.size());
+    for (size_t i = 0; i < meters.size(); ++i) {
+      Napi::Object item = Napi::Object::New(env);
+      item.Set("id", Napi::String::New(env, meters[i].id));
+      item.Set("peak", Napi::Number::New(env, meters[i].peak));
+      item.Set("rms", Napi::Number::New(env, meters[i].rms));
+      result.Set(static_cast<uint32_t>(i), item);
+    }
+    return result;
+  }
+
+  // 获取当前捕获格式的声道布局，启动或切换尚未完成时为空
+  Napi::Value GetChannelLayout(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    audio_capture::ChannelLayout layout;
+    if (IsMixing()) {
+      // 混音输出为立体声，分轨输出的其余轨道记为AUX
+      layout = mixer_->GetChannelLayout();
+    } else if (!start_pending_ && !switch_pending_) {
+      layout = capture_->GetChannelLayout();
+    }
+
+    Napi::Array result = Napi::Array::New(env, layout.size());
+    for (size_t i = 0; i < layout.size(); ++i) {
+      result.Set(static_cast<uint32_t>(i), Napi::String::New(env, layout[i]));
+    }
+    return result;
+  }
+
+  // 获取进程级DSP线程池的统计（所有会话共享），
+  // 线程池尚未创建时返回全零，查询统计不应顺带创建工作线程
+  Napi::Value GetDspPoolStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    audio_capture::DspPoolStats stats{};
+    if (audio_capture::DspPool *pool =
+            audio_capture::DspPool::SharedIfCreated()) {
+      stats = pool->GetStats();
+    }
+
+    auto number = [&env](uint64_t value) {
+      return Napi::Number::New(env, static_cast<double>(value));
+    };
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("workers", number(stats.workers));
+    result.Set("jobs", number(stats.jobs));
+    result.Set("steals", number(stats.steals));
+    result.Set("queueDepth", number(stats.queue_depth));
+    result.Set("maxQueueDepth", number(stats.max_queue_depth));
+    result.Set("dropped", number(stats.dropped));
+    return result;
+  }
+
+  // 停止捕获
+  Napi::Value StopCapture(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // 后端准备仍在工作线程中进行，只能请求取消
+    if (start_pending_) {
+      cancel_flag_->store(true);
+      return Napi::Boolean::New(env, false);
+    }
+
+    // 切换目标期间（例如旧音频源结束时）撤销切换并停止，
+    // 工作线程仍持有的音频源由它在收尾时停止
+    if (switch_pending_) {
+      if (switch_stopped_) {
+        return Napi::Boolean::New(env, false);
+      }
+      switch_stopped_ = true;
+
+      if (standby_) {
+        // 新音频源还在准备，当前音频源是唯一的数据来源，直接停止并释放
+        bool result = capture_->StopCapture();
+        ReleaseCallback();
+        return Napi::Boolean::New(env, result);
+      }
+
+      // 新音频源已经启动：撤销切换让退役线程立即停止旧音频源，
+      // 旧音频源停止前仍可能投递数据，TSFN由RetireWorker收尾时释放
+      if (ended_armed_) {
+        ended_armed_->store(false);
+      }
+      switcher_->CancelSwitch();
+      bool result = capture_->StopCapture();
+      return Napi::Boolean::New(env, result);
+    }
+
+    if (IsMixing()) {
+      mixer_->Stop();
+      mixer_.reset();
+      ReleaseCallback();
+      return Napi::Boolean::New(env, true);
+    }
+
+    bool result = false;
+    try {
+      result = capture_->StopCapture();
+    } catch (const std::exception &e) {
+      // 确保即使发生异常也能释放资源
+    }
+
+    // 释放线程安全函数
+    ReleaseCallback();
+
+    return Napi::Boolean::New(env, result);
+  }
+
+  // 检查是否正在捕获
+  Napi::Value IsCapturing(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    bool result = IsMixing() || capture_->IsCapturing();
+    return Napi::Boolean::New(env, result);
+  }
+
+  // 获取当前会话的统计数据
+  Napi::Value GetStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    const audio_capture::CaptureStats &stats = *stats_;
+
+    auto toMs = [](uint64_t ns) { return static_cast<double>(ns) / 1e6; };
+
+    Napi::Object latency = Napi::Object::New(env);
+    latency.Set("p50", Napi::Number::New(
+                           env, toMs(stats.callback_latency.Percentile(50))));
+    latency.Set("p90", Napi::Number::New(
+                           env, toMs(stats.callback_latency.Percentile(90))));
+    latency.Set("p99", Napi::Number::New(
+                           env, toMs(stats.callback_latency.Percentile(99))));
+    latency.Set("max",
+                Napi::Number::New(env, toMs(stats.callback_latency.Max())));
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("packets", Napi::Number::New(
+                              env, static_cast<double>(stats.packets.load())));
+    result.Set("frames", Napi::Number::New(
+                             env, static_cast<double>(stats.frames.load())));
+    result.Set("delivered",
+               Napi::Number::New(env,
+                                 static_cast<double>(stats.delivered.load())));
+    result.Set("dropped", Napi::Number::New(
+                              env, static_cast<double>(stats.dropped.load())));
+    result.Set("callbackLatency", latency);
+    // 实际的捕获周期：最近一个数据包的帧数及其时长
+    uint64_t periodFrames = stats.period_frames.load();
+    uint64_t sampleRate = stats.format.load() & 0xffffffffu;
+    result.Set("periodFrames",
+               Napi::Number::New(env, static_cast<double>(periodFrames)));
+    result.Set("periodMs",
+               Napi::Number::New(env, sampleRate > 0
+                                          ? periodFrames * 1000.0 / sampleRate
+                                          : 0.0));
+    result.Set("formatChanges",
+               Napi::Number::New(
+                   env, static_cast<double>(stats.format_changes.load())));
+    uint64_t graphDropped = 0;
+    audio_capture::StageCost denoise;
+    if (graph_slot_ && graph_slot_->Current()) {
+      graphDropped = graph_slot_->Current()->DroppedBlocks();
+      denoise = graph_slot_->Current()->DenoiseCost();
+    }
+    result.Set("graphDropped",
+               Napi::Number::New(env, static_cast<double>(graphDropped)));
+    // 降噪节点的处理耗时和处理的音频时长，两者之比即每路流的CPU占用
+    result.Set("denoiseCpuMs", Napi::Number::New(env, toMs(denoise.cpu_ns)));
+    result.Set("denoiseAudioMs",
+               Napi::Number::New(env, toMs(denoise.audio_ns)));
+    // 电平触发是否正在输出（未启用时总是true）
+    result.Set("triggerActive",
+               Napi::Boolean::New(env, !trigger_ || trigger_->IsActive()));
+    // 空闲挂起：是否挂起、挂起和探测次数，以及空闲期间的唤醒次数、CPU耗时和总时长
+    audio_capture::IdleSuspend::Snapshot idle = idle_->GetSnapshot();
+    result.Set("idle", Napi::Boolean::New(env, idle.idle));
+    result.Set("idleSuspensions",
+               Napi::Number::New(env, static_cast<double>(idle.suspensions)));
+    result.Set("idleProbes",
+               Napi::Number::New(env, static_cast<double>(idle.probes)));
+    result.Set("idleWakeups",
+               Napi::Number::New(env, static_cast<double>(idle.wakeups)));
+    result.Set("idleCpuMs", Napi::Number::New(env, toMs(idle.cpu_ns)));
+    result.Set("idleMs", Napi::Number::New(env, toMs(idle.idle_ns)));
+    // 自适应合并当前的批时长，未启用时为0
+    result.Set("batchMs",
+               Napi::Number::New(env, batcher_ ? batcher_->BatchMs() : 0.0));
+
+    // 从startCapture调用到收到第一个数据包的耗时，尚未收到时为-1
+    uint64_t startNs = stats.start_ns.load();
+    uint64_t firstFrameNs = stats.first_frame_ns.load();
+    result.Set("firstFrameLatency",
+               Napi::Number::New(env, firstFrameNs >= startNs && startNs != 0
+                                          ? toMs(firstFrameNs - startNs)
+                                          : -1.0));
+    return result;
+  }
+
+  // 开始记录trace
+  Napi::Value StartTracing(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    bool result = audio_capture::trace::Start();
+    return Napi::Boolean::New(env, result);
+  }
+
+  // 停止记录trace并导出为Chrome trace JSON文件
+  Napi::Value StopTracing(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // 验证参数
+    if (info.Length() < 1 || !info[0].IsString()) {
+      Napi::TypeError::New(env, "参数错误: 需要输出文件路径")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    if (!audio_capture::trace::IsEnabled()) {
+      return Napi::Boolean::New(env, false);
+    }
+
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    std::string error;
+    if (!audio_capture::trace::Stop(path, &error)) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 开启进程级指标记录，可选参数 { socket?, port? } 同时在本地应答抓取
+  // 已开启时按新的参数重新应答，监听失败时抛出异常
+  Napi::Value StartMetrics(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    std::string socketPath;
+    int port = 0;
+    if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNull()) {
+      if (!info[0].IsObject()) {
+        Napi::TypeError::New(env, "参数错误: 指标配置必须是对象")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      Napi::Object options = info[0].As<Napi::Object>();
+      Napi::Value socket = options.Get("socket");
+      Napi::Value portValue = options.Get("port");
+      if (!(socket.IsUndefined() || socket.IsString()) ||
+          !(portValue.IsUndefined() || portValue.IsNumber())) {
+        Napi::TypeError::New(env, "参数错误: 需要 { socket?: string, port?: number }")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      if (socket.IsString()) {
+        socketPath = socket.As<Napi::String>().Utf8Value();
+      }
+      if (portValue.IsNumber()) {
+        double value = portValue.As<Napi::Number>().DoubleValue();
+        if (value < 1 || value > 65535 || value != static_cast<int>(value)) {
+          Napi::TypeError::New(env, "参数错误: port 必须是 1~65535 的整数")
+              .ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        port = static_cast<int>(value);
+      }
+      if (!socketPath.empty() && port != 0) {
+        Napi::TypeError::New(env, "参数错误: socket 和 port 只能指定一个")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    }
+
+    if (!socketPath.empty() || port != 0) {
+      std::string error;
+      if (!audio_capture::metrics::Serve(socketPath, port, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    }
+    audio_capture::metrics::Enable(true);
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 停止记录指标和应答抓取（保留已有的累计值），未开启时返回false
+  Napi::Value StopMetrics(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    bool wasEnabled = audio_capture::metrics::IsEnabled();
+    audio_capture::metrics::StopServing();
+    audio_capture::metrics::Enable(false);
+    return Napi::Boolean::New(env, wasEnabled);
+  }
+
+  // 按OpenMetrics文本格式导出进程级指标
+  Napi::Value GetMetricsText(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    return Napi::String::New(env, audio_capture::metrics::Render());
+  }
+
+  // 开始录制本会话每个数据包的到达时间、帧数和格式（不含PCM）
+  // 可选参数为最多记录的数据包数
+  Napi::Value StartCadenceRecording(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    size_t capacity = audio_capture::CadenceRecorder::kDefaultCapacity;
+    if (info.Length() > 0 && !info[0].IsUndefined()) {
+      if (!info[0].IsNumber() || info[0].As<Napi::Number>().Int64Value() <= 0) {
+        Napi::TypeError::New(env, "参数错误: 最大数据包数必须是正数")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      capacity =
+          static_cast<size_t>(info[0].As<Napi::Number>().Int64Value());
+    }
+
+    return Napi::Boolean::New(env, cadence_->Start(capacity));
+  }
+
+  // 停止录制回调节奏并写出文件，未在录制时返回false
+  Napi::Value StopCadenceRecording(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // 验证参数
+    if (info.Length() < 1 || !info[0].IsString()) {
+      Napi::TypeError::New(env, "参数错误: 需要输出文件路径")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    if (!cadence_->IsRecording()) {
+      return Napi::Boolean::New(env, false);
+    }
+
+    std::string error;
+    if (!cadence_->Stop(info[0].As<Napi::String>().Utf8Value(), &error)) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    return Napi::Boolean::New(env, true);
+  }
+
+  // 获取音频线程实时作用域内的违规统计（仅在rt_check构建中有数据）
+  Napi::Value GetRealtimeViolations(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    bool reset = info.Length() > 0 && info[0].ToBoolean().Value();
+
+    std::vector<audio_capture::rt_check::Violation> violations =
+        audio_capture::rt_check::GetViolations();
+    if (reset) {
+      audio_capture::rt_check::Reset();
+    }
+
+    Napi::Array result = Napi::Array::New(env, violations.size());
+    for (size_t i = 0; i < violations.size(); i++) {
+      const auto &v = violations[i];
+      Napi::Object violation = Napi::Object::New(env);
+      violation.Set("kind", Napi::String::New(
+                                env, audio_capture::rt_check::KindName(v.kind)));
+      violation.Set("location", Napi::String::New(env, v.location));
+      violation.Set("count", Napi::Number::New(env, static_cast<double>(v.count)));
+      result.Set(i, violation);
+    }
+
+    return result;
   }
 };
 
@@ -0,0 +1,614 @@
+#include "../include/audio_mixer.h"
+#include "../include/rt_check.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) ||                                     \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AUDIO_CAPTURE_MIX_SSE 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AUDIO_CAPTURE_MIX_NEON 1
+#endif
+
+/**
+ * @file audio_mixer.cc
+ * @brief 多音频源混音器的实现
+ */
+
+namespace audio_capture {
+
+namespace {
+
+// -3dB，中置和环绕声道分到两侧时的权重
+constexpr float kSurroundGain = 0.70710678f;
+
+// 启动失败的音频源的重试间隔
+constexpr auto kRetryInterval = std::chrono::seconds(1);
+
+// 水位偏差到重采样比的增益，以及水位误差的平滑系数
+constexpr double kDriftGain = 0.002;
+constexpr double kDriftSmoothing = 0.01;
+
+const char *StateName(int state) {
+  switch (state) {
+  case 1:
+    return "priming";
+  case 2:
+    return "running";
+  default:
+    return "waiting";
+  }
+}
+
+// 带增益斜坡地把立体声数据累加到分轨输出中的一个轨道
+void AccumulateStem(float *out, int out_channels, int stem, const float *in,
+                    size_t frames, float from, float to) {
+  const float step = (to - from) / static_cast<float>(frames);
+  float gain = from;
+  float *dst = out + stem * AudioMixer::kChannels;
+  for (size_t frame = 0; frame < frames; ++frame) {
+    gain += step;
+    dst[frame * out_channels] += in[frame * AudioMixer::kChannels] * gain;
+    dst[frame * out_channels + 1] +=
+        in[frame * AudioMixer::kChannels + 1] * gain;
+  }
+}
+
+} // namespace
+
+void StereoDownmix::Configure(int channels) {
+  channels_ = channels;
+  used_ = std::max(0, std::min(channels, kMaxChannels));
+  std::fill(left_, left_ + kMaxChannels, 0.0f);
+  std::fill(right_, right_ + kMaxChannels, 0.0f);
+  if (used_ == 0) {
+    return;
+  }
+  if (used_ == 1) {
+    left_[0] = right_[0] = 1.0f;
+    return;
+  }
+
+  left_[0] = 1.0f;
+  right_[1] = 1.0f;
+  int c = 2;
+  // WAVE 默认布局：3、5声道和6声道以上第三个声道为FC，6声道以上第四个为LFE
+  if (used_ == 3 || used_ >= 5) {
+    left_[c] = right_[c] = kSurroundGain;
+    ++c;
+  }
+  if (used_ >= 6) {
+    ++c;
+  }
+  // 剩余的环绕声道成对出现（左、右），多出的一个是后中置
+  if ((used_ - c) % 2 == 1) {
+    left_[c] = right_[c] = kSurroundGain;
+    ++c;
+  }
+  for (; c + 1 < used_; c += 2) {
+    left_[c] = kSurroundGain;
+    right_[c + 1] = kSurroundGain;
+  }
+
+  float left_sum = 0.0f;
+  float right_sum = 0.0f;
+  for (int i = 0; i < used_; ++i) {
+    left_sum += left_[i];
+    right_sum += right_[i];
+  }
+  for (int i = 0; i < used_; ++i) {
+    left_[i] /= left_sum;
+    right_[i] /= right_sum;
+  }
+}
+
+void MixAccumulate(float *out, const float *in, size_t count, float gain) {
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_MIX_SSE)
+  const __m128 g = _mm_set1_ps(gain);
+  for (; i + 4 <= count; i += 4) {
+    __m128 acc = _mm_loadu_ps(out + i);
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(in + i), g));
+    _mm_storeu_ps(out + i, acc);
+  }
+#elif defined(AUDIO_CAPTURE_MIX_NEON)
+  const float32x4_t g = vdupq_n_f32(gain);
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(in + i), g));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] += in[i] * gain;
+  }
+}
+
+void MixAccumulateRamp(float *out, const float *in, size_t frames, int channels,
+                       float from, float to) {
+  if (from == to) {
+    MixAccumulate(out, in, frames * channels, to);
+    return;
+  }
+
+  const float step = (to - from) / static_cast<float>(frames);
+  float gain = from;
+  for (size_t frame = 0; frame < frames; ++frame) {
+    gain += step;
+    for (int c = 0; c < channels; ++c) {
+      out[frame * channels + c] += in[frame * channels + c] * gain;
+    }
+  }
+}
+
+AudioMixer::AudioMixer(CaptureFactory factory, int sample_rate,
+                       int period_frames, int stems, uint32_t session)
+    : factory_(std::move(factory)), session_(session),
+      sample_rate_(sample_rate),
+      period_frames_(period_frames), stems_(std::max(stems, 0)),
+      out_channels_(stems_ > 0 ? stems_ * kChannels : kChannels),
+      // 目标延迟需要覆盖各后端一次回调的帧数（PipeWire最多约1024帧）
+      target_fill_(std::max<size_t>(static_cast<size_t>(period_frames) * 3,
+                                    1536)) {}
+
+AudioMixer::~AudioMixer() { Stop(); }
+
+bool AudioMixer::Start(AudioDataCallback callback) {
+  if (running_ || !callback) {
+    return false;
+  }
+
+  callback_ = std::move(callback);
+  mix_buffer_.assign(static_cast<size_t>(period_frames_) * out_channels_,
+                     0.0f);
+  read_buffer_.assign(static_cast<size_t>(period_frames_) * kChannels, 0.0f);
+
+  running_ = true;
+  mix_thread_ = std::thread(&AudioMixer::MixThreadProc, this);
+  supervisor_thread_ = std::thread(&AudioMixer::SupervisorThreadProc, this);
+  return true;
+}
+
+bool AudioMixer::Stop() {
+  if (!running_.exchange(false)) {
+    return false;
+  }
+
+  WakeSupervisor();
+  if (supervisor_thread_.joinable()) {
+    supervisor_thread_.join();
+  }
+  if (mix_thread_.joinable()) {
+    mix_thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(control_mutex_);
+  for (auto &slot : sources_) {
+    Source *source = slot.exchange(nullptr);
+    if (source) {
+      if (source->capture) {
+        source->capture->StopCapture();
+      }
+      delete source;
+    }
+  }
+
+  callback_ = nullptr;
+  return true;
+}
+
+bool AudioMixer::AddSource(uint32_t pid, float gain, bool muted,
+                           CaptureFactory factory, int stem) {
+  if (!running_ || stem < 0 || (stems_ > 0 && stem >= stems_)) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (FindSource(pid)) {
+      return false;
+    }
+
+    auto free_slot = std::find_if(
+        sources_.begin(), sources_.end(),
+        [](const std::atomic<Source *> &slot) { return !slot.load(); });
+    if (free_slot == sources_.end()) {
+      return false;
+    }
+
+    auto *source = new Source();
+    source->pid = pid;
+    source->gain = gain;
+    source->muted = muted;
+    source->factory = std::move(factory);
+    source->stem = stem;
+    source->ring.assign(kRingFrames * kChannels, 0.0f);
+    free_slot->store(source, std::memory_order_release);
+  }
+
+  // 后端准备可能阻塞数秒，交给后台线程启动
+  WakeSupervisor();
+  return true;
+}
+
+bool AudioMixer::RemoveSource(uint32_t pid) {
+  Source *source = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    for (auto &slot : sources_) {
+      Source *candidate = slot.load();
+      if (candidate && candidate->pid == pid) {
+        source = candidate;
+        // 与混音线程对tick_和槽位的访问保持顺序一致，见 WaitForTick
+        slot.store(nullptr);
+        break;
+      }
+    }
+    if (!source) {
+      return false;
+    }
+
+    // 后台线程正在启动它，由后台线程在启动结束后释放
+    if (source->busy) {
+      source->removed = true;
+      return true;
+    }
+  }
+
+  // 等混音线程不再引用它之后再释放
+  WaitForTick();
+  if (source->capture) {
+    source->capture->StopCapture();
+  }
+  delete source;
+  return true;
+}
+
+bool AudioMixer::SetGain(uint32_t pid, float gain) {
+  std::lock_guard<std::mutex> lock(control_mutex_);
+  Source *source = FindSource(pid);
+  if (!source) {
+    return false;
+  }
+  source->gain.store(gain);
+  return true;
+}
+
+bool AudioMixer::SetMuted(uint32_t pid, bool muted) {
+  std::lock_guard<std::mutex> lock(control_mutex_);
+  Source *source = FindSource(pid);
+  if (!source) {
+    return false;
+  }
+  source->muted.store(muted);
+  return true;
+}
+
+std::vector<MixSourceInfo> AudioMixer::GetSources() const {
+  std::lock_guard<std::mutex> lock(control_mutex_);
+  std::vector<MixSourceInfo> result;
+  for (const auto &slot : sources_) {
+    const Source *source = slot.load();
+    if (!source) {
+      continue;
+    }
+    MixSourceInfo info;
+    info.pid = source->pid;
+    info.gain = source->gain.load();
+    info.muted = source->muted.load();
+    info.state = StateName(source->state.load());
+    info.underruns = source->underruns.load();
+    info.drift_ppm = (source->ratio_adjust.load() - 1.0) * 1e6;
+    result.push_back(info);
+  }
+  return result;
+}
+
+void AudioMixer::WakeSupervisor() {
+  {
+    std::lock_guard<std::mutex> lock(supervisor_mutex_);
+    supervisor_wake_ = true;
+  }
+  supervisor_cv_.notify_all();
+}
+
+ChannelLayout AudioMixer::GetChannelLayout() const {
+  ChannelLayout layout{"FL", "FR"};
+  while (layout.size() < static_cast<size_t>(out_channels_)) {
+    layout.push_back("AUX" + std::to_string(layout.size()));
+  }
+  return layout;
+}
+
+AudioMixer::Source *AudioMixer::FindSource(uint32_t pid) const {
+  for (const auto &slot : sources_) {
+    Source *source = slot.load();
+    if (source && source->pid == pid) {
+      return source;
+    }
+  }
+  return nullptr;
+}
+
+bool AudioMixer::StartSource(Source *source) {
+  // 处于waiting状态时混音线程和回调都不会访问这些字段
+  source->phase = 1.0;
+  source->last[0] = source->last[1] = 0.0f;
+  source->ratio_adjust = 1.0;
+  source->ring_write.store(source->ring_read.load());
+  source->ended.store(false);
+
+  auto capture = source->factory ? source->factory() : factory_();
+  if (!capture) {
+    return false;
+  }
+  // 后端结束时IsCapturing()不一定变化（例如Linux只停用音频流），
+  // 由结束回调通知后台线程停止并重试
+  capture->SetEndedCallback([this, source](const char * /*reason*/) {
+    source->ended.store(true);
+    WakeSupervisor();
+  });
+  // 子音频源的trace事件记录在混音会话下
+  CaptureOptions options;
+  options.trace_session = session_;
+  bool started = capture->StartCapture(
+      source->pid, [this, source](const uint8_t *data, size_t length,
+                                  int channels, int sample_rate) {
+        if (channels <= 0 || sample_rate <= 0) {
+          return;
+        }
+        OnSourceData(source, reinterpret_cast<const float *>(data),
+                     length / (sizeof(float) * channels), channels,
+                     sample_rate);
+      },
+      options);
+  if (!started) {
+    return false;
+  }
+
+  source->capture = std::move(capture);
+  source->state.store(static_cast<int>(SourceState::kPriming),
+                      std::memory_order_release);
+  return true;
+}
+
+void AudioMixer::WaitForTick() {
+  // 调用方已经把音频源从槽位摘除或置为waiting（顺序一致的写），之后开始的
+  // 周期读不到它；tick_为奇数时只需等正在进行的这个周期结束。
+  // 混音线程退出前总会结束当前周期，所以不需要超时，也不看running_
+  const uint64_t tick = tick_.load();
+  if ((tick & 1) == 0) {
+    return;
+  }
+  while (tick_.load() == tick) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void AudioMixer::OnSourceData(Source *source, const float *samples,
+                              size_t frames, int channels, int sample_rate) {
+  AUDIO_CAPTURE_RT_SCOPE();
+
+  // 每个输出帧前进的输入帧数，漂移校正在此基础上微调
+  const double step = static_cast<double>(sample_rate) / sample_rate_ *
+                      source->ratio_adjust.load(std::memory_order_relaxed);
+
+  size_t write = source->ring_write.load(std::memory_order_relaxed);
+  size_t read = source->ring_read.load(std::memory_order_acquire);
+  size_t free_frames = kRingFrames - (write - read);
+  float *ring = source->ring.data();
+
+  if (channels != source->downmix.channels()) {
+    source->downmix.Configure(channels);
+  }
+  const StereoDownmix &downmix = source->downmix;
+
+  // 线性插值重采样，phase坐标中0为上一包的最后一帧，k为本包第k-1帧
+  double phase = source->phase;
+  while (phase < static_cast<double>(frames)) {
+    size_t index = static_cast<size_t>(phase);
+    float frac = static_cast<float>(phase - static_cast<double>(index));
+
+    const float *b = samples + index * channels;
+    float a_left = source->last[0];
+    float a_right = source->last[1];
+    if (index > 0) {
+      downmix.Apply(b - channels, &a_left, &a_right);
+    }
+    float b_left;
+    float b_right;
+    downmix.Apply(b, &b_left, &b_right);
+
+    if (free_frames > 0) {
+      size_t slot = (write & (kRingFrames - 1)) * kChannels;
+      ring[slot] = a_left + (b_left - a_left) * frac;
+      ring[slot + 1] = a_right + (b_right - a_right) * frac;
+      ++write;
+      --free_frames;
+    }
+    phase += step;
+  }
+
+  if (frames > 0) {
+    downmix.Apply(samples + (frames - 1) * channels, &source->last[0],
+                  &source->last[1]);
+  }
+  source->phase = phase - static_cast<double>(frames);
+  source->ring_write.store(write, std::memory_order_release);
+}
+
+void AudioMixer::MixSource(Source *source) {
+  int state = source->state.load();
+  if (state == static_cast<int>(SourceState::kWaiting)) {
+    return;
+  }
+
+  size_t read = source->ring_read.load(std::memory_order_relaxed);
+  size_t write = source->ring_write.load(std::memory_order_acquire);
+  size_t fill = write - read;
+  const size_t period = static_cast<size_t>(period_frames_);
+
+  if (state == static_cast<int>(SourceState::kPriming)) {
+    if (fill < target_fill_) {
+      return;
+    }
+    // 缓冲到目标延迟后加入混音，多余的数据直接跳过，使各音频源延迟一致
+    read = write - target_fill_;
+    fill = target_fill_;
+    source->fill_error = 0.0;
+    source->applied_gain = 0.0f;
+    source->state.store(static_cast<int>(SourceState::kRunning),
+                        std::memory_order_relaxed);
+  }
+
+  if (fill < period) {
+    // 欠载：音频源暂停或已消失，输出静音并重新缓冲
+    source->underruns.fetch_add(1, std::memory_order_relaxed);
+    source->ring_read.store(write, std::memory_order_release);
+    source->ratio_adjust.store(1.0, std::memory_order_relaxed);
+    source->state.store(static_cast<int>(SourceState::kPriming),
+                        std::memory_order_relaxed);
+    return;
+  }
+
+  // 漂移校正：水位高于目标说明音频源时钟偏快，增大步长少产生一些帧
+  double error = (static_cast<double>(fill) - target_fill_) / target_fill_;
+  source->fill_error += (error - source->fill_error) * kDriftSmoothing;
+  double adjust = std::max(-kMaxDriftPpm, std::min(kMaxDriftPpm,
+                                                   source->fill_error *
+                                                       kDriftGain * 1e6));
+  source->ratio_adjust.store(1.0 + adjust / 1e6, std::memory_order_relaxed);
+
+  float *dst = read_buffer_.data();
+  const float *ring = source->ring.data();
+  for (size_t frame = 0; frame < period; ++frame) {
+    size_t slot = ((read + frame) & (kRingFrames - 1)) * kChannels;
+    dst[frame * kChannels] = ring[slot];
+    dst[frame * kChannels + 1] = ring[slot + 1];
+  }
+  source->ring_read.store(read + period, std::memory_order_release);
+
+  float gain = source->muted.load(std::memory_order_relaxed)
+                   ? 0.0f
+                   : source->gain.load(std::memory_order_relaxed);
+  if (stems_ > 0) {
+    AccumulateStem(mix_buffer_.data(), out_channels_, source->stem, dst, period,
+                   source->applied_gain, gain);
+  } else {
+    MixAccumulateRamp(mix_buffer_.data(), dst, period, kChannels,
+                      source->applied_gain, gain);
+  }
+  source->applied_gain = gain;
+}
+
+void AudioMixer::MixThreadProc() {
+  using Clock = std::chrono::steady_clock;
+
+  const auto period = std::chrono::nanoseconds(
+      static_cast<int64_t>(period_frames_) * 1000000000 / sample_rate_);
+
+  trace::RegisterThread();
+  auto deadline = Clock::now();
+  while (running_.load()) {
+    deadline += period;
+    std::this_thread::sleep_until(deadline);
+
+    AUDIO_CAPTURE_RT_SCOPE();
+    trace::ScopedSpan span("mix", session_);
+
+    std::fill(mix_buffer_.begin(), mix_buffer_.end(), 0.0f);
+    // 槽位和状态的读取与 WaitForTick 保持顺序一致
+    tick_.fetch_add(1);
+    for (auto &slot : sources_) {
+      Source *source = slot.load();
+      if (source) {
+        MixSource(source);
+      }
+    }
+    tick_.fetch_add(1, std::memory_order_release);
+
+    callback_(reinterpret_cast<const uint8_t *>(mix_buffer_.data()),
+              mix_buffer_.size() * sizeof(float), out_channels_,
+              sample_rate_);
+  }
+}
+
+void AudioMixer::SupervisorThreadProc() {
+  while (running_.load()) {
+    std::vector<Source *> pending;
+    std::vector<Source *> stopped;
+    {
+      std::lock_guard<std::mutex> lock(control_mutex_);
+      for (auto &slot : sources_) {
+        Source *source = slot.load();
+        if (!source || source->busy) {
+          continue;
+        }
+
+        // 后端已经停止（目标进程退出等），回到等待状态稍后重试
+        const bool ended =
+            source->capture &&
+            (source->ended.load() || !source->capture->IsCapturing());
+        if (ended) {
+          source->state.store(static_cast<int>(SourceState::kWaiting));
+          stopped.push_back(source);
+        }
+
+        if (!source->capture || ended) {
+          source->busy = true;
+          pending.push_back(source);
+        }
+      }
+    }
+
+    // 等待和停止都在锁外进行，避免阻塞JS线程上的增删操作；
+    // busy 的音频源被移除时只做标记，不会在这期间被释放
+    if (!stopped.empty()) {
+      WaitForTick();
+      for (Source *source : stopped) {
+        source->capture->StopCapture();
+        source->capture.reset();
+      }
+    }
+
+    // 失败的下一轮重试
+    for (Source *source : pending) {
+      if (!source->capture) {
+        StartSource(source);
+      }
+    }
+
+    std::vector<Source *> removed;
+    {
+      std::lock_guard<std::mutex> lock(control_mutex_);
+      for (Source *source : pending) {
+        source->busy = false;
+        if (source->removed) {
+          removed.push_back(source);
+        }
+      }
+    }
+
+    // 启动后音频源已经处于kPriming，混音线程本周期可能仍然持有它，
+    // 与 RemoveSource 相同，等它不再被引用后再释放
+    if (!removed.empty()) {
+      WaitForTick();
+      for (Source *source : removed) {
+        if (source->capture) {
+          source->capture->StopCapture();
+        }
+        delete source;
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(supervisor_mutex_);
+    supervisor_cv_.wait_for(lock, kRetryInterval, [this]() {
+      return !running_.load() || supervisor_wake_;
+    });
+    supervisor_wake_ = false;
+  }
+}
+
+} // namespace audio_capture
@@ -0,0 +1,156 @@
+#include "../include/cadence_trace.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+/**
+ * @file cadence_trace.cc
+ * @brief 回调节奏录制和读取的实现
+ */
+
+namespace audio_capture {
+
+namespace {
+
+constexpr uint32_t kVersion = 1;
+
+// 微秒间隔的上限（约71分钟），更长的停顿按上限记录
+constexpr uint64_t kMaxDeltaUs = 0xffffffffu;
+
+} // namespace
+
+bool LoadCadenceTrace(const std::string &path,
+                      std::vector<CadencePacket> *packets,
+                      std::string *error) {
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file) {
+    *error = "无法打开回调节奏文件: " + path;
+    return false;
+  }
+
+  char magic[4];
+  uint32_t header[3];
+  if (std::fread(magic, 1, 4, file) != 4 ||
+      std::fread(header, sizeof(header), 1, file) != 1 ||
+      std::memcmp(magic, "PACD", 4) != 0 || header[0] != kVersion) {
+    std::fclose(file);
+    *error = "不支持的回调节奏文件格式: " + path;
+    return false;
+  }
+
+  packets->clear();
+  packets->reserve(header[1]);
+  uint64_t time_ns = 0;
+  for (uint32_t i = 0; i < header[1]; ++i) {
+    uint32_t record[3];
+    if (std::fread(record, sizeof(record), 1, file) != 1) {
+      break;
+    }
+    time_ns += static_cast<uint64_t>(record[0]) * 1000;
+    int channels = static_cast<int>(record[2] >> 24);
+    int sample_rate = static_cast<int>(record[2] & 0xffffff);
+    if (record[1] == 0 || channels <= 0 || sample_rate <= 0) {
+      continue;
+    }
+    packets->push_back({time_ns, record[1], channels, sample_rate});
+  }
+  std::fclose(file);
+
+  if (packets->empty()) {
+    *error = "回调节奏文件中没有数据包: " + path;
+    return false;
+  }
+  return true;
+}
+
+bool SaveCadenceTrace(const std::string &path,
+                      const std::vector<CadencePacket> &packets,
+                      uint32_t overflow, std::string *error) {
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    *error = "无法创建回调节奏文件: " + path;
+    return false;
+  }
+
+  uint32_t header[3] = {kVersion, static_cast<uint32_t>(packets.size()),
+                        overflow};
+  std::fwrite("PACD", 1, 4, file);
+  std::fwrite(header, sizeof(header), 1, file);
+
+  uint64_t previous_ns = packets.empty() ? 0 : packets.front().time_ns;
+  for (const auto &packet : packets) {
+    // 多个音频线程并发记录时时间可能略微乱序，按0间隔处理
+    uint64_t delta_us =
+        packet.time_ns > previous_ns ? (packet.time_ns - previous_ns) / 1000 : 0;
+    previous_ns = std::max(previous_ns, packet.time_ns);
+    uint32_t record[3] = {
+        static_cast<uint32_t>(std::min(delta_us, kMaxDeltaUs)), packet.frames,
+        static_cast<uint32_t>(packet.channels) << 24 |
+            (static_cast<uint32_t>(packet.sample_rate) & 0xffffff)};
+    std::fwrite(record, sizeof(record), 1, file);
+  }
+
+  bool ok = std::ferror(file) == 0;
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok) {
+    *error = "写入回调节奏文件失败: " + path;
+  }
+  return ok;
+}
+
+bool CadenceRecorder::Start(size_t capacity) {
+  if (enabled_.load() || capacity == 0) {
+    return false;
+  }
+  // 未录制时音频线程不会访问缓冲区
+  entries_.resize(capacity);
+  next_.store(0);
+  enabled_.store(true, std::memory_order_release);
+  return true;
+}
+
+void CadenceRecorder::Record(uint32_t frames, int channels, int sample_rate) {
+  // 先登记再检查开关，Stop在看到writers_归零前不会读取缓冲区
+  writers_.fetch_add(1);
+  if (enabled_.load(std::memory_order_acquire)) {
+    size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+    if (index < entries_.size()) {
+      entries_[index] = {trace::NowNs(), frames,
+                         static_cast<uint32_t>(channels) << 24 |
+                             (static_cast<uint32_t>(sample_rate) & 0xffffff)};
+    }
+  }
+  writers_.fetch_sub(1);
+}
+
+bool CadenceRecorder::Stop(const std::string &path, std::string *error) {
+  if (!enabled_.exchange(false)) {
+    *error = "没有正在进行的回调节奏录制";
+    return false;
+  }
+  while (writers_.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  size_t recorded = next_.load();
+  size_t count = std::min(recorded, entries_.size());
+  std::vector<CadencePacket> packets(count);
+  uint64_t first_ns = count > 0 ? entries_[0].time_ns : 0;
+  for (size_t i = 0; i < count; ++i) {
+    const Entry &entry = entries_[i];
+    packets[i] = {entry.time_ns > first_ns ? entry.time_ns - first_ns : 0,
+                  entry.frames,
+                  static_cast<int>(entry.format >> 24),
+                  static_cast<int>(entry.format & 0xffffff)};
+  }
+
+  // 释放缓冲区，下次Start时重新分配
+  entries_.clear();
+  entries_.shrink_to_fit();
+  return SaveCadenceTrace(path, packets,
+                          static_cast<uint32_t>(recorded - count), error);
+}
+
+} // namespace audio_capture
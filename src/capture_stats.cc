@@ -0,0 +1,117 @@
+#include "../include/capture_stats.h"
+
+/**
+ * @file capture_stats.cc
+ * @brief 捕获会话运行统计的实现
+ */
+
+namespace audio_capture {
+
+size_t LatencyHistogram::BucketIndex(uint64_t ns) {
+  if (ns < kSubBuckets) {
+    return static_cast<size_t>(ns);
+  }
+
+  // 最高位决定所在的2的幂区间，其后3位决定子桶
+  int msb = 63;
+  while (!(ns & (uint64_t{1} << msb))) {
+    --msb;
+  }
+  size_t sub = static_cast<size_t>((ns >> (msb - 3)) & (kSubBuckets - 1));
+  return static_cast<size_t>(msb - 2) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketValue(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+
+  // BucketIndex的逆运算，返回子桶区间的中点
+  size_t msb = index / kSubBuckets + 2;
+  uint64_t sub = index % kSubBuckets;
+  uint64_t lower = (uint64_t{1} << msb) | (sub << (msb - 3));
+  return lower + (uint64_t{1} << (msb - 3)) / 2;
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+  counts_[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t current = max_.load(std::memory_order_relaxed);
+  while (ns > current &&
+         !max_.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::Count() const {
+  uint64_t total = 0;
+  for (const auto &count : counts_) {
+    total += count.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+  uint64_t total = Count();
+  if (total == 0) {
+    return 0;
+  }
+
+  uint64_t target = static_cast<uint64_t>(total * percentile / 100.0);
+  if (target >= total) {
+    target = total - 1;
+  }
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += counts_[i].load(std::memory_order_relaxed);
+    if (seen > target) {
+      uint64_t value = BucketValue(i);
+      uint64_t max = Max();
+      return value < max ? value : max;
+    }
+  }
+  return Max();
+}
+
+void LatencyHistogram::Reset() {
+  for (auto &count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  max_.store(0, std::memory_order_relaxed);
+}
+
+namespace {
+
+// 平滑系数1/8：约十几次回调后跟上负载变化，又不会被单次抖动带偏
+uint64_t Smooth(uint64_t average, uint64_t sample) {
+  return average == 0 ? sample : average - average / 8 + sample / 8;
+}
+
+} // namespace
+
+void CaptureStats::RecordDispatch(uint64_t delay_ns, uint64_t run_ns) {
+  // 只在JS线程写入，不需要读-改-写原子操作
+  dispatch_delay_ns.store(
+      Smooth(dispatch_delay_ns.load(std::memory_order_relaxed), delay_ns),
+      std::memory_order_relaxed);
+  callback_run_ns.store(
+      Smooth(callback_run_ns.load(std::memory_order_relaxed), run_ns),
+      std::memory_order_relaxed);
+}
+
+void CaptureStats::Reset() {
+  packets.store(0, std::memory_order_relaxed);
+  frames.store(0, std::memory_order_relaxed);
+  delivered.store(0, std::memory_order_relaxed);
+  dropped.store(0, std::memory_order_relaxed);
+  callback_latency.Reset();
+  start_ns.store(0, std::memory_order_relaxed);
+  first_frame_ns.store(0, std::memory_order_relaxed);
+  format.store(0, std::memory_order_relaxed);
+  format_changes.store(0, std::memory_order_relaxed);
+  period_frames.store(0, std::memory_order_relaxed);
+  dispatch_delay_ns.store(0, std::memory_order_relaxed);
+  callback_run_ns.store(0, std::memory_order_relaxed);
+}
+
+} // namespace audio_capture
@@ -0,0 +1,142 @@
+#include "../include/delivery_batcher.h"
+#include "../include/trace.h"
+#include <algorithm>
+
+/**
+ * @file delivery_batcher.cc
+ * @brief 自适应批量投递的实现
+ */
+
+namespace audio_capture {
+
+DeliveryBatcher::DeliveryBatcher(GraphSinkCallback output,
+                                 std::shared_ptr<CaptureStats> stats)
+    : output_(std::move(output)), stats_(std::move(stats)) {}
+
+void DeliveryBatcher::Configure(double min_ms, double max_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FlushLocked();
+  max_ns_ = static_cast<uint64_t>(std::max(0.0, max_ms) * 1e6);
+  min_ns_ = std::min(static_cast<uint64_t>(std::max(0.0, min_ms) * 1e6),
+                     max_ns_);
+  adjusted_ns_ = 0;
+  batch_ns_.store(max_ns_ > 0 ? min_ns_ : 0, std::memory_order_relaxed);
+  enabled_.store(max_ns_ > 0, std::memory_order_release);
+}
+
+void DeliveryBatcher::SetUnbatchedSinks(std::vector<std::string> sinks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // 变为不合并的输出端可能还有缓存的数据
+  FlushLocked();
+  unbatched_ = std::move(sinks);
+}
+
+void DeliveryBatcher::Push(const std::string &sink_id, const uint8_t *data,
+                           size_t length, int channels, int sample_rate,
+                           uint64_t position, SampleFormat format) {
+  if (!enabled_.load(std::memory_order_acquire)) {
+    output_(sink_id, data, length, channels, sample_rate, position, format);
+    return;
+  }
+
+  const uint64_t now_ns = trace::NowNs();
+  const size_t sample_bytes =
+      format == SampleFormat::kInt16 ? sizeof(int16_t) : sizeof(float);
+  const uint64_t frames = length / (sample_bytes * channels);
+  const uint64_t packet_ns =
+      frames * 1000000000ull / static_cast<uint64_t>(sample_rate);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (max_ns_ == 0 || std::find(unbatched_.begin(), unbatched_.end(),
+                                sink_id) != unbatched_.end()) {
+    output_(sink_id, data, length, channels, sample_rate, position, format);
+    return;
+  }
+
+  Adjust(now_ns, packet_ns);
+
+  auto it = std::find_if(
+      pending_.begin(), pending_.end(),
+      [&sink_id](const Pending &pending) { return pending.sink_id == sink_id; });
+  if (it == pending_.end()) {
+    pending_.emplace_back();
+    it = pending_.end() - 1;
+    it->sink_id = sink_id;
+  }
+  Pending &pending = *it;
+
+  // 只拼接格式相同且位置连续的数据，否则先投递已缓存的部分
+  if (!pending.data.empty() &&
+      (pending.channels != channels || pending.sample_rate != sample_rate ||
+       pending.format != format ||
+       pending.position + pending.frames != position)) {
+    Emit(pending);
+  }
+  if (pending.data.empty()) {
+    pending.channels = channels;
+    pending.sample_rate = sample_rate;
+    pending.format = format;
+    pending.position = position;
+    pending.frames = 0;
+    pending.first_ns = now_ns;
+  }
+  pending.data.insert(pending.data.end(), data, data + length);
+  pending.frames += frames;
+
+  // 缓存满一批，或最早的数据已经等待了上限时长（数据包到达不均匀时）
+  uint64_t buffered_ns = pending.frames * 1000000000ull /
+                         static_cast<uint64_t>(sample_rate);
+  if (buffered_ns >= batch_ns_.load(std::memory_order_relaxed) ||
+      now_ns - pending.first_ns >= max_ns_) {
+    Emit(pending);
+  }
+}
+
+void DeliveryBatcher::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FlushLocked();
+}
+
+void DeliveryBatcher::FlushLocked() {
+  for (Pending &pending : pending_) {
+    if (!pending.data.empty()) {
+      Emit(pending);
+    }
+  }
+}
+
+void DeliveryBatcher::Emit(Pending &pending) {
+  // 下游会复制数据，缓冲区保留容量供下一批使用
+  output_(pending.sink_id, pending.data.data(), pending.data.size(),
+          pending.channels, pending.sample_rate, pending.position,
+          pending.format);
+  pending.data.clear();
+  pending.frames = 0;
+}
+
+void DeliveryBatcher::Adjust(uint64_t now_ns, uint64_t packet_ns) {
+  if (now_ns - adjusted_ns_ < kAdjustIntervalNs) {
+    return;
+  }
+  adjusted_ns_ = now_ns;
+
+  const uint64_t delay_ns =
+      stats_->dispatch_delay_ns.load(std::memory_order_relaxed);
+  const uint64_t run_ns =
+      stats_->callback_run_ns.load(std::memory_order_relaxed);
+  uint64_t batch_ns = batch_ns_.load(std::memory_order_relaxed);
+
+  // 批时长小于一个数据包时实际上每个数据包投递一次
+  const uint64_t effective_ns = std::max(batch_ns, packet_ns);
+  if (delay_ns > effective_ns / 2 || run_ns > effective_ns / 4) {
+    // 回调排队超过半批，或回调本身占用了四分之一以上的JS线程：减半回调频率
+    batch_ns = std::min(max_ns_, effective_ns * 2);
+  } else if (delay_ns < effective_ns / 8 && run_ns < effective_ns / 16) {
+    // 事件循环空闲：逐步缩短批时长，降到一个数据包以内时直接回到下限
+    batch_ns = batch_ns * 3 / 4 <= packet_ns ? min_ns_
+                                             : std::max(min_ns_, batch_ns * 3 / 4);
+  }
+  batch_ns_.store(batch_ns, std::memory_order_relaxed);
+}
+
+} // namespace audio_capture
@@ -0,0 +1,296 @@
+#include "../include/dsp_pool.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+/**
+ * @file dsp_pool.cc
+ * @brief 工作窃取DSP线程池的实现
+ */
+
+namespace audio_capture {
+
+namespace {
+
+// 空闲工作线程的最长等待时间，兜底生产者不加锁通知时可能错过的唤醒
+constexpr auto kIdleWait = std::chrono::milliseconds(2);
+
+// 当前线程所属的线程池和工作线程序号，工作线程提交的任务优先放入自己的队列
+thread_local DspPool *tls_pool = nullptr;
+
+// 已创建的共享线程池，供只读取统计的调用方判断是否存在
+std::atomic<DspPool *> g_shared_pool{nullptr};
+thread_local size_t tls_worker = 0;
+
+} // namespace
+
+DspPool::ReadyQueue::ReadyQueue() : cells_(new Cell[kQueueCapacity]) {
+  for (size_t i = 0; i < kQueueCapacity; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+    cells_[i].strand = nullptr;
+  }
+}
+
+bool DspPool::ReadyQueue::Push(DspStrand *strand) {
+  size_t pos = tail_.load(std::memory_order_relaxed);
+  while (true) {
+    Cell &cell = cells_[pos & (kQueueCapacity - 1)];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    intptr_t diff =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed)) {
+        cell.strand = strand;
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+DspStrand *DspPool::ReadyQueue::Pop() {
+  size_t pos = head_.load(std::memory_order_relaxed);
+  while (true) {
+    Cell &cell = cells_[pos & (kQueueCapacity - 1)];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    intptr_t diff =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (head_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed)) {
+        DspStrand *strand = cell.strand;
+        cell.sequence.store(pos + kQueueCapacity, std::memory_order_release);
+        return strand;
+      }
+    } else if (diff < 0) {
+      return nullptr;
+    } else {
+      pos = head_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+DspPool &DspPool::Shared() {
+  // 进程退出时不析构，避免与仍在运行的会话竞争
+  static DspPool *pool = [] {
+    DspPool *created =
+        new DspPool(std::max(1u, std::thread::hardware_concurrency()));
+    g_shared_pool.store(created, std::memory_order_release);
+    return created;
+  }();
+  return *pool;
+}
+
+DspPool *DspPool::SharedIfCreated() {
+  return g_shared_pool.load(std::memory_order_acquire);
+}
+
+DspPool::DspPool(size_t workers) {
+  workers = std::max<size_t>(1, workers);
+  for (size_t i = 0; i < workers; ++i) {
+    queues_.push_back(std::make_unique<ReadyQueue>());
+  }
+  for (size_t i = 0; i < workers; ++i) {
+    threads_.emplace_back(&DspPool::WorkerProc, this, i);
+  }
+}
+
+DspPool::~DspPool() {
+  running_.store(false);
+  idle_cv_.notify_all();
+  for (auto &thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+DspPoolStats DspPool::GetStats() const {
+  DspPoolStats stats;
+  stats.workers = threads_.size();
+  stats.jobs = jobs_.load();
+  stats.steals = steals_.load();
+  stats.queue_depth = queue_depth_.load();
+  stats.max_queue_depth = max_queue_depth_.load();
+  stats.dropped = dropped_.load();
+  return stats;
+}
+
+void DspPool::Schedule(DspStrand *strand) {
+  size_t count = queues_.size();
+  size_t start = tls_pool == this
+                     ? tls_worker
+                     : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                           count;
+
+  for (size_t i = 0; i < count; ++i) {
+    if (queues_[(start + i) % count]->Push(strand)) {
+      if (idle_workers_.load() > 0) {
+        idle_cv_.notify_one();
+      }
+      return;
+    }
+  }
+
+  // 所有就绪队列都满（串行队列数超过总容量），下一次提交时重试
+  strand->scheduled_.store(false);
+  strand->refs_.fetch_sub(1, std::memory_order_release);
+}
+
+void DspPool::WorkerProc(size_t index) {
+  tls_pool = this;
+  tls_worker = index;
+  trace::RegisterThread();
+  size_t count = queues_.size();
+
+  while (running_.load(std::memory_order_relaxed)) {
+    DspStrand *strand = queues_[index]->Pop();
+    for (size_t i = 1; !strand && i < count; ++i) {
+      strand = queues_[(index + i) % count]->Pop();
+      if (strand) {
+        steals_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    if (!strand) {
+      idle_workers_.fetch_add(1);
+      {
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_cv_.wait_for(lock, kIdleWait);
+      }
+      idle_workers_.fetch_sub(1);
+      continue;
+    }
+
+    strand->RunBatch(DspStrand::kRunBudget);
+
+    // 先清除调度标记再检查：与提交方的“写入后置位”配合，不会漏掉新数据
+    strand->scheduled_.store(false);
+    if (strand->HasPending() && !strand->scheduled_.exchange(true)) {
+      strand->refs_.fetch_add(1, std::memory_order_relaxed);
+      Schedule(strand);
+    }
+    // 之后不再访问strand，Close()可能随即返回并释放它
+    strand->refs_.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void DspPool::OnJobQueued() {
+  uint64_t depth = queue_depth_.fetch_add(1, std::memory_order_relaxed) + 1;
+  uint64_t max = max_queue_depth_.load(std::memory_order_relaxed);
+  while (depth > max && !max_queue_depth_.compare_exchange_weak(
+                            max, depth, std::memory_order_relaxed)) {
+  }
+}
+
+void DspPool::OnJobDone() {
+  queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+  jobs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+DspStrand::DspStrand(DspPool &pool, Handler handler, uint32_t session,
+                     size_t slots, size_t slot_capacity)
+    : pool_(pool), handler_(std::move(handler)), session_(session),
+      slot_capacity_(slot_capacity),
+      slots_(std::max<size_t>(1, slots)) {
+  for (auto &slot : slots_) {
+    slot.samples.assign(slot_capacity_, 0.0f);
+  }
+}
+
+DspStrand::~DspStrand() { Close(); }
+
+bool DspStrand::Submit(const AudioBlock &block) {
+  if (closed_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+
+  // 大周期、多声道或高采样率的数据块可能超过一个槽位，按整帧拆到连续的
+  // 槽位中；只有全部放得下才提交，避免下游收到不完整的数据块
+  const size_t channels = static_cast<size_t>(std::max(1, block.channels));
+  const size_t slot_frames = slot_capacity_ / channels;
+  const size_t parts =
+      slot_frames == 0 ? 0
+                       : std::max<size_t>(1, (block.frames + slot_frames - 1) /
+                                                 slot_frames);
+  size_t write = write_.load(std::memory_order_relaxed);
+  size_t read = read_.load(std::memory_order_acquire);
+  if (parts == 0 || write - read + parts > slots_.size()) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    pool_.dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i < parts; ++i) {
+    const size_t frames = std::min(slot_frames, block.frames - offset);
+    Slot &slot = slots_[(write + i) % slots_.size()];
+    std::memcpy(slot.samples.data(), block.samples + offset * channels,
+                frames * channels * sizeof(float));
+    slot.frames = frames;
+    slot.channels = block.channels;
+    slot.sample_rate = block.sample_rate;
+    offset += frames;
+    pool_.OnJobQueued();
+  }
+  write_.store(write + parts, std::memory_order_release);
+
+  if (!scheduled_.exchange(true)) {
+    refs_.fetch_add(1, std::memory_order_relaxed);
+    pool_.Schedule(this);
+  }
+  return true;
+}
+
+void DspStrand::Close() {
+  closed_.store(true);
+
+  // 等待工作线程执行完已提交的任务
+  while (refs_.load(std::memory_order_acquire) != 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // 调度失败遗留的任务在当前线程执行完
+  while (HasPending()) {
+    RunBatch(slots_.size());
+  }
+}
+
+bool DspStrand::HasPending() const {
+  return read_.load(std::memory_order_relaxed) !=
+         write_.load(std::memory_order_acquire);
+}
+
+size_t DspStrand::RunBatch(size_t budget) {
+  size_t done = 0;
+  while (done < budget) {
+    size_t read = read_.load(std::memory_order_relaxed);
+    if (read == write_.load(std::memory_order_acquire)) {
+      break;
+    }
+
+    const Slot &slot = slots_[read % slots_.size()];
+    AudioBlock block;
+    block.samples = slot.samples.data();
+    block.frames = slot.frames;
+    block.channels = slot.channels;
+    block.sample_rate = slot.sample_rate;
+    {
+      trace::ScopedSpan span("dsp-job", session_);
+      handler_(block);
+    }
+
+    read_.store(read + 1, std::memory_order_release);
+    pool_.OnJobDone();
+    ++done;
+  }
+  return done;
+}
+
+} // namespace audio_capture
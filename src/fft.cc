@@ -0,0 +1,122 @@
+#include "../include/fft.h"
+#include <cmath>
+#include <utility>
+
+/**
+ * @file fft.cc
+ * @brief 实数FFT的实现
+ */
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+} // namespace
+
+Fft::Fft(size_t size)
+    : size_(size), half_(size / 2), bit_reverse_(half_), cos_(half_ / 2),
+      sin_(half_ / 2), post_cos_(half_ + 1), post_sin_(half_ + 1),
+      work_re_(half_), work_im_(half_) {
+  size_t bits = 0;
+  while ((size_t{1} << bits) < half_) {
+    ++bits;
+  }
+  for (size_t i = 0; i < half_; ++i) {
+    size_t reversed = 0;
+    for (size_t b = 0; b < bits; ++b) {
+      if (i & (size_t{1} << b)) {
+        reversed |= size_t{1} << (bits - 1 - b);
+      }
+    }
+    bit_reverse_[i] = static_cast<uint32_t>(reversed);
+  }
+  for (size_t i = 0; i < half_ / 2; ++i) {
+    double angle = -2.0 * kPi * i / half_;
+    cos_[i] = static_cast<float>(std::cos(angle));
+    sin_[i] = static_cast<float>(std::sin(angle));
+  }
+  for (size_t k = 0; k <= half_; ++k) {
+    double angle = -2.0 * kPi * k / size_;
+    post_cos_[k] = static_cast<float>(std::cos(angle));
+    post_sin_[k] = static_cast<float>(std::sin(angle));
+  }
+}
+
+void Fft::Transform(float *re, float *im) const {
+  for (size_t i = 0; i < half_; ++i) {
+    size_t j = bit_reverse_[i];
+    if (i < j) {
+      std::swap(re[i], re[j]);
+      std::swap(im[i], im[j]);
+    }
+  }
+
+  for (size_t length = 2; length <= half_; length <<= 1) {
+    const size_t span = length / 2;
+    const size_t stride = half_ / length;
+    for (size_t start = 0; start < half_; start += length) {
+      float *a_re = re + start;
+      float *a_im = im + start;
+      float *b_re = a_re + span;
+      float *b_im = a_im + span;
+      for (size_t k = 0; k < span; ++k) {
+        float w_re = cos_[k * stride];
+        float w_im = sin_[k * stride];
+        float t_re = b_re[k] * w_re - b_im[k] * w_im;
+        float t_im = b_re[k] * w_im + b_im[k] * w_re;
+        b_re[k] = a_re[k] - t_re;
+        b_im[k] = a_im[k] - t_im;
+        a_re[k] += t_re;
+        a_im[k] += t_im;
+      }
+    }
+  }
+}
+
+void Fft::Forward(const float *input, float *re, float *im) {
+  // 偶数样本作实部、奇数样本作虚部
+  for (size_t n = 0; n < half_; ++n) {
+    work_re_[n] = input[2 * n];
+    work_im_[n] = input[2 * n + 1];
+  }
+  Transform(work_re_.data(), work_im_.data());
+
+  // X[k] = E[k] + W^k·O[k]，E = (Z[k] + conj(Z[M-k]))/2，O = (Z[k] - conj(Z[M-k]))/2i
+  for (size_t k = 0; k <= half_; ++k) {
+    size_t a = k % half_;
+    size_t b = (half_ - k) % half_;
+    float e_re = 0.5f * (work_re_[a] + work_re_[b]);
+    float e_im = 0.5f * (work_im_[a] - work_im_[b]);
+    float o_re = 0.5f * (work_im_[a] + work_im_[b]);
+    float o_im = -0.5f * (work_re_[a] - work_re_[b]);
+    re[k] = e_re + post_cos_[k] * o_re - post_sin_[k] * o_im;
+    im[k] = e_im + post_cos_[k] * o_im + post_sin_[k] * o_re;
+  }
+}
+
+void Fft::Inverse(const float *re, const float *im, float *output) {
+  // Z[k] = E[k] + i·O[k]，E = (X[k] + conj(X[M-k]))/2，O = (X[k] - conj(X[M-k]))/2 · W^-k
+  for (size_t k = 0; k < half_; ++k) {
+    size_t m = half_ - k;
+    float e_re = 0.5f * (re[k] + re[m]);
+    float e_im = 0.5f * (im[k] - im[m]);
+    float d_re = 0.5f * (re[k] - re[m]);
+    float d_im = 0.5f * (im[k] + im[m]);
+    float o_re = d_re * post_cos_[k] + d_im * post_sin_[k];
+    float o_im = d_im * post_cos_[k] - d_re * post_sin_[k];
+    // 取共轭后做正变换，结果再取共轭即为逆变换
+    work_re_[k] = e_re - o_im;
+    work_im_[k] = -(e_im + o_re);
+  }
+  Transform(work_re_.data(), work_im_.data());
+
+  const float scale = 1.0f / static_cast<float>(half_);
+  for (size_t n = 0; n < half_; ++n) {
+    output[2 * n] = work_re_[n] * scale;
+    output[2 * n + 1] = -work_im_[n] * scale;
+  }
+}
+
+} // namespace audio_capture
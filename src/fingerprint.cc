@@ -0,0 +1,180 @@
+#include "../include/fingerprint.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file fingerprint.cc
+ * @brief 音频指纹提取的实现
+ */
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// 降采样前的低通截止频率，略低于 8kHz 的奈奎斯特频率
+constexpr double kCutoffHz = 3400.0;
+
+// 频带边界（频点），低频带窄、高频带宽；跳过直流分量
+constexpr uint16_t kBandEdges[Fingerprinter::kBands + 1] = {2,  10,  20, 40,
+                                                            80, 160, 255};
+
+// 峰值至少高出本帧平均对数幅度的量，以及绝对下限（静音不产生峰值）
+constexpr float kProminenceDb = 10.0f;
+constexpr float kFloorDb = -60.0f;
+
+} // namespace
+
+Fingerprinter::Fingerprinter() {
+  for (size_t i = 0; i < kFftSize; ++i) {
+    hann_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / kFftSize));
+  }
+}
+
+void Fingerprinter::Reset() {
+  input_rate_ = 0;
+  phase_ = 1.0;
+  last_ = 0.0f;
+  x1_ = x2_ = y1_ = y2_ = 0.0f;
+  window_ring_.fill(0.0f);
+  ring_pos_ = 0;
+  filled_ = 0;
+  since_hop_ = 0;
+  for (auto &frame : history_) {
+    frame.count = 0;
+  }
+  frame_index_ = 0;
+}
+
+void Fingerprinter::Configure(int sample_rate) {
+  input_rate_ = sample_rate;
+  step_ = static_cast<double>(sample_rate) / kSampleRate;
+
+  // RBJ 低通（Q = 1/√2）；输入不高于 8kHz 时不需要抗混叠
+  if (sample_rate <= kSampleRate) {
+    b0_ = 1.0f;
+    b1_ = b2_ = a1_ = a2_ = 0.0f;
+    return;
+  }
+  double w0 = 2.0 * kPi * kCutoffHz / sample_rate;
+  double alpha = std::sin(w0) / (2.0 * std::sqrt(0.5));
+  double cosw = std::cos(w0);
+  double a0 = 1.0 + alpha;
+  b0_ = static_cast<float>((1.0 - cosw) / 2.0 / a0);
+  b1_ = static_cast<float>((1.0 - cosw) / a0);
+  b2_ = b0_;
+  a1_ = static_cast<float>(-2.0 * cosw / a0);
+  a2_ = static_cast<float>((1.0 - alpha) / a0);
+}
+
+void Fingerprinter::Process(const float *samples, size_t frames, int channels,
+                            int sample_rate, std::vector<Landmark> *out) {
+  if (channels <= 0 || sample_rate <= 0) {
+    return;
+  }
+  if (sample_rate != input_rate_) {
+    Configure(sample_rate);
+  }
+
+  const float scale = 1.0f / channels;
+  for (size_t frame = 0; frame < frames; ++frame) {
+    const float *src = samples + frame * channels;
+    float mono = 0.0f;
+    for (int c = 0; c < channels; ++c) {
+      mono += src[c];
+    }
+    mono *= scale;
+
+    float filtered =
+        b0_ * mono + b1_ * x1_ + b2_ * x2_ - a1_ * y1_ - a2_ * y2_;
+    x2_ = x1_;
+    x1_ = mono;
+    y2_ = y1_;
+    y1_ = filtered;
+
+    // phase坐标中0为上一个输入样本，1为当前样本
+    while (phase_ <= 1.0) {
+      float frac = static_cast<float>(phase_);
+      window_ring_[ring_pos_] = last_ + (filtered - last_) * frac;
+      ring_pos_ = (ring_pos_ + 1) % kFftSize;
+      filled_ = std::min(filled_ + 1, kFftSize);
+      if (++since_hop_ >= kHop && filled_ == kFftSize) {
+        since_hop_ = 0;
+        AnalyzeFrame(out);
+      }
+      phase_ += step_;
+    }
+    phase_ -= 1.0;
+    last_ = filtered;
+  }
+}
+
+void Fingerprinter::AnalyzeFrame(std::vector<Landmark> *out) {
+  // 加窗，ring_pos_ 指向最旧的样本
+  for (size_t i = 0; i < kFftSize; ++i) {
+    frame_[i] = window_ring_[(ring_pos_ + i) % kFftSize] * hann_[i];
+  }
+  fft_.Forward(frame_.data(), re_.data(), im_.data());
+
+  float sum = 0.0f;
+  for (size_t bin = 0; bin < kBins; ++bin) {
+    float power = (re_[bin] * re_[bin] + im_[bin] * im_[bin]) *
+                  (4.0f / (kFftSize * kFftSize));
+    magnitude_db_[bin] = 10.0f * std::log10(power + 1e-12f);
+    sum += magnitude_db_[bin];
+  }
+  const float threshold = std::max(kFloorDb, sum / kBins + kProminenceDb);
+
+  PeakFrame &frame = history_[frame_index_ % kTargetFrames];
+  frame.count = 0;
+  for (int band = 0; band < kBands; ++band) {
+    uint16_t best = 0;
+    float best_db = threshold;
+    for (uint16_t bin = kBandEdges[band]; bin < kBandEdges[band + 1]; ++bin) {
+      float value = magnitude_db_[bin];
+      if (value > best_db && value >= magnitude_db_[bin - 1] &&
+          value >= magnitude_db_[bin + 1]) {
+        best = bin;
+        best_db = value;
+      }
+    }
+    if (best != 0) {
+      frame.peaks[frame.count++] = {best, best_db};
+    }
+  }
+
+  // 目标区域已完整的锚点帧：当前帧之前 kTargetFrames-1 帧
+  if (frame_index_ >= kTargetFrames - 1) {
+    PairAnchor(frame_index_ - (kTargetFrames - 1), out);
+  }
+  ++frame_index_;
+}
+
+void Fingerprinter::PairAnchor(uint64_t anchor, std::vector<Landmark> *out) {
+  const PeakFrame &anchors = history_[anchor % kTargetFrames];
+  const float time = static_cast<float>(
+      static_cast<double>(anchor * kHop) / kSampleRate);
+
+  for (int a = 0; a < anchors.count; ++a) {
+    const int f1 = anchors.peaks[a].bin;
+    int paired = 0;
+    // 按时间由近到远配对
+    for (int dt = 1; dt < kTargetFrames && paired < kFanOut; ++dt) {
+      const PeakFrame &targets = history_[(anchor + dt) % kTargetFrames];
+      for (int t = 0; t < targets.count && paired < kFanOut; ++t) {
+        int df = static_cast<int>(targets.peaks[t].bin) - f1;
+        if (df <= -kMaxDeltaBins || df >= kMaxDeltaBins) {
+          continue;
+        }
+        uint32_t hash = (static_cast<uint32_t>(f1) & 0xFF) << 12 |
+                        (static_cast<uint32_t>(df + kMaxDeltaBins) & 0x7F) << 5 |
+                        (static_cast<uint32_t>(dt) & 0x1F);
+        out->push_back({hash, time});
+        ++paired;
+      }
+    }
+  }
+}
+
+} // namespace audio_capture
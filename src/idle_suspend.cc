@@ -0,0 +1,146 @@
+#include "../include/idle_suspend.h"
+#include "../include/trace.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/**
+ * @file idle_suspend.cc
+ * @brief 空闲挂起策略和静音计时的实现
+ */
+
+namespace audio_capture {
+
+void IdleSuspend::Configure(const IdleSuspendOptions &options) {
+  silence_ms_.store(options.silence_ms, std::memory_order_relaxed);
+  probe_interval_ms_.store(options.probe_interval_ms,
+                           std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+  WakeAll();
+}
+
+void IdleSuspend::Disable() {
+  enabled_.store(false, std::memory_order_release);
+  WakeAll();
+}
+
+void IdleSuspend::WakeAll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const Watcher &watcher : watchers_) {
+    watcher.wake();
+  }
+}
+
+void IdleSuspend::Suspended(const void *owner, std::function<void()> wake) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  watchers_.push_back({owner, std::move(wake), trace::NowNs()});
+  idle_count_.fetch_add(1, std::memory_order_relaxed);
+  suspensions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void IdleSuspend::Resumed(const void *owner, bool probe) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(
+      watchers_.begin(), watchers_.end(),
+      [owner](const Watcher &watcher) { return watcher.owner == owner; });
+  if (it == watchers_.end()) {
+    return;
+  }
+
+  idle_ns_.fetch_add(trace::NowNs() - it->since_ns, std::memory_order_relaxed);
+  if (probe) {
+    probes_.fetch_add(1, std::memory_order_relaxed);
+  }
+  watchers_.erase(it);
+  idle_count_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+IdleSuspend::Snapshot IdleSuspend::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.idle = idle_count_.load(std::memory_order_relaxed) > 0;
+  snapshot.suspensions = suspensions_.load(std::memory_order_relaxed);
+  snapshot.probes = probes_.load(std::memory_order_relaxed);
+  snapshot.wakeups = wakeups_.load(std::memory_order_relaxed);
+  snapshot.cpu_ns = cpu_ns_.load(std::memory_order_relaxed);
+  snapshot.idle_ns = idle_ns_.load(std::memory_order_relaxed);
+
+  // 进行中的空闲时长也计入
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t now = trace::NowNs();
+  for (const Watcher &watcher : watchers_) {
+    snapshot.idle_ns += now - watcher.since_ns;
+  }
+  return snapshot;
+}
+
+void IdleSuspend::ResetStats() {
+  suspensions_.store(0, std::memory_order_relaxed);
+  probes_.store(0, std::memory_order_relaxed);
+  wakeups_.store(0, std::memory_order_relaxed);
+  cpu_ns_.store(0, std::memory_order_relaxed);
+  idle_ns_.store(0, std::memory_order_relaxed);
+}
+
+bool SilenceDetector::Feed(const float *samples, size_t frames, int channels,
+                           int sample_rate) {
+  if (!policy_ || !policy_->IsEnabled() || sample_rate <= 0) {
+    silent_frames_ = 0;
+    return false;
+  }
+
+  // 只把全零样本当作静音，遇到第一个非零样本就停止扫描
+  if (samples) {
+    const size_t count = frames * static_cast<size_t>(channels);
+    for (size_t i = 0; i < count; ++i) {
+      if (samples[i] != 0.0f) {
+        silent_frames_ = 0;
+        probing_ = false;
+        tripped_ = false;
+        return false;
+      }
+    }
+  }
+
+  silent_frames_ += frames;
+  const uint64_t limit_ms =
+      probing_ ? std::min<uint32_t>(kProbeWindowMs, policy_->SilenceMs())
+               : policy_->SilenceMs();
+  if (tripped_ || silent_frames_ * 1000 < limit_ms * sample_rate) {
+    return false;
+  }
+  tripped_ = true;
+  return true;
+}
+
+void SilenceDetector::Reset(bool probe) {
+  silent_frames_ = 0;
+  probing_ = probe;
+  tripped_ = false;
+}
+
+uint64_t ThreadCpuNs() {
+#ifdef _WIN32
+  FILETIME creation, exit, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+    return 0;
+  }
+  auto to100ns = [](const FILETIME &time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) |
+           time.dwLowDateTime;
+  };
+  return (to100ns(kernel) + to100ns(user)) * 100;
+#else
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+         static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+} // namespace audio_capture
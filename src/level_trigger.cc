@@ -0,0 +1,144 @@
+#include "../include/level_trigger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/**
+ * @file level_trigger.cc
+ * @brief 电平触发器的实现
+ */
+
+namespace audio_capture {
+
+void LevelTrigger::Configure(const LevelTriggerOptions &options) {
+  threshold_db_.store(options.threshold_db, std::memory_order_relaxed);
+  pre_roll_ms_.store(options.pre_roll_ms, std::memory_order_relaxed);
+  hold_ms_.store(options.hold_ms, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+}
+
+void LevelTrigger::Disable() {
+  enabled_.store(false, std::memory_order_release);
+}
+
+void LevelTrigger::Process(const float *samples, size_t frames, int channels,
+                           int sample_rate, uint64_t position,
+                           Result *result) {
+  result->count = 0;
+  result->opened = false;
+  result->closed = false;
+  const Segment packet = {samples, frames, position};
+
+  if (!enabled_.load(std::memory_order_acquire)) {
+    was_enabled_ = false;
+    active_.store(true, std::memory_order_relaxed);
+    result->segments[result->count++] = packet;
+    return;
+  }
+
+  // 刚启用时从空闲开始，之后只在格式或预录时长变化时重建缓冲区
+  const uint32_t pre_roll_ms = pre_roll_ms_.load(std::memory_order_relaxed);
+  if (!was_enabled_) {
+    was_enabled_ = true;
+    open_ = false;
+    active_.store(false, std::memory_order_relaxed);
+    Reset(channels, sample_rate, pre_roll_ms);
+  } else if (channels != channels_ || sample_rate != sample_rate_ ||
+             pre_roll_ms != ring_ms_) {
+    Reset(channels, sample_rate, pre_roll_ms);
+  }
+
+  const size_t count = frames * static_cast<size_t>(channels);
+  double sum = 0.0;
+  for (size_t i = 0; i < count; ++i) {
+    sum += static_cast<double>(samples[i]) * samples[i];
+  }
+  result->level_db = static_cast<float>(
+      10.0 * std::log10(count ? sum / count + 1e-20 : 1e-20));
+  const bool above =
+      result->level_db >= threshold_db_.load(std::memory_order_relaxed);
+
+  if (open_) {
+    silent_frames_ = above ? 0 : silent_frames_ + frames;
+    const uint64_t hold_frames =
+        static_cast<uint64_t>(hold_ms_.load(std::memory_order_relaxed)) *
+        sample_rate / 1000;
+    if (silent_frames_ < hold_frames) {
+      result->segments[result->count++] = packet;
+      return;
+    }
+    // 静默达到保持时长：本数据包不再输出，作为下一次触发的预录
+    open_ = false;
+    active_.store(false, std::memory_order_relaxed);
+    result->closed = true;
+    ring_filled_ = 0;
+    Write(samples, frames, position);
+    return;
+  }
+
+  if (!above) {
+    Write(samples, frames, position);
+    return;
+  }
+
+  // 触发：按时间顺序输出预录缓冲区（可能绕回）和当前数据包
+  open_ = true;
+  silent_frames_ = 0;
+  active_.store(true, std::memory_order_relaxed);
+  result->opened = true;
+  if (ring_filled_ > 0 && ring_end_ == position) {
+    const size_t start =
+        (ring_write_ + ring_frames_ - ring_filled_) % ring_frames_;
+    const size_t first = std::min(ring_filled_, ring_frames_ - start);
+    const uint64_t begin = ring_end_ - ring_filled_;
+    result->segments[result->count++] = {
+        ring_.data() + start * channels_, first, begin};
+    if (first < ring_filled_) {
+      result->segments[result->count++] = {ring_.data(), ring_filled_ - first,
+                                           begin + first};
+    }
+  }
+  ring_filled_ = 0;
+  result->segments[result->count++] = packet;
+}
+
+void LevelTrigger::Reset(int channels, int sample_rate, uint32_t pre_roll_ms) {
+  channels_ = channels;
+  sample_rate_ = sample_rate;
+  ring_ms_ = pre_roll_ms;
+  ring_frames_ =
+      static_cast<size_t>(static_cast<uint64_t>(pre_roll_ms) * sample_rate /
+                          1000);
+  ring_.assign(ring_frames_ * static_cast<size_t>(channels), 0.0f);
+  ring_write_ = 0;
+  ring_filled_ = 0;
+  silent_frames_ = 0;
+}
+
+void LevelTrigger::Write(const float *samples, size_t frames,
+                         uint64_t position) {
+  ring_end_ = position + frames;
+  if (ring_frames_ == 0) {
+    return;
+  }
+
+  // 比缓冲区长的数据包只保留最后的部分
+  if (frames >= ring_frames_) {
+    std::memcpy(ring_.data(),
+                samples + (frames - ring_frames_) * channels_,
+                ring_frames_ * channels_ * sizeof(float));
+    ring_write_ = 0;
+    ring_filled_ = ring_frames_;
+    return;
+  }
+
+  const size_t first = std::min(frames, ring_frames_ - ring_write_);
+  std::memcpy(ring_.data() + ring_write_ * channels_, samples,
+              first * channels_ * sizeof(float));
+  std::memcpy(ring_.data(), samples + first * channels_,
+              (frames - first) * channels_ * sizeof(float));
+  ring_write_ = (ring_write_ + frames) % ring_frames_;
+  ring_filled_ = std::min(ring_frames_, ring_filled_ + frames);
+}
+
+} // namespace audio_capture
@@ -0,0 +1,592 @@
+#ifdef __linux__
+
+#include "../../include/linux/audio_tap.h"
+#include "../../include/linux/linux_utils.h"
+#include "../../include/rt_check.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <iostream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <spa/debug/types.h>
+#include <spa/param/audio/format-utils.h>
+#include <spa/param/audio/type-info.h>
+#include <spa/pod/builder.h>
+
+/**
+ * @file audio_tap.cc
+ * @brief Linux进程级音频捕获实现
+ *
+ * 使用PipeWire的pw_stream捕获指定进程的音频输出
+ */
+
+// 旧版本PipeWire头文件中没有该常量
+#ifndef PW_KEY_TARGET_OBJECT
+#define PW_KEY_TARGET_OBJECT "target.object"
+#endif
+
+namespace audio_capture {
+namespace linux_audio {
+
+// 请求的默认格式，与Windows后端保持一致：48kHz 立体声 32-bit Float
+#define DEFAULT_SAMPLE_RATE 48000
+#define DEFAULT_CHANNELS 2
+
+pw_stream_events AudioTap::MakeStreamEvents() {
+  pw_stream_events events = {};
+  events.version = PW_VERSION_STREAM_EVENTS;
+  events.state_changed = &AudioTap::OnStateChanged;
+  events.param_changed = &AudioTap::OnParamChanged;
+  events.process = &AudioTap::OnProcess;
+  return events;
+}
+
+const pw_stream_events AudioTap::kStreamEvents = AudioTap::MakeStreamEvents();
+
+pw_node_events AudioTap::MakeNodeEvents() {
+  pw_node_events events = {};
+  events.version = PW_VERSION_NODE_EVENTS;
+  events.info = &AudioTap::OnNodeInfo;
+  return events;
+}
+
+const pw_node_events AudioTap::kNodeEvents = AudioTap::MakeNodeEvents();
+
+pw_registry_events AudioTap::MakeRegistryEvents() {
+  pw_registry_events events = {};
+  events.version = PW_VERSION_REGISTRY_EVENTS;
+  events.global_remove = &AudioTap::OnGlobalRemove;
+  return events;
+}
+
+const pw_registry_events AudioTap::kRegistryEvents =
+    AudioTap::MakeRegistryEvents();
+
+AudioTap::AudioTap(uint32_t pid) : target_pid_(pid), trace_session_(pid) {}
+
+AudioTap::~AudioTap() {
+  Stop();
+  Cleanup();
+}
+
+void AudioTap::SetInputDevice(const std::string &device) {
+  input_device_ = true;
+  device_ = device;
+}
+
+bool AudioTap::Initialize(const CaptureOptions &options) {
+  linux_utils::EnsurePipeWireInit();
+  native_format_ = options.native_format;
+  trace_session_ = options.TraceSession(target_pid_);
+  idle_ = options.idle_suspend;
+  detector_.SetPolicy(idle_.get());
+
+  // 查找目标进程的音频输出流节点，输入设备由会话管理器按目标名或默认源连接
+  if (!input_device_) {
+    bool found = false;
+    for (const auto &node : linux_utils::GetAudioStreamNodes()) {
+      if (node.pid == target_pid_) {
+        target_serial_ = node.serial;
+        target_id_ = node.id;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      SetError("Target process has no PipeWire audio output stream");
+      return false;
+    }
+  }
+
+  // 节点枚举可能耗时较长，创建连接前检查是否已被取消
+  if (options.IsCancelled()) {
+    SetError("Capture preparation cancelled");
+    return false;
+  }
+
+  thread_loop_ = pw_thread_loop_new("audio-capture", nullptr);
+  if (!thread_loop_) {
+    SetError("Failed to create PipeWire thread loop");
+    return false;
+  }
+
+  context_ = pw_context_new(pw_thread_loop_get_loop(thread_loop_), nullptr, 0);
+  if (!context_) {
+    SetError("Failed to create PipeWire context");
+    return false;
+  }
+
+  if (pw_thread_loop_start(thread_loop_) < 0) {
+    SetError("Failed to start PipeWire thread loop");
+    return false;
+  }
+
+  pw_thread_loop_lock(thread_loop_);
+
+  core_ = pw_context_connect(context_, nullptr, 0);
+  if (!core_) {
+    pw_thread_loop_unlock(thread_loop_);
+    SetError("Failed to connect to PipeWire");
+    return false;
+  }
+
+  pw_properties *props = pw_properties_new(
+      PW_KEY_MEDIA_TYPE, "Audio", PW_KEY_MEDIA_CATEGORY, "Capture",
+      PW_KEY_MEDIA_ROLE, input_device_ ? "Communication" : "Music",
+      PW_KEY_NODE_NAME,
+      input_device_ ? "process-audio-capture-input" : "process-audio-capture",
+      nullptr);
+  if (input_device_) {
+    // 未指定设备时不设置目标，默认音频源切换后会话管理器会重新链接
+    if (!device_.empty()) {
+      pw_properties_set(props, PW_KEY_TARGET_OBJECT, device_.c_str());
+    }
+  } else {
+    // 目标节点消失时不要自动连接到默认设备
+    pw_properties_set(props, PW_KEY_NODE_DONT_RECONNECT, "true");
+    pw_properties_setf(props, PW_KEY_TARGET_OBJECT, "%llu",
+                       static_cast<unsigned long long>(target_serial_));
+  }
+  // 期望的周期交给图调度器，实际的quantum由所有节点的请求共同决定
+  if (options.period_frames > 0) {
+    pw_properties_setf(props, PW_KEY_NODE_LATENCY, "%u/%d",
+                       options.period_frames,
+                       CaptureOptions::kReferenceSampleRate);
+  }
+
+  stream_ = pw_stream_new(core_, "process-audio-capture", props);
+  if (!stream_) {
+    pw_thread_loop_unlock(thread_loop_);
+    SetError("Failed to create PipeWire stream");
+    return false;
+  }
+  pw_stream_add_listener(stream_, &stream_listener_, &kStreamEvents, this);
+
+  // 空闲挂起的事件源：数据线程通过事件请求挂起，探测定时器挂起后才启动
+  if (idle_) {
+    pw_loop *loop = pw_thread_loop_get_loop(thread_loop_);
+    idle_event_ = pw_loop_add_event(loop, &AudioTap::OnIdleEvent, this);
+    probe_timer_ = pw_loop_add_timer(loop, &AudioTap::OnProbeTimer, this);
+  }
+  if (!input_device_) {
+    WatchTarget();
+  }
+
+  pw_thread_loop_unlock(thread_loop_);
+
+  // 预先连接（非活动状态），让会话管理器提前完成链接和格式协商
+  return ConnectStream();
+}
+
+bool AudioTap::ConnectStream() {
+  // 构造格式参数
+  uint8_t buffer[1024];
+  spa_pod_builder builder = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+
+  // 原始格式模式下只限定样本格式，采样率和声道布局由目标节点协商决定
+  spa_audio_info_raw info = {};
+  info.format = SPA_AUDIO_FORMAT_F32;
+  if (!native_format_) {
+    info.rate = DEFAULT_SAMPLE_RATE;
+    info.channels = DEFAULT_CHANNELS;
+    info.position[0] = SPA_AUDIO_CHANNEL_FL;
+    info.position[1] = SPA_AUDIO_CHANNEL_FR;
+  }
+
+  const spa_pod *params[1];
+  params[0] = spa_format_audio_raw_build(&builder, SPA_PARAM_EnumFormat, &info);
+
+  pw_thread_loop_lock(thread_loop_);
+  int result = pw_stream_connect(
+      stream_, PW_DIRECTION_INPUT, PW_ID_ANY,
+      static_cast<pw_stream_flags>(
+          PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_INACTIVE |
+          PW_STREAM_FLAG_MAP_BUFFERS | PW_STREAM_FLAG_RT_PROCESS),
+      params, 1);
+  pw_thread_loop_unlock(thread_loop_);
+
+  if (result < 0) {
+    SetError("Failed to connect PipeWire stream");
+    return false;
+  }
+
+  return true;
+}
+
+bool AudioTap::Start(AudioDataCallback callback) {
+  if (is_capturing_.load()) {
+    return false;
+  }
+
+  if (!stream_) {
+    SetError("Audio stream not initialized");
+    return false;
+  }
+
+  // 结束检测在线程循环中进行，持有锁检查，避免漏掉两者之间的结束通知
+  pw_thread_loop_lock(thread_loop_);
+  if (ended_reason_.load()) {
+    pw_thread_loop_unlock(thread_loop_);
+    SetError(std::string("Capture target ended: ") + ended_reason_.load());
+    return false;
+  }
+
+  // 先设置回调再激活，process回调中通过is_capturing_同步
+  callback_ = callback;
+  is_capturing_.store(true, std::memory_order_release);
+  int result = pw_stream_set_active(stream_, true);
+  pw_thread_loop_unlock(thread_loop_);
+
+  if (result < 0) {
+    is_capturing_.store(false);
+    SetError("Failed to activate PipeWire stream");
+    callback_ = nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+void AudioTap::Stop() {
+  if (!is_capturing_.load()) {
+    return;
+  }
+
+  is_capturing_.store(false);
+
+  // 断开连接会同步等待数据线程，之后不会再有process回调
+  pw_thread_loop_lock(thread_loop_);
+  if (suspended_) {
+    pw_loop_update_timer(pw_thread_loop_get_loop(thread_loop_), probe_timer_,
+                         nullptr, nullptr, false);
+    suspended_ = false;
+    idle_->Resumed(this, false);
+  }
+  pw_stream_disconnect(stream_);
+  pw_thread_loop_unlock(thread_loop_);
+
+  callback_ = nullptr;
+}
+
+void AudioTap::Cleanup() {
+  if (thread_loop_) {
+    pw_thread_loop_lock(thread_loop_);
+    pw_loop *loop = pw_thread_loop_get_loop(thread_loop_);
+    if (pidfd_source_) {
+      pw_loop_destroy_source(loop, pidfd_source_);
+      pidfd_source_ = nullptr;
+    }
+    if (target_node_) {
+      spa_hook_remove(&node_listener_);
+      pw_proxy_destroy(reinterpret_cast<pw_proxy *>(target_node_));
+      target_node_ = nullptr;
+    }
+    if (registry_) {
+      spa_hook_remove(&registry_listener_);
+      pw_proxy_destroy(reinterpret_cast<pw_proxy *>(registry_));
+      registry_ = nullptr;
+    }
+    if (probe_timer_) {
+      pw_loop_destroy_source(loop, probe_timer_);
+      probe_timer_ = nullptr;
+    }
+    if (idle_event_) {
+      pw_loop_destroy_source(loop, idle_event_);
+      idle_event_ = nullptr;
+    }
+    if (stream_) {
+      pw_stream_destroy(stream_);
+      stream_ = nullptr;
+    }
+    if (core_) {
+      pw_core_disconnect(core_);
+      core_ = nullptr;
+    }
+    pw_thread_loop_unlock(thread_loop_);
+    pw_thread_loop_stop(thread_loop_);
+  }
+
+  if (context_) {
+    pw_context_destroy(context_);
+    context_ = nullptr;
+  }
+
+  if (thread_loop_) {
+    pw_thread_loop_destroy(thread_loop_);
+    thread_loop_ = nullptr;
+  }
+}
+
+void AudioTap::SetError(const std::string &message) {
+  error_message_ = message;
+  trace::RecordInstant("error", trace_session_);
+  std::cerr << "AudioTap Error: " << message << std::endl;
+}
+
+void AudioTap::OnProcess(void *userdata) {
+  static_cast<AudioTap *>(userdata)->ProcessAudioData();
+}
+
+void AudioTap::OnParamChanged(void *userdata, uint32_t id,
+                              const struct spa_pod *param) {
+  auto *self = static_cast<AudioTap *>(userdata);
+  if (!param || id != SPA_PARAM_Format) {
+    return;
+  }
+
+  // 记录协商后的实际格式，process回调只读取缓存的值；
+  // 运行中重新协商时也从这里更新，下游按数据包的格式通知JS
+  spa_audio_info_raw info = {};
+  if (spa_format_audio_raw_parse(param, &info) < 0) {
+    return;
+  }
+  bool changed = false;
+  if (info.channels > 0) {
+    changed |= self->channels_.exchange(static_cast<int>(info.channels)) !=
+               static_cast<int>(info.channels);
+  }
+  if (info.rate > 0) {
+    changed |= self->sample_rate_.exchange(static_cast<int>(info.rate)) !=
+               static_cast<int>(info.rate);
+  }
+  if (changed) {
+    trace::RecordInstant("format-changed", self->trace_session_);
+  }
+
+  // 记录声道位置，未定位的声道记为AUX
+  ChannelLayout layout;
+  bool positioned = !(info.flags & SPA_AUDIO_FLAG_UNPOSITIONED);
+  for (uint32_t i = 0; i < info.channels && i < SPA_AUDIO_MAX_CHANNELS; ++i) {
+    const char *name =
+        positioned ? spa_debug_type_find_short_name(spa_type_audio_channel,
+                                                    info.position[i])
+                   : nullptr;
+    layout.push_back(name ? name : "AUX" + std::to_string(i));
+  }
+  std::lock_guard<std::mutex> lock(self->layout_mutex_);
+  self->layout_ = std::move(layout);
+}
+
+ChannelLayout AudioTap::GetChannelLayout() const {
+  std::lock_guard<std::mutex> lock(layout_mutex_);
+  return layout_;
+}
+
+void AudioTap::OnStateChanged(void *userdata, enum pw_stream_state /*old*/,
+                              enum pw_stream_state state, const char *error) {
+  auto *self = static_cast<AudioTap *>(userdata);
+  if (state == PW_STREAM_STATE_ERROR) {
+    self->SetError(std::string("PipeWire stream error: ") +
+                   (error ? error : "unknown"));
+    self->EndCapture("stream-error");
+  } else if (state == PW_STREAM_STATE_UNCONNECTED &&
+             self->is_capturing_.load()) {
+    // 不自动重连，目标节点消失后流会断开
+    self->EndCapture("stream-removed");
+  }
+}
+
+void AudioTap::ProcessAudioData() {
+  AUDIO_CAPTURE_RT_SCOPE();
+  trace::ScopedSpan span("backend-callback", trace_session_);
+
+  pw_buffer *buffer = pw_stream_dequeue_buffer(stream_);
+  if (!buffer) {
+    return;
+  }
+
+  spa_buffer *spa = buffer->buffer;
+  if (is_capturing_.load(std::memory_order_acquire) && callback_ &&
+      spa->n_datas > 0 && spa->datas[0].data &&
+      spa->datas[0].chunk) {
+    const spa_data &data = spa->datas[0];
+    uint32_t offset = std::min(data.chunk->offset, data.maxsize);
+    uint32_t size = std::min(data.chunk->size, data.maxsize - offset);
+
+    int channels = channels_.load(std::memory_order_relaxed);
+    int sample_rate = sample_rate_.load(std::memory_order_relaxed);
+    const float *samples = nullptr;
+
+    // 只在非静音时处理数据
+    if (size > 0 && !(data.chunk->flags & SPA_CHUNK_FLAG_EMPTY)) {
+      samples = reinterpret_cast<const float *>(
+          static_cast<const uint8_t *>(data.data) + offset);
+      callback_(static_cast<const uint8_t *>(data.data) + offset, size,
+                channels, sample_rate);
+    }
+
+    // 连续静音达到设定时长后请求线程循环暂停流
+    int rearm = rearm_.exchange(0, std::memory_order_acquire);
+    if (rearm != 0) {
+      detector_.Reset(rearm == 2);
+    }
+    if (idle_event_ &&
+        detector_.Feed(samples, size / (sizeof(float) * channels), channels,
+                       sample_rate)) {
+      suspend_requested_.store(true, std::memory_order_release);
+      pw_loop_signal_event(pw_thread_loop_get_loop(thread_loop_),
+                           idle_event_);
+    }
+  }
+
+  pw_stream_queue_buffer(stream_, buffer);
+}
+
+void AudioTap::WatchTarget() {
+  pw_loop *loop = pw_thread_loop_get_loop(thread_loop_);
+
+  // pidfd在目标进程退出时可读（Linux 5.3+），不支持时只依赖节点移除
+#ifdef SYS_pidfd_open
+  int pidfd = static_cast<int>(syscall(SYS_pidfd_open, target_pid_, 0));
+  if (pidfd >= 0) {
+    pidfd_source_ = pw_loop_add_io(loop, pidfd, SPA_IO_IN, true,
+                                   &AudioTap::OnTargetExit, this);
+  }
+#endif
+
+  registry_ = pw_core_get_registry(core_, PW_VERSION_REGISTRY, 0);
+  if (!registry_) {
+    return;
+  }
+  pw_registry_add_listener(registry_, &registry_listener_, &kRegistryEvents,
+                           this);
+
+  // 绑定目标节点只为空闲挂起时接收状态变化，失败时仍然可以按探测间隔恢复
+  if (idle_) {
+    target_node_ = static_cast<pw_node *>(pw_registry_bind(
+        registry_, target_id_, PW_TYPE_INTERFACE_Node, PW_VERSION_NODE, 0));
+    if (target_node_) {
+      pw_node_add_listener(target_node_, &node_listener_, &kNodeEvents, this);
+    }
+  }
+}
+
+void AudioTap::EndCapture(const char *reason) {
+  const char *expected = nullptr;
+  if (!ended_reason_.compare_exchange_strong(expected, reason)) {
+    return;
+  }
+  trace::RecordInstant("ended", trace_session_);
+  if (!is_capturing_.load()) {
+    return;
+  }
+
+  // 立即停止数据线程的回调，线程和连接由调用方的StopCapture释放
+  if (probe_timer_) {
+    pw_loop_update_timer(pw_thread_loop_get_loop(thread_loop_), probe_timer_,
+                         nullptr, nullptr, false);
+  }
+  pw_stream_set_active(stream_, false);
+  if (ended_callback_) {
+    ended_callback_(reason);
+  }
+}
+
+void AudioTap::OnTargetExit(void *userdata, int /*fd*/, uint32_t /*mask*/) {
+  auto *self = static_cast<AudioTap *>(userdata);
+
+  // pidfd保持可读，移除事件源（同时关闭pidfd）避免反复唤醒
+  pw_loop_destroy_source(pw_thread_loop_get_loop(self->thread_loop_),
+                         self->pidfd_source_);
+  self->pidfd_source_ = nullptr;
+  self->EndCapture("process-exited");
+}
+
+void AudioTap::OnGlobalRemove(void *userdata, uint32_t id) {
+  auto *self = static_cast<AudioTap *>(userdata);
+  if (id == self->target_id_) {
+    self->EndCapture("stream-removed");
+  }
+}
+
+void AudioTap::SuspendStream() {
+  if (ended_reason_.load() || pw_stream_set_active(stream_, false) < 0) {
+    return;
+  }
+  suspended_ = true;
+
+  // 配置变化时由JS线程发出同一个事件，在 OnIdleEvent 中处理
+  pw_loop *loop = pw_thread_loop_get_loop(thread_loop_);
+  spa_source *event = idle_event_;
+  idle_->Suspended(this, [loop, event]() { pw_loop_signal_event(loop, event); });
+  ArmProbeTimer();
+  trace::RecordInstant("idle-suspend", trace_session_);
+}
+
+void AudioTap::ResumeStream(bool probe) {
+  pw_loop_update_timer(pw_thread_loop_get_loop(thread_loop_), probe_timer_,
+                       nullptr, nullptr, false);
+  suspended_ = false;
+  idle_->Resumed(this, probe);
+  rearm_.store(probe ? 2 : 1, std::memory_order_release);
+  // 挂起期间目标已经结束时保持暂停，等待调用方停止
+  if (ended_reason_.load()) {
+    return;
+  }
+  pw_stream_set_active(stream_, true);
+  trace::RecordInstant("idle-resume", trace_session_);
+}
+
+void AudioTap::ArmProbeTimer() {
+  uint32_t ms = idle_->ProbeIntervalMs();
+  timespec value = {static_cast<time_t>(ms / 1000),
+                    static_cast<long>(ms % 1000) * 1000000};
+  pw_loop_update_timer(pw_thread_loop_get_loop(thread_loop_), probe_timer_,
+                       &value, nullptr, false);
+}
+
+void AudioTap::OnIdleEvent(void *userdata, uint64_t /*count*/) {
+  auto *self = static_cast<AudioTap *>(userdata);
+  uint64_t begin = ThreadCpuNs();
+  bool requested = self->suspend_requested_.exchange(false);
+  if (!self->is_capturing_.load()) {
+    return;
+  }
+
+  if (self->suspended_) {
+    // 配置变化：关闭时立即恢复，否则按新的探测间隔重新计时
+    if (self->idle_->IsEnabled()) {
+      self->ArmProbeTimer();
+    } else {
+      self->ResumeStream(false);
+    }
+    self->idle_->RecordWakeup(ThreadCpuNs() - begin);
+  } else if (requested && self->idle_->IsEnabled()) {
+    self->SuspendStream();
+  }
+}
+
+void AudioTap::OnProbeTimer(void *userdata, uint64_t /*expirations*/) {
+  auto *self = static_cast<AudioTap *>(userdata);
+  if (!self->suspended_) {
+    return;
+  }
+  uint64_t begin = ThreadCpuNs();
+  self->ResumeStream(true);
+  self->idle_->RecordWakeup(ThreadCpuNs() - begin);
+}
+
+void AudioTap::OnNodeInfo(void *userdata, const pw_node_info *info) {
+  auto *self = static_cast<AudioTap *>(userdata);
+  if (!(info->change_mask & PW_NODE_CHANGE_MASK_STATE)) {
+    return;
+  }
+  pw_node_state previous = self->target_state_;
+  self->target_state_ = info->state;
+  if (!self->suspended_) {
+    return;
+  }
+
+  // 目标节点重新开始运行（播放器从暂停恢复等）时立即恢复捕获
+  uint64_t begin = ThreadCpuNs();
+  if (info->state == PW_NODE_STATE_RUNNING &&
+      previous != PW_NODE_STATE_RUNNING) {
+    self->ResumeStream(false);
+  }
+  self->idle_->RecordWakeup(ThreadCpuNs() - begin);
+}
+
+} // namespace linux_audio
+} // namespace audio_capture
+
+#endif // __linux__
@@ -0,0 +1,110 @@
+#ifdef __linux__
+
+#include "../../include/linux/linux_audio_capture.h"
+#include "../../include/linux/audio_tap.h"
+
+/**
+ * @file linux_audio_capture.cc
+ * @brief Linux平台的音频捕获实现
+ *
+ * 本文件实现了Linux平台特定的音频捕获功能。
+ * 使用PipeWire实现进程级音频捕获。
+ */
+
+namespace audio_capture {
+
+LinuxAudioCapture::LinuxAudioCapture() {}
+
+LinuxAudioCapture::~LinuxAudioCapture() {
+  if (capturing_) {
+    StopCapture();
+  }
+}
+
+bool LinuxAudioCapture::Prepare(uint32_t pid, const CaptureOptions &options) {
+  if (capturing_) {
+    return false;
+  }
+
+  // 释放之前的准备结果
+  audio_tap_.reset();
+  current_pid_ = pid;
+
+  // 创建音频捕获对象，连接并协商好处于非活动状态的音频流
+  auto audio_tap = std::make_unique<linux_audio::AudioTap>(pid);
+  if (input_device_) {
+    audio_tap->SetInputDevice(device_);
+  }
+  if (!audio_tap->Initialize(options)) {
+    return false;
+  }
+
+  audio_tap_ = std::move(audio_tap);
+  return true;
+}
+
+bool LinuxAudioCapture::Start(AudioDataCallback callback) {
+  if (capturing_ || !audio_tap_) {
+    return false;
+  }
+
+  callback_ = callback;
+
+  // 激活已连接的音频流
+  audio_tap_->SetEndedCallback(ended_callback_);
+  if (!audio_tap_->Start(callback)) {
+    audio_tap_.reset();
+    return false;
+  }
+
+  capturing_ = true;
+  return true;
+}
+
+bool LinuxAudioCapture::IsPreparedFor(uint32_t pid) const {
+  return !capturing_ && audio_tap_ && current_pid_ == pid;
+}
+
+bool LinuxAudioCapture::StopCapture() {
+  bool was_capturing = capturing_.exchange(false);
+
+  // 停止音频捕获，同时释放尚未启动的准备结果
+  if (audio_tap_) {
+    audio_tap_->Stop();
+    audio_tap_.reset();
+  }
+
+  callback_ = nullptr;
+  current_pid_ = 0;
+  return was_capturing;
+}
+
+bool LinuxAudioCapture::IsCapturing() const { return capturing_.load(); }
+
+ChannelLayout LinuxAudioCapture::GetChannelLayout() const {
+  return audio_tap_ ? audio_tap_->GetChannelLayout() : ChannelLayout();
+}
+
+void LinuxAudioCapture::SetEndedCallback(EndedCallback callback) {
+  ended_callback_ = std::move(callback);
+}
+
+void LinuxAudioCapture::SetInputDevice(const std::string &device) {
+  input_device_ = true;
+  device_ = device;
+}
+
+std::unique_ptr<AudioCapture> CreatePlatformAudioCapture() {
+  return std::make_unique<LinuxAudioCapture>();
+}
+
+std::unique_ptr<AudioCapture>
+CreatePlatformInputCapture(const std::string &device) {
+  auto capture = std::make_unique<LinuxAudioCapture>();
+  capture->SetInputDevice(device);
+  return capture;
+}
+
+} // namespace audio_capture
+
+#endif // __linux__
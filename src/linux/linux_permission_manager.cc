@@ -0,0 +1,34 @@
+#ifdef __linux__
+
+#include "../../include/linux/linux_permission_manager.h"
+
+/**
+ * @file linux_permission_manager.cc
+ * @brief Linux平台的音频录制权限管理实现
+ */
+
+namespace permission_manager {
+
+// 在Linux平台上创建单例实例
+PermissionManager &PermissionManager::GetInstance() {
+  static LinuxPermissionManager instance;
+  return instance;
+}
+
+LinuxPermissionManager::LinuxPermissionManager() {}
+
+LinuxPermissionManager::~LinuxPermissionManager() {}
+
+PermissionStatus LinuxPermissionManager::CheckPermission() {
+  return PermissionStatus::Authorized;
+}
+
+void LinuxPermissionManager::RequestPermission(PermissionCallback callback) {
+  if (callback) {
+    callback(PermissionStatus::Authorized);
+  }
+}
+
+} // namespace permission_manager
+
+#endif // __linux__
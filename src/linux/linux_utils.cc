@@ -0,0 +1,188 @@
+#ifdef __linux__
+
+#include "../../include/linux/linux_utils.h"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <pipewire/pipewire.h>
+#include <unistd.h>
+
+/**
+ * @file linux_utils.cc
+ * @brief Linux平台工具函数实现
+ */
+
+namespace audio_capture {
+namespace linux_utils {
+
+namespace {
+
+// 枚举节点时等待PipeWire响应的超时时间（秒）
+constexpr time_t kEnumerateTimeoutSeconds = 2;
+
+struct EnumerateContext {
+  pw_main_loop *loop = nullptr;
+  int sync_seq = 0;
+  std::vector<StreamNode> nodes;
+};
+
+void OnRegistryGlobal(void *data, uint32_t id, uint32_t /*permissions*/,
+                      const char *type, uint32_t /*version*/,
+                      const struct spa_dict *props) {
+  auto *context = static_cast<EnumerateContext *>(data);
+  if (!props || std::strcmp(type, PW_TYPE_INTERFACE_Node) != 0) {
+    return;
+  }
+
+  // 只关心应用程序的音频输出流
+  const char *media_class = spa_dict_lookup(props, PW_KEY_MEDIA_CLASS);
+  if (!media_class || std::strcmp(media_class, "Stream/Output/Audio") != 0) {
+    return;
+  }
+
+  const char *pid = spa_dict_lookup(props, PW_KEY_APP_PROCESS_ID);
+  if (!pid) {
+    return;
+  }
+
+  StreamNode node = {};
+  node.id = id;
+  node.pid = static_cast<uint32_t>(std::strtoul(pid, nullptr, 10));
+
+  const char *serial = spa_dict_lookup(props, PW_KEY_OBJECT_SERIAL);
+  node.serial = serial ? std::strtoull(serial, nullptr, 10) : id;
+
+  const char *app_name = spa_dict_lookup(props, PW_KEY_APP_NAME);
+  if (app_name) {
+    node.app_name = app_name;
+  }
+
+  const char *binary = spa_dict_lookup(props, PW_KEY_APP_PROCESS_BINARY);
+  if (binary) {
+    node.binary = binary;
+  }
+
+  if (node.pid != 0) {
+    context->nodes.push_back(node);
+  }
+}
+
+void OnCoreDone(void *data, uint32_t id, int seq) {
+  auto *context = static_cast<EnumerateContext *>(data);
+  if (id == PW_ID_CORE && seq == context->sync_seq) {
+    pw_main_loop_quit(context->loop);
+  }
+}
+
+void OnCoreError(void *data, uint32_t id, int /*seq*/, int /*res*/,
+                 const char * /*message*/) {
+  auto *context = static_cast<EnumerateContext *>(data);
+  if (id == PW_ID_CORE) {
+    pw_main_loop_quit(context->loop);
+  }
+}
+
+void OnTimeout(void *data, uint64_t /*expirations*/) {
+  auto *context = static_cast<EnumerateContext *>(data);
+  pw_main_loop_quit(context->loop);
+}
+
+pw_registry_events MakeRegistryEvents() {
+  pw_registry_events events = {};
+  events.version = PW_VERSION_REGISTRY_EVENTS;
+  events.global = OnRegistryGlobal;
+  return events;
+}
+
+pw_core_events MakeCoreEvents() {
+  pw_core_events events = {};
+  events.version = PW_VERSION_CORE_EVENTS;
+  events.done = OnCoreDone;
+  events.error = OnCoreError;
+  return events;
+}
+
+const pw_registry_events kRegistryEvents = MakeRegistryEvents();
+const pw_core_events kCoreEvents = MakeCoreEvents();
+
+} // namespace
+
+void EnsurePipeWireInit() {
+  static std::once_flag once;
+  std::call_once(once, []() { pw_init(nullptr, nullptr); });
+}
+
+std::vector<StreamNode> GetAudioStreamNodes() {
+  EnsurePipeWireInit();
+
+  EnumerateContext context;
+  context.loop = pw_main_loop_new(nullptr);
+  if (!context.loop) {
+    return {};
+  }
+
+  pw_loop *loop = pw_main_loop_get_loop(context.loop);
+  pw_context *pw_ctx = pw_context_new(loop, nullptr, 0);
+  pw_core *core = pw_ctx ? pw_context_connect(pw_ctx, nullptr, 0) : nullptr;
+  if (!core) {
+    if (pw_ctx) {
+      pw_context_destroy(pw_ctx);
+    }
+    pw_main_loop_destroy(context.loop);
+    return {};
+  }
+
+  pw_registry *registry = pw_core_get_registry(core, PW_VERSION_REGISTRY, 0);
+
+  spa_hook registry_listener = {};
+  spa_hook core_listener = {};
+  pw_registry_add_listener(registry, &registry_listener, &kRegistryEvents,
+                           &context);
+  pw_core_add_listener(core, &core_listener, &kCoreEvents, &context);
+
+  // 所有已有对象的global事件都会在sync完成之前到达
+  context.sync_seq = pw_core_sync(core, PW_ID_CORE, 0);
+
+  // 防止PipeWire无响应时永久阻塞
+  spa_source *timer = pw_loop_add_timer(loop, OnTimeout, &context);
+  struct timespec timeout = {kEnumerateTimeoutSeconds, 0};
+  pw_loop_update_timer(loop, timer, &timeout, nullptr, false);
+
+  pw_main_loop_run(context.loop);
+
+  pw_loop_destroy_source(loop, timer);
+  spa_hook_remove(&registry_listener);
+  spa_hook_remove(&core_listener);
+  pw_proxy_destroy(reinterpret_cast<pw_proxy *>(registry));
+  pw_core_disconnect(core);
+  pw_context_destroy(pw_ctx);
+  pw_main_loop_destroy(context.loop);
+
+  return context.nodes;
+}
+
+std::string GetProcessName(uint32_t pid) {
+  std::ifstream comm("/proc/" + std::to_string(pid) + "/comm");
+  std::string name;
+  if (comm) {
+    std::getline(comm, name);
+  }
+  return name;
+}
+
+std::string GetProcessPath(uint32_t pid) {
+  std::string link = "/proc/" + std::to_string(pid) + "/exe";
+  char buffer[PATH_MAX];
+  ssize_t length = readlink(link.c_str(), buffer, sizeof(buffer) - 1);
+  if (length <= 0) {
+    return "";
+  }
+  return std::string(buffer, static_cast<size_t>(length));
+}
+
+} // namespace linux_utils
+} // namespace audio_capture
+
+#endif // __linux__
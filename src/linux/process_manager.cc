@@ -0,0 +1,72 @@
+#ifdef __linux__
+
+#include "../../include/process_manager.h"
+#include "../../include/linux/linux_utils.h"
+#include <set>
+#include <unistd.h>
+
+using namespace audio_capture;
+
+/**
+ * @file process_manager.cc
+ * @brief Linux进程管理实现
+ *
+ * 通过PipeWire的音频输出流节点获取正在播放音频的进程信息
+ */
+
+namespace process_manager {
+
+/**
+ * @brief 获取正在播放音频的进程列表
+ *
+ * 处理流程：
+ * 1. 枚举PipeWire中所有应用程序的音频输出流节点
+ * 2. 按 application.process.id 去重
+ * 3. 从节点属性和/proc中获取进程名称、路径
+ * 4. 过滤掉与当前应用相同可执行文件的进程
+ *
+ * @return 进程信息列表，失败时返回空列表
+ */
+std::vector<ProcessInfo> GetProcessList() {
+  std::vector<ProcessInfo> processes;
+  std::set<uint32_t> processed_pids;
+
+  std::string self_path =
+      linux_utils::GetProcessPath(static_cast<uint32_t>(getpid()));
+
+  for (const auto &node : linux_utils::GetAudioStreamNodes()) {
+    uint32_t pid = node.pid;
+    if (processed_pids.find(pid) != processed_pids.end()) {
+      continue;
+    }
+    processed_pids.insert(pid);
+
+    std::string path = linux_utils::GetProcessPath(pid);
+    if (!self_path.empty() && path == self_path) {
+      continue;
+    }
+
+    ProcessInfo process = {};
+    process.pid = pid;
+    process.path = path.empty() ? node.binary : path;
+    process.name = node.app_name;
+    if (process.name.empty()) {
+      process.name = linux_utils::GetProcessName(pid);
+    }
+    process.description =
+        node.binary.empty() ? "PID: " + std::to_string(pid) : node.binary;
+
+    // Linux上暂不提取图标
+    process.icon.format = "png";
+    process.icon.width = 0;
+    process.icon.height = 0;
+
+    processes.push_back(process);
+  }
+
+  return processes;
+}
+
+} // namespace process_manager
+
+#endif // __linux__
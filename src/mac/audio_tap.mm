@@ -2,12 +2,16 @@
 
 #include "../../include/mac/audio_tap.h"
 #include "../../include/mac/mac_utils.h"
+#include "../../include/rt_check.h"
+#include "../../include/trace.h"
 #include <AVFoundation/AVFoundation.h>
 #include <AppKit/AppKit.h>
 #include <AudioToolbox/AudioToolbox.h>
 #include <CoreAudio/AudioHardwareTapping.h>
 #include <CoreAudio/CATapDescription.h>
 #include <CoreFoundation/CoreFoundation.h>
+#include <algorithm>
+#include <atomic>
 #include <dispatch/dispatch.h>
 #include <libproc.h>
 #include <stdexcept>
@@ -35,8 +39,100 @@ struct AudioCallbackData {
   bool active;
   void *format;                    // AVAudioFormat对象指针
   AudioObjectID aggregateDeviceID; // 聚合设备ID
+  uint32_t session;                // trace事件的会话ID
+  // 聚合设备的实际采样率，由属性监听器更新，0表示使用格式中的采样率
+  std::atomic<int> sampleRate{0};
 };
 
+// 聚合设备实际采样率的属性地址
+static const AudioObjectPropertyAddress kActualSampleRateAddress = {
+    kAudioDevicePropertyActualSampleRate, kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMain};
+
+// 查询聚合设备的实际采样率（不在实时线程调用），失败时返回0
+static int QueryActualSampleRate(AudioObjectID deviceID) {
+  Float64 actualRate = 0;
+  UInt32 size = sizeof(actualRate);
+  OSStatus err = AudioObjectGetPropertyData(
+      deviceID, &kActualSampleRateAddress, 0, nullptr, &size, &actualRate);
+  return err == noErr && actualRate > 0 ? static_cast<int>(actualRate) : 0;
+}
+
+// 采样率变化时由HAL的通知线程调用，刷新缓存的采样率
+static OSStatus SampleRateListenerProc(
+    AudioObjectID inObjectID, UInt32 /*inNumberAddresses*/,
+    const AudioObjectPropertyAddress * /*inAddresses*/, void *inClientData) {
+  AudioCallbackData *data = static_cast<AudioCallbackData *>(inClientData);
+  int rate = QueryActualSampleRate(inObjectID);
+  if (data && rate > 0 &&
+      data->sampleRate.exchange(rate, std::memory_order_relaxed) != rate) {
+    trace::RecordInstant("format-changed", data->session);
+  }
+  return noErr;
+}
+
+// CoreAudio声道标签对应的位置简写
+static const char *ChannelLabelName(AudioChannelLabel label) {
+  switch (label) {
+  case kAudioChannelLabel_Left:
+    return "FL";
+  case kAudioChannelLabel_Right:
+    return "FR";
+  case kAudioChannelLabel_Center:
+    return "FC";
+  case kAudioChannelLabel_LFEScreen:
+    return "LFE";
+  case kAudioChannelLabel_LeftSurround:
+    return "SL";
+  case kAudioChannelLabel_RightSurround:
+    return "SR";
+  case kAudioChannelLabel_LeftCenter:
+    return "FLC";
+  case kAudioChannelLabel_RightCenter:
+    return "FRC";
+  case kAudioChannelLabel_CenterSurround:
+    return "RC";
+  case kAudioChannelLabel_RearSurroundLeft:
+    return "RL";
+  case kAudioChannelLabel_RearSurroundRight:
+    return "RR";
+  default:
+    return nullptr;
+  }
+}
+
+// 读取输出设备的首选声道布局，只识别按声道描述给出的布局，其余声道记为AUX
+static ChannelLayout QueryChannelLayout(AudioObjectID deviceID,
+                                        UInt32 channels) {
+  ChannelLayout layout;
+  AudioObjectPropertyAddress address = {
+      kAudioDevicePropertyPreferredChannelLayout,
+      kAudioObjectPropertyScopeOutput, kAudioObjectPropertyElementMain};
+  UInt32 size = 0;
+  if (AudioObjectGetPropertyDataSize(deviceID, &address, 0, nullptr, &size) ==
+          noErr &&
+      size >= sizeof(AudioChannelLayout)) {
+    std::vector<uint8_t> storage(size);
+    auto *channelLayout = reinterpret_cast<AudioChannelLayout *>(storage.data());
+    if (AudioObjectGetPropertyData(deviceID, &address, 0, nullptr, &size,
+                                   channelLayout) == noErr &&
+        channelLayout->mChannelLayoutTag ==
+            kAudioChannelLayoutTag_UseChannelDescriptions) {
+      for (UInt32 i = 0; i < channelLayout->mNumberChannelDescriptions &&
+                         layout.size() < channels;
+           ++i) {
+        const char *name =
+            ChannelLabelName(channelLayout->mChannelDescriptions[i].mChannelLabel);
+        layout.push_back(name ? name : "AUX" + std::to_string(layout.size()));
+      }
+    }
+  }
+  while (layout.size() < channels) {
+    layout.push_back("AUX" + std::to_string(layout.size()));
+  }
+  return layout;
+}
+
 // 音频IO回调函数
 static OSStatus AudioIOProcFunc(AudioDeviceID inDevice,
                                 const AudioTimeStamp *inNow,
@@ -50,6 +146,9 @@ static OSStatus AudioIOProcFunc(AudioDeviceID inDevice,
     return noErr;
   }
 
+  AUDIO_CAPTURE_RT_SCOPE();
+  trace::ScopedSpan span("backend-callback", data->session);
+
   if (!data->active) {
     return noErr;
   }
@@ -96,19 +195,10 @@ static OSStatus AudioIOProcFunc(AudioDeviceID inDevice,
   UInt32 channels = format.channelCount;
   int sampleRate = format.sampleRate;
 
-  // 查询聚合设备的实际采样率（更准确）
-  if (data->aggregateDeviceID != kAudioObjectUnknown) {
-    Float64 actualRate = 0;
-    AudioObjectPropertyAddress actualRateAddr = {
-        kAudioDevicePropertyActualSampleRate, kAudioObjectPropertyScopeGlobal,
-        kAudioObjectPropertyElementMain};
-    UInt32 size = sizeof(actualRate);
-    OSStatus err =
-        AudioObjectGetPropertyData(data->aggregateDeviceID, &actualRateAddr, 0,
-                                   nullptr, &size, &actualRate);
-    if (err == noErr && actualRate > 0) {
-      sampleRate = static_cast<int>(actualRate);
-    }
+  // 聚合设备的实际采样率（更准确）由属性监听器缓存，实时线程中不查询HAL
+  int actualRate = data->sampleRate.load(std::memory_order_relaxed);
+  if (actualRate > 0) {
+    sampleRate = actualRate;
   }
 
   // 重新计算帧数：如果是非交错数据，每个缓冲区包含一个声道的所有帧
@@ -145,6 +235,7 @@ static OSStatus AudioIOProcFunc(AudioDeviceID inDevice,
 
   } else {
     // 非交错格式：转换为交错格式
+    trace::ScopedSpan conversionSpan("conversion", data->session);
     bufferSize = frameCount * channels * sizeof(float);
     buffer = new uint8_t[bufferSize];
     float *outputFloat = reinterpret_cast<float *>(buffer);
@@ -179,14 +270,29 @@ static OSStatus AudioIOProcFunc(AudioDeviceID inDevice,
   return noErr;
 }
 
-ProcessTap::ProcessTap(uint32_t pid) : pid_(pid) {}
+ProcessTap::ProcessTap(uint32_t pid) : pid_(pid), trace_session_(pid) {}
 
-ProcessTap::~ProcessTap() { Stop(); }
+ProcessTap::~ProcessTap() {
+  Stop();
+  // 已准备但未启动时也需要销毁tap和聚合设备
+  Cleanup();
+}
 
-bool ProcessTap::Initialize() {
+bool ProcessTap::Initialize(const CaptureOptions &options) {
   if (initialized_) {
     return true;
   }
+  period_frames_ = options.period_frames;
+  native_format_ = options.native_format;
+  trace_session_ = options.TraceSession(pid_);
+
+  if (input_device_) {
+    if (!PrepareInput()) {
+      return false;
+    }
+    initialized_ = true;
+    return true;
+  }
 
   // 获取进程的AudioObjectID
   AudioObjectID objectID =
@@ -204,18 +310,148 @@ bool ProcessTap::Initialize() {
   return true;
 }
 
+void ProcessTap::SetInputDevice(const std::string &device) {
+  input_device_ = true;
+  device_uid_ = device;
+}
+
+bool ProcessTap::PrepareInput() {
+  error_message_ = "";
+
+  @autoreleasepool {
+    // 查找输入设备：指定UID时按UID转换，否则使用默认输入设备
+    AudioObjectID inputID = kAudioObjectUnknown;
+    UInt32 size = sizeof(inputID);
+    OSStatus err = noErr;
+    if (device_uid_.empty()) {
+      AudioObjectPropertyAddress address = {
+          kAudioHardwarePropertyDefaultInputDevice,
+          kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain};
+      err = AudioObjectGetPropertyData(kAudioObjectSystemObject, &address, 0,
+                                       nullptr, &size, &inputID);
+    } else {
+      CFStringRef uid = (__bridge CFStringRef)
+          [NSString stringWithUTF8String:device_uid_.c_str()];
+      AudioObjectPropertyAddress address = {
+          kAudioHardwarePropertyTranslateUIDToDevice,
+          kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain};
+      err = AudioObjectGetPropertyData(kAudioObjectSystemObject, &address,
+                                       sizeof(uid), &uid, &size, &inputID);
+    }
+    if (err != noErr || inputID == kAudioObjectUnknown) {
+      error_message_ = "获取输入设备失败，错误码: " + std::to_string(err);
+      return false;
+    }
+
+    CFStringRef inputUID = nullptr;
+    AudioObjectPropertyAddress uidAddress = {kAudioDevicePropertyDeviceUID,
+                                             kAudioObjectPropertyScopeGlobal,
+                                             kAudioObjectPropertyElementMain};
+    size = sizeof(inputUID);
+    err = AudioObjectGetPropertyData(inputID, &uidAddress, 0, nullptr, &size,
+                                     &inputUID);
+    if (err != noErr) {
+      error_message_ = "获取设备UID失败，错误码: " + std::to_string(err);
+      return false;
+    }
+
+    // 输入流的格式（HAL的虚拟格式为交错的32位浮点）
+    AudioObjectPropertyAddress formatAddress = {
+        kAudioDevicePropertyStreamFormat, kAudioObjectPropertyScopeInput,
+        kAudioObjectPropertyElementMain};
+    size = sizeof(tap_stream_description_);
+    err = AudioObjectGetPropertyData(inputID, &formatAddress, 0, nullptr, &size,
+                                     &tap_stream_description_);
+    if (err != noErr || tap_stream_description_.mChannelsPerFrame == 0) {
+      error_message_ = "获取输入格式失败，错误码: " + std::to_string(err);
+      CFRelease(inputUID);
+      return false;
+    }
+    layout_.clear();
+    for (UInt32 i = 0; i < tap_stream_description_.mChannelsPerFrame; ++i) {
+      layout_.push_back(tap_stream_description_.mChannelsPerFrame == 2
+                            ? (i == 0 ? "FL" : "FR")
+                            : "AUX" + std::to_string(i));
+    }
+
+    // 与进程捕获共用IO过程、采样率监听和周期设置，同样通过私有聚合设备打开
+    NSDictionary *description = @{
+      @"name" : [NSString stringWithFormat:@"Input-%u", pid_],
+      @"uid" : [[NSUUID UUID] UUIDString],
+      @"master" : (__bridge NSString *)inputUID,
+      @"private" : @YES,
+      @"stacked" : @NO,
+      @"subdevices" : @[ @{@"uid" : (__bridge NSString *)inputUID} ]
+    };
+
+    AudioObjectID aggregateDeviceID = kAudioObjectUnknown;
+    err = AudioHardwareCreateAggregateDevice(
+        (__bridge CFDictionaryRef)description, &aggregateDeviceID);
+    CFRelease(inputUID);
+    if (err != noErr) {
+      error_message_ = "创建聚合设备失败，错误码: " + std::to_string(err);
+      return false;
+    }
+    aggregate_device_id_ = aggregateDeviceID;
+    ApplyPeriod();
+  }
+
+  return true;
+}
+
 bool ProcessTap::Prepare(AudioObjectID objectID) {
   error_message_ = "";
 
   @try {
     @autoreleasepool {
 
+      // 获取默认输出设备
+      AudioObjectID systemOutputID = kAudioObjectUnknown;
+      AudioObjectPropertyAddress outputAddress = {
+          kAudioHardwarePropertyDefaultOutputDevice,
+          kAudioObjectPropertyScopeGlobal,
+          kAudioObjectPropertyElementMain,
+      };
+
+      UInt32 outputDataSize = sizeof(systemOutputID);
+      OSStatus outputErr = AudioObjectGetPropertyData(
+          kAudioObjectSystemObject, &outputAddress, 0, nullptr, &outputDataSize,
+          &systemOutputID);
+
+      if (outputErr != noErr) {
+        error_message_ =
+            "获取默认输出设备失败，错误码: " + std::to_string(outputErr);
+        return false;
+      }
+
+      // 获取输出设备UID
+      CFStringRef outputUID = nullptr;
+      outputAddress.mSelector = kAudioDevicePropertyDeviceUID;
+      outputDataSize = sizeof(CFStringRef);
+      outputErr =
+          AudioObjectGetPropertyData(systemOutputID, &outputAddress, 0, nullptr,
+                                     &outputDataSize, &outputUID);
+
+      if (outputErr != noErr) {
+        error_message_ =
+            "获取设备UID失败，错误码: " + std::to_string(outputErr);
+        return false;
+      }
+
       // 创建进程音频捕获描述
       CATapDescription *tapDescription = nil;
 
       @try {
-        tapDescription = [[CATapDescription alloc]
-            initStereoMixdownOfProcesses:@[ @(objectID) ]];
+        if (native_format_) {
+          // 按输出设备第一个流的原始格式捕获，不做立体声下混
+          tapDescription = [[CATapDescription alloc]
+              initWithProcesses:@[ @(objectID) ]
+                   andDeviceUID:(__bridge NSString *)outputUID
+                     withStream:0];
+        } else {
+          tapDescription = [[CATapDescription alloc]
+              initStereoMixdownOfProcesses:@[ @(objectID) ]];
+        }
       } @catch (NSException *exception) {
         error_message_ = "创建CATapDescription时出现异常: " +
                          std::string([exception.description UTF8String]);
@@ -251,39 +487,6 @@ bool ProcessTap::Prepare(AudioObjectID objectID) {
 
       process_tap_id_ = tapID;
 
-      // 获取默认输出设备
-      AudioObjectID systemOutputID = kAudioObjectUnknown;
-      AudioObjectPropertyAddress outputAddress = {
-          kAudioHardwarePropertyDefaultOutputDevice,
-          kAudioObjectPropertyScopeGlobal,
-          kAudioObjectPropertyElementMain,
-      };
-
-      UInt32 outputDataSize = sizeof(systemOutputID);
-      OSStatus outputErr = AudioObjectGetPropertyData(
-          kAudioObjectSystemObject, &outputAddress, 0, nullptr, &outputDataSize,
-          &systemOutputID);
-
-      if (outputErr != noErr) {
-        error_message_ =
-            "获取默认输出设备失败，错误码: " + std::to_string(outputErr);
-        return false;
-      }
-
-      // 获取输出设备UID
-      CFStringRef outputUID = nullptr;
-      outputAddress.mSelector = kAudioDevicePropertyDeviceUID;
-      outputDataSize = sizeof(CFStringRef);
-      outputErr =
-          AudioObjectGetPropertyData(systemOutputID, &outputAddress, 0, nullptr,
-                                     &outputDataSize, &outputUID);
-
-      if (outputErr != noErr) {
-        error_message_ =
-            "获取设备UID失败，错误码: " + std::to_string(outputErr);
-        return false;
-      }
-
       // 创建聚合设备描述
       NSString *aggregateUID = [[NSUUID UUID] UUIDString];
       NSString *tapUUID = [tapDescription.UUID UUIDString];
@@ -319,6 +522,10 @@ bool ProcessTap::Prepare(AudioObjectID objectID) {
         return false;
       }
       tap_stream_description_ = tapStreamDescription;
+      layout_ = native_format_
+                    ? QueryChannelLayout(systemOutputID,
+                                         tapStreamDescription.mChannelsPerFrame)
+                    : ChannelLayout{"FL", "FR"};
 
       // 创建聚合设备
       AudioObjectID aggregateDeviceID = kAudioObjectUnknown;
@@ -331,6 +538,7 @@ bool ProcessTap::Prepare(AudioObjectID objectID) {
         return false;
       }
       aggregate_device_id_ = aggregateDeviceID;
+      ApplyPeriod();
 
       // 释放资源
       if (outputUID) {
@@ -359,8 +567,19 @@ bool ProcessTap::Start(AudioDataCallback callback) {
   }
 
   // 创建AVAudioFormat对象（参考Swift版本在启动时获取格式）
-  AVAudioFormat *format = [[AVAudioFormat alloc]
-      initWithStreamDescription:&tap_stream_description_];
+  // 超过2声道时必须提供声道布局，这里只用来包装缓冲区，按顺序的离散声道即可
+  AVAudioFormat *format = nil;
+  if (tap_stream_description_.mChannelsPerFrame > 2) {
+    AVAudioChannelLayout *channelLayout = [[AVAudioChannelLayout alloc]
+        initWithLayoutTag:kAudioChannelLayoutTag_DiscreteInOrder |
+                          tap_stream_description_.mChannelsPerFrame];
+    format = [[AVAudioFormat alloc]
+        initWithStreamDescription:&tap_stream_description_
+                    channelLayout:channelLayout];
+  } else {
+    format = [[AVAudioFormat alloc]
+        initWithStreamDescription:&tap_stream_description_];
+  }
   if (!format) {
     error_message_ = "创建AVAudioFormat失败";
     return false;
@@ -375,16 +594,26 @@ bool ProcessTap::Start(AudioDataCallback callback) {
   callbackData->active = true;
   callbackData->format = audio_format_; // 传递格式对象给回调
   callbackData->aggregateDeviceID = aggregate_device_id_;
+  callbackData->session = trace_session_;
+  callbackData->sampleRate.store(QueryActualSampleRate(aggregate_device_id_));
 
   callback_ = callback;
   callback_data_ = callbackData;
 
+  // 监听实际采样率的变化，监听失败时沿用启动时查询到的采样率
+  rate_listener_added_ =
+      AudioObjectAddPropertyListener(aggregate_device_id_,
+                                     &kActualSampleRateAddress,
+                                     SampleRateListenerProc,
+                                     callbackData) == noErr;
+
   // 创建音频IO过程
   OSStatus err = AudioDeviceCreateIOProcID(
       aggregate_device_id_, AudioIOProcFunc, callbackData, &device_proc_id_);
 
   if (err != noErr) {
     error_message_ = "创建音频IO过程失败，错误码: " + std::to_string(err);
+    RemoveSampleRateListener();
     delete callbackData;
     callback_data_ = nullptr;
     return false;
@@ -396,15 +625,69 @@ bool ProcessTap::Start(AudioDataCallback callback) {
     error_message_ = "启动音频设备失败，错误码: " + std::to_string(err);
     AudioDeviceDestroyIOProcID(aggregate_device_id_, device_proc_id_);
     device_proc_id_ = nullptr;
+    RemoveSampleRateListener();
     delete callbackData;
     callback_data_ = nullptr;
     return false;
   }
 
   capturing_ = true;
+  WatchProcessExit();
   return true;
 }
 
+void ProcessTap::WatchProcessExit() {
+  if (input_device_ || !ended_callback_) {
+    return;
+  }
+
+  exit_queue_ = dispatch_queue_create("audio-capture.process-exit",
+                                      DISPATCH_QUEUE_SERIAL);
+  exit_source_ = dispatch_source_create(DISPATCH_SOURCE_TYPE_PROC, pid_,
+                                        DISPATCH_PROC_EXIT, exit_queue_);
+  if (!exit_source_) {
+    // 进程已经不存在时创建失败，按退出处理
+    dispatch_release(exit_queue_);
+    exit_queue_ = nullptr;
+    trace::RecordInstant("ended", trace_session_);
+    EndedCallback callback = std::move(ended_callback_);
+    ended_callback_ = nullptr;
+    callback("process-exited");
+    return;
+  }
+
+  // 事件源只触发一次：取走回调后调用，设备由调用方的StopCapture停止
+  uint32_t session = trace_session_;
+  EndedCallback *callback = &ended_callback_;
+  dispatch_source_set_event_handler(exit_source_, ^{
+    if (!*callback) {
+      return;
+    }
+    trace::RecordInstant("ended", session);
+    EndedCallback ended = std::move(*callback);
+    *callback = nullptr;
+    ended("process-exited");
+  });
+  dispatch_resume(exit_source_);
+}
+
+void ProcessTap::CancelProcessExitWatch() {
+  if (!exit_source_) {
+    return;
+  }
+
+  dispatch_source_cancel(exit_source_);
+  // 等待可能正在执行的事件处理结束，之后不会再调用回调
+  EndedCallback *callback = &ended_callback_;
+  dispatch_sync(exit_queue_, ^{
+    *callback = nullptr;
+  });
+  dispatch_release(exit_source_);
+  dispatch_release(exit_queue_);
+  exit_source_ = nullptr;
+  exit_queue_ = nullptr;
+}
+
 bool ProcessTap::Stop() {
 
   if (!capturing_) {
@@ -431,8 +714,58 @@ void ProcessTap::HandleInvalidation() {
   Cleanup();
 }
 
+void ProcessTap::ApplyPeriod() {
+  if (period_frames_ == 0) {
+    return;
+  }
+
+  // 按聚合设备的采样率换算，并限制在设备支持的范围内
+  UInt32 frames = period_frames_;
+  int rate = QueryActualSampleRate(aggregate_device_id_);
+  if (rate > 0) {
+    frames = static_cast<UInt32>(static_cast<uint64_t>(period_frames_) * rate /
+                                 CaptureOptions::kReferenceSampleRate);
+  }
+
+  AudioValueRange range = {};
+  AudioObjectPropertyAddress rangeAddress = {
+      kAudioDevicePropertyBufferFrameSizeRange,
+      kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain};
+  UInt32 size = sizeof(range);
+  if (AudioObjectGetPropertyData(aggregate_device_id_, &rangeAddress, 0,
+                                 nullptr, &size, &range) == noErr &&
+      range.mMaximum > 0) {
+    frames = std::max<UInt32>(static_cast<UInt32>(range.mMinimum),
+                              std::min<UInt32>(frames, range.mMaximum));
+  }
+
+  AudioObjectPropertyAddress sizeAddress = {kAudioDevicePropertyBufferFrameSize,
+                                            kAudioObjectPropertyScopeGlobal,
+                                            kAudioObjectPropertyElementMain};
+  OSStatus err = AudioObjectSetPropertyData(
+      aggregate_device_id_, &sizeAddress, 0, nullptr, sizeof(frames), &frames);
+  if (err != noErr) {
+    trace::RecordInstant("period-rejected", trace_session_);
+  }
+}
+
+void ProcessTap::RemoveSampleRateListener() {
+  if (rate_listener_added_) {
+    AudioObjectRemovePropertyListener(aggregate_device_id_,
+                                      &kActualSampleRateAddress,
+                                      SampleRateListenerProc, callback_data_);
+    rate_listener_added_ = false;
+  }
+}
+
 void ProcessTap::Cleanup() {
 
+  // 进程退出的回调可能在任意时刻到达，先于其他资源停止监视
+  CancelProcessExitWatch();
+
+  // 先移除属性监听器，之后HAL不会再访问回调数据
+  RemoveSampleRateListener();
+
   // 销毁音频IO过程ID
   if (aggregate_device_id_ != kAudioObjectUnknown &&
       device_proc_id_ != nullptr) {
@@ -47,24 +47,44 @@ bool MacAudioCapture::Initialize() {
 
 void MacAudioCapture::Cleanup() { initialized_ = false; }
 
-bool MacAudioCapture::StartCapture(uint32_t pid, AudioDataCallback callback) {
+bool MacAudioCapture::Prepare(uint32_t pid, const CaptureOptions &options) {
   if (capturing_) {
     return false;
   }
 
-  callback_ = callback;
+  // 释放之前的准备结果
+  process_tap_.reset();
   current_pid_ = pid;
 
-  // 创建音频捕获对象
-  process_tap_ = std::make_unique<audio_tap::ProcessTap>(pid);
+  // 创建音频捕获对象并完成tap和聚合设备的创建
+  auto process_tap = std::make_unique<audio_tap::ProcessTap>(pid);
+  if (input_device_) {
+    process_tap->SetInputDevice(device_);
+  }
+  if (!process_tap->Initialize(options)) {
+    return false;
+  }
 
-  // 初始化音频捕获
-  if (!process_tap_->Initialize()) {
+  // 在工作线程中准备时，调用方可能已经放弃了这次启动
+  if (options.IsCancelled()) {
     return false;
   }
 
+  process_tap_ = std::move(process_tap);
+  return true;
+}
+
+bool MacAudioCapture::Start(AudioDataCallback callback) {
+  if (capturing_ || !process_tap_) {
+    return false;
+  }
+
+  callback_ = callback;
+
   // 开始捕获
+  process_tap_->SetEndedCallback(ended_callback_);
   if (!process_tap_->Start(callback)) {
+    process_tap_.reset();
     return false;
   }
 
@@ -72,14 +92,14 @@ bool MacAudioCapture::StartCapture(uint32_t pid, AudioDataCallback callback) {
   return true;
 }
 
-bool MacAudioCapture::StopCapture() {
-  if (!capturing_) {
-    return false;
-  }
+bool MacAudioCapture::IsPreparedFor(uint32_t pid) const {
+  return !capturing_ && process_tap_ && current_pid_ == pid;
+}
 
-  capturing_ = false;
+bool MacAudioCapture::StopCapture() {
+  bool was_capturing = capturing_.exchange(false);
 
-  // 停止音频捕获
+  // 停止音频捕获，同时释放尚未启动的准备结果
   if (process_tap_) {
     process_tap_->Stop();
     process_tap_.reset();
@@ -88,11 +108,19 @@ bool MacAudioCapture::StopCapture() {
   callback_ = nullptr;
   current_pid_ = 0;
 
-  return true;
+  return was_capturing;
 }
 
 bool MacAudioCapture::IsCapturing() const { return capturing_.load(); }
 
+ChannelLayout MacAudioCapture::GetChannelLayout() const {
+  return process_tap_ ? process_tap_->GetChannelLayout() : ChannelLayout();
+}
+
+void MacAudioCapture::SetEndedCallback(EndedCallback callback) {
+  ended_callback_ = std::move(callback);
+}
+
 /**
  * @brief 工厂函数 - 创建平台特定的实现
  * @return 平台特定的AudioCapture实例
@@ -101,6 +129,22 @@ std::unique_ptr<AudioCapture> CreatePlatformAudioCapture() {
   return std::make_unique<MacAudioCapture>();
 }
 
+void MacAudioCapture::SetInputDevice(const std::string &device) {
+  input_device_ = true;
+  device_ = device;
+}
+
+/**
+ * @brief 工厂函数 - 创建捕获输入设备的实现
+ * @param device 输入设备UID，为空时使用默认输入设备
+ */
+std::unique_ptr<AudioCapture>
+CreatePlatformInputCapture(const std::string &device) {
+  auto capture = std::make_unique<MacAudioCapture>();
+  capture->SetInputDevice(device);
+  return capture;
+}
+
 } // namespace audio_capture
 
 #endif // __APPLE__
@@ -0,0 +1,424 @@
+#include "../include/metrics.h"
+#include "../include/dsp_pool.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file metrics.cc
+ * @brief 运行指标的记录、导出和抓取服务
+ */
+
+namespace audio_capture {
+namespace metrics {
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle kInvalidSocket = INVALID_SOCKET;
+void CloseSocket(SocketHandle fd) { closesocket(fd); }
+int PollSocket(SocketHandle fd, int timeout_ms) {
+  WSAPOLLFD entry = {fd, POLLRDNORM, 0};
+  return WSAPoll(&entry, 1, timeout_ms);
+}
+#else
+using SocketHandle = int;
+constexpr SocketHandle kInvalidSocket = -1;
+void CloseSocket(SocketHandle fd) { close(fd); }
+int PollSocket(SocketHandle fd, int timeout_ms) {
+  pollfd entry = {fd, POLLIN, 0};
+  return poll(&entry, 1, timeout_ms);
+}
+#endif
+
+/**
+ * 固定分桶的直方图，桶上界以纳秒为单位，导出时换算为秒并累加
+ */
+template <size_t N> class Histogram {
+public:
+  explicit Histogram(const uint64_t (&bounds)[N]) {
+    for (size_t i = 0; i < N; ++i) {
+      bounds_[i] = bounds[i];
+    }
+  }
+
+  void Observe(uint64_t ns) {
+    size_t index = 0;
+    while (index < N && ns > bounds_[index]) {
+      ++index;
+    }
+    counts_[index].fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+  }
+
+  void Render(std::string *out, const char *name, const char *help) const {
+    char line[256];
+    std::snprintf(line, sizeof(line), "# TYPE %s histogram\n# HELP %s %s\n",
+                  name, name, help);
+    *out += line;
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= N; ++i) {
+      cumulative += counts_[i].load(std::memory_order_relaxed);
+      if (i < N) {
+        std::snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %llu\n", name,
+                      bounds_[i] / 1e9,
+                      static_cast<unsigned long long>(cumulative));
+      } else {
+        std::snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n",
+                      name, static_cast<unsigned long long>(cumulative));
+      }
+      *out += line;
+    }
+    std::snprintf(line, sizeof(line), "%s_sum %.9g\n%s_count %llu\n", name,
+                  sum_ns_.load(std::memory_order_relaxed) / 1e9, name,
+                  static_cast<unsigned long long>(cumulative));
+    *out += line;
+  }
+
+private:
+  uint64_t bounds_[N];
+  std::atomic<uint64_t> counts_[N + 1] = {}; ///< 最后一个为 +Inf 桶
+  std::atomic<uint64_t> sum_ns_{0};
+};
+
+constexpr uint64_t kLatencyBounds[] = {
+    500000,   1000000,   2500000,   5000000,   10000000,  25000000,
+    50000000, 100000000, 250000000, 500000000, 1000000000};
+
+constexpr uint64_t kEnumerationBounds[] = {
+    1000000,   5000000,   10000000,   25000000,   50000000,  100000000,
+    250000000, 500000000, 1000000000, 2500000000, 5000000000};
+
+constexpr size_t kStageCount = 2;
+constexpr const char *kStageNames[kStageCount] = {"denoise", "wav"};
+
+struct StageCounters {
+  std::atomic<uint64_t> cpu_ns{0};
+  std::atomic<uint64_t> audio_ns{0};
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<int64_t> g_sessions_active{0};
+std::atomic<uint64_t> g_sessions_started{0};
+std::atomic<uint64_t> g_packets{0};
+std::atomic<uint64_t> g_dropped{0};
+Histogram<sizeof(kLatencyBounds) / sizeof(uint64_t)>
+    g_callback_latency(kLatencyBounds);
+Histogram<sizeof(kEnumerationBounds) / sizeof(uint64_t)>
+    g_enumeration(kEnumerationBounds);
+StageCounters g_stages[kStageCount];
+
+void RenderValue(std::string *out, const char *name, const char *type,
+                 const char *help, double value) {
+  char line[256];
+  // 计数器的样本名带 _total 后缀
+  std::snprintf(line, sizeof(line), "# TYPE %s %s\n# HELP %s %s\n%s%s %.17g\n",
+                name, type, name, help, name,
+                std::strcmp(type, "counter") == 0 ? "_total" : "", value);
+  *out += line;
+}
+
+// 抓取服务：一个线程轮询监听socket，逐个应答连接
+struct Server {
+  std::mutex mutex; ///< 保护启动和停止
+  std::thread thread;
+  std::atomic<bool> stop{false};
+  SocketHandle fd = kInvalidSocket;
+  std::string socket_path;
+};
+
+Server g_server;
+
+// 读取请求头（不关心内容，只是让HTTP客户端发完请求），最多等待1秒
+void DrainRequest(SocketHandle client) {
+  char buffer[2048];
+  std::string request;
+  while (request.size() < 16384 &&
+         request.find("\r\n\r\n") == std::string::npos &&
+         PollSocket(client, 1000) > 0) {
+    int received = static_cast<int>(recv(client, buffer, sizeof(buffer), 0));
+    if (received <= 0) {
+      break;
+    }
+    request.append(buffer, static_cast<size_t>(received));
+  }
+}
+
+void SendAll(SocketHandle client, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    int result = static_cast<int>(send(client, data.data() + sent,
+                                       static_cast<int>(data.size() - sent),
+                                       0));
+    if (result <= 0) {
+      return;
+    }
+    sent += static_cast<size_t>(result);
+  }
+}
+
+void ServerProc(SocketHandle fd) {
+  while (!g_server.stop.load()) {
+    // 定期醒来检查停止标志
+    if (PollSocket(fd, 100) <= 0) {
+      continue;
+    }
+    SocketHandle client = accept(fd, nullptr, nullptr);
+    if (client == kInvalidSocket) {
+      continue;
+    }
+    DrainRequest(client);
+    std::string body = Render();
+    std::string response =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/openmetrics-text; version=1.0.0; "
+        "charset=utf-8\r\n"
+        "Connection: close\r\n"
+        "Content-Length: " +
+        std::to_string(body.size()) + "\r\n\r\n" + body;
+    SendAll(client, response);
+    CloseSocket(client);
+  }
+}
+
+SocketHandle Listen(const std::string &socket_path, int port,
+                    std::string *error) {
+#ifdef _WIN32
+  if (!socket_path.empty()) {
+    *error = "Windows上指标服务只支持回环端口";
+    return kInvalidSocket;
+  }
+  WSADATA data;
+  if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+    *error = "初始化Winsock失败";
+    return kInvalidSocket;
+  }
+#endif
+
+  SocketHandle fd = kInvalidSocket;
+  int result = -1;
+  if (!socket_path.empty()) {
+#ifndef _WIN32
+    sockaddr_un address = {};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+      *error = "Unix socket路径过长: " + socket_path;
+      return kInvalidSocket;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd != kInvalidSocket) {
+      // 上次进程异常退出时可能留下socket文件
+      unlink(socket_path.c_str());
+      result = bind(fd, reinterpret_cast<sockaddr *>(&address),
+                    sizeof(address));
+    }
+#endif
+  } else {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd != kInvalidSocket) {
+      int reuse = 1;
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR,
+                 reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+      result = bind(fd, reinterpret_cast<sockaddr *>(&address),
+                    sizeof(address));
+    }
+  }
+
+  if (fd == kInvalidSocket || result != 0 || listen(fd, 8) != 0) {
+    if (fd != kInvalidSocket) {
+      CloseSocket(fd);
+    }
+#ifdef _WIN32
+    // 只有成功的 WSAStartup 才需要配对的 WSACleanup
+    WSACleanup();
+#endif
+    *error = socket_path.empty()
+                 ? "无法监听指标端口 127.0.0.1:" + std::to_string(port)
+                 : "无法监听指标socket: " + socket_path;
+    return kInvalidSocket;
+  }
+  return fd;
+}
+
+void StopServingLocked() {
+  if (g_server.fd == kInvalidSocket) {
+    return;
+  }
+  g_server.stop.store(true);
+  if (g_server.thread.joinable()) {
+    g_server.thread.join();
+  }
+  CloseSocket(g_server.fd);
+  g_server.fd = kInvalidSocket;
+#ifdef _WIN32
+  WSACleanup();
+#else
+  if (!g_server.socket_path.empty()) {
+    unlink(g_server.socket_path.c_str());
+  }
+#endif
+  g_server.socket_path.clear();
+}
+
+} // namespace
+
+bool IsEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+void Enable(bool enabled) { g_enabled.store(enabled); }
+
+void SessionStarted() {
+  g_sessions_active.fetch_add(1, std::memory_order_relaxed);
+  g_sessions_started.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SessionEnded() {
+  g_sessions_active.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void AddPackets(uint64_t count) {
+  if (IsEnabled()) {
+    g_packets.fetch_add(count, std::memory_order_relaxed);
+  }
+}
+
+void AddDropped(uint64_t count) {
+  if (IsEnabled()) {
+    g_dropped.fetch_add(count, std::memory_order_relaxed);
+  }
+}
+
+void ObserveCallbackLatency(uint64_t ns) {
+  if (IsEnabled()) {
+    g_callback_latency.Observe(ns);
+  }
+}
+
+void ObserveEnumeration(uint64_t ns) {
+  if (IsEnabled()) {
+    g_enumeration.Observe(ns);
+  }
+}
+
+void AddStageCost(Stage stage, uint64_t cpu_ns, uint64_t audio_ns) {
+  if (IsEnabled()) {
+    StageCounters &counters = g_stages[static_cast<size_t>(stage)];
+    counters.cpu_ns.fetch_add(cpu_ns, std::memory_order_relaxed);
+    counters.audio_ns.fetch_add(audio_ns, std::memory_order_relaxed);
+  }
+}
+
+std::string Render() {
+  std::string out;
+  out.reserve(4096);
+
+  RenderValue(&out, "audio_capture_sessions_active", "gauge",
+              "Capture sessions currently delivering data.",
+              static_cast<double>(g_sessions_active.load()));
+  RenderValue(&out, "audio_capture_sessions_started", "counter",
+              "Capture sessions started.",
+              static_cast<double>(g_sessions_started.load()));
+  RenderValue(&out, "audio_capture_packets", "counter",
+              "Packets received from audio backends.",
+              static_cast<double>(g_packets.load()));
+  RenderValue(&out, "audio_capture_dropped_packets", "counter",
+              "Packets dropped before reaching JavaScript.",
+              static_cast<double>(g_dropped.load()));
+  g_callback_latency.Render(
+      &out, "audio_capture_callback_latency_seconds",
+      "Delay from enqueue to the start of the JavaScript callback.");
+  g_enumeration.Render(&out, "audio_capture_enumeration_seconds",
+                       "Time spent enumerating audio processes.");
+
+  // 处理阶段：耗时、音频时长和累计的实时率（按速率计算时用前两者之比）
+  char line[256];
+  const char *families[3][2] = {
+      {"audio_capture_stage_cpu_seconds", "Processing time of a stage."},
+      {"audio_capture_stage_audio_seconds", "Audio duration processed by a stage."},
+      {"audio_capture_stage_realtime_factor",
+       "Cumulative processing time divided by audio duration."}};
+  for (size_t family = 0; family < 3; ++family) {
+    const bool counter = family < 2;
+    std::snprintf(line, sizeof(line), "# TYPE %s %s\n# HELP %s %s\n",
+                  families[family][0], counter ? "counter" : "gauge",
+                  families[family][0], families[family][1]);
+    out += line;
+    for (size_t stage = 0; stage < kStageCount; ++stage) {
+      double cpu = g_stages[stage].cpu_ns.load() / 1e9;
+      double audio = g_stages[stage].audio_ns.load() / 1e9;
+      double value =
+          family == 0 ? cpu : family == 1 ? audio : audio > 0 ? cpu / audio : 0;
+      std::snprintf(line, sizeof(line), "%s%s{stage=\"%s\"} %.17g\n",
+                    families[family][0], counter ? "_total" : "",
+                    kStageNames[stage], value);
+      out += line;
+    }
+  }
+
+  // 只读取已有线程池的统计，导出指标不应顺带创建工作线程
+  if (DspPool *shared = DspPool::SharedIfCreated()) {
+    DspPoolStats pool = shared->GetStats();
+    RenderValue(&out, "audio_capture_dsp_pool_workers", "gauge",
+                "Worker threads of the shared DSP pool.",
+                static_cast<double>(pool.workers));
+    RenderValue(&out, "audio_capture_dsp_pool_queue_depth", "gauge",
+                "Jobs waiting in the shared DSP pool.",
+                static_cast<double>(pool.queue_depth));
+    RenderValue(&out, "audio_capture_dsp_pool_jobs", "counter",
+                "Jobs executed by the shared DSP pool.",
+                static_cast<double>(pool.jobs));
+    RenderValue(&out, "audio_capture_dsp_pool_dropped", "counter",
+                "Jobs dropped because a DSP pool queue was full.",
+                static_cast<double>(pool.dropped));
+  }
+
+  out += "# EOF\n";
+  return out;
+}
+
+bool Serve(const std::string &socket_path, int port, std::string *error) {
+  std::lock_guard<std::mutex> lock(g_server.mutex);
+  StopServingLocked();
+
+  SocketHandle fd = Listen(socket_path, port, error);
+  if (fd == kInvalidSocket) {
+    return false;
+  }
+  g_server.fd = fd;
+  g_server.socket_path = socket_path;
+  g_server.stop.store(false);
+  g_server.thread = std::thread(ServerProc, fd);
+  return true;
+}
+
+void StopServing() {
+  std::lock_guard<std::mutex> lock(g_server.mutex);
+  StopServingLocked();
+}
+
+bool IsServing() {
+  std::lock_guard<std::mutex> lock(g_server.mutex);
+  return g_server.fd != kInvalidSocket;
+}
+
+} // namespace metrics
+} // namespace audio_capture
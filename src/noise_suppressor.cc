@@ -0,0 +1,146 @@
+#include "../include/noise_suppressor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * @file noise_suppressor.cc
+ * @brief 谱减法降噪的实现
+ */
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// 功率谱的时间平滑系数（步长10ms时约45ms）
+constexpr float kPowerSmoothing = 0.8f;
+// 噪声估计每个步长允许上升的比例（约1.7dB/s），跟踪变化的背景噪声
+constexpr float kNoiseRise = 1.004f;
+// 最小值跟踪会低估噪声，用过减因子补偿
+constexpr float kOverSubtraction = 3.0f;
+// 增益的时间平滑系数，抑制孤立频点忽开忽关的音乐噪声
+constexpr float kGainSmoothing = 0.5f;
+
+} // namespace
+
+NoiseSuppressor::NoiseSuppressor(float reduction_db)
+    : floor_(std::pow(10.0f, -std::fabs(reduction_db) / 20.0f)) {}
+
+NoiseSuppressor::~NoiseSuppressor() = default;
+
+void NoiseSuppressor::Configure(int channels, int sample_rate) {
+  channels_ = channels;
+  sample_rate_ = sample_rate;
+  hop_ = std::max(1, sample_rate / 100);
+  position_ = 0;
+  hops_ = 0;
+
+  const size_t length = 2 * hop_;
+  size_t size = 4;
+  while (size < length) {
+    size <<= 1;
+  }
+  if (!fft_ || fft_->Size() != size) {
+    fft_ = std::make_unique<Fft>(size);
+  }
+  const size_t bins = fft_->Bins();
+
+  // 周期sqrt-Hann窗，分析和合成各加一次，50%重叠时相加为1
+  window_.resize(length);
+  for (size_t i = 0; i < length; ++i) {
+    window_[i] = static_cast<float>(
+        std::sqrt(0.5 - 0.5 * std::cos(2.0 * kPi * i / length)));
+  }
+  frame_.assign(size, 0.0f);
+  re_.assign(bins, 0.0f);
+  im_.assign(bins, 0.0f);
+
+  state_.resize(channels);
+  for (auto &channel : state_) {
+    channel.input.assign(length, 0.0f);
+    channel.output.assign(hop_, 0.0f);
+    channel.overlap.assign(hop_, 0.0f);
+    channel.smoothed.assign(bins, 0.0f);
+    channel.noise.assign(bins, std::numeric_limits<float>::max());
+    channel.gain.assign(bins, 1.0f);
+  }
+}
+
+void NoiseSuppressor::Process(const float *in, float *out, size_t frames,
+                              int channels, int sample_rate) {
+  if (channels <= 0 || sample_rate <= 0) {
+    return;
+  }
+  if (channels != channels_ || sample_rate != sample_rate_) {
+    Configure(channels, sample_rate);
+  }
+
+  for (size_t frame = 0; frame < frames; ++frame) {
+    const size_t offset = frame * channels;
+    for (int c = 0; c < channels; ++c) {
+      // 先读输入再写输出，允许原地处理
+      float sample = in[offset + c];
+      Channel &channel = state_[c];
+      out[offset + c] = channel.output[position_];
+      channel.input[hop_ + position_] = sample;
+    }
+
+    if (++position_ == hop_) {
+      position_ = 0;
+      for (auto &channel : state_) {
+        ProcessHop(&channel);
+      }
+      ++hops_;
+    }
+  }
+}
+
+void NoiseSuppressor::ProcessHop(Channel *channel) {
+  const size_t length = 2 * hop_;
+  const size_t bins = fft_->Bins();
+
+  const float *window = window_.data();
+  const float *input = channel->input.data();
+  float *frame = frame_.data();
+  for (size_t i = 0; i < length; ++i) {
+    frame[i] = input[i] * window[i];
+  }
+  // 上一次逆变换写满了整帧，补零部分必须重新清零
+  std::fill(frame_.begin() + length, frame_.end(), 0.0f);
+  fft_->Forward(frame, re_.data(), im_.data());
+
+  // 第一帧直接作为平滑功率谱的初值
+  const float smoothing = hops_ == 0 ? 0.0f : kPowerSmoothing;
+  const float floor = floor_;
+  float *re = re_.data();
+  float *im = im_.data();
+  float *smoothed = channel->smoothed.data();
+  float *noise = channel->noise.data();
+  float *gain = channel->gain.data();
+  for (size_t k = 0; k < bins; ++k) {
+    float power = re[k] * re[k] + im[k] * im[k];
+    smoothed[k] = smoothing * smoothed[k] + (1.0f - smoothing) * power;
+    noise[k] = std::min(smoothed[k], noise[k] * kNoiseRise);
+    float g = std::max(floor,
+                       1.0f - kOverSubtraction * noise[k] / (smoothed[k] + 1e-12f));
+    gain[k] = kGainSmoothing * gain[k] + (1.0f - kGainSmoothing) * g;
+    re[k] *= gain[k];
+    im[k] *= gain[k];
+  }
+
+  // 补零部分的逆变换结果是增益引入的时域混叠，直接丢弃
+  fft_->Inverse(re, im, frame);
+  float *output = channel->output.data();
+  float *overlap = channel->overlap.data();
+  for (size_t i = 0; i < hop_; ++i) {
+    output[i] = overlap[i] + frame[i] * window[i];
+    overlap[i] = frame[hop_ + i] * window[hop_ + i];
+  }
+
+  std::copy(channel->input.begin() + hop_, channel->input.end(),
+            channel->input.begin());
+}
+
+} // namespace audio_capture
@@ -0,0 +1,977 @@
+#include "../include/processing_graph.h"
+#include "../include/audio_mixer.h"
+#include "../include/delivery_batcher.h"
+#include "../include/fingerprint.h"
+#include "../include/metrics.h"
+#include "../include/noise_suppressor.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <thread>
+
+/**
+ * @file processing_graph.cc
+ * @brief 会话级音频处理图的实现
+ */
+
+namespace audio_capture {
+
+/**
+ * 处理图节点：处理一块数据后把结果分发给下游节点
+ */
+class ProcessingGraph::Node {
+public:
+  virtual ~Node() = default;
+
+  // 在当前线程处理并继续向下游分发；输出块数与输入不是一一对应的节点
+  // （分块、电平统计）重写它并多次调用Emit
+  virtual void Run(const AudioBlock &in) {
+    AudioBlock out = in;
+    Process(in, &out);
+    if (out.frames != 0) {
+      Emit(out);
+    }
+  }
+
+  void Emit(const AudioBlock &out) {
+    for (Node *child : children) {
+      child->Dispatch(out);
+    }
+  }
+
+  // 由上游调用：在线程池中执行的节点提交到自己的串行队列，否则直接执行
+  void Dispatch(const AudioBlock &in) {
+    if (strand) {
+      strand->Submit(in);
+    } else {
+      Run(in);
+    }
+  }
+
+  virtual void Process(const AudioBlock & /*in*/, AudioBlock * /*out*/) {}
+  virtual void Close() {}
+  // 电平表节点返回true并写入最近一块数据的读数（node-gyp默认关闭RTTI）
+  virtual bool ReadMeter(float * /*peak*/, float * /*rms*/) const {
+    return false;
+  }
+  // 降噪节点返回true并写入累计的处理开销
+  virtual bool ReadCost(StageCost * /*cost*/) const { return false; }
+
+  std::string id;
+  std::vector<std::string> aliases; ///< 合并到该节点的其他节点ID
+  std::vector<Node *> children;
+  DspStrand *strand = nullptr;
+
+protected:
+  // 输出缓冲区只在数据块变大时增长
+  float *Reserve(size_t count) {
+    if (buffer_.size() < count) {
+      buffer_.resize(count);
+    }
+    return buffer_.data();
+  }
+
+private:
+  std::vector<float> buffer_;
+};
+
+namespace {
+
+using Node = ProcessingGraph::Node;
+
+// 线性插值重采样
+class ResampleNode : public Node {
+public:
+  explicit ResampleNode(int sample_rate) : sample_rate_(sample_rate) {}
+
+  void Process(const AudioBlock &in, AudioBlock *out) override {
+    const int channels = in.channels;
+    if (in.sample_rate == sample_rate_) {
+      return;
+    }
+    if (static_cast<int>(last_.size()) != channels) {
+      last_.assign(channels, 0.0f);
+      phase_ = 1.0;
+    }
+
+    const double step = static_cast<double>(in.sample_rate) / sample_rate_;
+    size_t capacity =
+        static_cast<size_t>(std::ceil(in.frames / step)) + 2;
+    float *dst = Reserve(capacity * channels);
+
+    // phase坐标中0为上一块的最后一帧，k为本块第k-1帧
+    size_t produced = 0;
+    while (phase_ < static_cast<double>(in.frames) && produced < capacity) {
+      size_t index = static_cast<size_t>(phase_);
+      float frac = static_cast<float>(phase_ - static_cast<double>(index));
+      const float *b = in.samples + index * channels;
+      for (int c = 0; c < channels; ++c) {
+        float a = index == 0 ? last_[c] : b[c - channels];
+        dst[produced * channels + c] = a + (b[c] - a) * frac;
+      }
+      ++produced;
+      phase_ += step;
+    }
+
+    if (in.frames > 0) {
+      std::memcpy(last_.data(), in.samples + (in.frames - 1) * channels,
+                  channels * sizeof(float));
+    }
+    phase_ -= static_cast<double>(in.frames);
+
+    out->samples = dst;
+    out->frames = produced;
+    out->sample_rate = sample_rate_;
+  }
+
+private:
+  int sample_rate_;
+  double phase_ = 1.0;
+  std::vector<float> last_;
+};
+
+// 改变通道数：下混到单声道取平均，其他情况按通道序号循环映射
+class RemixNode : public Node {
+public:
+  explicit RemixNode(int channels) : channels_(channels) {}
+
+  void Process(const AudioBlock &in, AudioBlock *out) override {
+    if (in.channels == channels_) {
+      return;
+    }
+
+    if (in.channels != downmix_.channels()) {
+      downmix_.Configure(in.channels);
+    }
+    float *dst = Reserve(in.frames * channels_);
+    for (size_t frame = 0; frame < in.frames; ++frame) {
+      const float *src = in.samples + frame * in.channels;
+      if (channels_ == 1) {
+        float sum = 0.0f;
+        for (int c = 0; c < in.channels; ++c) {
+          sum += src[c];
+        }
+        dst[frame] = sum / static_cast<float>(in.channels);
+      } else if (channels_ == 2 && in.channels > 2) {
+        downmix_.Apply(src, &dst[frame * 2], &dst[frame * 2 + 1]);
+      } else {
+        for (int c = 0; c < channels_; ++c) {
+          dst[frame * channels_ + c] = src[c % in.channels];
+        }
+      }
+    }
+
+    out->samples = dst;
+    out->channels = channels_;
+  }
+
+private:
+  int channels_;
+  StereoDownmix downmix_; ///< 多声道混成立体声，与混音器的音频源相同
+};
+
+// 线性增益
+class GainNode : public Node {
+public:
+  explicit GainNode(float gain) : gain_(gain) {}
+
+  void Process(const AudioBlock &in, AudioBlock *out) override {
+    size_t count = in.frames * static_cast<size_t>(in.channels);
+    float *dst = Reserve(count);
+    std::fill(dst, dst + count, 0.0f);
+    MixAccumulate(dst, in.samples, count, gain_);
+    out->samples = dst;
+  }
+
+private:
+  float gain_;
+};
+
+// 谱减法降噪，统计自身的处理耗时
+class DenoiseNode : public Node {
+public:
+  explicit DenoiseNode(float reduction_db) : suppressor_(reduction_db) {}
+
+  void Process(const AudioBlock &in, AudioBlock *out) override {
+    uint64_t begin = trace::NowNs();
+    float *dst = Reserve(in.frames * static_cast<size_t>(in.channels));
+    suppressor_.Process(in.samples, dst, in.frames, in.channels,
+                        in.sample_rate);
+    out->samples = dst;
+    uint64_t cpu_ns = trace::NowNs() - begin;
+    uint64_t audio_ns =
+        in.sample_rate > 0 ? in.frames * 1000000000ull / in.sample_rate : 0;
+    cpu_ns_.fetch_add(cpu_ns, std::memory_order_relaxed);
+    audio_ns_.fetch_add(audio_ns, std::memory_order_relaxed);
+    metrics::AddStageCost(metrics::Stage::kDenoise, cpu_ns, audio_ns);
+  }
+
+  bool ReadCost(StageCost *cost) const override {
+    cost->cpu_ns = cpu_ns_.load(std::memory_order_relaxed);
+    cost->audio_ns = audio_ns_.load(std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  NoiseSuppressor suppressor_;
+  std::atomic<uint64_t> cpu_ns_{0};
+  std::atomic<uint64_t> audio_ns_{0};
+};
+
+// 峰值/RMS电平表，数据原样通过
+class MeterNode : public Node {
+public:
+  void Process(const AudioBlock &in, AudioBlock * /*out*/) override {
+    size_t count = in.frames * static_cast<size_t>(in.channels);
+    float peak = 0.0f;
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+      float value = std::fabs(in.samples[i]);
+      peak = std::max(peak, value);
+      sum += static_cast<double>(value) * value;
+    }
+    peak_.store(peak, std::memory_order_relaxed);
+    rms_.store(count ? static_cast<float>(std::sqrt(sum / count)) : 0.0f,
+               std::memory_order_relaxed);
+  }
+
+  bool ReadMeter(float *peak, float *rms) const override {
+    *peak = peak_.load(std::memory_order_relaxed);
+    *rms = rms_.load(std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  std::atomic<float> peak_{0.0f};
+  std::atomic<float> rms_{0.0f};
+};
+
+// 重新分块为固定帧数，格式变化时丢弃未满的部分
+class ChunkNode : public Node {
+public:
+  explicit ChunkNode(size_t frames) : frames_(frames) {}
+
+  void Run(const AudioBlock &in) override {
+    if (in.channels != channels_ || in.sample_rate != sample_rate_) {
+      channels_ = in.channels;
+      sample_rate_ = in.sample_rate;
+      filled_ = 0;
+    }
+    float *chunk = Reserve(frames_ * channels_);
+
+    size_t consumed = 0;
+    while (consumed < in.frames) {
+      size_t count = std::min(frames_ - filled_, in.frames - consumed);
+      std::memcpy(chunk + filled_ * channels_,
+                  in.samples + consumed * channels_,
+                  count * channels_ * sizeof(float));
+      filled_ += count;
+      consumed += count;
+
+      if (filled_ == frames_) {
+        AudioBlock out = in;
+        out.samples = chunk;
+        out.frames = frames_;
+        Emit(out);
+        filled_ = 0;
+      }
+    }
+  }
+
+private:
+  size_t frames_;
+  size_t filled_ = 0;
+  int channels_ = 0;
+  int sample_rate_ = 0;
+};
+
+// 按固定频率输出各通道的峰值和RMS（只做分析，不输出PCM）
+// 输出块为 [peak0..peakN-1, rms0..rmsN-1]，即2帧N通道
+class LevelsNode : public Node {
+public:
+  explicit LevelsNode(double rate) : rate_(rate) {}
+
+  void Run(const AudioBlock &in) override {
+    if (in.channels != channels_ || in.sample_rate != sample_rate_) {
+      channels_ = in.channels;
+      sample_rate_ = in.sample_rate;
+      interval_ = std::max<size_t>(
+          1, static_cast<size_t>(in.sample_rate / rate_));
+      peak_.assign(channels_, 0.0f);
+      sum_.assign(channels_, 0.0);
+      counted_ = 0;
+    }
+
+    for (size_t frame = 0; frame < in.frames; ++frame) {
+      const float *src = in.samples + frame * channels_;
+      for (int c = 0; c < channels_; ++c) {
+        float value = std::fabs(src[c]);
+        peak_[c] = std::max(peak_[c], value);
+        sum_[c] += static_cast<double>(value) * value;
+      }
+
+      if (++counted_ == interval_) {
+        float *levels = Reserve(2 * channels_);
+        for (int c = 0; c < channels_; ++c) {
+          levels[c] = peak_[c];
+          levels[channels_ + c] = static_cast<float>(std::sqrt(sum_[c] / counted_));
+          peak_[c] = 0.0f;
+          sum_[c] = 0.0;
+        }
+        counted_ = 0;
+
+        AudioBlock out = in;
+        out.samples = levels;
+        out.frames = 2;
+        Emit(out);
+      }
+    }
+  }
+
+private:
+  double rate_;
+  int channels_ = 0;
+  int sample_rate_ = 0;
+  size_t interval_ = 1;
+  size_t counted_ = 0;
+  std::vector<float> peak_;
+  std::vector<double> sum_;
+};
+
+// 音频指纹：按 rate Hz 输出累积的记录，每条记录为一帧 [哈希, 锚点时间（秒）]
+class FingerprintNode : public Node {
+public:
+  explicit FingerprintNode(double rate) : rate_(rate) {}
+
+  void Run(const AudioBlock &in) override {
+    if (in.sample_rate != sample_rate_) {
+      sample_rate_ = in.sample_rate;
+      interval_ = std::max<size_t>(
+          1, static_cast<size_t>(in.sample_rate / rate_));
+    }
+
+    fingerprinter_.Process(in.samples, in.frames, in.channels, in.sample_rate,
+                           &landmarks_);
+    counted_ += in.frames;
+    if (counted_ < interval_) {
+      return;
+    }
+    counted_ = 0;
+    if (landmarks_.empty()) {
+      return;
+    }
+
+    float *records = Reserve(2 * landmarks_.size());
+    for (size_t i = 0; i < landmarks_.size(); ++i) {
+      records[2 * i] = static_cast<float>(landmarks_[i].hash);
+      records[2 * i + 1] = landmarks_[i].time;
+    }
+
+    AudioBlock out;
+    out.samples = records;
+    out.frames = landmarks_.size();
+    out.channels = 2;
+    out.sample_rate = Fingerprinter::kSampleRate;
+    landmarks_.clear();
+    Emit(out);
+  }
+
+private:
+  double rate_;
+  int sample_rate_ = 0;
+  size_t interval_ = 1;
+  size_t counted_ = 0;
+  Fingerprinter fingerprinter_;
+  std::vector<Landmark> landmarks_;
+};
+
+// 投递给JavaScript，Format 为 kInt16 时转换为16位整数
+template <SampleFormat Format> class JsSinkNode : public Node {
+public:
+  JsSinkNode(std::shared_ptr<DeliveryBatcher> batcher, std::string sink_id)
+      : sink_(std::move(batcher), std::move(sink_id)) {}
+
+  void Process(const AudioBlock &in, AudioBlock *out) override {
+    sink_.Push(in.samples, in.frames, in.channels, in.sample_rate, position_);
+    position_ += in.frames;
+    out->frames = 0;
+  }
+
+private:
+  BatcherSink<Format> sink_;
+  uint64_t position_ = 0;
+};
+
+// 录音的查找索引，录音结束时写入 <录音路径>.idx（小端序）：
+//   头部48字节：magic "PAIX"、版本、采样率、通道数、每帧字节数、PCM数据偏移、
+//              每个索引块的帧数、静音阈值(dBFS, f32)、块数、活动区间数、总帧数(u64)
+//   索引块：每秒一项 { 字节偏移(u64), RMS(dBFS, f32), 峰值(dBFS, f32) }
+//   活动区间：{ 起始帧(u64), 结束帧(u64) }，按时间排序且互不重叠
+// 读取方只需要索引就能定位、跳过静音和比较响度，不必扫描PCM
+class RecordingIndexWriter {
+public:
+  RecordingIndexWriter(double silence_db, double min_silence_ms)
+      : silence_db_(silence_db), min_silence_ms_(min_silence_ms) {}
+
+  void Begin(int channels, int sample_rate, uint32_t data_offset) {
+    channels_ = channels;
+    sample_rate_ = sample_rate;
+    data_offset_ = data_offset;
+    block_frames_ = static_cast<size_t>(sample_rate);
+    // 活动检测使用20ms的分析窗，短于min_silence_ms的静音不切分区间
+    window_frames_ = std::max<size_t>(1, static_cast<size_t>(sample_rate) / 50);
+    min_gap_frames_ =
+        static_cast<uint64_t>(min_silence_ms_ * sample_rate / 1000.0);
+    // 比较均方值，避免对每个分析窗取对数
+    silence_power_ = std::pow(10.0, silence_db_ / 10.0);
+  }
+
+  void Add(const float *samples, size_t frames) {
+    for (size_t frame = 0; frame < frames; ++frame) {
+      const float *src = samples + frame * channels_;
+      for (int c = 0; c < channels_; ++c) {
+        double value = src[c];
+        block_sum_ += value * value;
+        window_sum_ += value * value;
+        block_peak_ = std::max(block_peak_, std::fabs(src[c]));
+      }
+      ++frames_;
+
+      if (++window_filled_ == window_frames_) {
+        UpdateActivity(window_sum_ / (window_filled_ * channels_) >
+                       silence_power_);
+        window_sum_ = 0.0;
+        window_filled_ = 0;
+      }
+      if (++block_filled_ == block_frames_) {
+        FinishBlock();
+      }
+    }
+  }
+
+  bool Write(const std::string &path) {
+    if (block_filled_ > 0) {
+      FinishBlock();
+    }
+    if (span_open_) {
+      spans_.push_back({span_start_, last_active_end_});
+      span_open_ = false;
+    }
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+      return false;
+    }
+    const uint32_t block_align =
+        static_cast<uint32_t>(channels_ * sizeof(float));
+    const uint32_t header[] = {
+        1,
+        static_cast<uint32_t>(sample_rate_),
+        static_cast<uint32_t>(channels_),
+        block_align,
+        data_offset_,
+        static_cast<uint32_t>(block_frames_)};
+    const float silence_db = static_cast<float>(silence_db_);
+    const uint32_t counts[] = {static_cast<uint32_t>(blocks_.size()),
+                               static_cast<uint32_t>(spans_.size())};
+    std::fwrite("PAIX", 1, 4, file);
+    std::fwrite(header, sizeof(header), 1, file);
+    std::fwrite(&silence_db, sizeof(silence_db), 1, file);
+    std::fwrite(counts, sizeof(counts), 1, file);
+    std::fwrite(&frames_, sizeof(frames_), 1, file);
+
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+      uint64_t offset = data_offset_ + static_cast<uint64_t>(i) *
+                                           block_frames_ * block_align;
+      std::fwrite(&offset, sizeof(offset), 1, file);
+      std::fwrite(&blocks_[i], sizeof(blocks_[i]), 1, file);
+    }
+    for (const auto &span : spans_) {
+      std::fwrite(&span, sizeof(span), 1, file);
+    }
+    return std::fclose(file) == 0;
+  }
+
+private:
+  struct BlockLevels {
+    float rms_db;
+    float peak_db;
+  };
+
+  struct Span {
+    uint64_t start;
+    uint64_t end;
+  };
+
+  double silence_db_;
+  double min_silence_ms_;
+  double silence_power_ = 0.0;
+  int channels_ = 0;
+  int sample_rate_ = 0;
+  uint32_t data_offset_ = 0;
+  uint64_t frames_ = 0;
+
+  size_t block_frames_ = 1;
+  size_t block_filled_ = 0;
+  double block_sum_ = 0.0;
+  float block_peak_ = 0.0f;
+  std::vector<BlockLevels> blocks_;
+
+  size_t window_frames_ = 1;
+  size_t window_filled_ = 0;
+  double window_sum_ = 0.0;
+  uint64_t min_gap_frames_ = 0;
+  bool span_open_ = false;
+  uint64_t span_start_ = 0;
+  uint64_t last_active_end_ = 0;
+  std::vector<Span> spans_;
+
+  static float ToDb(double amplitude) {
+    return static_cast<float>(20.0 * std::log10(std::max(amplitude, 1e-6)));
+  }
+
+  void FinishBlock() {
+    double mean = block_sum_ / (block_filled_ * channels_);
+    blocks_.push_back({ToDb(std::sqrt(mean)), ToDb(block_peak_)});
+    block_sum_ = 0.0;
+    block_peak_ = 0.0f;
+    block_filled_ = 0;
+  }
+
+  // 每个分析窗结束时更新活动区间，frames_ 为窗口结束处的帧位置
+  void UpdateActivity(bool active) {
+    if (active) {
+      if (!span_open_) {
+        // 与上一个区间的间隔太短时继续使用上一个区间
+        if (!spans_.empty() &&
+            frames_ - window_frames_ - spans_.back().end < min_gap_frames_) {
+          span_start_ = spans_.back().start;
+          spans_.pop_back();
+        } else {
+          span_start_ = frames_ - window_frames_;
+        }
+        span_open_ = true;
+      }
+      last_active_end_ = frames_;
+    } else if (span_open_ && frames_ - last_active_end_ >= min_gap_frames_) {
+      spans_.push_back({span_start_, last_active_end_});
+      span_open_ = false;
+    }
+  }
+};
+
+// 32-bit float WAV文件，格式以第一块数据为准
+class WavSinkNode : public Node {
+public:
+  WavSinkNode(std::string path, std::unique_ptr<RecordingIndexWriter> index,
+              GraphErrorCallback on_error)
+      : path_(std::move(path)), index_(std::move(index)),
+        on_error_(std::move(on_error)) {}
+
+  void Process(const AudioBlock &in, AudioBlock *out) override {
+    // 开启指标时统计写入耗时（wav输出端即本模块的编码器）
+    uint64_t begin = metrics::IsEnabled() ? trace::NowNs() : 0;
+    out->frames = 0;
+    if (!file_ && !failed_) {
+      file_ = std::fopen(path_.c_str(), "wb");
+      failed_ = !file_;
+      if (file_) {
+        channels_ = in.channels;
+        sample_rate_ = in.sample_rate;
+        WriteHeader(0);
+        if (index_) {
+          index_->Begin(channels_, sample_rate_, kHeaderBytes);
+        }
+      } else {
+        Fail("无法打开WAV文件: " + path_);
+      }
+    }
+    if (!file_ || stopped_ || in.channels != channels_) {
+      return;
+    }
+
+    // RIFF的大小字段是32位，只写入不超过上限的整帧
+    const uint64_t frame_bytes = sizeof(float) * static_cast<uint64_t>(channels_);
+    const uint64_t room = (kMaxDataBytes - data_bytes_) / frame_bytes;
+    size_t frames = static_cast<size_t>(
+        std::min<uint64_t>(in.frames, room));
+    size_t count = frames * static_cast<size_t>(channels_);
+    size_t written = std::fwrite(in.samples, sizeof(float), count, file_);
+    // 索引只记录完整写入的帧，偏移与文件内容一致
+    frames = written / static_cast<size_t>(channels_);
+    data_bytes_ += frames * frame_bytes;
+    if (index_) {
+      index_->Add(in.samples, frames);
+    }
+
+    if (written < count) {
+      stopped_ = true;
+      Fail("写入WAV文件失败，已停止录制: " + path_);
+    } else if (frames < in.frames) {
+      stopped_ = true;
+      Fail("WAV文件达到4GiB上限，已停止录制: " + path_);
+    }
+    if (begin != 0 && in.sample_rate > 0) {
+      metrics::AddStageCost(metrics::Stage::kWav, trace::NowNs() - begin,
+                            in.frames * 1000000000ull / in.sample_rate);
+    }
+  }
+
+  void Close() override {
+    if (file_) {
+      // 写入失败时末尾可能有不完整的帧，头部的数据大小只包含完整的帧
+      std::fseek(file_, 0, SEEK_SET);
+      WriteHeader(static_cast<uint32_t>(data_bytes_));
+      std::fclose(file_);
+      file_ = nullptr;
+      if (index_) {
+        index_->Write(path_ + ".idx");
+      }
+    }
+  }
+
+private:
+  static constexpr uint32_t kHeaderBytes = 44;
+  // RIFF块大小 = 36 + 数据字节数，必须能用32位表示
+  static constexpr uint64_t kMaxDataBytes = 0xFFFFFFFFull - 36;
+
+  std::string path_;
+  std::unique_ptr<RecordingIndexWriter> index_;
+  GraphErrorCallback on_error_;
+  std::FILE *file_ = nullptr;
+  bool failed_ = false;
+  bool stopped_ = false; ///< 达到上限或写入失败后不再写入
+  int channels_ = 0;
+  int sample_rate_ = 0;
+  uint64_t data_bytes_ = 0;
+
+  void Fail(const std::string &message) {
+    if (on_error_) {
+      on_error_(id, message);
+    }
+  }
+
+  void WriteU32(uint32_t value) { std::fwrite(&value, 4, 1, file_); }
+  void WriteU16(uint16_t value) { std::fwrite(&value, 2, 1, file_); }
+
+  void WriteHeader(uint32_t data_bytes) {
+    const uint16_t kFormatIeeeFloat = 3;
+    uint16_t block_align = static_cast<uint16_t>(channels_ * sizeof(float));
+    std::fwrite("RIFF", 1, 4, file_);
+    WriteU32(36 + data_bytes);
+    std::fwrite("WAVEfmt ", 1, 8, file_);
+    WriteU32(16);
+    WriteU16(kFormatIeeeFloat);
+    WriteU16(static_cast<uint16_t>(channels_));
+    WriteU32(static_cast<uint32_t>(sample_rate_));
+    WriteU32(static_cast<uint32_t>(sample_rate_) * block_align);
+    WriteU16(block_align);
+    WriteU16(32);
+    std::fwrite("data", 1, 4, file_);
+    WriteU32(data_bytes);
+  }
+};
+
+double Param(const GraphNodeSpec &spec, const char *name, double fallback) {
+  auto it = spec.params.find(name);
+  return it == spec.params.end() ? fallback : it->second;
+}
+
+} // namespace
+
+ProcessingGraph::~ProcessingGraph() { Stop(); }
+
+std::unique_ptr<ProcessingGraph>
+ProcessingGraph::Build(const std::vector<GraphNodeSpec> &specs,
+                       std::shared_ptr<DeliveryBatcher> sink,
+                       std::string *error, uint32_t session,
+                       GraphErrorCallback on_error) {
+  static const std::set<std::string> kTypes = {
+      "resample", "remix", "gain",        "meter",  "chunk",
+      "levels",   "js",    "wav",         "fingerprint", "denoise"};
+
+  std::map<std::string, const GraphNodeSpec *> by_id;
+  for (const auto &spec : specs) {
+    if (spec.id.empty() || spec.id == "source") {
+      *error = "节点ID不能为空或为 source";
+      return nullptr;
+    }
+    if (!kTypes.count(spec.type)) {
+      *error = "未知的节点类型: " + spec.type;
+      return nullptr;
+    }
+    if (!by_id.emplace(spec.id, &spec).second) {
+      *error = "重复的节点ID: " + spec.id;
+      return nullptr;
+    }
+  }
+
+  std::unique_ptr<ProcessingGraph> graph(new ProcessingGraph());
+  graph->session_ = session;
+
+  // 规范化键 -> 节点，用于合并配置相同的节点
+  std::map<std::string, Node *> by_key;
+  std::map<std::string, std::string> key_of_id;
+  std::set<std::string> visiting;
+
+  // 递归实例化（先上游），返回节点的规范化键
+  std::function<bool(const GraphNodeSpec &, std::string *)> instantiate =
+      [&](const GraphNodeSpec &spec, std::string *key) -> bool {
+    auto known = key_of_id.find(spec.id);
+    if (known != key_of_id.end()) {
+      *key = known->second;
+      return true;
+    }
+    if (!visiting.insert(spec.id).second) {
+      *error = "处理图中存在环: " + spec.id;
+      return false;
+    }
+
+    std::string input_key = "source";
+    Node *parent = nullptr;
+    if (spec.input != "source") {
+      auto input = by_id.find(spec.input);
+      if (input == by_id.end()) {
+        *error = "节点 " + spec.id + " 的上游不存在: " + spec.input;
+        return false;
+      }
+      if (input->second->type == "js" || input->second->type == "wav") {
+        *error = "输出端不能有下游节点: " + spec.input;
+        return false;
+      }
+      if (!instantiate(*input->second, &input_key)) {
+        return false;
+      }
+      parent = by_key[input_key];
+    }
+
+    std::ostringstream stream;
+    stream << spec.type << "(";
+    for (const auto &param : spec.params) {
+      stream << param.first << "=" << param.second << ",";
+    }
+    if (spec.type == "wav") {
+      stream << "path=" << spec.path << ",";
+    }
+    if (spec.type == "js") {
+      // 不同的js输出端以ID区分，不合并
+      stream << "id=" << spec.id << ",";
+    }
+    stream << (spec.off_thread ? "async" : "sync") << ")<" << input_key;
+    *key = stream.str();
+
+    auto existing = by_key.find(*key);
+    if (existing != by_key.end()) {
+      existing->second->aliases.push_back(spec.id);
+    } else {
+      std::unique_ptr<Node> node;
+      if (spec.type == "resample") {
+        int rate = static_cast<int>(Param(spec, "sampleRate", 0));
+        if (rate <= 0 || rate > 384000) {
+          *error = "resample 节点需要有效的 sampleRate: " + spec.id;
+          return false;
+        }
+        node = std::make_unique<ResampleNode>(rate);
+      } else if (spec.type == "remix") {
+        int channels = static_cast<int>(Param(spec, "channels", 0));
+        if (channels <= 0 || channels > 32) {
+          *error = "remix 节点需要有效的 channels: " + spec.id;
+          return false;
+        }
+        node = std::make_unique<RemixNode>(channels);
+      } else if (spec.type == "gain") {
+        node = std::make_unique<GainNode>(
+            static_cast<float>(Param(spec, "gain", 1.0)));
+      } else if (spec.type == "denoise") {
+        double reduction = Param(spec, "reduction", 20);
+        if (reduction < 0 || reduction > 60) {
+          *error = "denoise 节点需要有效的 reduction: " + spec.id;
+          return false;
+        }
+        node = std::make_unique<DenoiseNode>(static_cast<float>(reduction));
+      } else if (spec.type == "meter") {
+        node = std::make_unique<MeterNode>();
+      } else if (spec.type == "chunk") {
+        double frames = Param(spec, "frames", 0);
+        if (frames < 1 || frames > 65536) {
+          *error = "chunk 节点需要有效的 frames: " + spec.id;
+          return false;
+        }
+        node = std::make_unique<ChunkNode>(static_cast<size_t>(frames));
+      } else if (spec.type == "levels") {
+        double rate = Param(spec, "rate", 30);
+        if (rate <= 0 || rate > 1000) {
+          *error = "levels 节点需要有效的 rate: " + spec.id;
+          return false;
+        }
+        node = std::make_unique<LevelsNode>(rate);
+      } else if (spec.type == "fingerprint") {
+        double rate = Param(spec, "rate", 4);
+        if (rate <= 0 || rate > 100) {
+          *error = "fingerprint 节点需要有效的 rate: " + spec.id;
+          return false;
+        }
+        node = std::make_unique<FingerprintNode>(rate);
+      } else if (spec.type == "js") {
+        if (Param(spec, "int16", 0) != 0) {
+          node = std::make_unique<JsSinkNode<SampleFormat::kInt16>>(sink,
+                                                                    spec.id);
+        } else {
+          node = std::make_unique<JsSinkNode<SampleFormat::kFloat32>>(
+              sink, spec.id);
+        }
+      } else {
+        if (spec.path.empty()) {
+          *error = "wav 节点需要 path: " + spec.id;
+          return false;
+        }
+        std::unique_ptr<RecordingIndexWriter> index;
+        if (Param(spec, "index", 0) != 0) {
+          index = std::make_unique<RecordingIndexWriter>(
+              Param(spec, "silenceDb", -50), Param(spec, "minSilenceMs", 500));
+        }
+        node = std::make_unique<WavSinkNode>(spec.path, std::move(index),
+                                             on_error);
+      }
+
+      node->id = spec.id;
+      Node *raw = node.get();
+      graph->nodes_.push_back(std::move(node));
+      by_key[*key] = raw;
+
+      // 文件输出、指纹提取和显式标记的节点在线程池中执行
+      if (spec.off_thread || spec.type == "wav" ||
+          spec.type == "fingerprint") {
+        graph->strands_.push_back(std::make_unique<DspStrand>(
+            DspPool::Shared(),
+            [raw](const AudioBlock &block) { raw->Run(block); }, session));
+        raw->strand = graph->strands_.back().get();
+      }
+
+      if (parent) {
+        parent->children.push_back(raw);
+      } else {
+        graph->roots_.push_back(raw);
+      }
+    }
+
+    visiting.erase(spec.id);
+    key_of_id[spec.id] = *key;
+    return true;
+  };
+
+  for (const auto &spec : specs) {
+    std::string key;
+    if (!instantiate(spec, &key)) {
+      graph->Stop();
+      return nullptr;
+    }
+  }
+
+  return graph;
+}
+
+void ProcessingGraph::Start() {
+  if (!stopped_) {
+    started_ = true;
+  }
+}
+
+void ProcessingGraph::Push(const uint8_t *data, size_t length, int channels,
+                           int sample_rate) {
+  if (!started_ || stopped_ || channels <= 0) {
+    return;
+  }
+
+  trace::ScopedSpan span("graph", session_);
+  AudioBlock block;
+  block.samples = reinterpret_cast<const float *>(data);
+  block.frames = length / (sizeof(float) * channels);
+  block.channels = channels;
+  block.sample_rate = sample_rate;
+
+  for (Node *root : roots_) {
+    root->Dispatch(block);
+  }
+}
+
+void ProcessingGraph::Stop() {
+  if (stopped_) {
+    return;
+  }
+  stopped_ = true;
+
+  for (auto &strand : strands_) {
+    strand->Close();
+  }
+  for (auto &node : nodes_) {
+    node->Close();
+  }
+}
+
+std::vector<MeterReading> ProcessingGraph::GetMeters() const {
+  std::vector<MeterReading> result;
+  for (const auto &node : nodes_) {
+    float peak = 0.0f;
+    float rms = 0.0f;
+    if (!node->ReadMeter(&peak, &rms)) {
+      continue;
+    }
+    result.push_back({node->id, peak, rms});
+    for (const auto &alias : node->aliases) {
+      result.push_back({alias, peak, rms});
+    }
+  }
+  return result;
+}
+
+StageCost ProcessingGraph::DenoiseCost() const {
+  StageCost total;
+  for (const auto &node : nodes_) {
+    StageCost cost;
+    if (node->ReadCost(&cost)) {
+      total.cpu_ns += cost.cpu_ns;
+      total.audio_ns += cost.audio_ns;
+    }
+  }
+  return total;
+}
+
+uint64_t ProcessingGraph::DroppedBlocks() const {
+  uint64_t dropped = 0;
+  for (const auto &strand : strands_) {
+    dropped += strand->Dropped();
+  }
+  return dropped;
+}
+
+bool ProcessingGraphSlot::Push(const uint8_t *data, size_t length,
+                               int channels, int sample_rate) {
+  // 先登记再读取指针，Replace在看到readers_归零前不会停止旧处理图
+  readers_.fetch_add(1);
+  ProcessingGraph *graph = graph_.load();
+  if (graph) {
+    graph->Push(data, length, channels, sample_rate);
+  }
+  readers_.fetch_sub(1, std::memory_order_release);
+  return graph != nullptr;
+}
+
+void ProcessingGraphSlot::Replace(std::shared_ptr<ProcessingGraph> graph) {
+  graph_.store(graph.get());
+  while (readers_.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  if (owner_) {
+    owner_->Stop();
+  }
+  owner_ = std::move(graph);
+}
+
+} // namespace audio_capture
@@ -0,0 +1,272 @@
+#include "../include/replay_audio_capture.h"
+#include "../include/rt_check.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @file replay_audio_capture.cc
+ * @brief 按回调节奏回放的音频源的实现
+ */
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+uint16_t ReadU16(const uint8_t *p) {
+  return static_cast<uint16_t>(p[0] | p[1] << 8);
+}
+
+uint32_t ReadU32(const uint8_t *p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+} // namespace
+
+bool LoadReplayAudio(const std::string &path, ReplayAudio *audio,
+                     std::string *error) {
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file) {
+    *error = "无法打开回放音频文件: " + path;
+    return false;
+  }
+  std::vector<uint8_t> bytes;
+  uint8_t chunk[65536];
+  size_t read = 0;
+  while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    bytes.insert(bytes.end(), chunk, chunk + read);
+  }
+  std::fclose(file);
+
+  if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+      std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+    *error = "回放音频不是WAV文件: " + path;
+    return false;
+  }
+
+  uint16_t format = 0;
+  uint16_t channels = 0;
+  uint16_t bits = 0;
+  const uint8_t *data = nullptr;
+  size_t data_size = 0;
+  size_t offset = 12;
+  while (offset + 8 <= bytes.size()) {
+    const uint8_t *header = bytes.data() + offset;
+    size_t size = ReadU32(header + 4);
+    size_t available = bytes.size() - offset - 8;
+    if (std::memcmp(header, "fmt ", 4) == 0 && size >= 16 &&
+        size <= available) {
+      format = ReadU16(header + 8);
+      channels = ReadU16(header + 10);
+      bits = ReadU16(header + 22);
+      if (format == kFormatExtensible && size >= 26) {
+        // 子格式GUID的前两个字节即格式标记
+        format = ReadU16(header + 8 + 24);
+      }
+    } else if (std::memcmp(header, "data", 4) == 0) {
+      // 未正常结束的录音中data长度可能不正确，以文件实际长度为准
+      data = header + 8;
+      data_size = std::min(size, available);
+      break;
+    }
+    offset += 8 + size + (size & 1);
+  }
+
+  bool supported = (format == kFormatPcm && bits == 16) ||
+                   (format == kFormatFloat && bits == 32);
+  if (!data || channels == 0 || !supported) {
+    *error = "回放音频只支持16位整数或32位浮点的WAV文件: " + path;
+    return false;
+  }
+
+  const size_t sample_bytes = bits / 8;
+  const size_t frames = data_size / (sample_bytes * channels);
+  if (frames == 0) {
+    *error = "回放音频文件中没有音频数据: " + path;
+    return false;
+  }
+
+  audio->channels = channels;
+  audio->samples.resize(frames * channels);
+  for (size_t i = 0; i < audio->samples.size(); ++i) {
+    const uint8_t *sample = data + i * sample_bytes;
+    if (format == kFormatPcm) {
+      audio->samples[i] =
+          static_cast<int16_t>(ReadU16(sample)) / 32768.0f;
+    } else {
+      uint32_t raw = ReadU32(sample);
+      std::memcpy(&audio->samples[i], &raw, sizeof(float));
+    }
+  }
+  return true;
+}
+
+ReplayAudioCapture::ReplayAudioCapture(
+    std::shared_ptr<const std::vector<CadencePacket>> packets,
+    std::shared_ptr<const ReplayAudio> audio, bool loop)
+    : packets_(std::move(packets)), audio_(std::move(audio)), loop_(loop) {}
+
+ReplayAudioCapture::~ReplayAudioCapture() { StopCapture(); }
+
+bool ReplayAudioCapture::Prepare(uint32_t pid,
+                                 const CaptureOptions &options) {
+  if (capturing_ || !packets_ || packets_->empty()) {
+    return false;
+  }
+
+  // 周期完全由回调节奏决定，忽略期望的周期
+  size_t largest = 0;
+  for (const auto &packet : *packets_) {
+    largest = std::max(largest, static_cast<size_t>(packet.frames) *
+                                    static_cast<size_t>(packet.channels));
+  }
+  pid_ = pid;
+  trace_session_ = options.TraceSession(pid);
+  buffer_.assign(largest, 0.0f);
+  prepared_ = true;
+  return true;
+}
+
+bool ReplayAudioCapture::Start(AudioDataCallback callback) {
+  if (capturing_ || !prepared_ || !callback) {
+    return false;
+  }
+
+  callback_ = std::move(callback);
+  prepared_ = false;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = false;
+  }
+  capturing_ = true;
+  thread_ = std::thread(&ReplayAudioCapture::ThreadProc, this);
+  return true;
+}
+
+bool ReplayAudioCapture::IsPreparedFor(uint32_t pid) const {
+  return prepared_ && !capturing_ && pid_ == pid;
+}
+
+bool ReplayAudioCapture::StopCapture() {
+  prepared_ = false;
+  if (!capturing_) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  capturing_ = false;
+  callback_ = nullptr;
+  return true;
+}
+
+bool ReplayAudioCapture::IsCapturing() const { return capturing_.load(); }
+
+void ReplayAudioCapture::ThreadProc() {
+  using Clock = std::chrono::steady_clock;
+
+  trace::RegisterThread();
+
+  const std::vector<CadencePacket> &packets = *packets_;
+  const ReplayAudio *audio =
+      audio_ && !audio_->samples.empty() ? audio_.get() : nullptr;
+  const size_t audio_frames =
+      audio ? audio->samples.size() / audio->channels : 0;
+  const double frequency = 220.0 + (pid_ % 32) * 20.0;
+
+  // 重复回放时两轮之间的间隔：开头两个不同到达时刻之间的间隔（突发模式下
+  // 同一时刻的多个数据包算一次到达），所有数据包同时到达时为第一个包的时长
+  const CadencePacket &last = packets.back();
+  uint64_t loop_gap_ns = static_cast<uint64_t>(packets.front().frames) *
+                         1000000000 / packets.front().sample_rate;
+  for (const auto &packet : packets) {
+    if (packet.time_ns > 0) {
+      loop_gap_ns = packet.time_ns;
+      break;
+    }
+  }
+
+  const auto origin = Clock::now();
+  uint64_t round_ns = 0; ///< 当前一轮的起始时间（相对origin）
+  size_t index = 0;
+  size_t audio_position = 0;
+  double phase = 0.0;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    if (index == packets.size()) {
+      if (!loop_) {
+        wake_.wait(lock, [this] { return stop_; });
+        break;
+      }
+      round_ns += last.time_ns + loop_gap_ns;
+      index = 0;
+    }
+
+    const CadencePacket &packet = packets[index++];
+    const auto due = origin + std::chrono::nanoseconds(round_ns + packet.time_ns);
+    if (wake_.wait_until(lock, due, [this] { return stop_; })) {
+      break;
+    }
+    lock.unlock();
+
+    {
+      AUDIO_CAPTURE_RT_SCOPE();
+      trace::ScopedSpan span("backend-callback", trace_session_);
+
+      const int channels = packet.channels;
+      float *dst = buffer_.data();
+      if (audio) {
+        for (uint32_t frame = 0; frame < packet.frames; ++frame) {
+          const float *src = audio->samples.data() +
+                             audio_position * audio->channels;
+          for (int c = 0; c < channels; ++c) {
+            dst[static_cast<size_t>(frame) * channels + c] =
+                src[c % audio->channels];
+          }
+          if (++audio_position == audio_frames) {
+            audio_position = 0;
+          }
+        }
+      } else {
+        const double step = 2.0 * kPi * frequency / packet.sample_rate;
+        for (uint32_t frame = 0; frame < packet.frames; ++frame) {
+          float sample = static_cast<float>(0.25 * std::sin(phase));
+          for (int c = 0; c < channels; ++c) {
+            dst[static_cast<size_t>(frame) * channels + c] = sample;
+          }
+          phase += step;
+          if (phase > 2.0 * kPi) {
+            phase -= 2.0 * kPi;
+          }
+        }
+      }
+
+      callback_(reinterpret_cast<const uint8_t *>(dst),
+                static_cast<size_t>(packet.frames) * channels * sizeof(float),
+                channels, packet.sample_rate);
+    }
+
+    lock.lock();
+  }
+}
+
+} // namespace audio_capture
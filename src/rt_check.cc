@@ -0,0 +1,363 @@
+#include "../include/rt_check.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+#if defined(AUDIO_CAPTURE_RT_CHECK) && defined(__linux__)
+#include <node_api.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file rt_check.cc
+ * @brief 音频回调路径的实时安全检查实现
+ *
+ * 违规记录保存在固定大小的开放寻址哈希表中，插入只使用原子操作，
+ * 因此可以在被拦截的malloc/free内部安全调用。
+ *
+ * Linux上通过 -Wl,--wrap=<symbol> 将本插件内对这些函数的调用重定向到
+ * __wrap_<symbol>。插件以 dlopen 方式加载，普通的符号覆盖无法生效，
+ * --wrap 只影响插件自身（包括内联进插件的标准库代码）的调用。
+ */
+
+#if defined(__GNUC__) && !defined(_WIN32)
+// 使用initial-exec模型，避免在被拦截的malloc中首次访问TLS时再次分配内存
+#define RT_CHECK_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define RT_CHECK_TLS
+#endif
+
+namespace audio_capture {
+namespace rt_check {
+
+namespace {
+
+// 哈希表容量（必须是2的幂）
+constexpr size_t kTableSize = 1024;
+
+struct Entry {
+  std::atomic<uint64_t> key{0}; ///< (调用地址 << 3) | 违规类型，0表示空槽
+  std::atomic<uint64_t> count{0};
+};
+
+Entry g_table[kTableSize];
+
+// 哈希表已满时无法记录的违规次数
+std::atomic<uint64_t> g_overflow{0};
+
+thread_local int g_scope_depth RT_CHECK_TLS = 0;
+
+uint64_t MakeKey(ViolationKind kind, const void *call_site) {
+  return (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(call_site)) << 3) |
+         static_cast<uint64_t>(kind);
+}
+
+std::string Symbolize(const void *address) {
+  char text[64];
+  std::snprintf(text, sizeof(text), "%p", address);
+  std::string result = text;
+
+#ifndef _WIN32
+  Dl_info info;
+  if (dladdr(address, &info) && info.dli_sname) {
+    int status = 0;
+    char *demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    std::string name = (status == 0 && demangled) ? demangled : info.dli_sname;
+    std::free(demangled);
+
+    std::snprintf(text, sizeof(text), "+0x%zx",
+                  static_cast<size_t>(static_cast<const char *>(address) -
+                                      static_cast<const char *>(info.dli_saddr)));
+    result = name + text;
+    if (info.dli_fname) {
+      result += std::string(" (") + info.dli_fname + ")";
+    }
+  }
+#endif
+
+  return result;
+}
+
+} // namespace
+
+bool InRealtimeScope() { return g_scope_depth > 0; }
+
+void EnterRealtimeScope() { ++g_scope_depth; }
+
+void LeaveRealtimeScope() { --g_scope_depth; }
+
+void ReportViolation(ViolationKind kind, const void *call_site) {
+  uint64_t key = MakeKey(kind, call_site);
+  size_t index = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 54) &
+                 (kTableSize - 1);
+
+  for (size_t probe = 0; probe < kTableSize; ++probe) {
+    Entry &entry = g_table[(index + probe) & (kTableSize - 1)];
+    uint64_t current = entry.key.load(std::memory_order_acquire);
+
+    if (current == 0) {
+      uint64_t expected = 0;
+      if (entry.key.compare_exchange_strong(expected, key,
+                                            std::memory_order_acq_rel)) {
+        current = key;
+      } else {
+        current = expected;
+      }
+    }
+
+    if (current == key) {
+      entry.count.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  g_overflow.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<Violation> GetViolations() {
+  std::vector<Violation> result;
+
+  for (const Entry &entry : g_table) {
+    uint64_t key = entry.key.load(std::memory_order_acquire);
+    uint64_t count = entry.count.load(std::memory_order_relaxed);
+    if (key == 0 || count == 0) {
+      continue;
+    }
+
+    const void *call_site = reinterpret_cast<const void *>(
+        static_cast<uintptr_t>(key >> 3));
+    result.push_back({static_cast<ViolationKind>(key & 0x7),
+                      Symbolize(call_site), count});
+  }
+
+  uint64_t overflow = g_overflow.load(std::memory_order_relaxed);
+  if (overflow > 0) {
+    result.push_back({ViolationKind::Blocking, "<未记录：违规表已满>", overflow});
+  }
+
+  std::sort(result.begin(), result.end(),
+            [](const Violation &a, const Violation &b) {
+              return a.count > b.count;
+            });
+  return result;
+}
+
+void Reset() {
+  // 只清空计数，已占用的槽位保留，避免与并发插入冲突
+  for (Entry &entry : g_table) {
+    entry.count.store(0, std::memory_order_relaxed);
+  }
+  g_overflow.store(0, std::memory_order_relaxed);
+}
+
+const char *KindName(ViolationKind kind) {
+  switch (kind) {
+  case ViolationKind::Allocation:
+    return "allocation";
+  case ViolationKind::Free:
+    return "free";
+  case ViolationKind::MutexWait:
+    return "mutex-wait";
+  case ViolationKind::Blocking:
+  default:
+    return "blocking";
+  }
+}
+
+#ifdef AUDIO_CAPTURE_RT_CHECK
+namespace {
+
+// 检查构建中，进程退出时将违规汇总输出到stderr，便于测试脚本检查
+struct ExitReporter {
+  ~ExitReporter() {
+    std::vector<Violation> violations = GetViolations();
+    if (violations.empty()) {
+      return;
+    }
+
+    std::fprintf(stderr, "[rt_check] 实时作用域内发现 %zu 处违规:\n",
+                 violations.size());
+    for (const auto &violation : violations) {
+      std::fprintf(stderr, "  %-10s x%-8llu %s\n", KindName(violation.kind),
+                   static_cast<unsigned long long>(violation.count),
+                   violation.location.c_str());
+    }
+  }
+} g_exit_reporter;
+
+} // namespace
+#endif
+
+} // namespace rt_check
+} // namespace audio_capture
+
+#if defined(AUDIO_CAPTURE_RT_CHECK) && defined(__linux__)
+
+using audio_capture::rt_check::InRealtimeScope;
+using audio_capture::rt_check::ReportViolation;
+using audio_capture::rt_check::ViolationKind;
+
+#define RT_CHECK_REPORT(kind)                                                  \
+  do {                                                                         \
+    if (InRealtimeScope()) {                                                   \
+      ReportViolation(kind, __builtin_return_address(0));                      \
+    }                                                                          \
+  } while (0)
+
+extern "C" {
+
+// 由链接器提供的原始实现
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+void *__real__Znwm(size_t size);
+void *__real__Znam(size_t size);
+void __real__ZdlPv(void *ptr);
+void __real__ZdaPv(void *ptr);
+void __real__ZdlPvm(void *ptr, size_t size);
+void __real__ZdaPvm(void *ptr, size_t size);
+int __real_pthread_mutex_lock(pthread_mutex_t *mutex);
+int __real_pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+int __real_pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+                                  const struct timespec *abstime);
+int __real_nanosleep(const struct timespec *req, struct timespec *rem);
+int __real_usleep(useconds_t usec);
+ssize_t __real_read(int fd, void *buf, size_t count);
+ssize_t __real_write(int fd, const void *buf, size_t count);
+int __real_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+napi_status
+__real_napi_call_threadsafe_function(napi_threadsafe_function func, void *data,
+                                     napi_threadsafe_function_call_mode mode);
+
+// 内存分配
+void *__wrap_malloc(size_t size) {
+  RT_CHECK_REPORT(ViolationKind::Allocation);
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  RT_CHECK_REPORT(ViolationKind::Allocation);
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  RT_CHECK_REPORT(ViolationKind::Allocation);
+  return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+  if (ptr) {
+    RT_CHECK_REPORT(ViolationKind::Free);
+  }
+  __real_free(ptr);
+}
+
+// operator new / new[]
+void *__wrap__Znwm(size_t size) {
+  RT_CHECK_REPORT(ViolationKind::Allocation);
+  return __real__Znwm(size);
+}
+
+void *__wrap__Znam(size_t size) {
+  RT_CHECK_REPORT(ViolationKind::Allocation);
+  return __real__Znam(size);
+}
+
+// operator delete / delete[]（含sized版本）
+void __wrap__ZdlPv(void *ptr) {
+  if (ptr) {
+    RT_CHECK_REPORT(ViolationKind::Free);
+  }
+  __real__ZdlPv(ptr);
+}
+
+void __wrap__ZdaPv(void *ptr) {
+  if (ptr) {
+    RT_CHECK_REPORT(ViolationKind::Free);
+  }
+  __real__ZdaPv(ptr);
+}
+
+void __wrap__ZdlPvm(void *ptr, size_t size) {
+  if (ptr) {
+    RT_CHECK_REPORT(ViolationKind::Free);
+  }
+  __real__ZdlPvm(ptr, size);
+}
+
+void __wrap__ZdaPvm(void *ptr, size_t size) {
+  if (ptr) {
+    RT_CHECK_REPORT(ViolationKind::Free);
+  }
+  __real__ZdaPvm(ptr, size);
+}
+
+// 互斥锁与条件变量
+int __wrap_pthread_mutex_lock(pthread_mutex_t *mutex) {
+  RT_CHECK_REPORT(ViolationKind::MutexWait);
+  return __real_pthread_mutex_lock(mutex);
+}
+
+int __wrap_pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+  RT_CHECK_REPORT(ViolationKind::MutexWait);
+  return __real_pthread_cond_wait(cond, mutex);
+}
+
+int __wrap_pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+                                  const struct timespec *abstime) {
+  RT_CHECK_REPORT(ViolationKind::MutexWait);
+  return __real_pthread_cond_timedwait(cond, mutex, abstime);
+}
+
+// 可能阻塞的系统调用
+int __wrap_nanosleep(const struct timespec *req, struct timespec *rem) {
+  RT_CHECK_REPORT(ViolationKind::Blocking);
+  return __real_nanosleep(req, rem);
+}
+
+int __wrap_usleep(useconds_t usec) {
+  RT_CHECK_REPORT(ViolationKind::Blocking);
+  return __real_usleep(usec);
+}
+
+ssize_t __wrap_read(int fd, void *buf, size_t count) {
+  RT_CHECK_REPORT(ViolationKind::Blocking);
+  return __real_read(fd, buf, count);
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t count) {
+  RT_CHECK_REPORT(ViolationKind::Blocking);
+  return __real_write(fd, buf, count);
+}
+
+int __wrap_poll(struct pollfd *fds, nfds_t nfds, int timeout) {
+  if (timeout != 0) {
+    RT_CHECK_REPORT(ViolationKind::Blocking);
+  }
+  return __real_poll(fds, nfds, timeout);
+}
+
+// 阻塞式TSFN调用（队列满时会等待JS线程）
+napi_status
+__wrap_napi_call_threadsafe_function(napi_threadsafe_function func, void *data,
+                                     napi_threadsafe_function_call_mode mode) {
+  if (mode == napi_tsfn_blocking) {
+    RT_CHECK_REPORT(ViolationKind::Blocking);
+  }
+  return __real_napi_call_threadsafe_function(func, data, mode);
+}
+
+} // extern "C"
+
+#endif // AUDIO_CAPTURE_RT_CHECK && __linux__
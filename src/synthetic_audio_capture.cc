@@ -0,0 +1,114 @@
+#include "../include/synthetic_audio_capture.h"
+#include "../include/rt_check.h"
+#include "../include/trace.h"
+#include <chrono>
+#include <cmath>
+
+/**
+ * @file synthetic_audio_capture.cc
+ * @brief 合成音频源的实现
+ */
+
+namespace audio_capture {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+}
+
+SyntheticAudioCapture::SyntheticAudioCapture(int sample_rate, int channels,
+                                             int period_frames)
+    : sample_rate_(sample_rate), channels_(channels),
+      period_frames_(period_frames) {}
+
+SyntheticAudioCapture::~SyntheticAudioCapture() { StopCapture(); }
+
+bool SyntheticAudioCapture::Prepare(uint32_t pid,
+                                    const CaptureOptions &options) {
+  if (capturing_) {
+    return false;
+  }
+
+  // 指定了期望的周期时按它产生数据，否则使用构造时的周期
+  uint32_t period = options.PeriodFramesAt(sample_rate_);
+  pid_ = pid;
+  trace_session_ = options.TraceSession(pid);
+  buffer_.assign(static_cast<size_t>(period > 0 ? period : period_frames_) *
+                     channels_,
+                 0.0f);
+  prepared_ = true;
+  return true;
+}
+
+bool SyntheticAudioCapture::Start(AudioDataCallback callback) {
+  if (capturing_ || !prepared_ || !callback) {
+    return false;
+  }
+
+  callback_ = std::move(callback);
+  prepared_ = false;
+
+  stop_ = false;
+  capturing_ = true;
+  thread_ = std::thread(&SyntheticAudioCapture::ThreadProc, this);
+  return true;
+}
+
+bool SyntheticAudioCapture::IsPreparedFor(uint32_t pid) const {
+  return prepared_ && !capturing_ && pid_ == pid;
+}
+
+bool SyntheticAudioCapture::StopCapture() {
+  prepared_ = false;
+  if (!capturing_) {
+    return false;
+  }
+
+  stop_ = true;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  capturing_ = false;
+  callback_ = nullptr;
+  return true;
+}
+
+bool SyntheticAudioCapture::IsCapturing() const { return capturing_.load(); }
+
+void SyntheticAudioCapture::ThreadProc() {
+  using Clock = std::chrono::steady_clock;
+
+  trace::RegisterThread();
+
+  const int period_frames = static_cast<int>(buffer_.size() / channels_);
+  const auto period = std::chrono::nanoseconds(
+      static_cast<int64_t>(period_frames) * 1000000000 / sample_rate_);
+  const double frequency = 220.0 + (pid_ % 32) * 20.0;
+  const double step = 2.0 * kPi * frequency / sample_rate_;
+  double phase = 0.0;
+
+  auto deadline = Clock::now();
+  while (!stop_.load()) {
+    deadline += period;
+    std::this_thread::sleep_until(deadline);
+
+    AUDIO_CAPTURE_RT_SCOPE();
+    trace::ScopedSpan span("backend-callback", trace_session_);
+
+    for (int frame = 0; frame < period_frames; ++frame) {
+      float sample = static_cast<float>(0.25 * std::sin(phase));
+      for (int channel = 0; channel < channels_; ++channel) {
+        buffer_[static_cast<size_t>(frame) * channels_ + channel] = sample;
+      }
+      phase += step;
+      if (phase > 2.0 * kPi) {
+        phase -= 2.0 * kPi;
+      }
+    }
+
+    callback_(reinterpret_cast<const uint8_t *>(buffer_.data()),
+              buffer_.size() * sizeof(float), channels_, sample_rate_);
+  }
+}
+
+} // namespace audio_capture
@@ -0,0 +1,223 @@
+#include "../include/target_switcher.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+/**
+ * @file target_switcher.cc
+ * @brief 捕获目标无缝切换的实现
+ */
+
+namespace audio_capture {
+
+TargetSwitcher::TargetSwitcher(AudioDataCallback output, uint32_t session)
+    : output_(std::move(output)), session_(session),
+      ring_(kRingCapacity, 0.0f), scratch_(kScratchCapacity * 2, 0.0f) {}
+
+AudioDataCallback TargetSwitcher::SourceCallback() {
+  uint32_t gen = next_gen_++;
+  state_.store(Pack(gen, 0), std::memory_order_release);
+  return [this, gen](const uint8_t *data, size_t length, int channels,
+                     int sample_rate) {
+    OnPacket(gen, data, length, channels, sample_rate);
+  };
+}
+
+AudioDataCallback TargetSwitcher::BeginSwitch(uint32_t crossfade_ms) {
+  crossfade_ms_ = crossfade_ms;
+  force_.store(false, std::memory_order_relaxed);
+
+  uint32_t gen = next_gen_++;
+  uint64_t state = state_.load(std::memory_order_acquire);
+  state_.store(Pack(ActiveGen(state), gen), std::memory_order_release);
+
+  return [this, gen](const uint8_t *data, size_t length, int channels,
+                     int sample_rate) {
+    OnPacket(gen, data, length, channels, sample_rate);
+  };
+}
+
+void TargetSwitcher::CancelSwitch() {
+  // 旧音频源可能正在交接（最多一个数据包的处理时间），让出CPU等待它释放
+  while (!TryLockHandoff()) {
+    std::this_thread::yield();
+  }
+
+  uint64_t state = state_.load(std::memory_order_acquire);
+  if (PendingGen(state) != 0) {
+    state_.store(Pack(ActiveGen(state), 0), std::memory_order_release);
+    // 丢弃新音频源已缓冲的数据
+    ring_read_.store(ring_write_.load(std::memory_order_acquire),
+                     std::memory_order_release);
+  }
+
+  UnlockHandoff();
+}
+
+bool TargetSwitcher::TryCompleteSwitch() {
+  if (!TryLockHandoff()) {
+    return false;
+  }
+
+  uint64_t state = state_.load(std::memory_order_acquire);
+  uint32_t pending = PendingGen(state);
+  if (pending != 0) {
+    // 先撤销旧音频源的输出权（新音频源继续缓冲），再等待旧音频源
+    // 在抢锁失败路径上可能正在进行的输出结束，下游始终只有一个调用方
+    state_.store(Pack(0, pending));
+    while (old_emitting_.load()) {
+      std::this_thread::yield();
+    }
+    state_.store(Pack(pending, 0), std::memory_order_release);
+    trace::RecordInstant("target-switch", session_);
+  }
+
+  UnlockHandoff();
+  return true;
+}
+
+void TargetSwitcher::OnPacket(uint32_t gen, const uint8_t *data, size_t length,
+                              int channels, int sample_rate) {
+  const float *samples = reinterpret_cast<const float *>(data);
+  size_t count = length / sizeof(float);
+
+  uint64_t state = state_.load(std::memory_order_acquire);
+  uint32_t active = ActiveGen(state);
+  uint32_t pending = PendingGen(state);
+
+  if (gen == active && pending == 0) {
+    // 刚完成交接的新音频源先输出缓冲区中剩余的数据
+    if (RingAvailable() > 0) {
+      DrainRing();
+    }
+    output_(data, length, channels, sample_rate);
+    return;
+  }
+
+  if (gen == active) {
+    // 切换期间的旧音频源：在数据包边界上尝试交接
+    if (!TryLockHandoff()) {
+      // 交接锁被JS线程或退役线程短暂占用：本数据包照常输出，下一个包再交接；
+      // 与 TryCompleteSwitch 按 old_emitting_ / state_ 的顺序一致性互斥
+      old_emitting_.store(true);
+      if (ActiveGen(state_.load()) == gen) {
+        output_(data, length, channels, sample_rate);
+      }
+      old_emitting_.store(false, std::memory_order_release);
+      return;
+    }
+    if (state_.load(std::memory_order_acquire) == state) {
+      Handoff(pending, samples, count, channels, sample_rate);
+    }
+    UnlockHandoff();
+    return;
+  }
+
+  if (gen == pending) {
+    // 新音频源在交接前只缓冲数据
+    pending_channels_.store(channels, std::memory_order_relaxed);
+    pending_sample_rate_.store(sample_rate, std::memory_order_relaxed);
+    RingWrite(samples, count, channels);
+    return;
+  }
+
+  // 已退役的音频源，直接丢弃
+}
+
+void TargetSwitcher::Handoff(uint32_t pending, const float *samples,
+                             size_t count, int channels, int sample_rate) {
+  size_t available = RingAvailable();
+  if (available == 0 && !force_.load(std::memory_order_acquire)) {
+    // 新音频源还没有数据，旧音频源继续输出
+    output_(reinterpret_cast<const uint8_t *>(samples), count * sizeof(float),
+            channels, sample_rate);
+    return;
+  }
+
+  int new_channels = pending_channels_.load(std::memory_order_relaxed);
+  int new_sample_rate = pending_sample_rate_.load(std::memory_order_relaxed);
+  size_t frames = channels > 0 ? count / channels : 0;
+  size_t fade = static_cast<size_t>(crossfade_ms_) * sample_rate / 1000;
+
+  // 格式一致时，把旧数据包的末尾与新音频源的开头做线性交叉淡化
+  if (fade > 0 && new_channels == channels && new_sample_rate == sample_rate &&
+      count <= kScratchCapacity) {
+    fade = std::min({fade, frames, available / channels});
+    size_t tail = frames - fade;
+
+    float *out = scratch_.data();
+    float *incoming = scratch_.data() + kScratchCapacity;
+    std::memcpy(out, samples, count * sizeof(float));
+    RingRead(incoming, fade * channels);
+
+    for (size_t i = 0; i < fade; ++i) {
+      float gain = static_cast<float>(i + 1) / static_cast<float>(fade + 1);
+      for (int c = 0; c < channels; ++c) {
+        size_t index = (tail + i) * channels + c;
+        out[index] = out[index] * (1.0f - gain) +
+                     incoming[i * channels + c] * gain;
+      }
+    }
+
+    output_(reinterpret_cast<const uint8_t *>(out), count * sizeof(float),
+            channels, sample_rate);
+  } else {
+    output_(reinterpret_cast<const uint8_t *>(samples), count * sizeof(float),
+            channels, sample_rate);
+  }
+
+  // 交接：此后缓冲区的消费者变为新音频源的线程
+  state_.store(Pack(pending, 0), std::memory_order_release);
+  trace::RecordInstant("target-switch", session_);
+}
+
+void TargetSwitcher::DrainRing() {
+  int channels = pending_channels_.load(std::memory_order_relaxed);
+  int sample_rate = pending_sample_rate_.load(std::memory_order_relaxed);
+  if (channels <= 0) {
+    return;
+  }
+
+  size_t chunk = kScratchCapacity / channels * channels;
+  size_t read;
+  while ((read = RingRead(scratch_.data(), chunk)) > 0) {
+    output_(reinterpret_cast<const uint8_t *>(scratch_.data()),
+            read * sizeof(float), channels, sample_rate);
+  }
+}
+
+size_t TargetSwitcher::RingAvailable() const {
+  return ring_write_.load(std::memory_order_acquire) -
+         ring_read_.load(std::memory_order_relaxed);
+}
+
+void TargetSwitcher::RingWrite(const float *samples, size_t count,
+                               int channels) {
+  if (channels <= 0) {
+    return;
+  }
+  size_t write = ring_write_.load(std::memory_order_relaxed);
+  size_t read = ring_read_.load(std::memory_order_acquire);
+  size_t free = kRingCapacity - (write - read);
+
+  // 缓冲区满时丢弃多出的数据，只写入完整的帧以保持声道交错
+  count = std::min(count, free) / channels * channels;
+  for (size_t i = 0; i < count; ++i) {
+    ring_[(write + i) & (kRingCapacity - 1)] = samples[i];
+  }
+  ring_write_.store(write + count, std::memory_order_release);
+}
+
+size_t TargetSwitcher::RingRead(float *out, size_t count) {
+  size_t read = ring_read_.load(std::memory_order_relaxed);
+  size_t write = ring_write_.load(std::memory_order_acquire);
+  count = std::min(count, write - read);
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = ring_[(read + i) & (kRingCapacity - 1)];
+  }
+  ring_read_.store(read + count, std::memory_order_release);
+  return count;
+}
+
+} // namespace audio_capture
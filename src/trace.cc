@@ -0,0 +1,327 @@
+#include "../include/trace.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+/**
+ * @file trace.cc
+ * @brief 捕获管线的trace事件记录实现
+ *
+ * 每个线程使用一个固定容量的缓冲区。缓冲区只在非实时路径上分配：
+ * 自有线程启动时通过RegisterThread注册，后端的实时线程在首次写入时从
+ * 开始记录或注册时补足的备用缓冲区中无锁领取，没有可领取的缓冲区时丢弃
+ * 事件。之后的写入只涉及本线程缓冲区和原子变量，不会加锁或分配内存。
+ * 缓冲区写满后新事件被丢弃并计数。导出时在JS线程上汇总所有缓冲区。
+ */
+
+namespace audio_capture {
+namespace trace {
+
+namespace {
+
+// 每个线程缓冲区可容纳的事件数
+constexpr size_t kEventsPerThread = 1 << 16;
+
+// 供未注册线程领取的备用缓冲区数
+constexpr size_t kSpareBuffers = 16;
+
+// 瞬时事件的结束时间标记
+constexpr uint64_t kInstantEvent = 0;
+
+struct TraceEvent {
+  const char *name;
+  uint64_t begin_ns;
+  uint64_t end_ns;
+  uint32_t session;
+};
+
+struct ThreadBuffer {
+  uint32_t tid = 0;
+  std::atomic<uint64_t> epoch{0};    ///< 缓冲区数据所属的记录轮次
+  std::atomic<size_t> count{0};      ///< 已发布的事件数
+  std::atomic<uint64_t> dropped{0};  ///< 缓冲区已满时丢弃的事件数
+  std::atomic<bool> retired{false};  ///< 所属线程是否已退出
+  std::unique_ptr<TraceEvent[]> events;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<uint64_t> g_epoch{0};
+std::atomic<uint32_t> g_next_tid{1};
+std::atomic<uint64_t> g_unbuffered{0}; ///< 线程没有缓冲区时丢弃的事件数
+uint64_t g_start_ns = 0;
+
+// g_registry 持有所有缓冲区（包括备用的），g_spare 中的缓冲区尚未被领取
+std::mutex g_registry_mutex;
+std::vector<std::shared_ptr<ThreadBuffer>> g_registry;
+std::array<std::atomic<ThreadBuffer *>, kSpareBuffers> g_spare{};
+
+// 线程退出时标记缓冲区为已退出，下次开始记录时回收
+struct ThreadSlot {
+  ThreadBuffer *buffer = nullptr;
+  ~ThreadSlot() {
+    if (buffer) {
+      buffer->retired.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local ThreadSlot t_slot;
+
+// 分配一个新缓冲区并加入g_registry，调用方持有g_registry_mutex
+ThreadBuffer *NewBuffer() {
+  auto buffer = std::make_shared<ThreadBuffer>();
+  buffer->events.reset(new TraceEvent[kEventsPerThread]);
+  g_registry.push_back(buffer);
+  return buffer.get();
+}
+
+// 补足备用缓冲区，调用方持有g_registry_mutex
+void RefillSpares() {
+  for (auto &spare : g_spare) {
+    if (!spare.load(std::memory_order_acquire)) {
+      spare.store(NewBuffer(), std::memory_order_release);
+    }
+  }
+}
+
+// 无锁领取一个备用缓冲区，没有时返回nullptr
+ThreadBuffer *ClaimSpare() {
+  for (auto &spare : g_spare) {
+    if (!spare.load(std::memory_order_relaxed)) {
+      continue;
+    }
+    ThreadBuffer *buffer = spare.exchange(nullptr, std::memory_order_acq_rel);
+    if (buffer) {
+      return buffer;
+    }
+  }
+  return nullptr;
+}
+
+// 把缓冲区绑定到调用线程
+void Bind(ThreadBuffer *buffer) {
+  buffer->tid = g_next_tid.fetch_add(1, std::memory_order_relaxed);
+  t_slot.buffer = buffer;
+}
+
+void Append(const char *name, uint32_t session, uint64_t begin_ns,
+            uint64_t end_ns) {
+  ThreadBuffer *buffer = t_slot.buffer;
+  if (!buffer) {
+    // 可能在实时线程上，只领取预先分配的缓冲区，不分配也不加锁
+    buffer = ClaimSpare();
+    if (!buffer) {
+      g_unbuffered.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    Bind(buffer);
+  }
+
+  // 新一轮记录开始后，由写入线程自己清空旧数据
+  uint64_t epoch = g_epoch.load(std::memory_order_acquire);
+  if (buffer->epoch.load(std::memory_order_relaxed) != epoch) {
+    buffer->count.store(0, std::memory_order_relaxed);
+    buffer->dropped.store(0, std::memory_order_relaxed);
+    buffer->epoch.store(epoch, std::memory_order_release);
+  }
+
+  size_t index = buffer->count.load(std::memory_order_relaxed);
+  if (index >= kEventsPerThread) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  buffer->events[index] = {name, begin_ns, end_ns, session};
+  buffer->count.store(index + 1, std::memory_order_release);
+}
+
+// 将纳秒时间转换为相对开始时间的微秒字符串
+std::string FormatMicros(uint64_t ns) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.3f", ns / 1000.0);
+  return text;
+}
+
+// 转义JSON字符串中的特殊字符
+std::string EscapeJson(const char *text) {
+  std::string result;
+  for (const char *p = text; *p; ++p) {
+    switch (*p) {
+    case '"':
+      result += "\\\"";
+      break;
+    case '\\':
+      result += "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(*p) >= 0x20) {
+        result += *p;
+      }
+      break;
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+uint64_t NowNs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+bool IsEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+void RegisterThread() {
+  if (!IsEnabled()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  if (!t_slot.buffer) {
+    Bind(NewBuffer());
+  }
+  RefillSpares();
+}
+
+bool Start() {
+  if (g_enabled.load()) {
+    return false;
+  }
+
+  {
+    // 已退出线程的缓冲区优先放回备用，其余的释放
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    std::vector<std::shared_ptr<ThreadBuffer>> alive;
+    for (auto &buffer : g_registry) {
+      if (!buffer->retired.load(std::memory_order_acquire)) {
+        alive.push_back(buffer);
+        continue;
+      }
+      for (auto &spare : g_spare) {
+        if (!spare.load(std::memory_order_relaxed)) {
+          buffer->retired.store(false, std::memory_order_relaxed);
+          spare.store(buffer.get(), std::memory_order_release);
+          alive.push_back(buffer);
+          break;
+        }
+      }
+    }
+    g_registry.swap(alive);
+    RefillSpares();
+  }
+
+  g_unbuffered.store(0, std::memory_order_relaxed);
+  g_start_ns = NowNs();
+  g_epoch.fetch_add(1, std::memory_order_release);
+  g_enabled.store(true);
+
+  // 调用线程（JS线程）也记录事件
+  RegisterThread();
+  return true;
+}
+
+bool Stop(const std::string &path, std::string *error) {
+  if (!g_enabled.exchange(false)) {
+    if (error) {
+      *error = "trace未开启";
+    }
+    return false;
+  }
+
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    buffers = g_registry;
+  }
+
+  std::ofstream out(path, std::ios::out | std::ios::trunc);
+  if (!out) {
+    if (error) {
+      *error = "无法打开trace输出文件: " + path;
+    }
+    return false;
+  }
+
+  uint64_t epoch = g_epoch.load(std::memory_order_acquire);
+  uint64_t dropped = g_unbuffered.load(std::memory_order_relaxed);
+  std::set<uint32_t> sessions;
+  bool first = true;
+
+  out << "{\"traceEvents\":[";
+  for (const auto &buffer : buffers) {
+    if (buffer->epoch.load(std::memory_order_acquire) != epoch) {
+      continue; // 本轮记录中该线程没有写入事件
+    }
+
+    size_t count = buffer->count.load(std::memory_order_acquire);
+    dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < count; ++i) {
+      const TraceEvent &event = buffer->events[i];
+      uint64_t begin =
+          event.begin_ns > g_start_ns ? event.begin_ns - g_start_ns : 0;
+
+      out << (first ? "\n" : ",\n");
+      first = false;
+      out << "{\"name\":\"" << EscapeJson(event.name)
+          << "\",\"cat\":\"audio_capture\",\"pid\":" << event.session
+          << ",\"tid\":" << buffer->tid << ",\"ts\":" << FormatMicros(begin);
+      if (event.end_ns == kInstantEvent) {
+        out << ",\"ph\":\"i\",\"s\":\"t\"}";
+      } else {
+        uint64_t duration =
+            event.end_ns > event.begin_ns ? event.end_ns - event.begin_ns : 0;
+        out << ",\"ph\":\"X\",\"dur\":" << FormatMicros(duration) << "}";
+      }
+      sessions.insert(event.session);
+    }
+  }
+
+  // 每个会话在trace查看器中显示为一个独立的进程分组
+  for (uint32_t session : sessions) {
+    out << (first ? "\n" : ",\n");
+    first = false;
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << session
+        << ",\"args\":{\"name\":\"session " << session << "\"}}";
+  }
+
+  out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":"
+      << dropped << "}}\n";
+
+  out.close();
+  if (!out) {
+    if (error) {
+      *error = "写入trace输出文件失败: " + path;
+    }
+    return false;
+  }
+  return true;
+}
+
+void RecordSpan(const char *name, uint32_t session, uint64_t begin_ns,
+                uint64_t end_ns) {
+  if (!IsEnabled()) {
+    return;
+  }
+  // 结束时间为0用于标记瞬时事件，span至少记录为1ns
+  Append(name, session, begin_ns, end_ns > begin_ns ? end_ns : begin_ns + 1);
+}
+
+void RecordInstant(const char *name, uint32_t session) {
+  if (!IsEnabled()) {
+    return;
+  }
+  Append(name, session, NowNs(), kInstantEvent);
+}
+
+} // namespace trace
+} // namespace audio_capture
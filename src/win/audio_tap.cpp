@@ -1,9 +1,14 @@
 #ifdef _WIN32
 
 #include "../../include/win/audio_tap.h"
+#include "../../include/win/win_utils.h"
+#include "../../include/rt_check.h"
+#include "../../include/trace.h"
+#include <algorithm>
 #include <comdef.h>
 #include <functiondiscoverykeys_devpkey.h>
 #include <iostream>
+#include <ksmedia.h>
 #include <mfapi.h>
 #include <mfidl.h>
 #include <mfreadwrite.h>
@@ -26,21 +31,25 @@ namespace win_audio {
 
 // 音频缓冲区持续时间（100ns单位）
 #define CAPTURE_BUFFER_DURATION 200000
+// 共享模式音频引擎的默认周期（100ns单位）
+#define ENGINE_PERIOD_DURATION 100000
 #define BITS_PER_BYTE 8
 
 AudioTap::AudioTap()
     : target_pid_(0), mix_format_(nullptr), buffer_frame_count_(0),
       capture_event_(nullptr), activate_completed_event_(nullptr),
-      activate_result_(E_FAIL) {}
+      wake_event_(nullptr), activate_result_(E_FAIL), activation_timeout_ms_(10000) {}
 
 HRESULT AudioTap::RuntimeClassInitialize(uint32_t pid) {
   target_pid_ = pid;
+  trace_session_ = pid;
 
   // 创建事件对象
   capture_event_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
   activate_completed_event_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+  wake_event_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 
-  if (!capture_event_ || !activate_completed_event_) {
+  if (!capture_event_ || !activate_completed_event_ || !wake_event_) {
     return E_FAIL;
   }
 
@@ -61,37 +70,62 @@ AudioTap::~AudioTap() {
     activate_completed_event_ = nullptr;
   }
 
+  if (wake_event_) {
+    CloseHandle(wake_event_);
+    wake_event_ = nullptr;
+  }
+
+  if (process_handle_) {
+    CloseHandle(process_handle_);
+    process_handle_ = nullptr;
+  }
+
   if (mix_format_) {
     CoTaskMemFree(mix_format_);
     mix_format_ = nullptr;
   }
 }
 
-bool AudioTap::Initialize() {
-  // 初始化COM为单线程单元（STA）
-  HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-  if (FAILED(hr) && hr != RPC_E_CHANGED_MODE) {
-    if (hr == RPC_E_CHANGED_MODE) {
-      CoUninitialize();
-      hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-      if (FAILED(hr)) {
-        SetError("Failed to initialize COM as STA");
-        return false;
-      }
-    } else {
+bool AudioTap::Initialize(const CaptureOptions &options) {
+  activation_timeout_ms_ = options.activation_timeout_ms;
+  cancel_flag_ = options.cancel_flag;
+  period_frames_ = options.period_frames;
+  native_format_ = options.native_format;
+  trace_session_ = options.TraceSession(target_pid_);
+  idle_ = options.idle_suspend;
+  detector_.SetPolicy(idle_.get());
+
+  // 准备在线程池中进行，停止和清理可能在JS线程或其他工作线程，
+  // 这里不改变调用线程的COM单元：持有MTA使用计数，未初始化COM的线程
+  // 隐式属于MTA，没有线程显式加入MTA时单元也不会被销毁。
+  // 计数和Media Foundation在Cleanup中释放，与调用线程无关
+  HRESULT hr = S_OK;
+  if (!mta_cookie_) {
+    hr = CoIncrementMTAUsage(&mta_cookie_);
+    if (FAILED(hr)) {
+      mta_cookie_ = nullptr;
       SetError("Failed to initialize COM");
       return false;
     }
   }
 
   // 初始化Media Foundation
-  hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
-  if (FAILED(hr)) {
-    SetError("Failed to initialize Media Foundation");
-    return false;
+  if (!mf_started_) {
+    hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+    if (FAILED(hr)) {
+      SetError("Failed to initialize Media Foundation");
+      return false;
+    }
+    mf_started_ = true;
   }
 
-  return ActivateProcessLoopbackAudioClient();
+  return input_device_ ? ActivateInputDeviceAudioClient()
+                       : ActivateProcessLoopbackAudioClient();
+}
+
+void AudioTap::SetInputDevice(const std::string &device) {
+  input_device_ = true;
+  device_id_ = win_utils::StringToWString(device);
 }
 
 bool AudioTap::Start(AudioDataCallback callback) {
@@ -129,6 +163,7 @@ void AudioTap::Stop() {
 
   is_capturing_.store(false);
   stop_capture_.store(true);
+  SetEvent(wake_event_);
 
   // 等待捕获线程结束
   if (capture_thread_.joinable()) {
@@ -151,12 +186,19 @@ void AudioTap::Cleanup() {
   session_manager_.Reset();
   target_session_.Reset();
 
-  MFShutdown();
-  CoUninitialize();
+  if (mf_started_) {
+    MFShutdown();
+    mf_started_ = false;
+  }
+  if (mta_cookie_) {
+    CoDecrementMTAUsage(mta_cookie_);
+    mta_cookie_ = nullptr;
+  }
 }
 
 void AudioTap::SetError(const std::string &message) {
   error_message_ = message;
+  trace::RecordInstant("error", trace_session_);
   std::wcerr << L"AudioTap Error: "
              << std::wstring(message.begin(), message.end()) << std::endl;
 }
@@ -239,6 +281,11 @@ bool AudioTap::ActivateProcessLoopbackAudioClient() {
     return false;
   }
 
+  // 捕获线程等待该句柄得知目标进程退出，打不开时（受保护进程等）不监视
+  if (!process_handle_) {
+    process_handle_ = OpenProcess(SYNCHRONIZE, FALSE, target_pid_);
+  }
+
   // 步骤2: 配置进程级音频回环参数
   // 设置音频捕获的目标进程和捕获模式
   AUDIOCLIENT_ACTIVATION_PARAMS activation_params = {};
@@ -270,8 +317,27 @@ bool AudioTap::ActivateProcessLoopbackAudioClient() {
   }
 
   // 步骤4: 等待激活完成
-  // 设置合理的超时时间（10秒），防止无限等待
-  DWORD wait_result = WaitForSingleObject(activate_completed_event_, 10000);
+  // 使用配置的超时时间（默认10秒），防止无限等待；分段等待以便响应取消
+  const DWORD kWaitSliceMs = 50;
+  ULONGLONG deadline = GetTickCount64() + activation_timeout_ms_;
+  DWORD wait_result = WAIT_TIMEOUT;
+  while (true) {
+    if (cancel_flag_ && cancel_flag_->load()) {
+      SetError("Audio interface activation cancelled");
+      return false;
+    }
+
+    ULONGLONG now = GetTickCount64();
+    if (now >= deadline) {
+      break;
+    }
+    DWORD slice = static_cast<DWORD>(
+        (std::min)(deadline - now, static_cast<ULONGLONG>(kWaitSliceMs)));
+    wait_result = WaitForSingleObject(activate_completed_event_, slice);
+    if (wait_result != WAIT_TIMEOUT) {
+      break;
+    }
+  }
   if (wait_result != WAIT_OBJECT_0) {
     SetError("Timeout waiting for audio interface activation");
     return false;
@@ -281,6 +347,37 @@ bool AudioTap::ActivateProcessLoopbackAudioClient() {
   return SUCCEEDED(activate_result_);
 }
 
+bool AudioTap::ActivateInputDeviceAudioClient() {
+  // 输入设备端点可以直接同步激活，不需要进程loopback的异步激活
+  HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr,
+                                CLSCTX_ALL, IID_PPV_ARGS(&device_enumerator_));
+  if (FAILED(hr)) {
+    SetError("Failed to create device enumerator");
+    return false;
+  }
+
+  hr = device_id_.empty()
+           ? device_enumerator_->GetDefaultAudioEndpoint(
+                 eCapture, eCommunications, &audio_device_)
+           : device_enumerator_->GetDevice(device_id_.c_str(), &audio_device_);
+  if (FAILED(hr)) {
+    SetError("Input device not found - HRESULT: 0x" + std::to_string(hr));
+    return false;
+  }
+
+  hr = audio_device_->Activate(
+      __uuidof(IAudioClient), CLSCTX_ALL, nullptr,
+      reinterpret_cast<void **>(audio_client_.ReleaseAndGetAddressOf()));
+  if (FAILED(hr)) {
+    SetError("Failed to activate input device - HRESULT: 0x" +
+             std::to_string(hr));
+    return false;
+  }
+
+  activate_result_ = InitializeAudioClientInCallback();
+  return SUCCEEDED(activate_result_);
+}
+
 HRESULT
 AudioTap::ActivateCompleted(IActivateAudioInterfaceAsyncOperation *operation) {
   // 获取激活结果
@@ -321,6 +418,66 @@ AudioTap::ActivateCompleted(IActivateAudioInterfaceAsyncOperation *operation) {
   return S_OK;
 }
 
+namespace {
+
+// WAVEFORMATEXTENSIBLE 声道掩码各位对应的位置，按位从低到高
+const char *const kSpeakerPositions[] = {
+    "FL",  "FR",  "FC",  "LFE", "RL",  "RR",  "FLC", "FRC", "RC",
+    "SL",  "SR",  "TC",  "TFL", "TFC", "TFR", "TRL", "TRC", "TRR"};
+
+// 按声道掩码生成声道布局，掩码中没有覆盖的声道记为AUX
+ChannelLayout LayoutFromMask(DWORD mask, WORD channels) {
+  ChannelLayout layout;
+  for (size_t bit = 0; bit < sizeof(kSpeakerPositions) / sizeof(char *) &&
+                       layout.size() < channels;
+       ++bit) {
+    if (mask & (1u << bit)) {
+      layout.push_back(kSpeakerPositions[bit]);
+    }
+  }
+  while (layout.size() < channels) {
+    layout.push_back("AUX" + std::to_string(layout.size()));
+  }
+  return layout;
+}
+
+// 32位浮点（包括 WAVE_FORMAT_EXTENSIBLE 的浮点子格式）
+bool IsFloatFormat(const WAVEFORMATEX *format) {
+  if (format->wBitsPerSample != 32) {
+    return false;
+  }
+  if (format->wFormatTag == WAVE_FORMAT_IEEE_FLOAT) {
+    return true;
+  }
+  return format->wFormatTag == WAVE_FORMAT_EXTENSIBLE &&
+         reinterpret_cast<const WAVEFORMATEXTENSIBLE *>(format)->SubFormat ==
+             KSDATAFORMAT_SUBTYPE_IEEE_FLOAT;
+}
+
+} // namespace
+
+WAVEFORMATEX *AudioTap::QueryDeviceMixFormat() {
+  ComPtr<IMMDeviceEnumerator> enumerator;
+  ComPtr<IMMDevice> device;
+  ComPtr<IAudioClient> client;
+  WAVEFORMATEX *format = nullptr;
+
+  // 输入设备的音频客户端已经激活，直接使用它的混音格式
+  if (input_device_) {
+    return SUCCEEDED(audio_client_->GetMixFormat(&format)) ? format : nullptr;
+  }
+
+  if (FAILED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr,
+                              CLSCTX_ALL, IID_PPV_ARGS(&enumerator))) ||
+      FAILED(enumerator->GetDefaultAudioEndpoint(eRender, eConsole, &device)) ||
+      FAILED(device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr,
+                              reinterpret_cast<void **>(client.GetAddressOf()))) ||
+      FAILED(client->GetMixFormat(&format))) {
+    return nullptr;
+  }
+  return format;
+}
+
 HRESULT AudioTap::InitializeAudioClientInCallback() {
   // 使用更现代的默认格式：48000Hz, 32-bit Float
   // 这是大多数现代应用（Chrome、游戏、视频播放器）使用的格式
@@ -328,29 +485,77 @@ HRESULT AudioTap::InitializeAudioClientInCallback() {
   if (mix_format_) {
     CoTaskMemFree(mix_format_);
   }
-  mix_format_ = (WAVEFORMATEX *)CoTaskMemAlloc(sizeof(WAVEFORMATEX));
+  mix_format_ = (WAVEFORMATEX *)CoTaskMemAlloc(sizeof(WAVEFORMATEXTENSIBLE));
   if (!mix_format_) {
     return E_OUTOFMEMORY;
   }
 
-  mix_format_->wFormatTag = WAVE_FORMAT_IEEE_FLOAT; // 使用 Float 格式
-  mix_format_->nChannels = 2;
-  mix_format_->nSamplesPerSec = 48000; // 48kHz 是现代应用的标准
-  mix_format_->wBitsPerSample = 32;    // 32-bit Float
+  WORD channels = 2;
+  DWORD sample_rate = 48000; // 48kHz 是现代应用的标准
+  DWORD channel_mask = SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT;
+
+  // 原始格式模式：按默认输出设备（捕获输入设备时为该设备）的混音格式
+  // （引擎实际混音使用的采样率和声道）请求数据，避免系统下混和重采样；
+  // 查询失败时退回默认格式
+  if (native_format_) {
+    WAVEFORMATEX *device_format = QueryDeviceMixFormat();
+    if (device_format) {
+      channels = device_format->nChannels;
+      sample_rate = device_format->nSamplesPerSec;
+      channel_mask =
+          device_format->wFormatTag == WAVE_FORMAT_EXTENSIBLE
+              ? reinterpret_cast<WAVEFORMATEXTENSIBLE *>(device_format)
+                    ->dwChannelMask
+              : 0;
+      CoTaskMemFree(device_format);
+    }
+  }
+
+  auto *extensible = reinterpret_cast<WAVEFORMATEXTENSIBLE *>(mix_format_);
+  mix_format_->nChannels = channels;
+  mix_format_->nSamplesPerSec = sample_rate;
+  mix_format_->wBitsPerSample = 32; // 32-bit Float
   mix_format_->nBlockAlign =
       mix_format_->nChannels * mix_format_->wBitsPerSample / BITS_PER_BYTE;
   mix_format_->nAvgBytesPerSec =
       mix_format_->nSamplesPerSec * mix_format_->nBlockAlign;
-  mix_format_->cbSize = 0;
+  if (native_format_) {
+    // 多声道需要用 WAVEFORMATEXTENSIBLE 描述声道位置
+    mix_format_->wFormatTag = WAVE_FORMAT_EXTENSIBLE;
+    mix_format_->cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
+    extensible->Samples.wValidBitsPerSample = 32;
+    extensible->dwChannelMask = channel_mask;
+    extensible->SubFormat = KSDATAFORMAT_SUBTYPE_IEEE_FLOAT;
+  } else {
+    mix_format_->wFormatTag = WAVE_FORMAT_IEEE_FLOAT; // 使用 Float 格式
+    mix_format_->cbSize = 0;
+  }
+  layout_ = LayoutFromMask(channel_mask, channels);
+
+  // 共享模式下事件周期固定为音频引擎周期（通常10ms）；期望的周期更长时
+  // 改为按该间隔轮询，一次取出所有数据包合并回调，缓冲区至少容纳两个周期
+  REFERENCE_TIME buffer_duration = CAPTURE_BUFFER_DURATION;
+  poll_interval_ms_ = 0;
+  if (period_frames_ > 0) {
+    REFERENCE_TIME period = static_cast<REFERENCE_TIME>(period_frames_) *
+                            10000000 / CaptureOptions::kReferenceSampleRate;
+    if (period > ENGINE_PERIOD_DURATION) {
+      poll_interval_ms_ = static_cast<DWORD>(period / 10000);
+      buffer_duration = std::max<REFERENCE_TIME>(buffer_duration, period * 2);
+    }
+  }
 
   // 初始化音频客户端
   // AUTOCONVERTPCM 让 Windows 自动处理格式转换
   // 共享模式下，周期参数必须为 0
+  // 输入设备按普通捕获流打开，进程音频使用loopback
+  DWORD stream_flags = AUDCLNT_STREAMFLAGS_EVENTCALLBACK |
+                       AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM;
+  if (!input_device_) {
+    stream_flags |= AUDCLNT_STREAMFLAGS_LOOPBACK;
+  }
   HRESULT hr = audio_client_->Initialize(AUDCLNT_SHAREMODE_SHARED,
-                                         AUDCLNT_STREAMFLAGS_LOOPBACK |
-                                             AUDCLNT_STREAMFLAGS_EVENTCALLBACK |
-                                             AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM,
-                                         CAPTURE_BUFFER_DURATION,
+                                         stream_flags, buffer_duration,
                                          0, // shared mode, period must be 0
                                          mix_format_, nullptr);
 
@@ -385,15 +590,51 @@ HRESULT AudioTap::InitializeAudioClientInCallback() {
 
 void AudioTap::CaptureThreadProc() {
   SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+  trace::RegisterThread();
+
+  // 捕获线程由本对象创建，显式加入MTA，退出时（包括结束捕获提前返回）离开
+  struct ComScope {
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    ~ComScope() {
+      if (SUCCEEDED(hr)) {
+        CoUninitialize();
+      }
+    }
+  } com;
 
   while (!stop_capture_.load()) {
-    DWORD wait_result = WaitForSingleObject(capture_event_, 1000);
+    if (poll_interval_ms_ > 0) {
+      // 轮询模式：每个周期唤醒一次，不等待引擎周期的事件
+      if (process_handle_) {
+        if (WaitForSingleObject(process_handle_, poll_interval_ms_) ==
+            WAIT_OBJECT_0) {
+          EndCapture("process-exited");
+          return;
+        }
+      } else {
+        Sleep(poll_interval_ms_);
+      }
+      if (stop_capture_.load()) {
+        continue;
+      }
+    } else {
+      HANDLE handles[] = {capture_event_, process_handle_};
+      DWORD wait_result = WaitForMultipleObjects(process_handle_ ? 2 : 1,
+                                                 handles, FALSE, 1000);
+      if (wait_result == WAIT_OBJECT_0 + 1) {
+        EndCapture("process-exited");
+        return;
+      }
 
-    if (wait_result != WAIT_OBJECT_0 || stop_capture_.load()) {
-      continue;
+      if (wait_result != WAIT_OBJECT_0 || stop_capture_.load()) {
+        continue;
+      }
     }
 
-    // 处理所有可用的音频数据包
+    // 处理所有可用的音频数据包，转换后合并为一次回调
+    AUDIO_CAPTURE_RT_SCOPE();
+    pending_.clear();
+    UINT32 silent_frames = 0;
     UINT32 packet_length = 0;
     HRESULT hr = capture_client_->GetNextPacketSize(&packet_length);
 
@@ -407,9 +648,12 @@ void AudioTap::CaptureThreadProc() {
                                       &device_position, &qpc_position);
 
       if (SUCCEEDED(hr)) {
+        trace::ScopedSpan span("backend-callback", trace_session_);
         // 只在非静音时处理数据
         if (!(flags & AUDCLNT_BUFFERFLAGS_SILENT)) {
           ProcessAudioData(data, frames_available, flags);
+        } else {
+          silent_frames += frames_available;
         }
         hr = capture_client_->ReleaseBuffer(frames_available);
       }
@@ -420,7 +664,84 @@ void AudioTap::CaptureThreadProc() {
 
       hr = capture_client_->GetNextPacketSize(&packet_length);
     }
+
+    // 音频设备被移除或重新配置后不会再有数据
+    if (hr == AUDCLNT_E_DEVICE_INVALIDATED) {
+      EndCapture("stream-removed");
+      return;
+    }
+
+    // 通过回调传递音频数据
+    if (!pending_.empty() && callback_) {
+      callback_(reinterpret_cast<const uint8_t *>(pending_.data()),
+                pending_.size() * sizeof(float), mix_format_->nChannels,
+                mix_format_->nSamplesPerSec);
+    }
+
+    // 连续静音达到设定时长后停止音频客户端，进入空闲监视
+    int channels = mix_format_->nChannels;
+    int sample_rate = static_cast<int>(mix_format_->nSamplesPerSec);
+    bool idle = detector_.Feed(pending_.data(), pending_.size() / channels,
+                               channels, sample_rate);
+    if (silent_frames > 0) {
+      idle |= detector_.Feed(nullptr, silent_frames, channels, sample_rate);
+    }
+    if (idle && !IdleWait()) {
+      return;
+    }
+  }
+}
+
+void AudioTap::EndCapture(const char *reason) {
+  // 捕获线程随后退出，音频客户端和COM对象由调用方的StopCapture释放
+  trace::RecordInstant("ended", trace_session_);
+  audio_client_->Stop();
+  if (ended_callback_) {
+    ended_callback_(reason);
+  }
+}
+
+bool AudioTap::IdleWait() {
+  audio_client_->Stop();
+  audio_client_->Reset();
+  trace::RecordInstant("idle-suspend", trace_session_);
+  HANDLE wake_event = wake_event_;
+  idle_->Suspended(this, [wake_event]() { SetEvent(wake_event); });
+
+  // 只在探测间隔到达、配置变化、目标退出或停止时唤醒；
+  // 配置变化后按新的间隔重新等待
+  bool probe = false;
+  bool exited = false;
+  while (!stop_capture_.load() && idle_->IsEnabled()) {
+    uint64_t begin = ThreadCpuNs();
+    HANDLE handles[] = {wake_event_, process_handle_};
+    DWORD wait_result = WaitForMultipleObjects(
+        process_handle_ ? 2 : 1, handles, FALSE, idle_->ProbeIntervalMs());
+    if (stop_capture_.load()) {
+      break;
+    }
+    if (wait_result == WAIT_OBJECT_0 + 1) {
+      exited = true;
+      break;
+    }
+    idle_->RecordWakeup(ThreadCpuNs() - begin);
+    if (wait_result == WAIT_TIMEOUT) {
+      probe = true;
+      break;
+    }
+  }
+
+  idle_->Resumed(this, probe);
+  detector_.Reset(probe);
+  if (exited) {
+    EndCapture("process-exited");
+    return false;
+  }
+  if (!stop_capture_.load()) {
+    audio_client_->Start();
+    trace::RecordInstant("idle-resume", trace_session_);
   }
+  return true;
 }
 
 void AudioTap::ProcessAudioData(BYTE *data, UINT32 frames, DWORD flags) {
@@ -432,18 +753,20 @@ void AudioTap::ProcessAudioData(BYTE *data, UINT32 frames, DWORD flags) {
   UINT32 sample_count = frames * mix_format_->nChannels;
   size_t float_data_size = sample_count * sizeof(float);
 
-  // 使用线程局部存储避免频繁内存分配
-  thread_local std::vector<float> float_buffer;
-  float_buffer.resize(sample_count);
+  uint64_t conversion_begin = trace::IsEnabled() ? trace::NowNs() : 0;
+
+  // 追加到本次唤醒的待回调缓冲区，容量只增不减，稳态下不分配内存
+  size_t offset = pending_.size();
+  pending_.resize(offset + sample_count);
+  float *float_buffer = pending_.data() + offset;
 
   // 根据我们请求的格式处理数据
   // 使用 AUTOCONVERTPCM 时，Windows 通常会按我们请求的格式返回数据
   // 但为了健壮性，仍然检查实际格式
-  if (mix_format_->wFormatTag == WAVE_FORMAT_IEEE_FLOAT &&
-      mix_format_->wBitsPerSample == 32) {
+  if (IsFloatFormat(mix_format_)) {
     // 32-bit Float 格式 - 直接复制（最高效，最常见的情况）
     float *float_samples = reinterpret_cast<float *>(data);
-    memcpy(float_buffer.data(), float_samples, float_data_size);
+    memcpy(float_buffer, float_samples, float_data_size);
   } else if (mix_format_->wFormatTag == WAVE_FORMAT_PCM &&
              mix_format_->wBitsPerSample == 16) {
     // 16-bit PCM - 可能在某些旧设备上发生
@@ -469,13 +792,13 @@ void AudioTap::ProcessAudioData(BYTE *data, UINT32 frames, DWORD flags) {
     }
     // 尝试按 Float 处理（最可能的情况）
     float *float_samples = reinterpret_cast<float *>(data);
-    memcpy(float_buffer.data(), float_samples, float_data_size);
+    memcpy(float_buffer, float_samples, float_data_size);
   }
 
-  // 通过回调传递音频数据
-  callback_(reinterpret_cast<const uint8_t *>(float_buffer.data()),
-            float_data_size, mix_format_->nChannels,
-            mix_format_->nSamplesPerSec);
+  if (conversion_begin != 0) {
+    trace::RecordSpan("conversion", trace_session_, conversion_begin,
+                      trace::NowNs());
+  }
 }
 
 } // namespace win_audio
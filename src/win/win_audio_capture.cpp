@@ -55,12 +55,13 @@ void WinAudioCapture::Cleanup() {
   }
 }
 
-bool WinAudioCapture::StartCapture(uint32_t pid, AudioDataCallback callback) {
+bool WinAudioCapture::Prepare(uint32_t pid, const CaptureOptions &options) {
   if (capturing_) {
     return false;
   }
 
-  callback_ = callback;
+  // 释放之前的准备结果
+  process_capture_.Reset();
   current_pid_ = pid;
 
   // 创建音频捕获对象
@@ -70,45 +71,86 @@ bool WinAudioCapture::StartCapture(uint32_t pid, AudioDataCallback callback) {
   if (FAILED(hr)) {
     return false;
   }
-  process_capture_ = std::move(audio_tap);
+  if (input_device_) {
+    audio_tap->SetInputDevice(device_);
+  }
 
-  // 初始化并开始捕获
-  if (!process_capture_->Initialize() || !process_capture_->Start(callback)) {
+  // 初始化COM/Media Foundation并等待音频客户端异步激活完成
+  if (!audio_tap->Initialize(options)) {
     return false;
   }
 
-  capturing_ = true;
+  process_capture_ = std::move(audio_tap);
   return true;
 }
 
-bool WinAudioCapture::StopCapture() {
-  if (!capturing_) {
+bool WinAudioCapture::Start(AudioDataCallback callback) {
+  if (capturing_ || !process_capture_) {
+    return false;
+  }
+
+  callback_ = callback;
+
+  // 启动已激活的音频客户端和捕获线程
+  process_capture_->SetEndedCallback(ended_callback_);
+  if (!process_capture_->Start(callback)) {
+    process_capture_.Reset();
     return false;
   }
 
-  capturing_ = false;
+  capturing_ = true;
+  return true;
+}
+
+bool WinAudioCapture::IsPreparedFor(uint32_t pid) const {
+  return !capturing_ && process_capture_ && current_pid_ == pid;
+}
 
-  // 停止音频捕获
+bool WinAudioCapture::StopCapture() {
+  bool was_capturing = capturing_.exchange(false);
+
+  // 停止音频捕获，同时释放尚未启动的准备结果
   if (process_capture_) {
     process_capture_->Stop();
     process_capture_.Reset();
   }
 
   CleanupCapture();
-  return true;
+  return was_capturing;
 }
 
 bool WinAudioCapture::IsCapturing() const { return capturing_.load(); }
 
+ChannelLayout WinAudioCapture::GetChannelLayout() const {
+  return process_capture_ ? process_capture_->GetChannelLayout()
+                          : ChannelLayout();
+}
+
 void WinAudioCapture::CleanupCapture() {
   callback_ = nullptr;
   current_pid_ = 0;
 }
 
+void WinAudioCapture::SetEndedCallback(EndedCallback callback) {
+  ended_callback_ = std::move(callback);
+}
+
+void WinAudioCapture::SetInputDevice(const std::string &device) {
+  input_device_ = true;
+  device_ = device;
+}
+
 std::unique_ptr<AudioCapture> CreatePlatformAudioCapture() {
   return std::make_unique<WinAudioCapture>();
 }
 
+std::unique_ptr<AudioCapture>
+CreatePlatformInputCapture(const std::string &device) {
+  auto capture = std::make_unique<WinAudioCapture>();
+  capture->SetInputDevice(device);
+  return capture;
+}
+
 } // namespace audio_capture
 
 #endif // _WIN32
@@ -0,0 +1,18 @@
+#include "/root/repo/include/noise_suppressor.h"
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+int main(){
+  const int sr=48000; const size_t n=sr*2;
+  std::mt19937 rng(1); std::normal_distribution<float> nd(0,0.05f);
+  std::vector<float> in(n);
+  for(size_t i=0;i<n;i++) in[i]=0.3f*std::sin(2*M_PI*440*i/sr)*(i>sr/2?1:0)+nd(rng);
+  std::vector<float> out(n);
+  audio_capture::NoiseSuppressor ns(20); ns.Process(in.data(),out.data(),n,1,sr);
+  // measure energy in first 0.4 s (noise only) and in tone region
+  double e0=0,e1=0,i0=0; for(size_t i=2400;i<sr*4/10;i++){e0+=out[i]*out[i]; i0+=in[i]*in[i];}
+  printf("noise-only in=%g out=%g ratio dB=%g\n", i0, e0, 10*log10(e0/i0));
+  double maxo=0; for(float v:out) maxo=std::max(maxo,(double)std::fabs(v));
+  printf("max |out| = %g\n", maxo);
+}
@@ -0,0 +1,4 @@
+// Check: does the padding region of frame_ stay zero? Print Fft size/bins vs hop.
+#include "/root/repo/include/fft.h"
+#include <cstdio>
+int main(){ audio_capture::Fft f(1024); printf("size=%zu bins=%zu\n", f.Size(), f.Bins()); }
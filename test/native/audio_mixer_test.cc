@@ -0,0 +1,286 @@
+#include "../../include/audio_mixer.h"
+#include "check.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file audio_mixer_test.cc
+ * @brief 混音器：多声道下混、增益/静音、分轨、移除音频源和后端结束后的重试
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+constexpr int kRate = 48000;
+
+/**
+ * 以实时节奏输出恒定值的音频源，值和声道数在构造时指定；
+ * 恒定信号经过重采样和漂移校正后仍然是同一个值，混音结果可以精确比较
+ */
+class ConstantCapture : public AudioCapture {
+public:
+  ConstantCapture(float value, int channels)
+      : value_(value), channels_(channels) {}
+  ~ConstantCapture() override { StopCapture(); }
+
+  bool Prepare(uint32_t pid, const CaptureOptions &) override {
+    pid_ = pid;
+    return true;
+  }
+  bool IsPreparedFor(uint32_t pid) const override { return pid_ == pid; }
+  bool Start(AudioDataCallback callback) override {
+    callback_ = std::move(callback);
+    stop_ = false;
+    capturing_ = true;
+    thread_ = std::thread([this]() {
+      std::vector<float> packet(480 * static_cast<size_t>(channels_), value_);
+      auto deadline = std::chrono::steady_clock::now();
+      while (!stop_) {
+        deadline += std::chrono::milliseconds(10);
+        std::this_thread::sleep_until(deadline);
+        callback_(reinterpret_cast<const uint8_t *>(packet.data()),
+                  packet.size() * sizeof(float), channels_, kRate);
+      }
+    });
+    return true;
+  }
+  bool StopCapture() override {
+    if (!capturing_.exchange(false)) {
+      return false;
+    }
+    stop_ = true;
+    thread_.join();
+    return true;
+  }
+  bool IsCapturing() const override { return capturing_; }
+  void SetEndedCallback(EndedCallback callback) override {
+    ended_ = std::move(callback);
+  }
+
+  /// 模拟后端报告目标结束
+  void End() { ended_("process-exited"); }
+
+private:
+  float value_;
+  int channels_;
+  uint32_t pid_ = 0;
+  std::atomic<bool> capturing_{false};
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+  AudioDataCallback callback_;
+  EndedCallback ended_;
+};
+
+// 保存混音器最近一次输出的数据包
+struct Output {
+  std::mutex mutex;
+  std::vector<float> last;
+  int channels = 0;
+
+  AudioDataCallback Callback() {
+    return [this](const uint8_t *data, size_t length, int out_channels, int) {
+      const float *values = reinterpret_cast<const float *>(data);
+      std::lock_guard<std::mutex> lock(mutex);
+      last.assign(values, values + length / sizeof(float));
+      channels = out_channels;
+    };
+  }
+
+  std::vector<float> Last() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return last;
+  }
+};
+
+// 创建恒定值音频源的工厂，可选地记录创建次数和最近创建的实例
+CaptureFactory Factory(float value, int channels,
+                       std::atomic<int> *created = nullptr,
+                       std::atomic<ConstantCapture *> *latest = nullptr) {
+  return [=]() -> std::unique_ptr<AudioCapture> {
+    auto capture = std::make_unique<ConstantCapture>(value, channels);
+    if (created) {
+      ++*created;
+    }
+    if (latest) {
+      latest->store(capture.get());
+    }
+    return capture;
+  };
+}
+
+// 输出稳定（所有音频源都在运行且增益斜坡已结束）后的最后一帧
+std::vector<float> SteadyFrame(AudioMixer &mixer, Output &out) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+  for (;;) {
+    bool running = true;
+    for (const auto &info : mixer.GetSources()) {
+      running = running && std::string(info.state) == "running";
+    }
+    if (running || std::chrono::steady_clock::now() > deadline) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::vector<float> last = out.Last();
+  int channels = mixer.GetChannels();
+  if (last.size() < static_cast<size_t>(channels)) {
+    return std::vector<float>(channels, -1.0f);
+  }
+  return std::vector<float>(last.end() - channels, last.end());
+}
+
+} // namespace
+
+TEST(DownmixPassesMonoAndStereo) {
+  float l = 0.0f;
+  float r = 0.0f;
+  StereoDownmix mono(1);
+  const float one[] = {0.5f};
+  mono.Apply(one, &l, &r);
+  CHECK_EQ(l, 0.5f);
+  CHECK_EQ(r, 0.5f);
+
+  StereoDownmix stereo(2);
+  const float two[] = {0.25f, -0.5f};
+  stereo.Apply(two, &l, &r);
+  CHECK_EQ(l, 0.25f);
+  CHECK_EQ(r, -0.5f);
+}
+
+TEST(DownmixWeightsFiveOneAndDropsLfe) {
+  // FL FR FC LFE BL BR
+  StereoDownmix downmix(6);
+  float l = 0.0f;
+  float r = 0.0f;
+  const float lfe_only[] = {0, 0, 0, 1, 0, 0};
+  downmix.Apply(lfe_only, &l, &r);
+  CHECK_EQ(l, 0.0f);
+  CHECK_EQ(r, 0.0f);
+
+  const double norm = 1.0 + 2 * 0.70710678;
+  const float center[] = {0, 0, 1, 0, 0, 0};
+  downmix.Apply(center, &l, &r);
+  CHECK_NEAR(l, 0.70710678 / norm, 1e-6);
+  CHECK_NEAR(r, 0.70710678 / norm, 1e-6);
+
+  const float back_left[] = {0, 0, 0, 0, 1, 0};
+  downmix.Apply(back_left, &l, &r);
+  CHECK_NEAR(l, 0.70710678 / norm, 1e-6);
+  CHECK_EQ(r, 0.0f);
+}
+
+TEST(DownmixWeightsSumToOne) {
+  // 所有声道为同一个值时两侧都等于该值，不会削波
+  for (int channels = 1; channels <= 8; ++channels) {
+    StereoDownmix downmix(channels);
+    std::vector<float> frame(channels, 1.0f);
+    float l = 0.0f;
+    float r = 0.0f;
+    downmix.Apply(frame.data(), &l, &r);
+    CHECK_NEAR(l, 1.0, 1e-6);
+    CHECK_NEAR(r, 1.0, 1e-6);
+  }
+}
+
+TEST(MixAccumulateAppliesGain) {
+  std::vector<float> out(7, 1.0f);
+  std::vector<float> in(7, 2.0f);
+  MixAccumulate(out.data(), in.data(), out.size(), 0.5f);
+  for (float value : out) {
+    CHECK_EQ(value, 2.0f);
+  }
+
+  // 斜坡从 from 逐帧过渡，最后一帧达到 to
+  std::vector<float> ramp(8, 0.0f);
+  std::vector<float> ones(8, 1.0f);
+  MixAccumulateRamp(ramp.data(), ones.data(), 4, 2, 0.0f, 1.0f);
+  CHECK_NEAR(ramp[0], 0.25, 1e-6);
+  CHECK_NEAR(ramp[1], 0.25, 1e-6);
+  CHECK_NEAR(ramp[6], 1.0, 1e-6);
+  CHECK_NEAR(ramp[7], 1.0, 1e-6);
+}
+
+TEST(MixesSourcesWithGainAndDownmix) {
+  Output out;
+  AudioMixer mixer(Factory(0.1f, 1));
+  CHECK(mixer.Start(out.Callback()));
+  CHECK(mixer.AddSource(1, 1.0f));
+  // 5.1声道的音频源下混后两侧仍为0.2，增益0.5
+  CHECK(mixer.AddSource(2, 0.5f, false, Factory(0.2f, 6)));
+  CHECK(!mixer.AddSource(2));
+
+  std::vector<float> frame = SteadyFrame(mixer, out);
+  CHECK_NEAR(frame[0], 0.2, 1e-5);
+  CHECK_NEAR(frame[1], 0.2, 1e-5);
+
+  CHECK(mixer.SetMuted(2, true));
+  frame = SteadyFrame(mixer, out);
+  CHECK_NEAR(frame[0], 0.1, 1e-5);
+  CHECK_NEAR(frame[1], 0.1, 1e-5);
+  CHECK(mixer.Stop());
+}
+
+TEST(StemsKeepSourcesApart) {
+  Output out;
+  AudioMixer mixer(Factory(0.1f, 1), kRate, 480, 2);
+  CHECK_EQ(mixer.GetChannels(), 4);
+  CHECK(mixer.Start(out.Callback()));
+  CHECK(mixer.AddSource(1, 1.0f, false, nullptr, 0));
+  CHECK(mixer.AddSource(2, 1.0f, false, Factory(0.3f, 2), 1));
+  CHECK(!mixer.AddSource(3, 1.0f, false, nullptr, 2));
+
+  std::vector<float> frame = SteadyFrame(mixer, out);
+  CHECK_NEAR(frame[0], 0.1, 1e-5);
+  CHECK_NEAR(frame[1], 0.1, 1e-5);
+  CHECK_NEAR(frame[2], 0.3, 1e-5);
+  CHECK_NEAR(frame[3], 0.3, 1e-5);
+  CHECK(mixer.Stop());
+}
+
+TEST(RemovedSourceLeavesTheMix) {
+  Output out;
+  AudioMixer mixer(Factory(0.1f, 2));
+  CHECK(mixer.Start(out.Callback()));
+  CHECK(mixer.AddSource(1));
+  CHECK(mixer.AddSource(2));
+  SteadyFrame(mixer, out);
+
+  CHECK(mixer.RemoveSource(2));
+  CHECK(!mixer.RemoveSource(2));
+  CHECK_EQ(mixer.GetSources().size(), size_t{1});
+  std::vector<float> frame = SteadyFrame(mixer, out);
+  CHECK_NEAR(frame[0], 0.1, 1e-5);
+  CHECK(mixer.Stop());
+  CHECK(!mixer.Stop());
+}
+
+TEST(EndedSourceIsRestarted) {
+  Output out;
+  std::atomic<int> created{0};
+  std::atomic<ConstantCapture *> latest{nullptr};
+  AudioMixer mixer(Factory(0.1f, 2, &created, &latest));
+  CHECK(mixer.Start(out.Callback()));
+  CHECK(mixer.AddSource(1));
+  SteadyFrame(mixer, out);
+  CHECK_EQ(created.load(), 1);
+
+  // 后端报告结束后由后台线程停止并重新启动
+  latest.load()->End();
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+  while (created.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  CHECK_EQ(created.load(), 2);
+  std::vector<float> frame = SteadyFrame(mixer, out);
+  CHECK_NEAR(frame[0], 0.1, 1e-5);
+  CHECK(mixer.Stop());
+}
+
+int main() { return check::RunAll(); }
@@ -0,0 +1,263 @@
+#include "../../include/cadence_trace.h"
+#include "../../include/replay_audio_capture.h"
+#include "check.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file cadence_trace_test.cc
+ * @brief 回调节奏：文件读写、录制容量溢出、按节奏回放和回放音频的读取
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+// 回放音频源送出的数据包
+struct Received {
+  std::mutex mutex;
+  std::vector<uint32_t> frames;
+  std::vector<int> channels;
+  std::vector<int> rates;
+  std::vector<float> samples;
+
+  AudioDataCallback Callback() {
+    return [this](const uint8_t *data, size_t length, int packet_channels,
+                  int sample_rate) {
+      const float *values = reinterpret_cast<const float *>(data);
+      std::lock_guard<std::mutex> lock(mutex);
+      frames.push_back(static_cast<uint32_t>(length / sizeof(float) /
+                                             packet_channels));
+      channels.push_back(packet_channels);
+      rates.push_back(sample_rate);
+      samples.insert(samples.end(), values, values + length / sizeof(float));
+    };
+  }
+
+  size_t Count() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames.size();
+  }
+};
+
+// 等待收到至少 count 个数据包（最多2秒）
+bool WaitFor(Received &received, size_t count) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (received.Count() < count) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+void WriteU16(std::FILE *file, uint16_t value) {
+  std::fwrite(&value, 2, 1, file);
+}
+
+void WriteU32(std::FILE *file, uint32_t value) {
+  std::fwrite(&value, 4, 1, file);
+}
+
+// 写出最简的WAV文件（format 1为整数PCM，3为浮点）
+void WriteWav(const std::string &path, uint16_t format, uint16_t channels,
+              uint16_t bits, const void *data, uint32_t size) {
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  std::fwrite("RIFF", 1, 4, file);
+  WriteU32(file, 36 + size);
+  std::fwrite("WAVEfmt ", 1, 8, file);
+  WriteU32(file, 16);
+  WriteU16(file, format);
+  WriteU16(file, channels);
+  WriteU32(file, 48000);
+  WriteU32(file, 48000u * channels * bits / 8);
+  WriteU16(file, static_cast<uint16_t>(channels * bits / 8));
+  WriteU16(file, bits);
+  std::fwrite("data", 1, 4, file);
+  WriteU32(file, size);
+  std::fwrite(data, 1, size, file);
+  std::fclose(file);
+}
+
+std::shared_ptr<const std::vector<CadencePacket>> Packets() {
+  // 两个5ms间隔的数据包，第三个包改变格式
+  return std::make_shared<const std::vector<CadencePacket>>(
+      std::vector<CadencePacket>{{0, 240, 2, 48000},
+                                 {5000000, 240, 2, 48000},
+                                 {10000000, 160, 1, 16000}});
+}
+
+} // namespace
+
+TEST(SaveAndLoadRoundTrip) {
+  std::vector<CadencePacket> packets = {{0, 512, 2, 44100},
+                                        {11609000, 512, 2, 44100},
+                                        {11609000, 480, 6, 48000},
+                                        {30000000, 1024, 1, 192000}};
+  std::string error;
+  CHECK(SaveCadenceTrace("cadence_round_trip.pacd", packets, 7, &error));
+
+  std::vector<CadencePacket> loaded;
+  CHECK(LoadCadenceTrace("cadence_round_trip.pacd", &loaded, &error));
+  CHECK_EQ(loaded.size(), packets.size());
+  if (loaded.size() != packets.size()) {
+    return;
+  }
+  // 时间以微秒保存
+  for (size_t i = 0; i < packets.size(); ++i) {
+    CHECK_EQ(loaded[i].time_ns, packets[i].time_ns);
+    CHECK_EQ(loaded[i].frames, packets[i].frames);
+    CHECK_EQ(loaded[i].channels, packets[i].channels);
+    CHECK_EQ(loaded[i].sample_rate, packets[i].sample_rate);
+  }
+
+  // 头部记录溢出数
+  std::FILE *file = std::fopen("cadence_round_trip.pacd", "rb");
+  uint8_t header[16] = {};
+  CHECK_EQ(std::fread(header, 1, 16, file), size_t{16});
+  std::fclose(file);
+  uint32_t overflow = 0;
+  std::memcpy(&overflow, header + 12, 4);
+  CHECK(std::memcmp(header, "PACD", 4) == 0);
+  CHECK_EQ(overflow, uint32_t{7});
+}
+
+TEST(LoadRejectsMissingAndEmptyTraces) {
+  std::vector<CadencePacket> loaded;
+  std::string error;
+  CHECK(!LoadCadenceTrace("missing.pacd", &loaded, &error));
+  CHECK(!error.empty());
+
+  error.clear();
+  CHECK(SaveCadenceTrace("cadence_empty.pacd", {}, 0, &error));
+  CHECK(!LoadCadenceTrace("cadence_empty.pacd", &loaded, &error));
+  CHECK(!error.empty());
+}
+
+TEST(RecorderCountsOverflow) {
+  CadenceRecorder recorder;
+  std::string error;
+  CHECK(!recorder.Stop("cadence_recorder.pacd", &error));
+  CHECK(!recorder.Start(0));
+
+  // 未录制时的记录被忽略
+  recorder.Record(100, 1, 8000);
+  CHECK(recorder.Start(3));
+  CHECK(recorder.IsRecording());
+  CHECK(!recorder.Start(3));
+  for (uint32_t i = 1; i <= 5; ++i) {
+    recorder.Record(i * 10, 2, 48000);
+  }
+  CHECK(recorder.Stop("cadence_recorder.pacd", &error));
+  CHECK(!recorder.IsRecording());
+
+  std::vector<CadencePacket> loaded;
+  CHECK(LoadCadenceTrace("cadence_recorder.pacd", &loaded, &error));
+  CHECK_EQ(loaded.size(), size_t{3});
+  if (loaded.size() != 3) {
+    return;
+  }
+  CHECK_EQ(loaded[0].time_ns, uint64_t{0});
+  CHECK_EQ(loaded[2].frames, uint32_t{30});
+  CHECK_EQ(loaded[2].channels, 2);
+  CHECK_EQ(loaded[2].sample_rate, 48000);
+
+  std::FILE *file = std::fopen("cadence_recorder.pacd", "rb");
+  uint8_t header[16] = {};
+  CHECK_EQ(std::fread(header, 1, 16, file), size_t{16});
+  std::fclose(file);
+  uint32_t overflow = 0;
+  std::memcpy(&overflow, header + 12, 4);
+  CHECK_EQ(overflow, uint32_t{2});
+}
+
+TEST(ReplayFollowsPacketSizesAndFormats) {
+  Received received;
+  ReplayAudioCapture capture(Packets(), nullptr, false);
+  CHECK(capture.Prepare(1, CaptureOptions()));
+  CHECK(capture.IsPreparedFor(1));
+  CHECK(capture.Start(received.Callback()));
+  CHECK(WaitFor(received, 3));
+
+  // 不重复回放时送完最后一个数据包后不再输出，直到停止
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  CHECK(capture.IsCapturing());
+  CHECK(capture.StopCapture());
+  CHECK(!capture.StopCapture());
+
+  CHECK_EQ(received.frames.size(), size_t{3});
+  if (received.frames.size() != 3) {
+    return;
+  }
+  CHECK_EQ(received.frames[0], uint32_t{240});
+  CHECK_EQ(received.channels[1], 2);
+  CHECK_EQ(received.frames[2], uint32_t{160});
+  CHECK_EQ(received.channels[2], 1);
+  CHECK_EQ(received.rates[2], 16000);
+}
+
+TEST(ReplayLoopsWithAudioContent) {
+  // 3帧立体声内容，按数据包的声道数逐帧循环
+  auto audio = std::make_shared<ReplayAudio>();
+  audio->channels = 2;
+  audio->samples = {0.1f, -0.1f, 0.2f, -0.2f, 0.3f, -0.3f};
+
+  Received received;
+  ReplayAudioCapture capture(Packets(), audio, true);
+  CHECK(capture.Prepare(1, CaptureOptions()));
+  CHECK(capture.Start(received.Callback()));
+  CHECK(WaitFor(received, 7));
+  CHECK(capture.StopCapture());
+
+  // 第二轮同样的节奏
+  CHECK_EQ(received.frames[3], uint32_t{240});
+  CHECK_EQ(received.frames[5], uint32_t{160});
+  CHECK_EQ(received.rates[6], 48000);
+
+  CHECK_EQ(received.samples[0], 0.1f);
+  CHECK_EQ(received.samples[1], -0.1f);
+  CHECK_EQ(received.samples[2], 0.2f);
+  CHECK_EQ(received.samples[5], -0.3f);
+  CHECK_EQ(received.samples[6], 0.1f);
+  // 第三个包为单声道：取内容的第一个声道，接着上一个包的位置（480 % 3 == 0）
+  const size_t mono = 240 * 2 * 2;
+  CHECK_EQ(received.samples[mono], 0.1f);
+  CHECK_EQ(received.samples[mono + 1], 0.2f);
+}
+
+TEST(LoadsSixteenBitAndFloatWav) {
+  const int16_t pcm[] = {16384, -16384, 32767, -32768};
+  WriteWav("replay_int16.wav", 1, 2, 16, pcm, sizeof(pcm));
+  ReplayAudio audio;
+  std::string error;
+  CHECK(LoadReplayAudio("replay_int16.wav", &audio, &error));
+  CHECK_EQ(audio.channels, 2);
+  CHECK_EQ(audio.samples.size(), size_t{4});
+  CHECK_EQ(audio.samples[0], 0.5f);
+  CHECK_EQ(audio.samples[1], -0.5f);
+  CHECK_EQ(audio.samples[3], -1.0f);
+
+  const float values[] = {0.25f, -0.75f, 1.5f};
+  WriteWav("replay_float.wav", 3, 1, 32, values, sizeof(values));
+  CHECK(LoadReplayAudio("replay_float.wav", &audio, &error));
+  CHECK_EQ(audio.channels, 1);
+  CHECK_EQ(audio.samples.size(), size_t{3});
+  CHECK_EQ(audio.samples[1], -0.75f);
+  CHECK_EQ(audio.samples[2], 1.5f);
+
+  // 24位整数不支持
+  const uint8_t packed[] = {0, 0, 0x40, 0, 0, 0xc0};
+  WriteWav("replay_int24.wav", 1, 1, 24, packed, sizeof(packed));
+  error.clear();
+  CHECK(!LoadReplayAudio("replay_int24.wav", &audio, &error));
+  CHECK(!error.empty());
+}
+
+int main() { return check::RunAll(); }
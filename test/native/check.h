@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @file check.h
+ * @brief 原生测试使用的极简断言
+ *
+ * 每个测试文件是一个独立的可执行文件（由 test/run_native.js 编译），
+ * 用 TEST 定义用例，main 中调用 check::RunAll()。断言失败时输出位置并
+ * 继续执行当前用例，RunAll 的返回值即进程退出码。
+ */
+
+namespace check {
+
+struct Case {
+  const char *name;
+  void (*body)();
+};
+
+inline std::vector<Case> &Cases() {
+  static std::vector<Case> cases;
+  return cases;
+}
+
+inline int &Failures() {
+  static int failures = 0;
+  return failures;
+}
+
+struct Registrar {
+  Registrar(const char *name, void (*body)()) {
+    Cases().push_back({name, body});
+  }
+};
+
+inline void Fail(const char *file, int line, const std::string &message) {
+  std::fprintf(stderr, "  %s:%d: %s\n", file, line, message.c_str());
+  ++Failures();
+}
+
+/// 依次执行所有用例，返回失败的断言数（0表示全部通过）
+inline int RunAll() {
+  for (const Case &test : Cases()) {
+    int before = Failures();
+    test.body();
+    std::printf("%s %s\n", Failures() == before ? "ok  " : "FAIL", test.name);
+  }
+  return Failures() == 0 ? 0 : 1;
+}
+
+} // namespace check
+
+#define TEST(name)                                                             \
+  static void name();                                                          \
+  static check::Registrar name##_registrar(#name, name);                       \
+  static void name()
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      check::Fail(__FILE__, __LINE__, "CHECK(" #cond ")");                     \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                         \
+  do {                                                                         \
+    auto check_a_ = (a);                                                       \
+    auto check_b_ = (b);                                                       \
+    if (!(check_a_ == check_b_)) {                                             \
+      check::Fail(__FILE__, __LINE__,                                          \
+                  "CHECK_EQ(" #a ", " #b "): " + std::to_string(check_a_) +    \
+                      " != " + std::to_string(check_b_));                      \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_NEAR(a, b, eps)                                                  \
+  do {                                                                         \
+    double check_a_ = (a);                                                     \
+    double check_b_ = (b);                                                     \
+    if (!(std::fabs(check_a_ - check_b_) <= (eps))) {                          \
+      check::Fail(__FILE__, __LINE__,                                          \
+                  "CHECK_NEAR(" #a ", " #b "): " + std::to_string(check_a_) +  \
+                      " vs " + std::to_string(check_b_));                      \
+    }                                                                          \
+  } while (0)
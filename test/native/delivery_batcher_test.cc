@@ -0,0 +1,186 @@
+#include "../../include/delivery_batcher.h"
+#include "check.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file delivery_batcher_test.cc
+ * @brief 投递合并：未启用时直接转交、连续数据包的拼接、格式变化和位置不连续时的
+ *        提前投递、不合并的输出端、Flush，以及按JS线程负载调整批时长
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+constexpr int kRate = 48000;
+
+// 下游收到的一次投递
+struct Delivery {
+  std::string sink_id;
+  std::vector<float> samples;
+  int channels;
+  uint64_t position;
+};
+
+struct Output {
+  std::vector<Delivery> deliveries;
+
+  GraphSinkCallback Callback() {
+    return [this](const std::string &sink_id, const uint8_t *data,
+                  size_t length, int channels, int, uint64_t position,
+                  SampleFormat) {
+      const float *values = reinterpret_cast<const float *>(data);
+      deliveries.push_back({sink_id,
+                            std::vector<float>(values,
+                                               values + length / sizeof(float)),
+                            channels, position});
+    };
+  }
+};
+
+// 投递一个10ms、全部为 value 的数据包
+void Push(DeliveryBatcher &batcher, const std::string &sink_id, float value,
+          uint64_t position, int channels = 1) {
+  std::vector<float> packet(480 * static_cast<size_t>(channels), value);
+  batcher.Push(sink_id, reinterpret_cast<const uint8_t *>(packet.data()),
+               packet.size() * sizeof(float), channels, kRate, position,
+               SampleFormat::kFloat32);
+}
+
+} // namespace
+
+TEST(DisabledBatcherPassesThrough) {
+  Output out;
+  DeliveryBatcher batcher(out.Callback(), std::make_shared<CaptureStats>());
+  CHECK_EQ(batcher.BatchMs(), 0.0);
+  Push(batcher, "", 1.0f, 0);
+  Push(batcher, "", 1.0f, 480);
+  CHECK_EQ(out.deliveries.size(), size_t{2});
+
+  // 上限为0时关闭合并
+  batcher.Configure(10, 0);
+  CHECK_EQ(batcher.BatchMs(), 0.0);
+  Push(batcher, "", 1.0f, 960);
+  CHECK_EQ(out.deliveries.size(), size_t{3});
+}
+
+TEST(ContiguousPacketsAreMerged) {
+  Output out;
+  DeliveryBatcher batcher(out.Callback(), std::make_shared<CaptureStats>());
+  batcher.Configure(20, 20);
+  CHECK_EQ(batcher.BatchMs(), 20.0);
+
+  Push(batcher, "", 1.0f, 0);
+  CHECK(out.deliveries.empty());
+  Push(batcher, "", 2.0f, 480);
+  CHECK_EQ(out.deliveries.size(), size_t{1});
+  CHECK_EQ(out.deliveries[0].samples.size(), size_t{960});
+  CHECK_EQ(out.deliveries[0].position, uint64_t{0});
+  CHECK_EQ(out.deliveries[0].samples[479], 1.0f);
+  CHECK_EQ(out.deliveries[0].samples[480], 2.0f);
+
+  // 下一批从新的位置开始
+  Push(batcher, "", 3.0f, 960);
+  Push(batcher, "", 3.0f, 1440);
+  CHECK_EQ(out.deliveries.size(), size_t{2});
+  CHECK_EQ(out.deliveries[1].position, uint64_t{960});
+}
+
+TEST(FormatChangeAndGapsEmitEarly) {
+  Output out;
+  DeliveryBatcher batcher(out.Callback(), std::make_shared<CaptureStats>());
+  batcher.Configure(50, 50);
+
+  Push(batcher, "", 1.0f, 0);
+  // 声道数变化：先投递已缓存的单声道数据
+  Push(batcher, "", 2.0f, 480, 2);
+  CHECK_EQ(out.deliveries.size(), size_t{1});
+  CHECK_EQ(out.deliveries[0].channels, 1);
+  CHECK_EQ(out.deliveries[0].samples.size(), size_t{480});
+
+  // 位置不连续（中间丢了数据）：不拼接
+  Push(batcher, "", 3.0f, 5000, 2);
+  CHECK_EQ(out.deliveries.size(), size_t{2});
+  CHECK_EQ(out.deliveries[1].channels, 2);
+  CHECK_EQ(out.deliveries[1].position, uint64_t{480});
+
+  batcher.Flush();
+  CHECK_EQ(out.deliveries.size(), size_t{3});
+  CHECK_EQ(out.deliveries[2].position, uint64_t{5000});
+  CHECK_EQ(out.deliveries[2].samples[0], 3.0f);
+
+  // 没有缓存的数据时 Flush 不投递
+  batcher.Flush();
+  CHECK_EQ(out.deliveries.size(), size_t{3});
+}
+
+TEST(SinksAreBufferedSeparately) {
+  Output out;
+  DeliveryBatcher batcher(out.Callback(), std::make_shared<CaptureStats>());
+  batcher.Configure(20, 20);
+  batcher.SetUnbatchedSinks({"chunk"});
+
+  Push(batcher, "", 1.0f, 0);
+  Push(batcher, "meter", 2.0f, 0);
+  CHECK(out.deliveries.empty());
+
+  // 不合并的输出端直接投递
+  Push(batcher, "chunk", 3.0f, 0);
+  CHECK_EQ(out.deliveries.size(), size_t{1});
+  CHECK(out.deliveries[0].sink_id == "chunk");
+
+  Push(batcher, "meter", 2.0f, 480);
+  CHECK_EQ(out.deliveries.size(), size_t{2});
+  CHECK(out.deliveries[1].sink_id == "meter");
+  CHECK_EQ(out.deliveries[1].samples.size(), size_t{960});
+
+  // 重新配置前投递所有缓存的数据
+  batcher.Configure(10, 40);
+  CHECK_EQ(out.deliveries.size(), size_t{3});
+  CHECK(out.deliveries[2].sink_id.empty());
+  CHECK_EQ(batcher.BatchMs(), 10.0);
+}
+
+TEST(BatchFollowsJsThreadLoad) {
+  Output out;
+  auto stats = std::make_shared<CaptureStats>();
+  DeliveryBatcher batcher(out.Callback(), stats);
+  batcher.Configure(10, 80);
+
+  // 排队延迟超过半批：批时长加倍，不超过上限
+  stats->dispatch_delay_ns = 100000000;
+  uint64_t position = 0;
+  Push(batcher, "", 1.0f, position += 480);
+  CHECK_EQ(batcher.BatchMs(), 20.0);
+
+  // 两次调整之间至少间隔250ms
+  Push(batcher, "", 1.0f, position += 480);
+  CHECK_EQ(batcher.BatchMs(), 20.0);
+  for (double expected : {40.0, 80.0, 80.0}) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(260));
+    Push(batcher, "", 1.0f, position += 480);
+    CHECK_EQ(batcher.BatchMs(), expected);
+  }
+
+  // 空闲后每次缩短到3/4（按纳秒取整），降到一个数据包以内时回到下限
+  stats->dispatch_delay_ns = 0;
+  stats->callback_run_ns = 0;
+  for (double expected : {60.0, 45.0, 33.75, 25.3125, 18.984375, 14.238281,
+                          10.67871, 10.0}) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(260));
+    Push(batcher, "", 1.0f, position += 480);
+    CHECK_NEAR(batcher.BatchMs(), expected, 1e-6);
+  }
+
+  // 回调执行耗时超过四分之一批时长同样加倍
+  stats->callback_run_ns = 5000000;
+  std::this_thread::sleep_for(std::chrono::milliseconds(260));
+  Push(batcher, "", 1.0f, position += 480);
+  CHECK_EQ(batcher.BatchMs(), 20.0);
+}
+
+int main() { return check::RunAll(); }
@@ -0,0 +1,172 @@
+#include "../../include/dsp_pool.h"
+#include "check.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file dsp_pool_test.cc
+ * @brief DSP线程池：串行队列的顺序、超过槽位的数据块拆分、满队列丢弃和关闭
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+// 处理函数收到的数据块（在工作线程中记录）
+struct Received {
+  std::mutex mutex;
+  std::vector<std::vector<float>> blocks;
+  std::vector<int> channels;
+
+  DspStrand::Handler Handler() {
+    return [this](const AudioBlock &block) {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocks.emplace_back(block.samples,
+                          block.samples + block.frames * block.channels);
+      channels.push_back(block.channels);
+    };
+  }
+};
+
+AudioBlock Block(const std::vector<float> &samples, int channels) {
+  AudioBlock block;
+  block.samples = samples.data();
+  block.frames = samples.size() / channels;
+  block.channels = channels;
+  block.sample_rate = 48000;
+  return block;
+}
+
+std::vector<float> Ramp(size_t count, float start = 0.0f) {
+  std::vector<float> samples(count);
+  for (size_t i = 0; i < count; ++i) {
+    samples[i] = start + static_cast<float>(i);
+  }
+  return samples;
+}
+
+} // namespace
+
+TEST(StrandsKeepSubmissionOrder) {
+  DspPool pool(4);
+  constexpr int kStrands = 8;
+  constexpr int kBlocks = 200;
+  std::vector<Received> received(kStrands);
+  std::vector<std::unique_ptr<DspStrand>> strands;
+  for (auto &target : received) {
+    strands.push_back(
+        std::make_unique<DspStrand>(pool, target.Handler(), 0, 256, 64));
+  }
+
+  for (int i = 0; i < kBlocks; ++i) {
+    std::vector<float> value(1, static_cast<float>(i));
+    for (auto &strand : strands) {
+      CHECK(strand->Submit(Block(value, 1)));
+    }
+  }
+  for (auto &strand : strands) {
+    strand->Close();
+  }
+
+  for (auto &target : received) {
+    CHECK_EQ(target.blocks.size(), size_t{kBlocks});
+    for (size_t i = 0; i < target.blocks.size(); ++i) {
+      CHECK_EQ(target.blocks[i][0], static_cast<float>(i));
+    }
+  }
+  CHECK_EQ(pool.GetStats().workers, size_t{4});
+  CHECK_EQ(pool.GetStats().jobs, uint64_t{kStrands * kBlocks});
+  CHECK_EQ(pool.GetStats().dropped, uint64_t{0});
+}
+
+TEST(LargeBlocksAreSplitOnFrameBoundaries) {
+  DspPool pool(2);
+  Received received;
+  // 每个槽位100个样本，立体声为50帧；3声道时为33帧
+  DspStrand strand(pool, received.Handler(), 0, 8, 100);
+
+  std::vector<float> stereo = Ramp(120 * 2);
+  CHECK(strand.Submit(Block(stereo, 2)));
+  std::vector<float> surround = Ramp(40 * 3, 1000.0f);
+  CHECK(strand.Submit(Block(surround, 3)));
+  strand.Close();
+
+  CHECK_EQ(received.blocks.size(), size_t{5});
+  if (received.blocks.size() != 5) {
+    return;
+  }
+  CHECK_EQ(received.blocks[0].size(), size_t{100});
+  CHECK_EQ(received.blocks[1].size(), size_t{100});
+  CHECK_EQ(received.blocks[2].size(), size_t{40});
+  CHECK_EQ(received.blocks[3].size(), size_t{99});
+  CHECK_EQ(received.blocks[4].size(), size_t{21});
+  CHECK_EQ(received.channels[3], 3);
+
+  // 各段依次拼起来就是原数据块
+  std::vector<float> joined;
+  for (size_t i = 0; i < 3; ++i) {
+    joined.insert(joined.end(), received.blocks[i].begin(),
+                  received.blocks[i].end());
+  }
+  CHECK(joined == stereo);
+  joined.clear();
+  for (size_t i = 3; i < 5; ++i) {
+    joined.insert(joined.end(), received.blocks[i].begin(),
+                  received.blocks[i].end());
+  }
+  CHECK(joined == surround);
+}
+
+TEST(BlocksThatDoNotFitAreDroppedWhole) {
+  DspPool pool(1);
+  std::atomic<bool> gate{false};
+  std::atomic<int> handled{0};
+  DspStrand strand(
+      pool,
+      [&](const AudioBlock &) {
+        while (!gate.load()) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ++handled;
+      },
+      0, 4, 100);
+
+  // 需要5个槽位的数据块永远放不下
+  std::vector<float> huge = Ramp(500);
+  CHECK(!strand.Submit(Block(huge, 1)));
+
+  // 第一块阻塞在处理函数中，槽位不会释放
+  std::vector<float> small = Ramp(10);
+  for (int i = 0; i < 3; ++i) {
+    CHECK(strand.Submit(Block(small, 1)));
+  }
+  // 只剩1个槽位时，需要2个槽位的数据块整块丢弃，不会只提交前一半
+  std::vector<float> pair = Ramp(150);
+  CHECK(!strand.Submit(Block(pair, 1)));
+  CHECK(strand.Submit(Block(small, 1)));
+  CHECK(!strand.Submit(Block(small, 1)));
+
+  gate = true;
+  strand.Close();
+  CHECK_EQ(handled.load(), 4);
+  CHECK_EQ(strand.Dropped(), uint64_t{3});
+  CHECK_EQ(pool.GetStats().dropped, uint64_t{3});
+}
+
+TEST(ClosedStrandRejectsSubmissions) {
+  DspPool pool(1);
+  Received received;
+  DspStrand strand(pool, received.Handler());
+  std::vector<float> samples = Ramp(10);
+  CHECK(strand.Submit(Block(samples, 1)));
+  strand.Close();
+  CHECK_EQ(received.blocks.size(), size_t{1});
+  CHECK(!strand.Submit(Block(samples, 1)));
+  CHECK_EQ(received.blocks.size(), size_t{1});
+}
+
+int main() { return check::RunAll(); }
@@ -0,0 +1,194 @@
+#include "../../include/idle_suspend.h"
+#include "check.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/**
+ * @file idle_suspend_test.cc
+ * @brief 空闲挂起：静音计时、探测窗口、挂起/恢复的统计和配置变化时的唤醒
+ *
+ * 采样率取1000Hz，毫秒数即帧数。
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+constexpr int kRate = 1000;
+
+IdleSuspendOptions Options(uint32_t silence_ms) {
+  IdleSuspendOptions options;
+  options.silence_ms = silence_ms;
+  options.probe_interval_ms = 500;
+  return options;
+}
+
+// 连续送入30帧的静音数据包，返回第几个数据包触发挂起（没有触发时为0）
+int PacketsUntilTrip(SilenceDetector &detector, int limit) {
+  std::vector<float> silence(30, 0.0f);
+  for (int i = 1; i <= limit; ++i) {
+    if (detector.Feed(silence.data(), silence.size(), 1, kRate)) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+} // namespace
+
+TEST(DetectorIgnoresSilenceWithoutPolicy) {
+  SilenceDetector detector;
+  CHECK_EQ(PacketsUntilTrip(detector, 100), 0);
+
+  IdleSuspend policy;
+  detector.SetPolicy(&policy);
+  CHECK_EQ(PacketsUntilTrip(detector, 100), 0);
+
+  // 未启用期间的静音不计入
+  policy.Configure(Options(100));
+  CHECK_EQ(PacketsUntilTrip(detector, 100), 4);
+}
+
+TEST(DetectorTripsOncePerSilence) {
+  IdleSuspend policy;
+  policy.Configure(Options(100));
+  SilenceDetector detector;
+  detector.SetPolicy(&policy);
+
+  // 120帧时达到100ms，之后不再重复返回true
+  CHECK_EQ(PacketsUntilTrip(detector, 10), 4);
+  CHECK_EQ(PacketsUntilTrip(detector, 10), 0);
+
+  // 非零样本重新计时；系统标记为静音的数据包（samples为空）算作静音
+  std::vector<float> sound(30, 0.0f);
+  sound[17] = 1e-6f;
+  CHECK(!detector.Feed(sound.data(), 30, 1, kRate));
+  CHECK(!detector.Feed(nullptr, 60, 2, kRate));
+  CHECK(detector.Feed(nullptr, 60, 2, kRate));
+
+  // 后端挂起后恢复时重新计时；策略关闭期间已累计的静音清零
+  detector.Reset(false);
+  CHECK(!detector.Feed(nullptr, 60, 2, kRate));
+  policy.Disable();
+  CHECK(!detector.Feed(nullptr, 60, 2, kRate));
+  policy.Configure(Options(100));
+  CHECK(!detector.Feed(nullptr, 60, 2, kRate));
+  CHECK(detector.Feed(nullptr, 60, 2, kRate));
+}
+
+TEST(ProbeResumeUsesShortWindow) {
+  IdleSuspend policy;
+  policy.Configure(Options(1000));
+  SilenceDetector detector;
+  detector.SetPolicy(&policy);
+
+  // 探测恢复后只等待200ms（210帧时触发）
+  detector.Reset(true);
+  CHECK_EQ(PacketsUntilTrip(detector, 100), 7);
+
+  // 普通恢复按完整时长计时
+  detector.Reset(false);
+  CHECK_EQ(PacketsUntilTrip(detector, 100), 34);
+
+  // 探测期间有声音则回到完整时长
+  detector.Reset(true);
+  std::vector<float> sound(30, 0.5f);
+  detector.Feed(sound.data(), 30, 1, kRate);
+  CHECK_EQ(PacketsUntilTrip(detector, 100), 34);
+
+  // 挂起时长比探测窗口短时按挂起时长
+  policy.Configure(Options(50));
+  detector.Reset(true);
+  CHECK_EQ(PacketsUntilTrip(detector, 100), 2);
+}
+
+TEST(SuspendAndResumeAreCounted) {
+  IdleSuspend policy;
+  policy.Configure(Options(100));
+  int first = 0;
+  int second = 0;
+  CHECK(!policy.GetSnapshot().idle);
+
+  policy.Suspended(&first, [] {});
+  policy.Suspended(&second, [] {});
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  IdleSuspend::Snapshot snapshot = policy.GetSnapshot();
+  CHECK(snapshot.idle);
+  CHECK_EQ(snapshot.suspensions, uint64_t{2});
+  // 进行中的空闲时长也计入（两个后端各约20ms）
+  CHECK(snapshot.idle_ns >= 40000000);
+
+  policy.Resumed(&first, true);
+  // 未挂起的后端恢复时忽略
+  policy.Resumed(&first, true);
+  CHECK(policy.GetSnapshot().idle);
+  policy.Resumed(&second, false);
+  snapshot = policy.GetSnapshot();
+  CHECK(!snapshot.idle);
+  CHECK_EQ(snapshot.probes, uint64_t{1});
+  CHECK(snapshot.idle_ns >= 40000000);
+
+  // 已结束的空闲时长不再增长
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK_EQ(policy.GetSnapshot().idle_ns, snapshot.idle_ns);
+
+  policy.RecordWakeup(1500);
+  policy.RecordWakeup(500);
+  snapshot = policy.GetSnapshot();
+  CHECK_EQ(snapshot.wakeups, uint64_t{2});
+  CHECK_EQ(snapshot.cpu_ns, uint64_t{2000});
+
+  // 清空统计不影响挂起状态
+  policy.Suspended(&first, [] {});
+  policy.ResetStats();
+  snapshot = policy.GetSnapshot();
+  CHECK(snapshot.idle);
+  CHECK_EQ(snapshot.suspensions, uint64_t{0});
+  CHECK_EQ(snapshot.wakeups, uint64_t{0});
+  policy.Resumed(&first, false);
+  CHECK(!policy.GetSnapshot().idle);
+}
+
+TEST(ConfigurationChangesWakeSuspendedBackends) {
+  IdleSuspend policy;
+  policy.Configure(Options(100));
+  int owner = 0;
+  int wakes = 0;
+  policy.Suspended(&owner, [&wakes] { ++wakes; });
+
+  IdleSuspendOptions options = Options(250);
+  options.probe_interval_ms = 750;
+  policy.Configure(options);
+  CHECK_EQ(wakes, 1);
+  CHECK_EQ(policy.SilenceMs(), uint32_t{250});
+  CHECK_EQ(policy.ProbeIntervalMs(), uint32_t{750});
+
+  policy.Disable();
+  CHECK_EQ(wakes, 2);
+  CHECK(!policy.IsEnabled());
+
+  // 恢复后不再被唤醒
+  policy.Resumed(&owner, false);
+  policy.Configure(options);
+  CHECK_EQ(wakes, 2);
+}
+
+TEST(ThreadCpuTimeAdvances) {
+  uint64_t start = ThreadCpuNs();
+  CHECK(start > 0);
+  volatile double sink = 0.0;
+  auto until =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+  while (std::chrono::steady_clock::now() < until) {
+    sink = sink + 1.0;
+  }
+  CHECK(ThreadCpuNs() > start);
+
+  // 睡眠不消耗CPU时间
+  uint64_t before = ThreadCpuNs();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK(ThreadCpuNs() - before < 25000000);
+}
+
+int main() { return check::RunAll(); }
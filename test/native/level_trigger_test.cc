@@ -0,0 +1,183 @@
+#include "../../include/level_trigger.h"
+#include "check.h"
+#include <vector>
+
+/**
+ * @file level_trigger_test.cc
+ * @brief 电平触发：预录缓冲区的绕回和位置、保持时长、不连续的数据和格式变化
+ *
+ * 采样率取1000Hz，毫秒数即帧数。安静的数据包按位置填充可以区分的小值
+ * （远低于阈值），输出片段的内容可以和位置逐帧对照。
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+constexpr int kRate = 1000;
+
+// 安静数据的样本值：由会话位置决定
+float QuietValue(uint64_t position) {
+  return static_cast<float>(position + 1) * 1e-5f;
+}
+
+std::vector<float> Quiet(uint64_t position, size_t frames, int channels = 1) {
+  std::vector<float> samples(frames * static_cast<size_t>(channels));
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = QuietValue(position + i / static_cast<size_t>(channels));
+  }
+  return samples;
+}
+
+std::vector<float> Loud(size_t frames, int channels = 1) {
+  return std::vector<float>(frames * static_cast<size_t>(channels), 0.5f);
+}
+
+LevelTrigger::Result Process(LevelTrigger &trigger,
+                             const std::vector<float> &samples,
+                             uint64_t position, int channels = 1) {
+  LevelTrigger::Result result;
+  trigger.Process(samples.data(), samples.size() / channels, channels, kRate,
+                  position, &result);
+  return result;
+}
+
+// 片段的每一帧都是对应位置的安静数据
+bool MatchesPosition(const LevelTrigger::Segment &segment) {
+  for (size_t i = 0; i < segment.frames; ++i) {
+    if (segment.samples[i] != QuietValue(segment.position + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+LevelTriggerOptions Options() {
+  LevelTriggerOptions options;
+  options.threshold_db = -20.0f;
+  options.pre_roll_ms = 100;
+  options.hold_ms = 50;
+  return options;
+}
+
+} // namespace
+
+TEST(DisabledTriggerPassesEverything) {
+  LevelTrigger trigger;
+  CHECK(!trigger.IsEnabled());
+  LevelTrigger::Result result = Process(trigger, Quiet(0, 30), 0);
+  CHECK_EQ(result.count, size_t{1});
+  CHECK_EQ(result.segments[0].frames, size_t{30});
+  CHECK(trigger.IsActive());
+}
+
+TEST(PreRollIsEmittedInOrderAcrossWrap) {
+  LevelTrigger trigger;
+  trigger.Configure(Options());
+
+  // 150帧安静数据写入100帧的缓冲区，保留的50..149绕回分成两段
+  uint64_t position = 0;
+  for (int i = 0; i < 5; ++i, position += 30) {
+    LevelTrigger::Result result =
+        Process(trigger, Quiet(position, 30), position);
+    CHECK_EQ(result.count, size_t{0});
+    CHECK(result.level_db < -20.0f);
+  }
+  CHECK(!trigger.IsActive());
+
+  // 当前数据包的片段指向调用方的数据
+  std::vector<float> loud = Loud(30);
+  LevelTrigger::Result result = Process(trigger, loud, position);
+  CHECK(result.opened);
+  CHECK(trigger.IsActive());
+  CHECK_NEAR(result.level_db, -6.0206, 1e-3);
+  CHECK_EQ(result.count, size_t{3});
+  if (result.count != 3) {
+    return;
+  }
+  CHECK_EQ(result.segments[0].position, uint64_t{50});
+  CHECK_EQ(result.segments[0].frames, size_t{50});
+  CHECK_EQ(result.segments[1].position, uint64_t{100});
+  CHECK_EQ(result.segments[1].frames, size_t{50});
+  CHECK(MatchesPosition(result.segments[0]));
+  CHECK(MatchesPosition(result.segments[1]));
+  CHECK_EQ(result.segments[2].position, uint64_t{150});
+  CHECK(result.segments[2].samples == loud.data());
+}
+
+TEST(HoldKeepsOutputThenClosesIntoPreRoll) {
+  LevelTrigger trigger;
+  trigger.Configure(Options());
+  CHECK(Process(trigger, Loud(30), 0).opened);
+
+  // 保持50帧：静默30帧时仍然输出，静默60帧时停止
+  LevelTrigger::Result result = Process(trigger, Quiet(30, 30), 30);
+  CHECK_EQ(result.count, size_t{1});
+  CHECK(!result.closed);
+  // 电平回到阈值以上时重新计时
+  CHECK_EQ(Process(trigger, Loud(30), 60).count, size_t{1});
+  CHECK_EQ(Process(trigger, Quiet(90, 30), 90).count, size_t{1});
+  result = Process(trigger, Quiet(120, 30), 120);
+  CHECK(result.closed);
+  CHECK_EQ(result.count, size_t{0});
+  CHECK(!trigger.IsActive());
+
+  // 停止时的数据包成为下一次触发的预录，之前输出过的数据不再重复
+  result = Process(trigger, Loud(30), 150);
+  CHECK(result.opened);
+  CHECK_EQ(result.count, size_t{2});
+  CHECK_EQ(result.segments[0].position, uint64_t{120});
+  CHECK_EQ(result.segments[0].frames, size_t{30});
+  CHECK(MatchesPosition(result.segments[0]));
+}
+
+TEST(LongPacketKeepsItsTail) {
+  LevelTrigger trigger;
+  trigger.Configure(Options());
+  CHECK_EQ(Process(trigger, Quiet(0, 250), 0).count, size_t{0});
+
+  LevelTrigger::Result result = Process(trigger, Loud(10), 250);
+  CHECK_EQ(result.count, size_t{2});
+  CHECK_EQ(result.segments[0].position, uint64_t{150});
+  CHECK_EQ(result.segments[0].frames, size_t{100});
+  CHECK(MatchesPosition(result.segments[0]));
+}
+
+TEST(GapOrFormatChangeDropsPreRoll) {
+  LevelTrigger trigger;
+  trigger.Configure(Options());
+
+  // 位置不连续（中间丢了数据）：预录与当前数据包接不上，只输出当前数据包
+  Process(trigger, Quiet(0, 30), 0);
+  LevelTrigger::Result result = Process(trigger, Loud(30), 100);
+  CHECK(result.opened);
+  CHECK_EQ(result.count, size_t{1});
+
+  // 声道数变化时缓冲区重建
+  trigger.Disable();
+  Process(trigger, Loud(30), 130);
+  trigger.Configure(Options());
+  Process(trigger, Quiet(160, 30), 160);
+  result = Process(trigger, Loud(30, 2), 190, 2);
+  CHECK(result.opened);
+  CHECK_EQ(result.count, size_t{1});
+  CHECK_EQ(result.segments[0].frames, size_t{30});
+}
+
+TEST(ReenablingStartsIdle) {
+  LevelTrigger trigger;
+  trigger.Configure(Options());
+  Process(trigger, Loud(30), 0);
+  CHECK(trigger.IsActive());
+
+  trigger.Disable();
+  CHECK_EQ(Process(trigger, Quiet(30, 30), 30).count, size_t{1});
+  CHECK(trigger.IsActive());
+
+  // 重新启用后从空闲开始，之前的输出状态不保留
+  trigger.Configure(Options());
+  CHECK_EQ(Process(trigger, Quiet(60, 30), 60).count, size_t{0});
+  CHECK(!trigger.IsActive());
+}
+
+int main() { return check::RunAll(); }
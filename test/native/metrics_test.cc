@@ -0,0 +1,214 @@
+#include "../../include/dsp_pool.h"
+#include "../../include/metrics.h"
+#include "check.h"
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @file metrics_test.cc
+ * @brief OpenMetrics导出：开关、计数器和直方图的取值、文本格式，以及Unix socket上的抓取
+ *
+ * 指标是进程级的全局状态，各用例按注册顺序执行，只比较自己造成的变化量。
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+// 取样本行的值（样本名包含标签），不存在时为-1
+double Sample(const std::string &text, const std::string &name) {
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.compare(0, name.size() + 1, name + " ") == 0) {
+      return std::strtod(line.c_str() + name.size() + 1, nullptr);
+    }
+  }
+  return -1.0;
+}
+
+bool Contains(const std::string &text, const std::string &part) {
+  return text.find(part) != std::string::npos;
+}
+
+// 通过Unix socket发送HTTP请求，返回完整的应答
+std::string Fetch(const std::string &socket_path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path.c_str(),
+               sizeof(address.sun_path) - 1);
+  std::string response;
+  if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) ==
+      0) {
+    const char request[] = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    if (write(fd, request, sizeof(request) - 1) > 0) {
+      char buffer[4096];
+      ssize_t received = 0;
+      while ((received = read(fd, buffer, sizeof(buffer))) > 0) {
+        response.append(buffer, static_cast<size_t>(received));
+      }
+    }
+  }
+  close(fd);
+  return response;
+}
+
+} // namespace
+
+TEST(DisabledMetricsOnlyCountSessions) {
+  CHECK(!metrics::IsEnabled());
+  metrics::SessionStarted();
+  metrics::AddPackets(5);
+  metrics::AddDropped(2);
+  metrics::ObserveCallbackLatency(1000000);
+
+  std::string text = metrics::Render();
+  CHECK_EQ(Sample(text, "audio_capture_sessions_active"), 1.0);
+  CHECK_EQ(Sample(text, "audio_capture_sessions_started_total"), 1.0);
+  CHECK_EQ(Sample(text, "audio_capture_packets_total"), 0.0);
+  CHECK_EQ(Sample(text, "audio_capture_dropped_packets_total"), 0.0);
+  CHECK_EQ(Sample(text, "audio_capture_callback_latency_seconds_count"), 0.0);
+
+  metrics::SessionEnded();
+  text = metrics::Render();
+  CHECK_EQ(Sample(text, "audio_capture_sessions_active"), 0.0);
+  CHECK_EQ(Sample(text, "audio_capture_sessions_started_total"), 1.0);
+}
+
+TEST(CountersAndHistogramsAccumulate) {
+  metrics::Enable(true);
+  metrics::AddPackets(5);
+  metrics::AddPackets(7);
+  metrics::AddDropped(3);
+  // 桶上界包含等于上界的值：0.5ms、1ms、3ms、2s（超过所有上界）
+  metrics::ObserveCallbackLatency(500000);
+  metrics::ObserveCallbackLatency(1000000);
+  metrics::ObserveCallbackLatency(3000000);
+  metrics::ObserveCallbackLatency(2000000000);
+  metrics::ObserveEnumeration(20000000);
+  metrics::Enable(false);
+  // 关闭后不再累加，已有的值保留
+  metrics::AddPackets(100);
+
+  std::string text = metrics::Render();
+  CHECK_EQ(Sample(text, "audio_capture_packets_total"), 12.0);
+  CHECK_EQ(Sample(text, "audio_capture_dropped_packets_total"), 3.0);
+
+  const std::string latency = "audio_capture_callback_latency_seconds";
+  CHECK_EQ(Sample(text, latency + "_bucket{le=\"0.0005\"}"), 1.0);
+  CHECK_EQ(Sample(text, latency + "_bucket{le=\"0.001\"}"), 2.0);
+  CHECK_EQ(Sample(text, latency + "_bucket{le=\"0.0025\"}"), 2.0);
+  CHECK_EQ(Sample(text, latency + "_bucket{le=\"0.005\"}"), 3.0);
+  CHECK_EQ(Sample(text, latency + "_bucket{le=\"1\"}"), 3.0);
+  CHECK_EQ(Sample(text, latency + "_bucket{le=\"+Inf\"}"), 4.0);
+  CHECK_EQ(Sample(text, latency + "_count"), 4.0);
+  CHECK_NEAR(Sample(text, latency + "_sum"), 2.0045, 1e-9);
+
+  const std::string enumeration = "audio_capture_enumeration_seconds";
+  CHECK_EQ(Sample(text, enumeration + "_bucket{le=\"0.01\"}"), 0.0);
+  CHECK_EQ(Sample(text, enumeration + "_bucket{le=\"0.025\"}"), 1.0);
+  CHECK_EQ(Sample(text, enumeration + "_count"), 1.0);
+}
+
+TEST(StagesReportRealtimeFactor) {
+  metrics::Enable(true);
+  // 0.1秒处理了2秒音频
+  metrics::AddStageCost(metrics::Stage::kDenoise, 100000000, 2000000000);
+  metrics::Enable(false);
+
+  std::string text = metrics::Render();
+  const std::string denoise = "{stage=\"denoise\"}";
+  CHECK_NEAR(Sample(text, "audio_capture_stage_cpu_seconds_total" + denoise),
+             0.1, 1e-12);
+  CHECK_NEAR(Sample(text, "audio_capture_stage_audio_seconds_total" + denoise),
+             2.0, 1e-12);
+  CHECK_NEAR(Sample(text, "audio_capture_stage_realtime_factor" + denoise),
+             0.05, 1e-12);
+  // 没有处理过音频的阶段实时率为0
+  CHECK_EQ(Sample(text, "audio_capture_stage_realtime_factor{stage=\"wav\"}"),
+           0.0);
+}
+
+TEST(RenderIsWellFormedOpenMetrics) {
+  // 导出不会创建共享线程池
+  std::string text = metrics::Render();
+  CHECK(DspPool::SharedIfCreated() == nullptr);
+  CHECK(!Contains(text, "audio_capture_dsp_pool_workers"));
+
+  DspPool::Shared();
+  text = metrics::Render();
+  CHECK(Sample(text, "audio_capture_dsp_pool_workers") >= 1.0);
+  CHECK_EQ(Sample(text, "audio_capture_dsp_pool_jobs_total"), 0.0);
+
+  // 以 "# EOF" 结尾；每个指标族只声明一次，每个样本都属于最近声明的指标族，
+  // 计数器的样本带 _total 后缀
+  const std::string eof = "# EOF\n";
+  CHECK(text.size() > eof.size() &&
+        text.compare(text.size() - eof.size(), eof.size(), eof) == 0);
+  std::set<std::string> families;
+  std::string family;
+  std::string type;
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line == "# EOF") {
+      continue;
+    }
+    if (line.compare(0, 7, "# TYPE ") == 0) {
+      std::istringstream fields(line.substr(7));
+      fields >> family >> type;
+      CHECK(families.insert(family).second);
+      continue;
+    }
+    if (line.compare(0, 7, "# HELP ") == 0) {
+      CHECK(line.compare(7, family.size() + 1, family + " ") == 0);
+      continue;
+    }
+    CHECK(!family.empty() && line.compare(0, family.size(), family) == 0);
+    if (type == "counter") {
+      CHECK(line.compare(family.size(), 6, "_total") == 0);
+    }
+  }
+  CHECK(families.count("audio_capture_callback_latency_seconds") == 1);
+}
+
+TEST(ServesScrapesOverUnixSocket) {
+  const std::string path = "metrics_test.sock";
+  std::string error;
+  CHECK(metrics::Serve(path, 0, &error));
+  CHECK(metrics::IsServing());
+
+  std::string response = Fetch(path);
+  CHECK(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+  CHECK(Contains(response, "Content-Type: application/openmetrics-text"));
+  size_t header_end = response.find("\r\n\r\n");
+  CHECK(header_end != std::string::npos);
+  if (header_end == std::string::npos) {
+    metrics::StopServing();
+    return;
+  }
+  std::string body = response.substr(header_end + 4);
+  CHECK(Contains(response, "Content-Length: " + std::to_string(body.size())));
+  CHECK(Contains(body, "audio_capture_packets_total 12"));
+
+  // 重新服务时先停止原来的服务；停止后删除socket文件
+  CHECK(metrics::Serve(path, 0, &error));
+  CHECK(!Fetch(path).empty());
+  metrics::StopServing();
+  CHECK(!metrics::IsServing());
+  CHECK(access(path.c_str(), F_OK) != 0);
+
+  // 路径过长时报告错误
+  CHECK(!metrics::Serve(std::string(200, 'x'), 0, &error));
+  CHECK(Contains(error, "Unix socket"));
+  CHECK(!metrics::IsServing());
+}
+
+int main() { return check::RunAll(); }
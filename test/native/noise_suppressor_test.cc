@@ -0,0 +1,177 @@
+#include "../../include/fft.h"
+#include "../../include/noise_suppressor.h"
+#include "check.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/**
+ * @file noise_suppressor_test.cc
+ * @brief 实数FFT的正确性，以及降噪器在补零的帧长下的重建、延迟和衰减
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<float> Noise(size_t count, float amplitude, unsigned seed) {
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> uniform(-amplitude, amplitude);
+  std::vector<float> samples(count);
+  for (float &sample : samples) {
+    sample = uniform(random);
+  }
+  return samples;
+}
+
+double Rms(const float *samples, size_t count, size_t stride = 1) {
+  double sum = 0.0;
+  for (size_t i = 0; i < count; ++i) {
+    sum += static_cast<double>(samples[i * stride]) * samples[i * stride];
+  }
+  return count ? std::sqrt(sum / count) : 0.0;
+}
+
+// reduction 为0时增益恒为1，输出应该是延迟两个步长的输入
+double MaxReconstructionError(int sample_rate) {
+  NoiseSuppressor suppressor(0.0f);
+  const size_t frames = static_cast<size_t>(sample_rate) / 2;
+  std::vector<float> in(frames);
+  for (size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / sample_rate;
+    in[i] = static_cast<float>(0.5 * std::sin(2 * kPi * 440 * t) +
+                               0.2 * std::sin(2 * kPi * 3100 * t));
+  }
+  std::vector<float> out(frames);
+  // 以不对齐步长的数据块输入
+  for (size_t done = 0; done < frames; done += 333) {
+    size_t count = std::min<size_t>(333, frames - done);
+    suppressor.Process(in.data() + done, out.data() + done, count, 1,
+                       sample_rate);
+  }
+
+  const size_t delay = 2 * suppressor.HopFrames();
+  double error = 0.0;
+  for (size_t i = delay; i < frames; ++i) {
+    error = std::max<double>(error, std::fabs(out[i] - in[i - delay]));
+  }
+  return error;
+}
+
+} // namespace
+
+TEST(FftRoundTripRestoresInput) {
+  for (size_t size = 4; size <= 4096; size <<= 1) {
+    Fft fft(size);
+    CHECK_EQ(fft.Bins(), size / 2 + 1);
+    std::vector<float> input = Noise(size, 1.0f, static_cast<unsigned>(size));
+    std::vector<float> re(fft.Bins());
+    std::vector<float> im(fft.Bins());
+    std::vector<float> output(size);
+    fft.Forward(input.data(), re.data(), im.data());
+    fft.Inverse(re.data(), im.data(), output.data());
+    double error = 0.0;
+    for (size_t i = 0; i < size; ++i) {
+      error = std::max<double>(error, std::fabs(output[i] - input[i]));
+    }
+    CHECK(error < 1e-4);
+  }
+}
+
+TEST(FftPlacesToneInItsBin) {
+  constexpr size_t kSize = 256;
+  Fft fft(kSize);
+  std::vector<float> input(kSize);
+  for (size_t i = 0; i < kSize; ++i) {
+    input[i] = static_cast<float>(0.25 + std::cos(2 * kPi * 10 * i / kSize));
+  }
+  std::vector<float> re(fft.Bins());
+  std::vector<float> im(fft.Bins());
+  fft.Forward(input.data(), re.data(), im.data());
+
+  // 直流为样本和，余弦的能量全部在第10个频点（幅度 N/2）
+  CHECK_NEAR(re[0], 0.25 * kSize, 1e-3);
+  CHECK_NEAR(re[10], kSize / 2.0, 1e-3);
+  for (size_t k = 1; k < fft.Bins(); ++k) {
+    if (k != 10) {
+      CHECK(std::hypot(re[k], im[k]) < 1e-3);
+    }
+  }
+}
+
+TEST(ReconstructsWithZeroPaddedFrames) {
+  // 44.1kHz 的帧长 882、48kHz 的 960、16kHz 的 320 都要补零到2的幂；
+  // 补零部分每帧都要清零，否则上一帧逆变换的残留会混入下一帧
+  CHECK(MaxReconstructionError(44100) < 1e-4);
+  CHECK(MaxReconstructionError(48000) < 1e-4);
+  CHECK(MaxReconstructionError(16000) < 1e-4);
+}
+
+TEST(AttenuatesStationaryNoise) {
+  constexpr int kRate = 48000;
+  NoiseSuppressor suppressor(20.0f);
+  std::vector<float> noise = Noise(kRate * 3, 0.1f, 7);
+  std::vector<float> out(noise.size());
+  suppressor.Process(noise.data(), out.data(), noise.size(), 1, kRate);
+  CHECK_EQ(suppressor.HopFrames(), size_t{480});
+
+  // 噪声估计收敛之后（最后一秒）明显衰减，但不超过设定的20dB下限
+  const size_t tail = kRate;
+  double in_rms = Rms(noise.data() + noise.size() - tail, tail);
+  double out_rms = Rms(out.data() + out.size() - tail, tail);
+  double reduction_db = 20.0 * std::log10(in_rms / out_rms);
+  CHECK(reduction_db > 8.0);
+  CHECK(reduction_db < 20.5);
+}
+
+TEST(KeepsBurstsAboveNoise) {
+  // 语音式的间歇信号：每500ms中前200ms有1kHz正弦。最小值跟踪的噪声估计
+  // 只跟随背景噪声缓慢上升，短时的信号不会被当作噪声
+  constexpr int kRate = 48000;
+  constexpr size_t kCycle = kRate / 2;
+  constexpr size_t kBurst = kRate / 5;
+  NoiseSuppressor suppressor(20.0f);
+  std::vector<float> in = Noise(kCycle * 6, 0.01f, 3);
+  for (size_t i = 0; i < in.size(); ++i) {
+    if (i % kCycle < kBurst) {
+      in[i] += static_cast<float>(0.5 * std::sin(2 * kPi * 1000 * i / kRate));
+    }
+  }
+  std::vector<float> out(in.size());
+  suppressor.Process(in.data(), out.data(), in.size(), 1, kRate);
+
+  // 最后一个脉冲的中间部分（输出延迟两个步长）
+  const size_t delay = 2 * suppressor.HopFrames();
+  const size_t start = kCycle * 5 + kBurst / 4;
+  double in_rms = Rms(in.data() + start, kBurst / 2);
+  double out_rms = Rms(out.data() + start + delay, kBurst / 2);
+  CHECK_NEAR(20.0 * std::log10(out_rms / in_rms), 0.0, 1.0);
+}
+
+TEST(ProcessesInPlaceAndChannelsIndependently) {
+  constexpr int kRate = 16000;
+  const size_t frames = kRate;
+  // 左声道静音，右声道噪声
+  std::vector<float> noise = Noise(frames, 0.1f, 11);
+  std::vector<float> interleaved(frames * 2, 0.0f);
+  for (size_t i = 0; i < frames; ++i) {
+    interleaved[i * 2 + 1] = noise[i];
+  }
+
+  NoiseSuppressor separate(20.0f);
+  std::vector<float> out(interleaved.size());
+  separate.Process(interleaved.data(), out.data(), frames, 2, kRate);
+
+  NoiseSuppressor in_place(20.0f);
+  std::vector<float> buffer = interleaved;
+  in_place.Process(buffer.data(), buffer.data(), frames, 2, kRate);
+
+  CHECK(buffer == out);
+  CHECK_EQ(Rms(out.data(), frames, 2), 0.0);
+  CHECK(Rms(out.data() + 1, frames, 2) > 0.0);
+}
+
+int main() { return check::RunAll(); }
@@ -0,0 +1,398 @@
+#include "../../include/capture_stats.h"
+#include "../../include/delivery_batcher.h"
+#include "../../include/processing_graph.h"
+#include "check.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file processing_graph_test.cc
+ * @brief 处理图：声明校验、节点去重、各处理阶段和js输出端的数据与位置、
+ *        wav录音的查找索引
+ *
+ * 数据从 Push 送入，js输出端经过未启用合并的 DeliveryBatcher 原样交给测试。
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+// js输出端收到的一个数据块
+struct Delivery {
+  std::string sink;
+  std::vector<float> samples;
+  std::vector<int16_t> pcm16;
+  int channels;
+  int sample_rate;
+  uint64_t position;
+  SampleFormat format;
+};
+
+struct Collector {
+  std::vector<Delivery> deliveries;
+  std::shared_ptr<DeliveryBatcher> batcher;
+
+  Collector() {
+    batcher = std::make_shared<DeliveryBatcher>(
+        [this](const std::string &sink, const uint8_t *data, size_t length,
+               int channels, int sample_rate, uint64_t position,
+               SampleFormat format) {
+          Delivery delivery{sink, {}, {}, channels, sample_rate, position,
+                            format};
+          if (format == SampleFormat::kInt16) {
+            const int16_t *values = reinterpret_cast<const int16_t *>(data);
+            delivery.pcm16.assign(values, values + length / sizeof(int16_t));
+          } else {
+            const float *values = reinterpret_cast<const float *>(data);
+            delivery.samples.assign(values, values + length / sizeof(float));
+          }
+          deliveries.push_back(std::move(delivery));
+        },
+        std::make_shared<CaptureStats>());
+  }
+
+  std::vector<const Delivery *> For(const std::string &sink) const {
+    std::vector<const Delivery *> result;
+    for (const auto &delivery : deliveries) {
+      if (delivery.sink == sink) {
+        result.push_back(&delivery);
+      }
+    }
+    return result;
+  }
+};
+
+GraphNodeSpec Spec(const std::string &id, const std::string &type,
+                   const std::string &input = "source",
+                   std::map<std::string, double> params = {}) {
+  GraphNodeSpec spec;
+  spec.id = id;
+  spec.type = type;
+  spec.input = input;
+  spec.params = std::move(params);
+  return spec;
+}
+
+void Push(ProcessingGraph &graph, const std::vector<float> &samples,
+          int channels, int sample_rate = 48000) {
+  graph.Push(reinterpret_cast<const uint8_t *>(samples.data()),
+             samples.size() * sizeof(float), channels, sample_rate);
+}
+
+std::vector<uint8_t> ReadFile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(in),
+                              std::istreambuf_iterator<char>());
+}
+
+template <typename T> T Read(const std::vector<uint8_t> &bytes, size_t offset) {
+  T value{};
+  if (offset + sizeof(T) <= bytes.size()) {
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+  }
+  return value;
+}
+
+std::string BuildError(const std::vector<GraphNodeSpec> &specs) {
+  std::string error;
+  auto graph = ProcessingGraph::Build(specs, nullptr, &error);
+  return graph ? std::string() : error;
+}
+
+} // namespace
+
+TEST(RejectsInvalidDeclarations) {
+  CHECK(!BuildError({Spec("", "gain")}).empty());
+  CHECK(!BuildError({Spec("source", "gain")}).empty());
+  CHECK(!BuildError({Spec("a", "reverb")}).empty());
+  CHECK(!BuildError({Spec("a", "gain"), Spec("a", "meter")}).empty());
+  CHECK(!BuildError({Spec("a", "gain", "missing")}).empty());
+  CHECK(!BuildError({Spec("a", "gain", "b"), Spec("b", "gain", "a")}).empty());
+  CHECK(!BuildError({Spec("out", "js"), Spec("a", "gain", "out")}).empty());
+  CHECK(!BuildError({Spec("r", "resample")}).empty());
+  CHECK(!BuildError({Spec("c", "chunk", "source", {{"frames", 0}})}).empty());
+  CHECK(!BuildError({Spec("w", "wav")}).empty());
+  CHECK(BuildError({Spec("a", "gain"), Spec("b", "meter", "a")}).empty());
+}
+
+TEST(IdenticalStagesAreShared) {
+  Collector collector;
+  std::string error;
+  auto graph = ProcessingGraph::Build(
+      {Spec("g1", "gain", "source", {{"gain", 0.5}}),
+       Spec("g2", "gain", "source", {{"gain", 0.5}}),
+       Spec("m1", "meter", "g1"), Spec("m2", "meter", "g2"),
+       Spec("out1", "js", "m1"), Spec("out2", "js", "m2")},
+      collector.batcher, &error);
+  CHECK(graph != nullptr);
+  if (!graph) {
+    return;
+  }
+  // 两条分支的增益和电平表各实例化一次，js输出端按ID区分
+  CHECK_EQ(graph->NodeCount(), size_t{4});
+  graph->Start();
+  Push(*graph, std::vector<float>(100, 0.8f), 1);
+  CHECK_EQ(collector.For("out1").size(), size_t{1});
+  CHECK_EQ(collector.For("out2").size(), size_t{1});
+  CHECK_NEAR(collector.For("out2")[0]->samples[0], 0.4, 1e-6);
+
+  // 合并的电平表在两个ID下都能读到
+  std::vector<MeterReading> meters = graph->GetMeters();
+  CHECK_EQ(meters.size(), size_t{2});
+  for (const auto &meter : meters) {
+    CHECK_NEAR(meter.peak, 0.4, 1e-6);
+    CHECK_NEAR(meter.rms, 0.4, 1e-6);
+  }
+}
+
+TEST(IgnoresDataBeforeStartAndAfterStop) {
+  Collector collector;
+  std::string error;
+  auto graph = ProcessingGraph::Build({Spec("out", "js")}, collector.batcher,
+                                      &error);
+  Push(*graph, std::vector<float>(10, 0.1f), 1);
+  graph->Start();
+  Push(*graph, std::vector<float>(10, 0.1f), 1);
+  graph->Stop();
+  Push(*graph, std::vector<float>(10, 0.1f), 1);
+  CHECK_EQ(collector.deliveries.size(), size_t{1});
+}
+
+TEST(ChunkEmitsFixedFrameCountsWithPositions) {
+  Collector collector;
+  std::string error;
+  auto graph = ProcessingGraph::Build(
+      {Spec("c", "chunk", "source", {{"frames", 256}}), Spec("out", "js", "c")},
+      collector.batcher, &error);
+  graph->Start();
+
+  // 3 × 200 帧立体声 → 两块256帧，剩余88帧留待下一次
+  std::vector<float> packet(400);
+  for (int i = 0; i < 3; ++i) {
+    for (size_t s = 0; s < packet.size(); ++s) {
+      packet[s] = static_cast<float>(i * 200 + s / 2);
+    }
+    Push(*graph, packet, 2);
+  }
+  auto out = collector.For("out");
+  CHECK_EQ(out.size(), size_t{2});
+  for (size_t i = 0; i < out.size(); ++i) {
+    CHECK_EQ(out[i]->samples.size(), size_t{512});
+    CHECK_EQ(out[i]->position, uint64_t{256 * i});
+    // 帧顺序不变，跨数据包拼接
+    CHECK_EQ(out[i]->samples[0], static_cast<float>(256 * i));
+    CHECK_EQ(out[i]->samples[511], static_cast<float>(256 * i + 255));
+  }
+
+  // 格式变化时丢弃未满的部分，从新格式重新分块
+  Push(*graph, std::vector<float>(256, 1.0f), 1);
+  out = collector.For("out");
+  CHECK_EQ(out.size(), size_t{3});
+  CHECK_EQ(out[2]->channels, 1);
+  CHECK_EQ(out[2]->samples.size(), size_t{256});
+  CHECK_EQ(out[2]->samples[0], 1.0f);
+}
+
+TEST(ResampleAndRemixChangeFormat) {
+  Collector collector;
+  std::string error;
+  auto graph = ProcessingGraph::Build(
+      {Spec("r", "resample", "source", {{"sampleRate", 16000}}),
+       Spec("m", "remix", "r", {{"channels", 1}}), Spec("out", "js", "m")},
+      collector.batcher, &error);
+  graph->Start();
+
+  std::vector<float> packet(480 * 2);
+  for (size_t frame = 0; frame < 480; ++frame) {
+    packet[frame * 2] = 0.2f;
+    packet[frame * 2 + 1] = 0.6f;
+  }
+  size_t frames = 0;
+  for (int i = 0; i < 10; ++i) {
+    Push(*graph, packet, 2);
+  }
+  for (const Delivery *delivery : collector.For("out")) {
+    CHECK_EQ(delivery->channels, 1);
+    CHECK_EQ(delivery->sample_rate, 16000);
+    CHECK_EQ(delivery->position, uint64_t{frames});
+    frames += delivery->samples.size();
+    CHECK_NEAR(delivery->samples.back(), 0.4, 1e-6);
+  }
+  // 4800帧 48kHz → 1600帧 16kHz（起始相位最多差一帧）
+  CHECK(frames >= 1599 && frames <= 1600);
+}
+
+TEST(Int16SinkConvertsAndClamps) {
+  Collector collector;
+  std::string error;
+  auto graph = ProcessingGraph::Build(
+      {Spec("out", "js", "source", {{"int16", 1}})}, collector.batcher,
+      &error);
+  graph->Start();
+  Push(*graph, {0.5f, -1.5f, 1.0f, 0.0f}, 2);
+  auto out = collector.For("out");
+  CHECK_EQ(out.size(), size_t{1});
+  CHECK(out[0]->format == SampleFormat::kInt16);
+  CHECK_EQ(out[0]->pcm16.size(), size_t{4});
+  CHECK_EQ(out[0]->pcm16[0], int16_t{16384});
+  CHECK_EQ(out[0]->pcm16[1], int16_t{-32767});
+  CHECK_EQ(out[0]->pcm16[2], int16_t{32767});
+}
+
+TEST(LevelsEmitPeakAndRmsAtRate) {
+  Collector collector;
+  std::string error;
+  auto graph = ProcessingGraph::Build(
+      {Spec("l", "levels", "source", {{"rate", 100}}), Spec("out", "js", "l")},
+      collector.batcher, &error);
+  graph->Start();
+
+  // 100Hz → 每480帧一组读数；第二声道为方波 ±0.5
+  std::vector<float> packet(960 * 2);
+  for (size_t frame = 0; frame < 960; ++frame) {
+    packet[frame * 2] = 0.25f;
+    packet[frame * 2 + 1] = frame % 2 ? 0.5f : -0.5f;
+  }
+  Push(*graph, packet, 2);
+  auto out = collector.For("out");
+  CHECK_EQ(out.size(), size_t{2});
+  for (const Delivery *delivery : out) {
+    // [peak0, peak1, rms0, rms1]
+    CHECK_EQ(delivery->samples.size(), size_t{4});
+    CHECK_NEAR(delivery->samples[0], 0.25, 1e-6);
+    CHECK_NEAR(delivery->samples[1], 0.5, 1e-6);
+    CHECK_NEAR(delivery->samples[2], 0.25, 1e-6);
+    CHECK_NEAR(delivery->samples[3], 0.5, 1e-6);
+  }
+}
+
+TEST(WavOpenFailureIsReported) {
+  Collector collector;
+  std::string error;
+  std::vector<std::string> errors;
+  GraphNodeSpec wav = Spec("rec", "wav");
+  wav.path = "missing-dir/out.wav";
+  auto graph = ProcessingGraph::Build(
+      {wav}, collector.batcher, &error, 0,
+      [&errors](const std::string &node, const std::string &message) {
+        errors.push_back(node + ": " + message);
+      });
+  graph->Start();
+  Push(*graph, std::vector<float>(100, 0.1f), 1);
+  Push(*graph, std::vector<float>(100, 0.1f), 1);
+  graph->Stop();
+  // 只报告一次
+  CHECK_EQ(errors.size(), size_t{1});
+  CHECK(!errors.empty() && errors[0].rfind("rec: ", 0) == 0);
+}
+
+TEST(WavIndexRecordsBlocksAndMergesShortSilences) {
+  // 48kHz单声道：1s 有声、0.2s 静音、1s 有声、1s 静音、0.5s 有声。
+  // 短于 minSilenceMs 的静音不切分区间，更长的静音结束当前区间
+  constexpr int kRate = 48000;
+  const std::vector<std::pair<double, float>> segments = {
+      {1.0, 0.5f}, {0.2, 0.0f}, {1.0, 0.5f}, {1.0, 0.0f}, {0.5, 0.5f}};
+
+  Collector collector;
+  std::string error;
+  GraphNodeSpec wav = Spec("rec", "wav", "source",
+                           {{"index", 1}, {"silenceDb", -40},
+                            {"minSilenceMs", 500}});
+  wav.path = "graph_index.wav";
+  auto graph = ProcessingGraph::Build({wav}, collector.batcher, &error);
+  CHECK(graph != nullptr);
+  if (!graph) {
+    return;
+  }
+  graph->Start();
+
+  uint64_t total = 0;
+  std::vector<float> packet(4800);
+  for (const auto &segment : segments) {
+    const size_t frames = static_cast<size_t>(segment.first * kRate);
+    for (size_t done = 0; done < frames; done += packet.size()) {
+      std::fill(packet.begin(), packet.end(), segment.second);
+      Push(*graph, packet, 1, kRate);
+      // wav输出端在线程池中执行，避免串行队列的槽位被占满
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    total += frames;
+  }
+  graph->Stop();
+  CHECK_EQ(graph->DroppedBlocks(), uint64_t{0});
+
+  std::vector<uint8_t> audio = ReadFile("graph_index.wav");
+  CHECK_EQ(audio.size(), size_t{44 + total * sizeof(float)});
+  CHECK_EQ(Read<uint32_t>(audio, 40), static_cast<uint32_t>(total * 4));
+
+  std::vector<uint8_t> index = ReadFile("graph_index.wav.idx");
+  CHECK(index.size() >= 48 && std::memcmp(index.data(), "PAIX", 4) == 0);
+  CHECK_EQ(Read<uint32_t>(index, 4), uint32_t{1});
+  CHECK_EQ(Read<uint32_t>(index, 8), uint32_t{kRate});
+  CHECK_EQ(Read<uint32_t>(index, 12), uint32_t{1});
+  CHECK_EQ(Read<uint32_t>(index, 16), uint32_t{4});
+  CHECK_EQ(Read<uint32_t>(index, 20), uint32_t{44});
+  CHECK_EQ(Read<uint32_t>(index, 24), uint32_t{kRate});
+  CHECK_EQ(Read<float>(index, 28), -40.0f);
+  const uint32_t blocks = Read<uint32_t>(index, 32);
+  const uint32_t spans = Read<uint32_t>(index, 36);
+  CHECK_EQ(Read<uint64_t>(index, 40), total);
+  // 3.7s → 4个索引块（最后一块不满一秒）
+  CHECK_EQ(blocks, uint32_t{4});
+  CHECK_EQ(spans, uint32_t{2});
+  CHECK_EQ(index.size(), size_t{48 + blocks * 16 + spans * 16});
+
+  // 索引块：偏移按整秒递增；第一秒为0.5的直流，RMS和峰值都是 -6.02dB
+  for (uint32_t i = 0; i < blocks; ++i) {
+    CHECK_EQ(Read<uint64_t>(index, 48 + i * 16),
+             uint64_t{44 + uint64_t{i} * kRate * 4});
+  }
+  CHECK_NEAR(Read<float>(index, 56), -6.0206, 1e-3);
+  CHECK_NEAR(Read<float>(index, 60), -6.0206, 1e-3);
+  // 第四块（3s~3.7s）中有声部分为0.5s
+  CHECK(Read<float>(index, 48 + 3 * 16 + 8) > -10.0f);
+
+  // 活动区间：[0, 2.2s) 合并了0.2s的静音，[3.2s, 3.7s)
+  const size_t span_offset = 48 + blocks * 16;
+  CHECK_EQ(Read<uint64_t>(index, span_offset), uint64_t{0});
+  CHECK_EQ(Read<uint64_t>(index, span_offset + 8), uint64_t{105600});
+  CHECK_EQ(Read<uint64_t>(index, span_offset + 16), uint64_t{153600});
+  CHECK_EQ(Read<uint64_t>(index, span_offset + 24), uint64_t{177600});
+}
+
+TEST(SlotReplacesGraphs) {
+  Collector collector;
+  std::string error;
+  std::shared_ptr<ProcessingGraph> first = ProcessingGraph::Build(
+      {Spec("a", "js")}, collector.batcher, &error);
+  std::shared_ptr<ProcessingGraph> second = ProcessingGraph::Build(
+      {Spec("b", "js")}, collector.batcher, &error);
+  first->Start();
+  second->Start();
+
+  ProcessingGraphSlot slot;
+  std::vector<float> packet(10, 0.1f);
+  const uint8_t *data = reinterpret_cast<const uint8_t *>(packet.data());
+  const size_t length = packet.size() * sizeof(float);
+  CHECK(!slot.Push(data, length, 1, 48000));
+  slot.Replace(first);
+  CHECK(slot.Push(data, length, 1, 48000));
+  slot.Replace(second);
+  CHECK(slot.Push(data, length, 1, 48000));
+  slot.Replace(nullptr);
+  CHECK(!slot.Push(data, length, 1, 48000));
+
+  CHECK_EQ(collector.For("a").size(), size_t{1});
+  CHECK_EQ(collector.For("b").size(), size_t{1});
+  // 被替换的处理图已停止
+  first->Push(data, length, 1, 48000);
+  CHECK_EQ(collector.For("a").size(), size_t{1});
+}
+
+int main() { return check::RunAll(); }
@@ -0,0 +1,184 @@
+#include "../../include/delivery_batcher.h"
+#include "../../include/processing_graph.h"
+#include "../../include/rt_check.h"
+#include "../../include/synthetic_audio_capture.h"
+#include "../../include/target_switcher.h"
+#include "../../include/trace.h"
+#include "check.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <node_api.h>
+#include <thread>
+
+/**
+ * @file rt_check_test.cc
+ * @brief 实时安全检查：拦截是否生效，合成捕获管线在实时作用域内是否干净
+ *
+ * 以 AUDIO_CAPTURE_RT_CHECK 和 binding.gyp 中相同的 --wrap 选项编译，
+ * 仅在Linux上运行。
+ */
+
+// rt_check.cc 的 __wrap_napi_call_threadsafe_function 转发到真实函数，
+// 测试不链接node，这里提供一个空实现
+extern "C" napi_status
+napi_call_threadsafe_function(napi_threadsafe_function /*func*/,
+                              void * /*data*/,
+                              napi_threadsafe_function_call_mode /*mode*/) {
+  return napi_ok;
+}
+
+using namespace audio_capture;
+
+namespace {
+
+uint64_t Total(rt_check::ViolationKind kind) {
+  uint64_t total = 0;
+  for (const auto &violation : rt_check::GetViolations()) {
+    if (violation.kind == kind) {
+      total += violation.count;
+    }
+  }
+  return total;
+}
+
+uint64_t Total() {
+  uint64_t total = 0;
+  for (const auto &violation : rt_check::GetViolations()) {
+    total += violation.count;
+  }
+  return total;
+}
+
+// 打印所有违规，便于定位失败原因
+void Dump() {
+  for (const auto &violation : rt_check::GetViolations()) {
+    std::fprintf(stderr, "  %-10s x%-6llu %s\n",
+                 rt_check::KindName(violation.kind),
+                 static_cast<unsigned long long>(violation.count),
+                 violation.location.c_str());
+  }
+}
+
+// 在作用域外等待，直到 condition 成立或超时
+template <typename Condition> bool WaitFor(Condition condition, int ms = 2000) {
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(DeliberateViolationsAreReported) {
+  rt_check::Reset();
+  std::mutex mutex;
+  {
+    AUDIO_CAPTURE_RT_SCOPE();
+    CHECK(rt_check::InRealtimeScope());
+    void *volatile block = std::malloc(64);
+    std::free(block);
+    int *volatile value = new int(1);
+    delete value;
+    mutex.lock();
+    mutex.unlock();
+  }
+  CHECK(!rt_check::InRealtimeScope());
+  CHECK_EQ(Total(rt_check::ViolationKind::Allocation), uint64_t{2});
+  CHECK_EQ(Total(rt_check::ViolationKind::Free), uint64_t{2});
+  CHECK_EQ(Total(rt_check::ViolationKind::MutexWait), uint64_t{1});
+  rt_check::Reset();
+}
+
+TEST(CallsOutsideScopeAreIgnored) {
+  rt_check::Reset();
+  std::mutex mutex;
+  void *volatile block = std::malloc(64);
+  std::free(block);
+  mutex.lock();
+  mutex.unlock();
+  CHECK_EQ(Total(), uint64_t{0});
+}
+
+TEST(SyntheticCapturePipelineIsRealtimeSafe) {
+  // 与插件默认配置相同的链：合成源 → 切换器 → 处理图 → 合并器 → 输出。
+  // 合并器未启用（启用后 Push 按设计持有互斥锁）；输出端只计数，
+  // 不模拟N-API层复制数据包时的分配
+  std::atomic<uint64_t> source_bytes{0};
+  std::atomic<uint64_t> sink_bytes{0};
+  auto batcher = std::make_shared<DeliveryBatcher>(
+      [&](const std::string &sink, const uint8_t *, size_t length, int, int,
+          uint64_t, SampleFormat) {
+        (sink.empty() ? source_bytes : sink_bytes) += length;
+      },
+      std::make_shared<CaptureStats>());
+
+  std::vector<GraphNodeSpec> specs(3);
+  specs[0].id = "gain";
+  specs[0].type = "gain";
+  specs[0].params["gain"] = 0.5;
+  specs[1].id = "meter";
+  specs[1].type = "meter";
+  specs[1].input = "gain";
+  specs[2].id = "out";
+  specs[2].type = "js";
+  specs[2].input = "meter";
+  std::string error;
+  std::unique_ptr<ProcessingGraph> graph =
+      ProcessingGraph::Build(specs, batcher, &error, 1);
+  CHECK(graph != nullptr);
+  if (!graph) {
+    return;
+  }
+  graph->Start();
+  ProcessingGraph *raw_graph = graph.get();
+
+  TargetSwitcher switcher(
+      [raw_graph](const uint8_t *data, size_t length, int channels,
+                  int sample_rate) {
+        raw_graph->Push(data, length, channels, sample_rate);
+      },
+      1);
+
+  CHECK(trace::Start());
+  CaptureOptions options;
+  options.period_frames = 480;
+  SyntheticAudioCapture first;
+  SyntheticAudioCapture second;
+  CHECK(first.StartCapture(1, switcher.SourceCallback(), options));
+
+  // 预热：处理阶段的缓冲区按需增长，首个数据包之后进入稳态
+  CHECK(WaitFor([&]() { return sink_bytes.load() > 0; }));
+  rt_check::Reset();
+
+  // 稳态下切换一次目标，两个音频源同时运行直到交接完成
+  CHECK(second.StartCapture(2, switcher.BeginSwitch(5), options));
+  CHECK(WaitFor([&]() { return switcher.IsSwitchComplete(); }));
+  first.StopCapture();
+  uint64_t before = sink_bytes.load();
+  CHECK(WaitFor([&]() { return sink_bytes.load() > before; }));
+  second.StopCapture();
+  graph->Stop();
+
+  std::string trace_error;
+  CHECK(trace::Stop("rt_check_trace.json", &trace_error));
+
+  CHECK_EQ(source_bytes.load(), uint64_t{0});
+  CHECK(sink_bytes.load() > 0);
+  uint64_t violations = Total();
+  CHECK_EQ(violations, uint64_t{0});
+  if (violations != 0) {
+    Dump();
+    rt_check::Reset();
+  }
+}
+
+int main() { return check::RunAll(); }
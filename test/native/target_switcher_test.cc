@@ -0,0 +1,175 @@
+#include "../../include/target_switcher.h"
+#include "check.h"
+#include <vector>
+
+/**
+ * @file target_switcher_test.cc
+ * @brief 目标切换：包边界交接、缓冲数据的续接、交叉淡化、取消和强制交接
+ *
+ * 回调都在测试线程上直接调用，交接顺序是确定的。
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+constexpr int kRate = 48000;
+
+// 记录下游收到的所有样本
+struct Output {
+  std::vector<float> samples;
+  int packets = 0;
+
+  AudioDataCallback Callback() {
+    return [this](const uint8_t *data, size_t length, int, int) {
+      const float *values = reinterpret_cast<const float *>(data);
+      samples.insert(samples.end(), values, values + length / sizeof(float));
+      ++packets;
+    };
+  }
+};
+
+// 发送一个单声道、全部为 value 的数据包
+void Send(const AudioDataCallback &source, float value, size_t frames = 480) {
+  std::vector<float> packet(frames, value);
+  source(reinterpret_cast<const uint8_t *>(packet.data()),
+         packet.size() * sizeof(float), 1, kRate);
+}
+
+size_t CountOf(const std::vector<float> &samples, float value) {
+  size_t count = 0;
+  for (float sample : samples) {
+    count += sample == value ? 1 : 0;
+  }
+  return count;
+}
+
+} // namespace
+
+TEST(ActiveSourcePassesThrough) {
+  Output out;
+  TargetSwitcher switcher(out.Callback());
+  AudioDataCallback source = switcher.SourceCallback();
+  Send(source, 1.0f);
+  Send(source, 1.0f);
+  CHECK_EQ(out.packets, 2);
+  CHECK_EQ(out.samples.size(), size_t{960});
+  CHECK(switcher.IsSwitchComplete());
+}
+
+TEST(OldSourceKeepsOutputUntilNewSourceHasData) {
+  Output out;
+  TargetSwitcher switcher(out.Callback());
+  AudioDataCallback old_source = switcher.SourceCallback();
+  AudioDataCallback new_source = switcher.BeginSwitch(0);
+  Send(old_source, 1.0f);
+  CHECK(!switcher.IsSwitchComplete());
+  CHECK_EQ(CountOf(out.samples, 1.0f), size_t{480});
+}
+
+TEST(HandoffHappensOnOldPacketBoundary) {
+  Output out;
+  TargetSwitcher switcher(out.Callback());
+  AudioDataCallback old_source = switcher.SourceCallback();
+  AudioDataCallback new_source = switcher.BeginSwitch(0);
+
+  // 新音频源的数据先缓冲，不直接输出
+  Send(new_source, 2.0f);
+  CHECK(out.samples.empty());
+
+  // 旧音频源的下一个数据包完整输出，然后交出输出权
+  Send(old_source, 1.0f);
+  CHECK(switcher.IsSwitchComplete());
+  Send(old_source, 9.0f);
+
+  // 新音频源先续接缓冲的数据，再输出自己的数据包
+  Send(new_source, 3.0f);
+  std::vector<float> expected;
+  expected.insert(expected.end(), 480, 1.0f);
+  expected.insert(expected.end(), 480, 2.0f);
+  expected.insert(expected.end(), 480, 3.0f);
+  CHECK(out.samples == expected);
+}
+
+TEST(CrossfadeBlendsOldTailWithNewHead) {
+  Output out;
+  TargetSwitcher switcher(out.Callback());
+  AudioDataCallback old_source = switcher.SourceCallback();
+  AudioDataCallback new_source = switcher.BeginSwitch(1); // 48帧
+  Send(new_source, 0.0f);
+  Send(old_source, 1.0f);
+  CHECK(switcher.IsSwitchComplete());
+  CHECK_EQ(out.samples.size(), size_t{480});
+
+  // 前432帧不变，之后的48帧从旧数据线性过渡到新数据
+  CHECK_EQ(out.samples[431], 1.0f);
+  CHECK_NEAR(out.samples[432], 1.0 - 1.0 / 49.0, 1e-6);
+  CHECK_NEAR(out.samples[479], 1.0 - 48.0 / 49.0, 1e-6);
+  for (size_t i = 433; i < 480; ++i) {
+    CHECK(out.samples[i] < out.samples[i - 1]);
+  }
+
+  // 淡化用掉的48帧不再重复输出
+  Send(new_source, 0.5f);
+  CHECK_EQ(out.samples.size(), size_t{480 + 432 + 480});
+  CHECK_EQ(CountOf(out.samples, 0.5f), size_t{480});
+}
+
+TEST(CancelDropsBufferedData) {
+  Output out;
+  TargetSwitcher switcher(out.Callback());
+  AudioDataCallback old_source = switcher.SourceCallback();
+  AudioDataCallback failed_source = switcher.BeginSwitch(0);
+  Send(failed_source, 2.0f);
+  switcher.CancelSwitch();
+  CHECK(switcher.IsSwitchComplete());
+
+  // 旧音频源继续输出，被取消的音频源的数据被丢弃
+  Send(old_source, 1.0f);
+  Send(failed_source, 2.0f);
+  CHECK_EQ(CountOf(out.samples, 1.0f), size_t{480});
+  CHECK_EQ(CountOf(out.samples, 2.0f), size_t{0});
+
+  // 下一次切换不会续接被取消的音频源缓冲的数据
+  AudioDataCallback new_source = switcher.BeginSwitch(0);
+  Send(new_source, 3.0f);
+  Send(old_source, 1.0f);
+  Send(new_source, 3.0f);
+  CHECK_EQ(CountOf(out.samples, 2.0f), size_t{0});
+  CHECK_EQ(CountOf(out.samples, 3.0f), size_t{960});
+}
+
+TEST(ForceSwitchHandsOffWithoutNewData) {
+  Output out;
+  TargetSwitcher switcher(out.Callback());
+  AudioDataCallback old_source = switcher.SourceCallback();
+  AudioDataCallback new_source = switcher.BeginSwitch(0);
+  switcher.ForceSwitch();
+  Send(old_source, 1.0f);
+  CHECK(switcher.IsSwitchComplete());
+  Send(old_source, 1.0f);
+  Send(new_source, 3.0f);
+  CHECK_EQ(CountOf(out.samples, 1.0f), size_t{480});
+  CHECK_EQ(CountOf(out.samples, 3.0f), size_t{480});
+}
+
+TEST(TryCompleteSwitchAfterOldSourceStops) {
+  Output out;
+  TargetSwitcher switcher(out.Callback());
+  AudioDataCallback old_source = switcher.SourceCallback();
+  AudioDataCallback new_source = switcher.BeginSwitch(0);
+  Send(new_source, 2.0f);
+
+  // 旧音频源不再送数据时由调用方完成交接
+  CHECK(switcher.TryCompleteSwitch());
+  CHECK(switcher.IsSwitchComplete());
+  Send(old_source, 1.0f);
+  Send(new_source, 3.0f);
+
+  std::vector<float> expected;
+  expected.insert(expected.end(), 480, 2.0f);
+  expected.insert(expected.end(), 480, 3.0f);
+  CHECK(out.samples == expected);
+}
+
+int main() { return check::RunAll(); }
@@ -0,0 +1,162 @@
+#include "../../include/trace.h"
+#include "check.h"
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+/**
+ * @file trace_test.cc
+ * @brief trace事件记录：导出格式、轮次隔离、未注册线程的缓冲区领取
+ */
+
+using namespace audio_capture;
+
+namespace {
+
+std::string ReadFile(const std::string &path) {
+  std::ifstream in(path);
+  std::stringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+
+size_t Count(const std::string &text, const std::string &needle) {
+  size_t count = 0;
+  for (size_t at = text.find(needle); at != std::string::npos;
+       at = text.find(needle, at + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+// 导出JSON末尾的 droppedEvents
+uint64_t Dropped(const std::string &text) {
+  size_t at = text.find("\"droppedEvents\":");
+  return at == std::string::npos
+             ? ~0ull
+             : std::stoull(text.substr(at + sizeof("\"droppedEvents\":") - 1));
+}
+
+// 在新线程（未注册）上记录 events 个瞬时事件
+void RecordOnThreads(int threads, const char *name, int events = 1) {
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back([name, events]() {
+      for (int e = 0; e < events; ++e) {
+        trace::RecordInstant(name, 7);
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+} // namespace
+
+TEST(StopWithoutStartFails) {
+  std::string error;
+  CHECK(!trace::Stop("trace_unused.json", &error));
+  CHECK(!error.empty());
+}
+
+TEST(ExportsSpansAndInstantsPerSession) {
+  CHECK(trace::Start());
+  CHECK(!trace::Start());
+  uint64_t begin = trace::NowNs();
+  trace::RecordSpan("span-a", 3, begin, begin + 2000);
+  trace::RecordInstant("instant-b", 4);
+  {
+    trace::ScopedSpan span("scoped-c", 3);
+  }
+  CHECK(trace::Stop("trace_basic.json"));
+
+  std::string text = ReadFile("trace_basic.json");
+  CHECK_EQ(Count(text, "\"name\":\"span-a\""), size_t{1});
+  CHECK_EQ(Count(text, "\"name\":\"instant-b\""), size_t{1});
+  CHECK_EQ(Count(text, "\"name\":\"scoped-c\""), size_t{1});
+  CHECK(text.find("\"dur\":2.000") != std::string::npos);
+  CHECK(text.find("\"ph\":\"i\"") != std::string::npos);
+  // 每个会话一个进程分组
+  CHECK(text.find("\"name\":\"session 3\"") != std::string::npos);
+  CHECK(text.find("\"name\":\"session 4\"") != std::string::npos);
+  CHECK_EQ(Dropped(text), uint64_t{0});
+}
+
+TEST(IgnoresEventsWhileDisabled) {
+  trace::RecordInstant("before-start", 1);
+  CHECK(trace::Start());
+  trace::RecordInstant("during", 1);
+  CHECK(trace::Stop("trace_disabled.json"));
+  trace::RecordInstant("after-stop", 1);
+
+  std::string text = ReadFile("trace_disabled.json");
+  CHECK_EQ(Count(text, "before-start"), size_t{0});
+  CHECK_EQ(Count(text, "after-stop"), size_t{0});
+  CHECK_EQ(Count(text, "\"name\":\"during\""), size_t{1});
+}
+
+TEST(NewRoundDropsPreviousEvents) {
+  CHECK(trace::Start());
+  trace::RecordInstant("round-1", 1);
+  CHECK(trace::Stop("trace_round1.json"));
+  CHECK(trace::Start());
+  trace::RecordInstant("round-2", 1);
+  CHECK(trace::Stop("trace_round2.json"));
+
+  std::string text = ReadFile("trace_round2.json");
+  CHECK_EQ(Count(text, "round-1"), size_t{0});
+  CHECK_EQ(Count(text, "\"name\":\"round-2\""), size_t{1});
+}
+
+TEST(UnregisteredThreadsClaimSparesOrDrop) {
+  // 远多于备用缓冲区的未注册线程：领取到的记录事件，其余丢弃并计数，
+  // 不会在这些线程上分配缓冲区
+  constexpr int kThreads = 64;
+  CHECK(trace::Start());
+  RecordOnThreads(kThreads, "spare", 2);
+  CHECK(trace::Stop("trace_spare.json"));
+
+  std::string text = ReadFile("trace_spare.json");
+  size_t recorded = Count(text, "\"name\":\"spare\"");
+  uint64_t dropped = Dropped(text);
+  CHECK(recorded > 0);
+  CHECK(dropped > 0);
+  CHECK_EQ(recorded + dropped, size_t{kThreads * 2});
+  // 每个领取到缓冲区的线程都记录了它的全部事件
+  CHECK_EQ(recorded % 2, size_t{0});
+}
+
+TEST(RegisteredThreadsNeverDrop) {
+  constexpr int kThreads = 64;
+  CHECK(trace::Start());
+  std::vector<std::thread> workers;
+  for (int i = 0; i < kThreads; ++i) {
+    workers.emplace_back([]() {
+      trace::RegisterThread();
+      trace::RecordInstant("registered", 2);
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  CHECK(trace::Stop("trace_registered.json"));
+
+  std::string text = ReadFile("trace_registered.json");
+  CHECK_EQ(Count(text, "\"name\":\"registered\""), size_t{kThreads});
+  CHECK_EQ(Dropped(text), uint64_t{0});
+}
+
+TEST(SparesAreRefilledOnStart) {
+  // 上一个用例的线程都已退出，开始记录时备用池重新补满（优先复用它们的缓冲区）
+  CHECK(trace::Start());
+  RecordOnThreads(8, "recycled");
+  CHECK(trace::Stop("trace_recycled.json"));
+
+  std::string text = ReadFile("trace_recycled.json");
+  CHECK_EQ(Count(text, "\"name\":\"recycled\""), size_t{8});
+  CHECK_EQ(Dropped(text), uint64_t{0});
+}
+
+int main() { return check::RunAll(); }
@@ -0,0 +1,152 @@
+/**
+ * 原生模块测试
+ *
+ * 每个测试是 test/native 下的一个独立可执行文件，只链接它用到的源文件，
+ * 直接用 c++ 编译（与 bench:sink 相同），不依赖 node-gyp 和 node-addon-api。
+ * 依次编译并运行，任一测试失败时以非0退出。
+ *
+ * 用法:
+ *   npm run test:native -- [测试名...]
+ *
+ * 环境变量:
+ *   CXX    编译器（默认 c++）
+ */
+
+const { execFileSync, spawnSync } = require("child_process");
+const fs = require("fs");
+const path = require("path");
+
+const root = path.resolve(__dirname, "..");
+const outDir = path.join(root, "build", "test");
+
+// 处理图及其依赖的节点实现
+const GRAPH_SOURCES = [
+  "src/processing_graph.cc",
+  "src/delivery_batcher.cc",
+  "src/dsp_pool.cc",
+  "src/audio_mixer.cc",
+  "src/fingerprint.cc",
+  "src/noise_suppressor.cc",
+  "src/fft.cc",
+  "src/metrics.cc",
+  "src/capture_stats.cc",
+  "src/rt_check.cc",
+  "src/trace.cc",
+];
+
+// 测试名 -> 需要链接的源文件和额外选项
+const TESTS = {
+  trace: { sources: ["src/trace.cc"] },
+  rt_check: {
+    // 与 binding.gyp 的 rt_check 构建相同的宏和 --wrap 选项
+    sources: [
+      "src/synthetic_audio_capture.cc",
+      "src/target_switcher.cc",
+      ...GRAPH_SOURCES,
+    ],
+    flags: ["-DAUDIO_CAPTURE_RT_CHECK=1"],
+    ldflags: [
+      "-rdynamic",
+      "-ldl",
+      "-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free",
+      "-Wl,--wrap=_Znwm,--wrap=_Znam,--wrap=_ZdlPv,--wrap=_ZdaPv,--wrap=_ZdlPvm,--wrap=_ZdaPvm",
+      "-Wl,--wrap=pthread_mutex_lock,--wrap=pthread_cond_wait,--wrap=pthread_cond_timedwait",
+      "-Wl,--wrap=nanosleep,--wrap=usleep,--wrap=read,--wrap=write,--wrap=poll",
+      "-Wl,--wrap=napi_call_threadsafe_function",
+    ],
+    platforms: ["linux"],
+  },
+  target_switcher: { sources: ["src/target_switcher.cc", "src/trace.cc"] },
+  audio_mixer: {
+    sources: ["src/audio_mixer.cc", "src/rt_check.cc", "src/trace.cc"],
+  },
+  processing_graph: { sources: GRAPH_SOURCES },
+  dsp_pool: { sources: ["src/dsp_pool.cc", "src/trace.cc"] },
+  noise_suppressor: { sources: ["src/noise_suppressor.cc", "src/fft.cc"] },
+  delivery_batcher: {
+    sources: ["src/delivery_batcher.cc", "src/capture_stats.cc", "src/trace.cc"],
+  },
+  metrics: {
+    sources: ["src/metrics.cc", "src/dsp_pool.cc", "src/trace.cc"],
+    platforms: ["linux", "darwin"],
+  },
+  cadence_trace: {
+    sources: [
+      "src/cadence_trace.cc",
+      "src/replay_audio_capture.cc",
+      "src/rt_check.cc",
+      "src/trace.cc",
+    ],
+  },
+  level_trigger: { sources: ["src/level_trigger.cc"] },
+  idle_suspend: { sources: ["src/idle_suspend.cc", "src/trace.cc"] },
+};
+
+// rt_check.cc 在检查构建中引用 node_api.h 的类型
+function nodeIncludeDirs() {
+  return [
+    path.resolve(process.execPath, "..", "..", "include", "node"),
+    "/usr/include/node",
+  ].filter((dir) => fs.existsSync(path.join(dir, "node_api.h")));
+}
+
+function build(name, test) {
+  const binary = path.join(outDir, name);
+  const args = [
+    "-std=c++17",
+    "-O1",
+    "-g",
+    "-Wall",
+    "-I" + path.join(root, "include"),
+    ...nodeIncludeDirs().map((dir) => "-I" + dir),
+    ...(test.flags || []),
+    "-o",
+    binary,
+    path.join(root, "test", "native", `${name}_test.cc`),
+    ...test.sources.map((source) => path.join(root, source)),
+    "-pthread",
+    ...(test.ldflags || []),
+  ];
+  execFileSync(process.env.CXX || "c++", args, { stdio: "inherit" });
+  return binary;
+}
+
+function main() {
+  const selected = process.argv.slice(2);
+  const names = selected.length > 0 ? selected : Object.keys(TESTS);
+  fs.mkdirSync(outDir, { recursive: true });
+
+  const failed = [];
+  for (const name of names) {
+    const test = TESTS[name];
+    if (!test) {
+      console.error(`未知的测试: ${name}`);
+      process.exit(1);
+    }
+    if (test.platforms && !test.platforms.includes(process.platform)) {
+      console.log(`# ${name}: 跳过（仅 ${test.platforms.join(", ")}）`);
+      continue;
+    }
+
+    console.log(`# ${name}`);
+    let binary;
+    try {
+      binary = build(name, test);
+    } catch (error) {
+      failed.push(name);
+      continue;
+    }
+    const result = spawnSync(binary, [], { stdio: "inherit", cwd: outDir });
+    if (result.status !== 0) {
+      failed.push(name);
+    }
+  }
+
+  if (failed.length > 0) {
+    console.error(`失败: ${failed.join(", ")}`);
+    process.exit(1);
+  }
+  console.log(`全部通过（${names.length} 个测试）`);
+}
+
+main();
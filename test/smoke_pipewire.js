@@ -0,0 +1,152 @@
+/**
+ * PipeWire 后端冒烟测试
+ *
+ * 生成一段正弦波WAV，用 pw-play 播放作为捕获目标，通过 platform 音频源
+ * 捕获它：确认目标出现在进程列表中、收到非静音数据，然后结束播放进程，
+ * 确认会话报告 ended。需要已运行的 PipeWire（及会话管理器）和一个输出设备，
+ * CI中由工作流启动无头的 PipeWire 并创建 null sink。
+ *
+ * 用法:
+ *   npm run build && npm run test:pipewire
+ *
+ * 环境变量:
+ *   PW_PLAY    播放命令（默认 pw-play）
+ */
+
+const { spawn } = require("child_process");
+const fs = require("fs");
+const os = require("os");
+const path = require("path");
+const { AudioCapture } = require("..");
+
+const SAMPLE_RATE = 48000;
+const TONE_SECONDS = 30;
+
+// 写出单声道16位正弦波WAV
+function writeTone(file) {
+  const frames = SAMPLE_RATE * TONE_SECONDS;
+  const data = Buffer.alloc(frames * 2);
+  for (let i = 0; i < frames; i++) {
+    const sample = 0.5 * Math.sin((2 * Math.PI * 440 * i) / SAMPLE_RATE);
+    data.writeInt16LE(Math.round(sample * 32767), i * 2);
+  }
+
+  const header = Buffer.alloc(44);
+  header.write("RIFF", 0);
+  header.writeUInt32LE(36 + data.length, 4);
+  header.write("WAVE", 8);
+  header.write("fmt ", 12);
+  header.writeUInt32LE(16, 16);
+  header.writeUInt16LE(1, 20);
+  header.writeUInt16LE(1, 22);
+  header.writeUInt32LE(SAMPLE_RATE, 24);
+  header.writeUInt32LE(SAMPLE_RATE * 2, 28);
+  header.writeUInt16LE(2, 32);
+  header.writeUInt16LE(16, 34);
+  header.write("data", 36);
+  header.writeUInt32LE(data.length, 40);
+  fs.writeFileSync(file, Buffer.concat([header, data]));
+}
+
+function sleep(ms) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+// 轮询直到 condition 返回真值，超时时抛出
+async function waitFor(condition, timeoutMs, what) {
+  const deadline = Date.now() + timeoutMs;
+  for (;;) {
+    const value = condition();
+    if (value) {
+      return value;
+    }
+    if (Date.now() > deadline) {
+      throw new Error(`等待${what}超时`);
+    }
+    await sleep(50);
+  }
+}
+
+async function main() {
+  const file = path.join(os.tmpdir(), `process-audio-capture-${process.pid}.wav`);
+  writeTone(file);
+
+  const player = spawn(process.env.PW_PLAY || "pw-play", [file], {
+    stdio: "inherit",
+  });
+  const playerExited = new Promise((resolve) => {
+    player.on("exit", resolve);
+    player.on("error", resolve);
+  });
+
+  const capture = new AudioCapture({ source: "platform" });
+  try {
+    const permission = capture.checkPermission();
+    if (permission.status !== "authorized") {
+      throw new Error(`没有音频捕获权限: ${permission.status}`);
+    }
+
+    await waitFor(
+      () => capture.getProcessList().find((p) => p.pid === player.pid),
+      5000,
+      "播放进程出现在进程列表中"
+    );
+    console.log(`# 目标 pid=${player.pid}`);
+
+    let frames = 0;
+    let peak = 0;
+    let format = null;
+    const ended = new Promise((resolve) => capture.once("ended", resolve));
+
+    const started = capture.startCapture(player.pid, (audioData) => {
+      const samples = audioData.buffer;
+      for (const sample of samples) {
+        peak = Math.max(peak, Math.abs(sample));
+      }
+      frames += samples.length / audioData.channels;
+      format = `${audioData.channels}ch ${audioData.sampleRate}Hz`;
+    });
+    if (!started) {
+      throw new Error("startCapture 失败");
+    }
+
+    await waitFor(() => frames >= SAMPLE_RATE, 5000, "一秒的音频数据");
+    console.log(`# 收到 ${frames} 帧 (${format})，峰值 ${peak.toFixed(3)}`);
+    if (peak < 0.1) {
+      throw new Error("捕获到的数据是静音");
+    }
+
+    // 结束播放进程，会话应报告 ended 并停止
+    player.kill("SIGTERM");
+    const { reason } = await Promise.race([
+      ended,
+      sleep(5000).then(() => {
+        throw new Error("等待 ended 事件超时");
+      }),
+    ]);
+    console.log(`# ended: ${reason}`);
+    if (capture.isCapturing) {
+      throw new Error("ended 之后会话仍在捕获");
+    }
+
+    // rt_check 构建中输出音频线程上的违规，供排查（投递给JS的复制本身会分配）
+    const violations = capture.getRealtimeViolations(true);
+    for (const v of violations) {
+      console.log(`# rt_check ${v.kind} x${v.count} ${v.location}`);
+    }
+
+    console.log("通过");
+  } finally {
+    if (capture.isCapturing) {
+      capture.stopCapture();
+    }
+    player.kill("SIGKILL");
+    await playerExited;
+    fs.rmSync(file, { force: true });
+  }
+}
+
+main().catch((error) => {
+  console.error(`失败: ${error.message}`);
+  process.exit(1);
+});